@@ -38,6 +38,17 @@ const char* RIFT_LOCATION = "Deposito Principal";
 // Intervalo de envío (milisegundos)
 const unsigned long SEND_INTERVAL = 30000; // 30 segundos
 
+// Modo a batería: dormir entre muestras (requiere puente D0/GPIO16 -> RST)
+// El WiFi solo se levanta cada SAMPLES_PER_UPLOAD muestras o antes si la
+// temperatura se mueve UPLOAD_TEMP_DELTA, supera UPLOAD_TEMP_ALERT o la
+// puerta cambió. Las muestras esperan en la memoria RTC.
+#define DEEP_SLEEP_MODE 0
+const uint32_t SLEEP_INTERVAL_SEC = 30;     // Una muestra por despertar
+const uint8_t SAMPLES_PER_UPLOAD = 10;      // 5 minutos entre envíos
+const float UPLOAD_TEMP_DELTA = 1.0;        // °C respecto al último envío
+const float UPLOAD_TEMP_ALERT = -10.0;      // Arriba de esto se envía cada muestra
+const unsigned long FAST_CONNECT_MS = 3000; // Después, conexión normal (DHCP)
+
 // ============================================================================
 // PINES
 // ============================================================================
@@ -65,14 +76,61 @@ bool doorOpen = false;
 unsigned long doorOpenTime = 0;
 unsigned long lastDoorChange = 0;
 
-// Timing
-unsigned long lastSendTime = 0;
+// Timing: planificador sin bloqueos. La conversión del DS18B20 arranca
+// conversionMs antes de cada envío y corre sola mientras loop() sigue con
+// la puerta, el LED y el WiFi.
+const unsigned long LOOP_TICK_MS = 10;   // Período de loop() (debounce de puerta)
+unsigned long conversionMs = 750;        // Según la resolución configurada
+unsigned long conversionStart = 0;
+bool conversionPending = false;
+unsigned long nextSendTime = 0;
 unsigned long lastReconnectAttempt = 0;
 
 // Estadísticas
 unsigned long totalReadings = 0;
 unsigned long successfulSends = 0;
 unsigned long failedSends = 0;
+unsigned long cycleBusyUs = 0;           // CPU ocupada en el ciclo en curso
+unsigned long lastCycleBusyMs = 0;       // Ídem, ciclo de envío anterior
+
+// ============================================================================
+// MEMORIA RTC (sobrevive al deep sleep, no a un corte de energía)
+// ============================================================================
+
+#define RTC_MAGIC 0x52494654        // "RIFT"
+#define RTC_MAX_SAMPLES 36
+#define RTC_NO_TEMP INT16_MIN
+
+// Flags de RtcData
+#define RTC_LAST_DOOR  0x01          // Puerta en la última muestra
+#define RTC_RADIO_ON   0x02          // Este despertar tiene la radio habilitada
+#define RTC_UPLOAD_NOW 0x04          // Reinicio solo para enviar (ya hay muestra)
+
+struct RtcSample {
+  uint32_t clock;                   // Segundos del reloj RTC
+  int16_t temp1, temp2;             // Centésimas de °C
+  uint8_t doorOpen;
+};
+
+struct RtcData {
+  uint32_t crc;                     // CRC32 de todo lo que sigue
+  uint32_t magic;
+  uint32_t clock;                   // Segundos acumulados (dormido + despierto)
+  uint32_t seq;                     // seq de samples[0]
+  uint32_t boot;                    // Al azar en cada corte de energía (reinicia seq)
+  uint8_t count;
+  uint8_t flags;
+  int16_t lastSentTemp;             // Promedio del último envío (centésimas)
+  // Caché para reconectar sin escanear ni DHCP
+  uint8_t bssid[6];
+  uint8_t channel;                  // 0 = sin caché
+  uint8_t reserved;
+  uint32_t ip, gateway, subnet, dns;
+  RtcSample samples[RTC_MAX_SAMPLES];
+};
+static_assert(sizeof(RtcData) <= 512, "RtcData no entra en la memoria RTC de usuario");
+
+RtcData rtc;
 
 // ============================================================================
 // SETUP
@@ -95,12 +153,19 @@ void setup() {
   // Inicializar sensores de temperatura
   initTemperatureSensors();
   
+#if DEEP_SLEEP_MODE
+  dutyCycleWake();  // Termina en deep sleep, no vuelve
+#endif
+  
   // Conectar WiFi
   connectWiFi();
   
   // Leer estado inicial de puerta
   doorOpen = (digitalRead(DOOR_SENSOR_PIN) == HIGH);
   
+  // Primera lectura apenas termine una conversión
+  nextSendTime = millis() + conversionMs;
+  
   Serial.println("\n[OK] Sistema inicializado correctamente");
   Serial.println("============================================\n");
 }
@@ -110,6 +175,9 @@ void setup() {
 // ============================================================================
 
 void loop() {
+  unsigned long tickStart = micros();
+  unsigned long now = millis();
+  
   // Verificar conexión WiFi
   if (WiFi.status() != WL_CONNECTED) {
     reconnectWiFi();
@@ -118,17 +186,27 @@ void loop() {
   // Leer estado de puerta (con debounce)
   checkDoorStatus();
   
+  // Arrancar la conversión para que termine justo al momento del envío
+  if (!conversionPending && (long)(now + conversionMs - nextSendTime) >= 0) {
+    startConversion();
+  }
+  
   // Enviar datos periódicamente
-  if (millis() - lastSendTime >= SEND_INTERVAL) {
-    readTemperatures();
+  if (conversionPending && (long)(now - nextSendTime) >= 0 && now - conversionStart >= conversionMs) {
+    lastCycleBusyMs = cycleBusyUs / 1000;
+    cycleBusyUs = 0;
+    collectTemperatures();
     sendDataToReceptor();
-    lastSendTime = millis();
+    
+    nextSendTime += SEND_INTERVAL;
+    if ((long)(millis() - nextSendTime) >= 0) nextSendTime = millis() + SEND_INTERVAL;
   }
   
   // Parpadeo LED según estado
   updateStatusLED();
   
-  delay(100);
+  cycleBusyUs += micros() - tickStart;
+  delay(LOOP_TICK_MS);
 }
 
 // ============================================================================
@@ -143,6 +221,10 @@ void initTemperatureSensors() {
   // Configurar resolución (12 bits = mayor precisión)
   sensors.setResolution(12);
   
+  // requestTemperatures() vuelve enseguida; el tiempo lo lleva loop()
+  sensors.setWaitForConversion(false);
+  conversionMs = sensors.millisToWaitForConversion(12);
+  
   // Detectar sensores conectados
   sensorCount = sensors.getDeviceCount();
   Serial.println("[INFO] Sensores detectados: " + String(sensorCount));
@@ -179,11 +261,23 @@ void printAddress(DeviceAddress deviceAddress) {
   Serial.println();
 }
 
+void startConversion() {
+  sensors.requestTemperatures();
+  conversionStart = millis();
+  conversionPending = true;
+}
+
+// Lectura bloqueante (modo deep sleep: no hay nada más que hacer mientras)
 void readTemperatures() {
+  startConversion();
+  delay(conversionMs);
+  collectTemperatures();
+}
+
+// Leer el resultado de la conversión ya terminada
+void collectTemperatures() {
   Serial.println("\n[READ] Leyendo temperaturas...");
-  
-  sensors.requestTemperatures();
-  delay(750); // Esperar conversión (12 bits)
+  conversionPending = false;
   
   if (sensorCount >= 1) {
     temperature1 = sensors.getTempC(sensor1Address);
@@ -352,7 +446,216 @@ void sendDataToReceptor() {
   
   // Mostrar estadísticas
   Serial.println("[STATS] Enviados: " + String(successfulSends) + 
-                 " | Fallidos: " + String(failedSends));
+                 " | Fallidos: " + String(failedSends) +
+                 " | Activo: " + String(lastCycleBusyMs) + " ms/ciclo");
+}
+
+// ============================================================================
+// MODO DUTY CYCLE (DEEP SLEEP)
+// ============================================================================
+
+uint32_t rtcCrc(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (len--) {
+    crc ^= *data++;
+    for (int i = 0; i < 8; i++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+void rtcLoad() {
+  ESP.rtcUserMemoryRead(0, (uint32_t*)&rtc, sizeof(rtc));
+  uint32_t crc = rtcCrc((const uint8_t*)&rtc + 4, sizeof(rtc) - 4);
+  if (rtc.magic != RTC_MAGIC || rtc.crc != crc) {
+    // Primer arranque o corte de energía
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = RTC_MAGIC;
+    rtc.seq = 1;
+    do rtc.boot = ESP.random(); while (rtc.boot == 0);
+    rtc.lastSentTemp = RTC_NO_TEMP;
+    rtc.flags = RTC_RADIO_ON;
+    Serial.println("[RTC] Memoria RTC inicializada");
+  }
+}
+
+void rtcSave() {
+  rtc.crc = rtcCrc((const uint8_t*)&rtc + 4, sizeof(rtc) - 4);
+  ESP.rtcUserMemoryWrite(0, (uint32_t*)&rtc, sizeof(rtc));
+}
+
+int16_t toCenti(float temp) {
+  return temp == -999.0 ? RTC_NO_TEMP : (int16_t)lroundf(temp * 100.0);
+}
+
+void rtcAppendSample() {
+  // Buffer lleno (receptor caído): se pierde la muestra más vieja
+  if (rtc.count == RTC_MAX_SAMPLES) {
+    memmove(&rtc.samples[0], &rtc.samples[1], sizeof(RtcSample) * (RTC_MAX_SAMPLES - 1));
+    rtc.count--;
+    rtc.seq++;
+  }
+  RtcSample& s = rtc.samples[rtc.count++];
+  s.clock = rtc.clock;
+  s.temp1 = toCenti(temperature1);
+  s.temp2 = toCenti(temperature2);
+  s.doorOpen = doorOpen;
+}
+
+// BSSID, canal e IP del último enlace; si fallan, escaneo y DHCP normales
+bool fastConnect() {
+  WiFi.forceSleepWake();
+  delay(1);
+  WiFi.mode(WIFI_STA);
+  
+  bool cached = rtc.channel != 0 && rtc.ip != 0;
+  if (cached) {
+    WiFi.config(IPAddress(rtc.ip), IPAddress(rtc.gateway), IPAddress(rtc.subnet), IPAddress(rtc.dns));
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, rtc.channel, rtc.bssid, true);
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+  
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (cached && millis() - start > FAST_CONNECT_MS) {
+      Serial.println("[WIFI] Caché inválida, conexión normal");
+      cached = false;
+      rtc.channel = 0;
+      WiFi.disconnect();
+      WiFi.config(0u, 0u, 0u);
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+      start = millis();
+    } else if (!cached && millis() - start > 15000) {
+      return false;
+    }
+    delay(10);
+  }
+  
+  rtc.ip = (uint32_t)WiFi.localIP();
+  rtc.gateway = (uint32_t)WiFi.gatewayIP();
+  rtc.subnet = (uint32_t)WiFi.subnetMask();
+  rtc.dns = (uint32_t)WiFi.dnsIP();
+  memcpy(rtc.bssid, WiFi.BSSID(), sizeof(rtc.bssid));
+  rtc.channel = WiFi.channel();
+  Serial.println("[WIFI] Conectado en " + String(millis() - start) + " ms");
+  return true;
+}
+
+// Todo el buffer en un POST binario a /api/data/batch
+bool sendBatch() {
+  uint8_t body[4 + 1 + 32 + 2 + 4 + 1 + RTC_MAX_SAMPLES * 12];
+  size_t n = 0;
+  body[n++] = 'R';
+  body[n++] = 'B';
+  body[n++] = 3;                    // Versión 3: con rift_id y boot
+  
+  uint8_t idLen = strlen(RIFT_NAME);
+  body[n++] = idLen;
+  memcpy(body + n, RIFT_NAME, idLen);
+  n += idLen;
+  uint16_t riftId = RIFT_ID;
+  memcpy(body + n, &riftId, 2);
+  n += 2;
+  memcpy(body + n, &rtc.boot, 4);
+  n += 4;
+  body[n++] = rtc.count;
+  
+  uint32_t now = rtc.clock + millis() / 1000;
+  int8_t rssi = WiFi.RSSI();
+  for (int i = 0; i < rtc.count; i++) {
+    const RtcSample& s = rtc.samples[i];
+    uint32_t seq = rtc.seq + i;
+    uint32_t age = now - s.clock;
+    uint16_t age16 = age > 65535 ? 65535 : age;
+    memcpy(body + n, &seq, 4);
+    memcpy(body + n + 4, &age16, 2);
+    memcpy(body + n + 6, &s.temp1, 2);
+    memcpy(body + n + 8, &s.temp2, 2);
+    body[n + 10] = s.doorOpen ? 0x01 : 0x00;
+    body[n + 11] = (uint8_t)rssi;
+    n += 12;
+  }
+  
+  WiFiClient client;
+  HTTPClient http;
+  String url = "http://" + String(RECEPTOR_IP) + ":" + String(RECEPTOR_PORT) + "/api/data/batch";
+  http.begin(client, url);
+  http.addHeader("Content-Type", "application/octet-stream");
+  http.setTimeout(5000);
+  
+  int httpCode = http.POST(body, n);
+  bool ok = httpCode == HTTP_CODE_OK;
+  if (ok) {
+    // Solo interesa cuántos confirmó
+    StaticJsonDocument<32> filter;
+    filter["accepted"] = true;
+    StaticJsonDocument<64> resp;
+    deserializeJson(resp, http.getStream(), DeserializationOption::Filter(filter));
+    Serial.println("[OK] Lote enviado: " + String(resp["accepted"] | 0) + "/" + String(rtc.count));
+  } else {
+    Serial.println("[ERROR] Lote no enviado, HTTP " + String(httpCode));
+  }
+  http.end();
+  return ok;
+}
+
+void dutyCycleWake() {
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_OFF);
+  WiFi.forceSleepBegin();
+  delay(1);
+  
+  rtcLoad();
+  bool radioOn = rtc.flags & RTC_RADIO_ON;
+  bool retry = rtc.flags & RTC_UPLOAD_NOW;
+  rtc.flags &= ~RTC_UPLOAD_NOW;
+  
+  bool upload = retry;
+  if (!retry) {
+    readTemperatures();
+    doorOpen = (digitalRead(DOOR_SENSOR_PIN) == HIGH);
+    rtcAppendSample();
+    
+    bool lastDoor = rtc.flags & RTC_LAST_DOOR;
+    int16_t avg = toCenti(temperatureAvg);
+    upload = rtc.count >= SAMPLES_PER_UPLOAD || doorOpen != lastDoor ||
+             (temperatureAvg != -999.0 && temperatureAvg > UPLOAD_TEMP_ALERT) ||
+             (avg != RTC_NO_TEMP && rtc.lastSentTemp != RTC_NO_TEMP &&
+              abs(avg - rtc.lastSentTemp) >= (int)(UPLOAD_TEMP_DELTA * 100));
+    if (doorOpen) rtc.flags |= RTC_LAST_DOOR;
+    else rtc.flags &= ~RTC_LAST_DOOR;
+  }
+  
+  // Despertar sin radio: reinicio inmediato con la radio habilitada
+  if (upload && !radioOn) {
+    rtc.flags |= RTC_UPLOAD_NOW | RTC_RADIO_ON;
+    rtcSave();
+    ESP.deepSleep(1000, WAKE_RF_DEFAULT);
+  }
+  
+  if (upload && rtc.count > 0 && fastConnect() && sendBatch()) {
+    // Referencia para UPLOAD_TEMP_DELTA: promedio de la última muestra
+    const RtcSample& last = rtc.samples[rtc.count - 1];
+    if (last.temp1 != RTC_NO_TEMP && last.temp2 != RTC_NO_TEMP) rtc.lastSentTemp = (last.temp1 + last.temp2) / 2;
+    else rtc.lastSentTemp = last.temp1 != RTC_NO_TEMP ? last.temp1 : last.temp2;
+    rtc.seq += rtc.count;
+    rtc.count = 0;
+  }
+  
+  // La radio del próximo despertar solo si ese ya completa el lote
+  bool nextRadio = rtc.count + 1 >= SAMPLES_PER_UPLOAD;
+  if (nextRadio) rtc.flags |= RTC_RADIO_ON;
+  else rtc.flags &= ~RTC_RADIO_ON;
+  
+  // Cadencia fija: el tiempo despierto se descuenta del sueño
+  unsigned long awakeMs = millis();
+  uint64_t sleepUs = SLEEP_INTERVAL_SEC * 1000000ULL;
+  sleepUs = awakeMs * 1000ULL < sleepUs - 100000 ? sleepUs - awakeMs * 1000ULL : 100000;
+  rtc.clock += SLEEP_INTERVAL_SEC;
+  rtcSave();
+  
+  Serial.println("[SLEEP] Despierto " + String(awakeMs) + " ms, " + String(rtc.count) + " muestras en RTC");
+  ESP.deepSleep(sleepUs, nextRadio ? WAKE_RF_DEFAULT : WAKE_RF_DISABLED);
 }
 
 // ============================================================================
@@ -7,7 +7,8 @@
  * Integrado con la máquina de estados:
  * - Solo verifica alertas en estados NORMAL o ALERT
  * - Suspende alertas durante DEFROST y COOLDOWN
- * - Reporta a Supabase y Telegram
+ * - Reporta a Supabase y Telegram por la bandeja de salida (outbox.h)
+ * - Las condiciones de alerta son reglas por sonda/puerta (rules.h)
  * 
  * ============================================================================
  */
@@ -17,29 +18,36 @@
 
 #include "config.h"
 #include "types.h"
+#include "state_machine.h"
+#include "rules.h"
+#include "outbox.h"
 
 extern Config config;
 extern SensorData sensorData;
 extern SystemState state;
 
 extern void setRelay(int relayIndex, bool on);
-extern void sendTelegramAlert(String message);
-extern void sendAlertToSupabase(String alertType, String severity, String message);
-extern void changeState(SystemStateEnum newState, const char* reason);
-
-// Variables de tracking de alertas
-static unsigned long highTempAccumulatedSec = 0;
-static unsigned long lastAlertCheckTime = 0;
-static unsigned long doorOpenAlertSent[MAX_DOOR_SENSORS] = {0};
+extern bool stateDispatch(StateEvent event, const char* reason);
 
 // ============================================================================
 // ACTIVAR ALERTA
 // ============================================================================
-void triggerAlert(String message, bool critical = true) {
-    if (state.alertActive) return;
+// type: tipo para la bandeja de salida ("temperature", "door", "humidity")
+void triggerAlert(String message, bool critical = true, uint8_t source = ALERT_SOURCE_SYSTEM,
+                  const char* type = "temperature") {
+    // Ya en ALERT (otra regla crítica): sin transición ni sirena, pero la
+    // nueva causa igual sale por Telegram, Supabase y SMS
+    if (state.alertActive) {
+        state.alertMessage = message;
+        state.totalAlerts++;
+        Serial.println("🚨 [ALERTA] " + message);
+        outboxPost(type, critical ? "critical" : "warning", source, message);
+        streamNotifyAlert();
+        return;
+    }
     
     // Cambiar a estado ALERT
-    changeState(STATE_ALERT, message.c_str());
+    stateDispatch(EV_ALERT_RAISED, message.c_str());
     
     state.alertActive = true;
     state.alertCritical = critical;
@@ -62,24 +70,10 @@ void triggerAlert(String message, bool critical = true) {
         digitalWrite(PIN_BUZZER, HIGH);
     }
     
-    // Enviar a Telegram (con rate limit de 5 minutos)
-    if (config.telegramEnabled && state.internetAvailable) {
-        unsigned long now = millis();
-        if (now - state.lastTelegramAlert > 300000) {
-            String telegramMsg = "🚨 *ALERTA " + String(critical ? "CRÍTICA" : "WARNING") + "*\n\n";
-            telegramMsg += "📍 *Dispositivo:* " + String(DEVICE_ID) + "\n";
-            telegramMsg += "📝 " + message + "\n";
-            telegramMsg += "🌡️ *Temp actual:* " + String(sensorData.tempAvg, 1) + "°C";
-            
-            sendTelegramAlert(telegramMsg);
-            state.lastTelegramAlert = now;
-        }
-    }
+    // Telegram, Supabase y SMS con reintentos (outbox.h)
+    outboxPost(type, critical ? "critical" : "warning", source, message);
     
-    // Enviar a Supabase
-    if (config.supabaseEnabled && state.internetAvailable) {
-        sendAlertToSupabase("temperature", critical ? "critical" : "warning", message);
-    }
+    streamNotifyAlert();
 }
 
 // ============================================================================
@@ -98,9 +92,10 @@ void clearAlert() {
     digitalWrite(PIN_BUZZER, LOW);
     
     // Volver a estado NORMAL
-    changeState(STATE_NORMAL, "Alerta resuelta");
+    stateDispatch(EV_ALERT_CLEARED, nullptr);
     
     Serial.println("✅ [ALERTA] Alerta desactivada - Condiciones normalizadas");
+    streamNotifyAlert();
 }
 
 // ============================================================================
@@ -116,92 +111,7 @@ void acknowledgeAlert() {
     digitalWrite(PIN_BUZZER, LOW);
     
     Serial.println("🔕 [ALERTA] Alerta reconocida - Sirena silenciada");
-}
-
-// ============================================================================
-// VERIFICAR ALERTAS DE TEMPERATURA
-// ============================================================================
-void checkTemperatureAlerts() {
-    if (!sensorData.tempValid) return;
-    
-    float temp = sensorData.tempAvg;
-    unsigned long now = millis();
-    
-    // Calcular tiempo transcurrido desde última verificación
-    unsigned long elapsed = 0;
-    if (lastAlertCheckTime > 0) {
-        elapsed = (now - lastAlertCheckTime) / 1000;
-    }
-    lastAlertCheckTime = now;
-    
-    // Verificar si temperatura está por encima del umbral crítico
-    if (temp > config.tempCritical) {
-        // Acumular tiempo en temperatura alta
-        highTempAccumulatedSec += elapsed;
-        
-        // Si superó el delay y no hay alerta activa ni reconocida
-        if (highTempAccumulatedSec >= (unsigned long)config.alertDelaySec && 
-            !state.alertActive && 
-            !state.alertAcknowledged) {
-            
-            String msg = "🌡️ Temperatura CRÍTICA: " + String(temp, 1) + "°C";
-            msg += " (límite: " + String(config.tempCritical, 1) + "°C)";
-            msg += " - Sostenida por " + String(highTempAccumulatedSec / 60) + " min";
-            
-            triggerAlert(msg, true);
-        }
-    } else {
-        // Temperatura OK - resetear acumulador
-        highTempAccumulatedSec = 0;
-        state.alertAcknowledged = false;
-        
-        // Si había alerta activa, desactivarla
-        if (state.alertActive && state.currentState == STATE_ALERT) {
-            clearAlert();
-        }
-    }
-}
-
-// ============================================================================
-// VERIFICAR ALERTAS DE PUERTAS
-// ============================================================================
-void checkDoorAlerts() {
-    unsigned long now = millis();
-    
-    for (int i = 0; i < MAX_DOOR_SENSORS; i++) {
-        if (!sensorData.door[i].enabled) continue;
-        
-        if (sensorData.door[i].isOpen && sensorData.door[i].openSince > 0) {
-            unsigned long openDuration = (now - sensorData.door[i].openSince) / 1000;
-            
-            // Si superó el tiempo máximo y no se envió alerta recientemente
-            if (openDuration >= (unsigned long)config.doorOpenMaxSec) {
-                // Rate limit: una alerta por puerta cada 10 minutos
-                if (now - doorOpenAlertSent[i] > 600000) {
-                    doorOpenAlertSent[i] = now;
-                    
-                    String msg = "🚪 Puerta " + String(sensorData.door[i].name);
-                    msg += " abierta por " + String(openDuration / 60) + " minutos";
-                    msg += " (máximo: " + String(config.doorOpenMaxSec / 60) + " min)";
-                    
-                    // Enviar a Telegram
-                    if (config.telegramEnabled && state.internetAvailable) {
-                        sendTelegramAlert("⚠️ *ALERTA PUERTA*\n\n" + msg);
-                    }
-                    
-                    // Enviar a Supabase
-                    if (config.supabaseEnabled && state.internetAvailable) {
-                        sendAlertToSupabase("door", "warning", msg);
-                    }
-                    
-                    Serial.println("⚠️ [PUERTA] " + msg);
-                }
-            }
-        } else {
-            // Puerta cerrada - resetear timer de alerta
-            doorOpenAlertSent[i] = 0;
-        }
-    }
+    streamNotifyAlert();
 }
 
 // ============================================================================
@@ -224,11 +134,18 @@ void checkAlerts() {
         return;
     }
     
-    // Verificar alertas de temperatura
-    checkTemperatureAlerts();
+    // Reglas de sondas, puertas e interior
+    bool critical = rulesEvaluate();
     
-    // Verificar alertas de puertas
-    checkDoorAlerts();
+    if (!critical) {
+        // Condiciones normales - el próximo disparo vuelve a sonar
+        state.alertAcknowledged = false;
+        
+        // Si había alerta activa, desactivarla
+        if (state.alertActive && state.currentState == STATE_ALERT) {
+            clearAlert();
+        }
+    }
 }
 
 // ============================================================================
@@ -245,8 +162,23 @@ void getAlertsJSON(JsonObject& obj) {
         obj["alert_duration_sec"] = (millis() - state.alertStartTime) / 1000;
     }
     
-    obj["high_temp_accumulated_sec"] = highTempAccumulatedSec;
-    obj["alert_threshold_sec"] = config.alertDelaySec;
+    // Claves de antes de las reglas, de la regla crítica del interior
+    int interior = rulesInteriorRule();
+    obj["high_temp_accumulated_sec"] = ruleHeldSec(interior);
+    obj["alert_threshold_sec"] = interior >= 0 ? ruleDurationSec(config.rules[interior])
+                                               : (unsigned long)config.alertDelaySec;
+    
+    JsonArray rules = obj.createNestedArray("rules");
+    getRulesStateJSON(rules);
+    
+    // Predicción: minutos hasta temp_critical y confianza (0-1) por sonda
+    obj["trend_horizon_min"] = config.trendHorizonMin;
+    JsonArray trendArr = obj.createNestedArray("trend");
+    getTrendJSON(trendArr);
+    
+    // Bandeja de salida: entregas por canal y recibos
+    JsonObject outboxObj = obj.createNestedObject("outbox");
+    getOutboxJSON(outboxObj);
 }
 
 #endif // ALERTS_H
@@ -52,10 +52,21 @@
 #define TELEGRAM_BOT_TOKEN  "8175168657:AAE5HJBnp4Hx6LOECBh7Ps3utw35WMRdGnI"
 #define TELEGRAM_CHAT_ID    "7713503644"
 
+// Destinatarios de las alertas (agregar chat IDs según necesidad)
+const char* TELEGRAM_CHAT_IDS[] = {
+    TELEGRAM_CHAT_ID,
+};
+const int TELEGRAM_CHAT_COUNT = 1;
+
 // Supabase
 #define SUPABASE_URL        "https://xhdeacnwdzvkivfjzard.supabase.co"
 #define SUPABASE_ANON_KEY   "sb_publishable_JhTUv1X2LHMBVILUaysJ3g_Ho11zu-Q"
 
+// Hora del dispositivo (SNTP, UTC) para created_at de cada fila
+#define NTP_SERVER_1        "pool.ntp.org"
+#define NTP_SERVER_2        "time.google.com"
+#define CLOCK_VALID_AFTER   1700000000UL    // time() menor = aún sin sincronizar
+
 // ============================================================================
 // SECCIÓN 3: MAPA DE PINES ESP32-WROOM-32 (38 pines)
 // ============================================================================
@@ -207,7 +218,15 @@
 #define WIFI_RESET_HOLD_SEC 5       // Segundos para resetear WiFi
 
 // ----------------------------------------------------------------------------
-// 3.8 PINES LIBRES DISPONIBLES
+// 3.8 MÓDULO GSM SIM800L (sim800.h) - SMS de alertas críticas
+// ----------------------------------------------------------------------------
+// UART2 en GPIO16/17: los mismos pines que las puertas 3 y 2 (no usar
+// juntas). Sin el módulo, o si no responde al arrancar, el canal SMS de la
+// bandeja de alertas queda salteado.
+#define SIM800_ENABLED      false
+
+// ----------------------------------------------------------------------------
+// 3.9 PINES LIBRES DISPONIBLES
 // ----------------------------------------------------------------------------
 // Los siguientes pines están libres para expansión futura:
 //
@@ -247,6 +266,8 @@ typedef enum {
     STATE_INITIALIZING              // Arrancando sistema
 } SystemStateEnum;
 
+#define STATE_COUNT                 7       // Filas del índice de state_machine.h
+
 // Nombres de estados para reportes
 #define STATE_NAME_NORMAL           "NORMAL"
 #define STATE_NAME_DEFROST          "EN_DESCONGELAMIENTO"
@@ -269,6 +290,17 @@ typedef enum {
 // Tiempos de alerta (en segundos)
 #define DEFAULT_ALERT_DELAY_SEC     300     // 5 min antes de alertar
 #define DEFAULT_DOOR_OPEN_MAX_SEC   180     // 3 min máximo puerta abierta
+#define DEFAULT_DOOR_REPEAT_SEC     600     // Re-avisar puerta abierta cada 10 min
+
+// Reglas de alerta (ver rules.h)
+#define DEFAULT_INTERIOR_PROBES     0x03    // Sondas 1 y 2: interior (3 y 4 son evaporador/condensador)
+#define RULE_RATE_WINDOW_MS         60000   // Ventana de las reglas de subida
+
+// Tendencia hacia temperatura crítica (ver trend.h)
+#define DEFAULT_TREND_HORIZON_MIN   30      // Avisar si se llega a la crítica antes de esto
+#define TREND_TAU_SEC               900     // Memoria del ajuste (peso exp(-edad/tau))
+#define TREND_MIN_CONFIDENCE        0.6     // r² mínimo para confiar en la predicción
+#define TREND_MIN_SLOPE_C_MIN       0.01    // Subida menor = sin predicción
 
 // Tiempos de descongelamiento (en segundos)
 #define DEFAULT_DEFROST_COOLDOWN_SEC    1800    // 30 min post-defrost
@@ -281,24 +313,132 @@ typedef enum {
 // SECCIÓN 6: INTERVALOS DE OPERACIÓN (no bloqueantes, en ms)
 // ============================================================================
 
-#define INTERVAL_SENSOR_READ_MS     2000    // Leer sensores cada 2 seg
+#define INTERVAL_SENSOR_READ_MS     2000    // Leer puertas y DHT22 cada 2 seg
+#define TEMP_SAMPLE_INTERVAL_MS     1000    // Ciclo DS18B20 (todas las sondas)
+#define TEMP_READ_RETRIES           1       // Re-lecturas si falla el CRC
+#define TEMP_MAX_FAIL_STREAK        3       // Ciclos fallidos para invalidar sonda
+#define TEMP_SAMPLE_FAST_INTERVAL_MS 250    // Ciclo DS18B20 en alerta o subida rápida
 #define INTERVAL_STATUS_PRINT_MS    5000    // Imprimir status cada 5 seg
 #define INTERVAL_DEFROST_CHECK_MS   500     // Verificar defrost cada 500ms
 #define INTERVAL_ALERT_CHECK_MS     1000    // Verificar alertas cada 1 seg
 #define INTERVAL_INTERNET_CHECK_MS  30000   // Verificar internet cada 30 seg
 #define INTERVAL_SUPABASE_SYNC_MS   5000    // Sincronizar Supabase cada 5 seg
-#define INTERVAL_HISTORY_UPDATE_MS  60000   // Actualizar historial cada 1 min
+#define INTERVAL_HISTORY_UPDATE_MS  1000    // Muestra del historial cada 1 seg
 #define INTERVAL_DEVICE_STATUS_MS   60000   // Actualizar estado dispositivo cada 1 min
 
+#define INTERVAL_COMMAND_CHECK_MS   30000   // Verificar comandos remotos cada 30 seg
+
+// Resolución adaptativa DS18B20 (bits: 9=94ms 0.5°C ... 12=750ms 0.0625°C)
+#define TEMP_RES_NORMAL             12      // Monitoreo normal
+#define TEMP_RES_MODERATE           11      // Subida moderada
+#define TEMP_RES_DEFROST            10      // Defrost / cooldown / config
+#define TEMP_RES_FAST               9       // Alerta o subida rápida
+#define TEMP_RATE_MODERATE_C_MIN    0.3     // °C/min de subida para 11 bits
+#define TEMP_RATE_FAST_C_MIN        1.0     // °C/min de subida para 9 bits
+#define TEMP_RATE_WINDOW_MS         30000   // Ventana para medir la subida
+#define TEMP_RES_HOLD_MS            60000   // Mínimo antes de volver a más bits
+
+// Lote de lecturas a Supabase (un POST con varias filas)
+#define SUPABASE_BATCH_MAX_ROWS     12      // Enviar al juntar N lecturas (1 = sin lotes)
+#define SUPABASE_BATCH_INTERVAL_MS  60000   // ...o al pasar este tiempo desde la primera
+
+// Alias para compatibilidad con código existente
+#define SUPABASE_SYNC_INTERVAL      INTERVAL_SUPABASE_SYNC_MS
+
 // ============================================================================
 // SECCIÓN 7: LÍMITES DEL SISTEMA
 // ============================================================================
 
-#define HISTORY_SIZE                60      // Puntos de historial (1 hora a 1/min)
-#define MAX_ALERTS_QUEUE            10      // Cola de alertas pendientes
+// Historial por niveles (ver history.h): período de bucket x cantidad
+#define HISTORY_TIER1_SEC           60      // 1 min ...
+#define HISTORY_TIER1_SIZE          360     // ... 6 horas
+#define HISTORY_TIER2_SEC           300     // 5 min ...
+#define HISTORY_TIER2_SIZE          576     // ... 48 horas
+#define HISTORY_TIER3_SEC           3600    // 1 hora ...
+#define HISTORY_TIER3_SIZE          720     // ... 30 días
+#define HISTORY_DEFAULT_RANGE_SEC   3600    // /api/history sin range
+#define MAX_ALERTS_QUEUE            10      // Alertas en la bandeja de salida (outbox.h)
+#define MAX_ALERT_RULES             16      // Reglas de alerta configurables
 #define JSON_BUFFER_SIZE            2048    // Buffer para JSON
+#define WEB_CHUNK_SIZE              512     // Bloque de respuesta por partes (web_response.h)
+
+// Servidor web esp_http_server (ver web_api.h)
+#define WEB_SERVER_CORE             0
+#define WEB_SERVER_STACK            8192    // Tarea del servidor (handlers rápidos)
+#define WEB_SERVER_PRIORITY         1
+#define WEB_MAX_SOCKETS             10      // Conexiones abiertas (keep-alive y /api/stream)
+#define WEB_MAX_URI_HANDLERS        32
+#define WEB_WORKERS                 2       // Handlers lentos en paralelo
+#define WEB_WORKER_STACK            6144
+#define WEB_JOB_QUEUE_LEN           4       // Pedidos lentos esperando worker (más: 503)
+#define WEB_BODY_MAX                4096    // Cuerpo máximo de un POST
+#define WEB_COMMAND_QUEUE_LEN       8       // Cambios pendientes de aplicar en loop()
+#define WEB_COMMAND_TIMEOUT_MS      2000    // Espera máxima de un handler por loop()
+#define WEB_COMMAND_TEXT_LEN        64      // Comando de /api/command (serial_api.h)
+#define WEB_COMMAND_REPLY_LEN       768     // Respuesta de /api/command (HELP es la más larga)
+
+// Versión y caché de /api/status (ver web_status.h)
+#define STATUS_TICK_MS              10000   // Uptime, WiFi, contadores; evento "system"
+#define STATUS_CACHE_SIZE           3072    // Documento completo serializado
+
+// Efectos de la máquina de estados (ver state_machine.h)
+#define STATE_EFFECT_QUEUE_LEN      8       // Relé, Supabase y log pendientes
+#define STATE_EFFECTS_PER_LOOP      2       // Efectos ejecutados por vuelta de loop()
+
+// Eventos en vivo /api/stream (ver web_stream.h)
+#define STREAM_MAX_CLIENTS          4       // Suscriptores simultáneos
+#define STREAM_RING_LEN             16      // Eventos guardados por cliente atrasado
+#define STREAM_EVENT_MAX            256     // JSON máximo de un evento
+#define STREAM_OUT_SIZE             (STATUS_CACHE_SIZE + 64)  // Pendiente por cliente (entra un snapshot)
+#define STREAM_PUMP_MS              20      // Cada cuánto se escribe a los clientes
+#define STREAM_TASK_STACK           2048
 #define MAX_WIFI_RETRIES            3       // Reintentos de conexión WiFi
 
+// Tarea de enlace de red (ver uplink.h)
+#define UPLINK_TASK_ENABLED         true    // false = HTTP en línea dentro de loop()
+#define UPLINK_TASK_CORE            0       // loop() corre en el core 1
+#define UPLINK_TASK_STACK           8192
+#define UPLINK_TASK_PRIORITY        1
+#define UPLINK_QUEUE_LEN            12      // Eventos pendientes (alertas, puertas...)
+#define UPLINK_BODY_MAX             768     // Payload máximo por trabajo
+#define UPLINK_PATH_MAX             160     // Tabla + filtro PostgREST
+#define UPLINK_JOB_MAX_AGE_MS       600000  // Trabajos más viejos se descartan (10 min)
+#define UPLINK_IDLE_WAIT_MS         100     // Espera de la tarea sin trabajos
+#define SUPABASE_BATCH_JSON_MAX     8192    // JSON de un lote (se arma en la tarea)
+
+// Bandeja de salida de alertas (ver outbox.h); lugares: MAX_ALERTS_QUEUE
+#define OUTBOX_MSG_MAX              192     // Texto de una alerta
+#define OUTBOX_RETRY_BASE_MS        15000   // Primer reintento; se duplica en cada falla
+#define OUTBOX_RETRY_MAX_MS         1800000 // Tope del backoff (30 min)
+#define OUTBOX_MAX_ATTEMPTS         20      // Fallas por canal antes de abandonar (~7 h)
+
+// Conexiones HTTPS persistentes (ver http_pool.h)
+#define HTTP_POOL_SIZE              2       // Hosts con conexión abierta (Supabase, Telegram)
+#define HTTP_POOL_HOST_MAX          64
+#define HTTP_POOL_IDLE_MS           50000   // Cerrar antes que el keep-alive del servidor
+#define HTTP_POOL_DNS_TTL_MS        300000  // IP resuelta válida 5 min
+#define HTTP_POOL_TIMEOUT_MS        5000    // Conexión + handshake + respuesta
+
+// Diario de telemetría en flash (ver journal.h y partitions.csv)
+#define JOURNAL_ENABLED             true    // false = lecturas solo con internet
+#define JOURNAL_PARTITION_LABEL     "journal"
+#define JOURNAL_SECTOR_SIZE         4096
+#define JOURNAL_CURSOR_SAVE_MS      60000   // Guardar el cursor de subida en NVS
+#define JOURNAL_REPLAY_GAP_MS       1000    // Mínimo entre envíos desde el diario
+#define JOURNAL_RETRY_MS            15000   // Espera tras un envío fallido
+
+// Grabador de entradas para trace_replay (ver recorder.h, trace.h y partitions.csv)
+#define TRACE_ENABLED               true    // false = no grabar
+#define TRACE_PARTITION_LABEL       "trace"
+#define TRACE_SECTOR_SIZE           4096
+#define TRACE_BUFFER_SIZE           256     // Registros en RAM antes de escribir en flash
+#define TRACE_FLUSH_MS              60000   // Escribir lo pendiente al menos cada 1 min
+#define TRACE_TEMP_DEADBAND_C       0.125   // Cambio mínimo de una sonda para grabarla
+
+// Perfilador de loop() (ver profiler.h)
+#define PERF_PROFILER_ENABLED       true    // Medir cada etapa de loop()
+#define PERF_WORST_COUNT            4       // Peores casos guardados por etapa
+
 // ============================================================================
 // SECCIÓN 8: CONFIGURACIÓN DE SIMULACIÓN (para testing)
 // ============================================================================
@@ -311,6 +451,8 @@ typedef enum {
 // SECCIÓN 9: UBICACIÓN GPS (opcional)
 // ============================================================================
 
+#define LOCATION_NAME               "Desarrollo FrioSeguro"
+#define LOCATION_DETAIL             DEVICE_LOCATION
 #define LOCATION_LAT                -38.7196  // Bahía Blanca
 #define LOCATION_LON                -62.2724
 
@@ -11,11 +11,16 @@
  * - sensors.h       : Lectura de sensores (temp, puertas, DHT22)
  * - storage.h       : Almacenamiento en flash (Preferences)
  * - alerts.h        : Lógica de alertas y alarmas
+ * - rules.h         : Reglas de alerta por sonda, puerta e interior
+ * - trend.h         : Tendencia de temperatura (aviso antes de la crítica)
+ * - outbox.h        : Bandeja de salida de alertas (reintentos, NVS)
+ * - sim800.h        : SMS de alertas críticas (módulo GSM opcional)
  * - telegram.h      : Notificaciones Telegram
  * - supabase.h      : Integración con Supabase
  * - wifi_utils.h    : Gestión de WiFi
  * - web_api.h       : Servidor web y API REST
- * - html_ui.h       : Página HTML embebida
+ * - html_ui.h       : Dashboard embebido (ui/, gzip en flash)
+ * - serial_api.h    : Comandos de texto (Serial y /api/command)
  * 
  * ESTADOS DEL SISTEMA:
  * - NORMAL: Operación normal, monitoreando
@@ -44,9 +49,10 @@
 #include <WiFiManager.h>
 #include <WiFiUdp.h>
 #include <ESPmDNS.h>
-#include <WebServer.h>
+#include <esp_http_server.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
+#include <WiFiClientSecure.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <DHT.h>
@@ -61,7 +67,7 @@
 // ============================================================================
 // OBJETOS GLOBALES
 // ============================================================================
-WebServer server(80);
+httpd_handle_t server = NULL;       // esp_http_server, se inicia en webStart()
 WiFiManager wifiManager;
 WiFiUDP udpDiscovery;
 Preferences prefs;
@@ -77,27 +83,31 @@ Config config;
 SensorData sensorData;
 SystemState state;
 
-#define HISTORY_SIZE 60
-HistoryPoint history[HISTORY_SIZE];
-int historyIndex = 0;
-
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
 void setRelay(int relayIndex, bool on);
 void setRelayAll(bool on);
 void sendTelegramAlert(String message);
-void sendAlertToSupabase(String alertType, String severity, String message);
 void supabaseSendDefrostStart(float tempAtStart, const char* triggeredBy);
 void supabaseSendDefrostEnd(float tempAtEnd, unsigned long durationMin);
 void acknowledgeAlert();
 void clearAlert();
-void triggerAlert(String message, bool critical);
+void triggerAlert(String message, bool critical, uint8_t source, const char* type);
 void saveConfig();
 void loadConfig();
 bool testTelegram();
 void resetWiFi();
-String getEmbeddedHTML();
+void streamNotifyState();
+void streamNotifyAlert();
+void streamNotifyDoor(int door);
+void streamNotifySample();
+void recorderProbe(int probe, float tempC);
+void recorderProbeFail(int probe);
+void recorderInput(uint8_t input, bool level);
+void recorderConfig();
+void rulesSetDefaults(Config& c);
+void getRulesConfigJSON(JsonObject& obj, const Config& c);
 
 // ============================================================================
 // INCLUIR MÓDULOS
@@ -105,12 +115,18 @@ String getEmbeddedHTML();
 #include "state_machine.h"
 #include "html_ui.h"
 #include "storage.h"
+#include "sim800.h"
+#include "uplink.h"
+#include "outbox.h"
 #include "telegram.h"
 #include "supabase.h"
+#include "history.h"
 #include "sensors.h"
 #include "alerts.h"
+#include "recorder.h"
 #include "wifi_utils.h"
 #include "web_api.h"
+#include "profiler.h"
 
 // ============================================================================
 // CONTROL DE RELÉS
@@ -192,18 +208,19 @@ void initPins() {
 // HISTORIAL DE TEMPERATURAS
 // ============================================================================
 void updateHistory() {
-    static unsigned long lastHistoryUpdate = 0;
-    
-    if (millis() - lastHistoryUpdate >= INTERVAL_HISTORY_UPDATE_MS) {
-        lastHistoryUpdate = millis();
-        
-        history[historyIndex].temp = sensorData.tempAvg;
-        history[historyIndex].humidity = sensorData.humidity;
-        history[historyIndex].doorOpen = sensorData.anyDoorOpen;
-        history[historyIndex].alertActive = state.alertActive;
-        history[historyIndex].timestamp = millis();
+    static unsigned long lastHistoryUpdate = millis();
+    
+    unsigned long now = millis();
+    unsigned long elapsed = now - lastHistoryUpdate;
+    if (elapsed >= INTERVAL_HISTORY_UPDATE_MS) {
+        // Si loop() se demoró, la muestra cuenta por todos los segundos perdidos
+        unsigned long ticks = elapsed / INTERVAL_HISTORY_UPDATE_MS;
+        lastHistoryUpdate += ticks * INTERVAL_HISTORY_UPDATE_MS;
+        if (ticks > 0xFFFF) ticks = 0xFFFF;
         
-        historyIndex = (historyIndex + 1) % HISTORY_SIZE;
+        historyAdd((now - state.bootTime) / 1000, sensorData.tempValid, sensorData.tempAvg,
+                   sensorData.anyDoorOpen, state.alertActive,
+                   (uint16_t)(ticks * INTERVAL_HISTORY_UPDATE_MS / 1000));
     }
 }
 
@@ -251,6 +268,9 @@ void printStatusJSON() {
     network["supabase_enabled"] = config.supabaseEnabled;
     network["last_supabase_sync_sec"] = (millis() - state.lastSupabaseSync) / 1000;
     
+    JsonObject uplinkObj = network.createNestedObject("uplink");
+    getUplinkJSON(uplinkObj);
+    
     // Imprimir JSON
     Serial.println("\n===== STATUS JSON =====");
     serializeJsonPretty(doc, Serial);
@@ -313,6 +333,42 @@ void checkWiFiResetButton() {
     }
 }
 
+// ============================================================================
+// COMANDOS POR SERIAL
+// ============================================================================
+void checkSerialCommands() {
+    static String line;
+    
+    while (Serial.available()) {
+        char c = (char)Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (line.length() < 64) line += c;
+            continue;
+        }
+        
+        line.trim();
+        line.toLowerCase();
+        if (line == "perf") {
+            printPerfReport();
+        } else if (line == "perf reset") {
+            perfReset();
+            Serial.println("[PERF] Estadísticas reiniciadas");
+        } else if (line == "status") {
+            printStatusJSON();
+        } else if (line == "trace") {
+            printRecorderStats();
+        } else if (line.length() > 0) {
+            // El resto: comandos de serial_api.h (HELP para la lista).
+            // Pueden cambiar config y estado: con el lock, la impresión sin él
+            webStateLock();
+            String reply = processCommand(line);
+            webStateUnlock();
+            Serial.println(reply);
+        }
+        line = "";
+    }
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
@@ -341,6 +397,7 @@ void setup() {
     
     // Inicializar máquina de estados
     initStateMachine();
+    perfReset();
     
     // Cargar configuración desde flash
     loadConfig();
@@ -358,10 +415,30 @@ void setup() {
     // Conectar WiFi
     connectWiFi();
     
+    // Hora real para created_at de las lecturas en lote
+    initDeviceClock();
+    
     // Inicializar sensores
     Serial.println("\n[SENSORES] Inicializando...");
     initSensors();
     
+    // Diario de telemetría en flash (lecturas y eventos hacia Supabase)
+    journalInit();
+    
+    // Grabador de entradas para trace_replay (después de la primera lectura)
+    recorderInit();
+    
+    // Módulo GSM (antes de la bandeja: decide si hay canal SMS)
+    #if SIM800_ENABLED
+    sim800Init();
+    #endif
+    
+    // Alertas sin entregar de antes del reinicio
+    outboxInit();
+    
+    // Tarea de enlace de red (Supabase, Telegram, internet) en el core 0
+    uplinkInit();
+    
     // Configurar mDNS
     setupMDNS();
     
@@ -383,7 +460,7 @@ void setup() {
     #endif
     
     // Cambiar a estado NORMAL
-    changeState(STATE_NORMAL, "Inicialización completa");
+    stateDispatch(EV_BOOT_DONE);
     
     Serial.println("\n[SISTEMA] ════════════════════════════════════════");
     Serial.println("[SISTEMA] ✓ INICIALIZACIÓN COMPLETA");
@@ -392,23 +469,39 @@ void setup() {
     Serial.printf("[SISTEMA] Device ID: %s\n", DEVICE_ID);
     Serial.printf("[SISTEMA] Supabase: %s\n", config.supabaseEnabled ? "HABILITADO" : "DESHABILITADO");
     Serial.println("[SISTEMA] ════════════════════════════════════════\n");
+    
+    // Servidor web y sus workers (core 0)
+    webStart();
 }
 
 // ============================================================================
 // LOOP PRINCIPAL (100% NO BLOQUEANTE)
 // ============================================================================
 void loop() {
-    // Manejar peticiones web
-    server.handleClient();
+    PerfMark loopStart = perfStart();
+    
+    // Desde acá hasta webStateUnlock() los handlers web no leen el estado:
+    // solo lo que lo cambia. Lo que únicamente lo lee o espera I/O va
+    // después, sin el lock (loop() es el único que escribe)
+    webStateLock();
+    
+    // Cambios pedidos por la API web
+    PERF_RUN(PERF_WEB, webApplyCommands());
+    
+    // Versión de /api/status (uptime, WiFi, contadores)
+    statusTick();
     
     // Máquina de estados (verifica defrost, cooldown, config)
-    stateMachineLoop();
+    PERF_RUN(PERF_STATE_MACHINE, stateMachineLoop());
     
-    // Leer sensores (no bloqueante)
+    // Sondas DS18B20 (motor con deadline propio, no bloqueante)
+    PERF_RUN(PERF_TEMP, readTempSensors());
+    
+    // Leer puertas y DHT22
     static unsigned long lastSensorRead = 0;
     if (millis() - lastSensorRead >= INTERVAL_SENSOR_READ_MS) {
         lastSensorRead = millis();
-        readSensors();
+        PERF_RUN(PERF_SENSORS, readSensors());
     }
     
     // Verificar alertas (solo si estamos monitoreando)
@@ -416,31 +509,45 @@ void loop() {
     if (millis() - lastAlertCheck >= INTERVAL_ALERT_CHECK_MS) {
         lastAlertCheck = millis();
         if (isStateMonitoring(state.currentState)) {
-            checkAlerts();
+            PERF_RUN(PERF_ALERTS, checkAlerts());
         }
     }
     
+    // Actualizar historial
+    PERF_RUN(PERF_HISTORY, updateHistory());
+    
+    // Traza de entradas: escribir en flash lo pendiente (/api/trace la
+    // vacía con el lock)
+    recorderLoop();
+    
+    webStateUnlock();
+    
     // Imprimir estado JSON por serial
     static unsigned long lastStatusPrint = 0;
     if (millis() - lastStatusPrint >= INTERVAL_STATUS_PRINT_MS) {
         lastStatusPrint = millis();
-        printStatusJSON();
+        PERF_RUN(PERF_STATUS_PRINT, printStatusJSON());
     }
     
-    // Verificar conexión a internet
-    checkInternet();
-    
-    // Actualizar historial
-    updateHistory();
+    // Enlace de red (internet/comandos; en línea solo si no hay tarea)
+    PERF_RUN(PERF_UPLINK, uplinkLoop());
     
     // Sincronizar con Supabase
-    supabaseSync();
+    PERF_RUN(PERF_SUPABASE, supabaseSync());
     
     // Actualizar LED de estado
-    updateStatusLED();
+    PERF_RUN(PERF_LED, updateStatusLED());
     
     // Verificar botón de reset WiFi
-    checkWiFiResetButton();
+    PERF_RUN(PERF_BUTTON, checkWiFiResetButton());
+    
+    // Comandos por Serial (perf, perf reset, status, trace, serial_api.h)
+    PERF_RUN(PERF_SERIAL, checkSerialCommands());
+    serialApiLoop();
+    
+    #if PERF_PROFILER_ENABLED
+    perfEnd(PERF_LOOP_TOTAL, loopStart);
+    #endif
     
     // Pequeña pausa para estabilidad
     delay(10);
@@ -0,0 +1,113 @@
+/*
+ * ============================================================================
+ * FSM.H - MOTOR GENÉRICO DE MÁQUINA DE ESTADOS POR TABLA
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * La máquina se declara como una tabla constexpr de transiciones:
+ *
+ *   { desde, evento, hacia, guarda, acción, efectos, razón }
+ *
+ * - desde:    estado de origen, o FSM_ANY para cualquier estado
+ * - guarda:   bool(const Ctx&) sin efectos; nullptr = siempre
+ * - acción:   void(Ctx&) que solo toca estado en RAM (timers, flags)
+ * - efectos:  bits que interpreta quien usa el motor (E/S encolada)
+ * - razón:    texto por defecto para el log
+ *
+ * fsmBuildIndex() arma en compilación un índice [estado][evento] con la
+ * primera fila candidata, así que despachar un evento es una búsqueda
+ * indexada. Las filas del mismo (estado, evento) van contiguas y se prueban
+ * en orden hasta que una guarda pase; fsmTableValid() lo verifica en
+ * compilación. Una fila específica tiene prioridad sobre una FSM_ANY.
+ *
+ * Si hacia == desde la transición es interna: corre la acción y los
+ * efectos, pero el estado no cambia.
+ *
+ * ============================================================================
+ */
+
+#ifndef FSM_H
+#define FSM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FSM_ANY 0xFF
+
+template <typename Ctx>
+struct FsmTransition {
+    uint8_t from;                   // Estado de origen o FSM_ANY
+    uint8_t event;
+    uint8_t to;
+    bool (*guard)(const Ctx&);      // nullptr = siempre
+    void (*action)(Ctx&);           // nullptr = ninguna
+    uint16_t effects;               // Efectos a encolar
+    const char* reason;
+};
+
+// Fila + 1 de la primera transición candidata (0 = evento ignorado)
+template <size_t NumStates, size_t NumEvents>
+struct FsmIndex {
+    uint8_t slot[NumStates][NumEvents];
+};
+
+// ============================================================================
+// CONSTRUCCIÓN Y VALIDACIÓN (en compilación)
+// ============================================================================
+template <size_t NumStates, size_t NumEvents, typename Ctx, size_t NumRows>
+constexpr FsmIndex<NumStates, NumEvents> fsmBuildIndex(const FsmTransition<Ctx> (&table)[NumRows]) {
+    FsmIndex<NumStates, NumEvents> index{};
+
+    // Primero los comodines, después las filas específicas encima
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t i = NumRows; i-- > 0;) {
+            const FsmTransition<Ctx>& t = table[i];
+            bool any = t.from == FSM_ANY;
+            if (any != (pass == 0)) continue;
+            for (size_t s = 0; s < NumStates; s++) {
+                if (any || t.from == s) index.slot[s][t.event] = (uint8_t)(i + 1);
+            }
+        }
+    }
+    return index;
+}
+
+// Rangos válidos, filas del mismo (desde, evento) contiguas y caben en el índice
+template <size_t NumStates, size_t NumEvents, typename Ctx, size_t NumRows>
+constexpr bool fsmTableValid(const FsmTransition<Ctx> (&table)[NumRows]) {
+    if (NumRows > 254) return false;
+    for (size_t i = 0; i < NumRows; i++) {
+        const FsmTransition<Ctx>& t = table[i];
+        if ((t.from >= NumStates && t.from != FSM_ANY) || t.event >= NumEvents || t.to >= NumStates) {
+            return false;
+        }
+        for (size_t j = i + 2; j < NumRows; j++) {
+            if (table[j].from == t.from && table[j].event == t.event &&
+                !(table[j - 1].from == t.from && table[j - 1].event == t.event)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// DESPACHO
+// ============================================================================
+// Transición que corresponde a (estado, evento), o nullptr si se ignora
+template <typename Ctx, size_t NumRows, size_t NumStates, size_t NumEvents>
+inline const FsmTransition<Ctx>* fsmFind(const FsmTransition<Ctx> (&table)[NumRows],
+                                         const FsmIndex<NumStates, NumEvents>& index,
+                                         uint8_t from, uint8_t event, const Ctx& ctx) {
+    if (from >= NumStates || event >= NumEvents) return nullptr;
+    uint8_t slot = index.slot[from][event];
+    if (slot == 0) return nullptr;
+
+    uint8_t rowFrom = table[slot - 1].from;
+    for (size_t i = slot - 1; i < NumRows && table[i].from == rowFrom && table[i].event == event; i++) {
+        if (!table[i].guard || table[i].guard(ctx)) return &table[i];
+    }
+    return nullptr;
+}
+
+#endif // FSM_H
@@ -0,0 +1,159 @@
+/*
+ * ============================================================================
+ * HISTORY.H - HISTORIAL POR NIVELES EN RAM v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Serie de tiempo local con tres resoluciones:
+ *   - 1 minuto durante 6 horas
+ *   - 5 minutos durante 48 horas
+ *   - 1 hora durante 30 días
+ *
+ * Cada bucket guarda mínimo, máximo y promedio de la temperatura, más los
+ * segundos con puerta abierta y con alerta activa. updateHistory() agrega
+ * una muestra por segundo a los tres niveles, en O(1): solo se toca el
+ * bucket actual de cada nivel (al cambiar de bucket se limpia el siguiente
+ * del anillo). Un pico entre dos minutos queda en el máximo.
+ *
+ * Los buckets se numeran con el uptime en segundos (monótono aunque el NTP
+ * ajuste la hora). /api/history los pasa a hora unix si el reloj es válido.
+ *
+ * Memoria: 16 bytes por bucket, ~26 KB en total. Se pierde al reiniciar
+ * (el historial largo está en Supabase).
+ *
+ * ============================================================================
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "config.h"
+#include "telemetry.h"
+
+// ============================================================================
+// TIPOS
+// ============================================================================
+struct HistoryBucket {
+    int32_t sum;                    // Centésimas de °C
+    int16_t min;
+    int16_t max;
+    uint16_t count;                 // Muestras de temperatura válidas
+    uint16_t doorSec;
+    uint16_t alertSec;
+    uint16_t sampleSec;             // Segundos muestreados (0 = sin datos)
+};
+
+struct HistoryTier {
+    uint32_t periodSec;
+    uint16_t size;
+    HistoryBucket* buckets;
+    uint16_t head;                  // Bucket actual
+    uint16_t filled;                // Buckets con historia (<= size)
+    uint32_t headId;                // uptime / periodSec del bucket actual
+};
+
+#define HISTORY_TIERS 3
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+HistoryBucket historyTier1[HISTORY_TIER1_SIZE];
+HistoryBucket historyTier2[HISTORY_TIER2_SIZE];
+HistoryBucket historyTier3[HISTORY_TIER3_SIZE];
+
+HistoryTier historyTiers[HISTORY_TIERS] = {
+    { HISTORY_TIER1_SEC, HISTORY_TIER1_SIZE, historyTier1, 0, 0, 0 },
+    { HISTORY_TIER2_SEC, HISTORY_TIER2_SIZE, historyTier2, 0, 0, 0 },
+    { HISTORY_TIER3_SEC, HISTORY_TIER3_SIZE, historyTier3, 0, 0, 0 },
+};
+
+// ============================================================================
+// ACTUALIZACIÓN
+// ============================================================================
+inline void historyClearBucket(HistoryBucket& b) {
+    b.sum = 0;
+    b.min = INT16_MAX;
+    b.max = INT16_MIN;
+    b.count = 0;
+    b.doorSec = 0;
+    b.alertSec = 0;
+    b.sampleSec = 0;
+}
+
+// Mover el bucket actual hasta id; los buckets salteados quedan vacíos
+void historyAdvance(HistoryTier& t, uint32_t id) {
+    if (t.filled == 0) {
+        t.head = 0;
+        t.filled = 1;
+        t.headId = id;
+        historyClearBucket(t.buckets[0]);
+        return;
+    }
+    if (id <= t.headId) return;
+
+    uint32_t steps = id - t.headId;
+    if (steps > t.size) steps = t.size;
+    for (uint32_t i = 0; i < steps; i++) {
+        t.head = (uint16_t)((t.head + 1) % t.size);
+        historyClearBucket(t.buckets[t.head]);
+    }
+    t.filled = (uint16_t)min((uint32_t)t.size, t.filled + steps);
+    t.headId = id;
+}
+
+inline uint16_t historyAddSat(uint16_t a, uint32_t b) {
+    return (uint16_t)min((uint32_t)0xFFFF, (uint32_t)a + b);
+}
+
+// Una muestra que representa 'seconds' segundos (más de 1 si loop() se
+// demoró). nowSec: uptime en segundos.
+void historyAdd(uint32_t nowSec, bool tempValid, float temp, bool doorOpen,
+                bool alertActive, uint16_t seconds) {
+    int16_t c = tlmCenti(temp);
+    if (c == TLM_NULL_I16) tempValid = false;
+
+    for (int i = 0; i < HISTORY_TIERS; i++) {
+        HistoryTier& t = historyTiers[i];
+        historyAdvance(t, nowSec / t.periodSec);
+
+        HistoryBucket& b = t.buckets[t.head];
+        if (tempValid) {
+            b.sum += c;
+            if (c < b.min) b.min = c;
+            if (c > b.max) b.max = c;
+            b.count++;
+        }
+        if (doorOpen) b.doorSec = historyAddSat(b.doorSec, seconds);
+        if (alertActive) b.alertSec = historyAddSat(b.alertSec, seconds);
+        b.sampleSec = historyAddSat(b.sampleSec, seconds);
+    }
+}
+
+// ============================================================================
+// CONSULTA
+// ============================================================================
+// Nivel más fino con buckets de al menos resSec que cubra rangeSec; si
+// ninguno lo cubre, el más grueso
+const HistoryTier& historySelectTier(uint32_t rangeSec, uint32_t resSec) {
+    for (int i = 0; i < HISTORY_TIERS; i++) {
+        const HistoryTier& t = historyTiers[i];
+        if (t.periodSec >= resSec && t.periodSec * t.size >= rangeSec) return t;
+    }
+    return historyTiers[HISTORY_TIERS - 1];
+}
+
+// Buckets a devolver para rangeSec (el actual incluido)
+uint16_t historyBucketCount(const HistoryTier& t, uint32_t rangeSec) {
+    uint32_t n = (rangeSec + t.periodSec - 1) / t.periodSec;
+    if (n == 0) n = 1;
+    return (uint16_t)min(n, (uint32_t)t.filled);
+}
+
+// Bucket por número (uptime / periodSec). false si ya salió del anillo
+bool historyBucketById(const HistoryTier& t, uint32_t id, HistoryBucket& out) {
+    if (t.filled == 0 || id > t.headId || t.headId - id >= t.filled) return false;
+    out = t.buckets[(t.head + t.size - (t.headId - id)) % t.size];
+    return true;
+}
+
+#endif // HISTORY_H
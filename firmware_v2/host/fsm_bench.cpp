@@ -0,0 +1,254 @@
+/*
+ * ============================================================================
+ * FSM_BENCH.CPP - RECORRIDO Y BENCHMARK DE LA MÁQUINA DE ESTADOS
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Usa STATE_TABLE y stateDispatch() de state_machine.h sin modificar.
+ *
+ * USO:
+ *   fsm_bench [--walk] [--bench N]
+ *
+ *   --walk           Recorre cada par (estado, evento) con todas las
+ *                    combinaciones de guardas (señal de defrost, timers,
+ *                    conexión). Compara el índice contra una búsqueda lineal
+ *                    en la tabla, verifica los invariantes de cada estado y
+ *                    que toda fila de la tabla se use. Sale con 1 si falla.
+ *   --bench N        Mide N despachos aleatorios: búsqueda indexada, búsqueda
+ *                    lineal y stateDispatch() completo (default 10000000)
+ *
+ * Sin opciones hace las dos cosas.
+ *
+ * ============================================================================
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "hal.h"
+#include "../config.h"
+#include "../types.h"
+
+#include <string>
+#include <vector>
+
+SystemState state;
+SensorData sensorData;
+Config config;
+
+// El resto del firmware no se compila: los efectos se descartan
+void setRelay(bool) {}
+void sendTelegramAlert(String) {}
+void supabaseSendDefrostStart(float, const char*) {}
+void supabaseSendDefrostEnd(float, unsigned long) {}
+void streamNotifyState() {}
+void recorderInput(uint8_t, bool) {}
+void rulesReset() {}
+
+#include "../state_machine.h"
+
+static const char* EVENT_NAMES[EV_COUNT] = {
+    "POLL", "BOOT_DONE", "DEFROST_MANUAL", "DEFROST_STOP",
+    "CONFIG_SAVED", "ALERT_RAISED", "ALERT_CLEARED",
+};
+
+// ============================================================================
+// CONDICIONES DE LAS GUARDAS
+// ============================================================================
+enum CondBits {
+    COND_SIGNAL         = 1 << 0,
+    COND_DEFROST_DUE    = 1 << 1,
+    COND_COOLDOWN_DUE   = 1 << 2,
+    COND_CONFIG_DUE     = 1 << 3,
+    COND_LINK           = 1 << 4,
+    COND_COMBINATIONS   = 1 << 5
+};
+
+static void setTimer(NonBlockingTimer& t, bool due) {
+    t.start(due ? 0 : 3600000UL);
+}
+
+static void applyConditions(unsigned cond) {
+    sensorData.defrostSignalActive = cond & COND_SIGNAL;
+    setTimer(defrostMaxTimer, cond & COND_DEFROST_DUE);
+    setTimer(cooldownTimer, cond & COND_COOLDOWN_DUE);
+    setTimer(configLoadTimer, cond & COND_CONFIG_DUE);
+    state.wifiConnected = cond & COND_LINK;
+    state.internetAvailable = cond & COND_LINK;
+}
+
+// Semántica de fsm.h escrita de la forma más directa: filas específicas en
+// orden de tabla y, solo si no hay ninguna para el par, las FSM_ANY
+static const StateTransition* linearFind(uint8_t from, uint8_t event) {
+    for (int pass = 0; pass < 2; pass++) {
+        bool any = pass == 1;
+        bool candidates = false;
+        for (size_t i = 0; i < STATE_TABLE_ROWS; i++) {
+            const StateTransition& t = STATE_TABLE[i];
+            if (t.event != event || (any ? t.from != FSM_ANY : t.from != from)) continue;
+            candidates = true;
+            if (!t.guard || t.guard(state)) return &t;
+        }
+        if (candidates) return nullptr;
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// RECORRIDO EXHAUSTIVO
+// ============================================================================
+static int fail(const char* what, int s, int e, unsigned cond) {
+    fprintf(stderr, "FALLA: %s (estado %s, evento %s, condiciones 0x%02x)\n",
+            what, getStateName((SystemStateEnum)s), EVENT_NAMES[e], cond);
+    return 1;
+}
+
+static int walk() {
+    std::vector<bool> rowUsed(STATE_TABLE_ROWS, false);
+    int failures = 0;
+    unsigned pairs = 0, transitions = 0;
+
+    for (int s = 0; s < STATE_COUNT; s++) {
+        for (int e = 0; e < EV_COUNT; e++) {
+            pairs++;
+            std::string dests;
+            for (unsigned cond = 0; cond < COND_COMBINATIONS; cond++) {
+                initStateMachine();
+                state.currentState = (SystemStateEnum)s;
+                applyConditions(cond);
+
+                const StateTransition* expected = linearFind(s, e);
+                const StateTransition* found = fsmFind(STATE_TABLE, STATE_INDEX, s, e, state);
+                if (found != expected) failures += fail("índice distinto de la búsqueda lineal", s, e, cond);
+
+                bool fired = stateDispatch((StateEvent)e);
+                uint8_t to = state.currentState;
+                if (fired != (expected != nullptr)) failures += fail("stateDispatch() no coincide", s, e, cond);
+                if (to >= STATE_COUNT) failures += fail("estado fuera de rango", s, e, cond);
+                if (!fired && to != s) failures += fail("cambio de estado sin transición", s, e, cond);
+                if (fired) {
+                    rowUsed[expected - STATE_TABLE] = true;
+                    transitions++;
+                }
+
+                // Invariantes al entrar en cada estado
+                if (to != s) {
+                    if (to == STATE_INITIALIZING) failures += fail("vuelta a INITIALIZING", s, e, cond);
+                    if (to == STATE_DEFROST && !defrostMaxTimer.running) failures += fail("DEFROST sin timer de seguridad", s, e, cond);
+                    if (to == STATE_DEFROST && state.alertActive) failures += fail("DEFROST con alerta activa", s, e, cond);
+                    if (to == STATE_COOLDOWN && !cooldownTimer.running) failures += fail("COOLDOWN sin timer", s, e, cond);
+                    if (s == STATE_DEFROST && to == STATE_COOLDOWN && defrostMaxTimer.running) failures += fail("timer de defrost sigue corriendo", s, e, cond);
+                    if (state.previousState != s) failures += fail("previousState incorrecto", s, e, cond);
+                    if (stateEffectCount != 1) failures += fail("cambio de estado sin efecto encolado", s, e, cond);
+                }
+                if (to == STATE_LOADING_CONFIG && fired && !configLoadTimer.running) failures += fail("LOADING_CONFIG sin timer", s, e, cond);
+
+                if (to != s && dests.find(getStateName((SystemStateEnum)to)) == std::string::npos) {
+                    if (!dests.empty()) dests += "|";
+                    dests += getStateName((SystemStateEnum)to);
+                }
+            }
+            // Una línea por par con cambio de estado posible
+            if (!dests.empty()) {
+                printf("%-26s %-16s -> %s\n", getStateName((SystemStateEnum)s), EVENT_NAMES[e], dests.c_str());
+            }
+        }
+    }
+
+    for (size_t i = 0; i < STATE_TABLE_ROWS; i++) {
+        if (!rowUsed[i]) {
+            fprintf(stderr, "FALLA: fila %zu nunca se usa (%s)\n", i, STATE_TABLE[i].reason);
+            failures++;
+        }
+    }
+
+    printf("\n%u pares x %u combinaciones, %u transiciones, %zu filas, %d fallas\n",
+           pairs, (unsigned)COND_COMBINATIONS, transitions, STATE_TABLE_ROWS, failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+struct BenchCase {
+    uint8_t state, event, cond;
+};
+
+static void report(const char* name, uint64_t count, uint64_t ns) {
+    printf("%-22s %10.1f M/s  %6.1f ns\n", name, count * 1e3 / ns, (double)ns / count);
+}
+
+static void bench(uint64_t count) {
+    // Casos pregenerados (xorshift) para no medir el generador
+    std::vector<BenchCase> cases(4096);
+    uint32_t x = 2463534242u;
+    for (BenchCase& c : cases) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        c.state = x % STATE_COUNT;
+        c.event = (x >> 8) % EV_COUNT;
+        c.cond = (x >> 16) % COND_COMBINATIONS;
+    }
+    size_t mask = cases.size() - 1;
+    applyConditions(COND_LINK);
+    uint64_t hits = 0;
+
+    uint64_t t0 = halRealNowNs();
+    for (uint64_t i = 0; i < count; i++) {
+        const BenchCase& c = cases[i & mask];
+        hits += fsmFind(STATE_TABLE, STATE_INDEX, c.state, c.event, state) != nullptr;
+    }
+    report("búsqueda indexada", count, halRealNowNs() - t0);
+
+    t0 = halRealNowNs();
+    for (uint64_t i = 0; i < count; i++) {
+        const BenchCase& c = cases[i & mask];
+        hits += linearFind(c.state, c.event) != nullptr;
+    }
+    report("búsqueda lineal", count, halRealNowNs() - t0);
+
+    // Despacho completo: guardas, acción, cambio de estado y cola de efectos
+    uint64_t fired = 0;
+    t0 = halRealNowNs();
+    for (uint64_t i = 0; i < count; i++) {
+        const BenchCase& c = cases[i & mask];
+        state.currentState = (SystemStateEnum)c.state;
+        sensorData.defrostSignalActive = c.cond & COND_SIGNAL;
+        fired += stateDispatch((StateEvent)c.event);
+        stateEffectCount = 0;
+    }
+    report("stateDispatch()", count, halRealNowNs() - t0);
+
+    printf("%llu despachos, %.1f%% con transición, %llu búsquedas con fila\n",
+           (unsigned long long)count, 100.0 * fired / count, (unsigned long long)hits);
+}
+
+int main(int argc, char** argv) {
+    bool doWalk = false;
+    uint64_t benchCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--walk") doWalk = true;
+        else if (a == "--bench" && i + 1 < argc) benchCount = strtoull(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "Uso: %s [--walk] [--bench N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!doWalk && benchCount == 0) {
+        doWalk = true;
+        benchCount = 10000000;
+    }
+
+    // Los logs de los efectos no interesan acá
+    halSerialSetEcho(false);
+    halClockSetSpeed(0);
+
+    int result = 0;
+    if (doWalk) result = walk();
+    if (benchCount > 0) {
+        if (doWalk) printf("\n");
+        bench(benchCount);
+    }
+    return result;
+}
@@ -0,0 +1,256 @@
+/*
+ * ============================================================================
+ * ARDUINO.H - HAL HOST (Linux) PARA FIRMWARE v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Sustituye al core Arduino-ESP32 cuando el firmware se compila como
+ * ejecutable nativo. Provee:
+ * - Reloj virtual (millis/micros/delay) con factor de aceleración
+ * - GPIO simulado (pinMode/digitalRead/digitalWrite/analogRead)
+ * - String, Print y Serial compatibles con la API de Arduino
+ * - Objeto ESP (heap, restart, contador de ciclos)
+ * - FreeRTOS (tareas y colas sobre std::thread)
+ *
+ * El estado simulado se controla desde hal.h
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+// Como el core ESP32, Arduino.h expone FreeRTOS (ver hal/freertos/)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#define ARDUINO_HOST 1
+
+using std::min;
+using std::max;
+
+// ============================================================================
+// CONSTANTES DE GPIO
+// ============================================================================
+#define LOW             0x0
+#define HIGH            0x1
+
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define INPUT_PULLDOWN  0x09
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define F(s) (s)
+
+typedef uint8_t byte;
+
+// ============================================================================
+// TIEMPO (reloj virtual, ver hal.cpp)
+// ============================================================================
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// SNTP: time() pasa de segundos desde el boot a hora real anclada al reloj
+// virtual (ver hal.cpp)
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+// ============================================================================
+// GPIO SIMULADO
+// ============================================================================
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
+
+// ============================================================================
+// STRING (subconjunto de la API Arduino sobre std::string)
+// ============================================================================
+class String {
+public:
+    String() {}
+    String(const char* s) : buf_(s ? s : "") {}
+    String(const std::string& s) : buf_(s) {}
+    String(char c) : buf_(1, c) {}
+    String(unsigned char v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(int v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned int v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long long v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned long long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+    const char* c_str() const { return buf_.c_str(); }
+    unsigned int length() const { return (unsigned int)buf_.size(); }
+    bool isEmpty() const { return buf_.empty(); }
+    bool reserve(unsigned int size) { buf_.reserve(size); return true; }
+    const std::string& str() const { return buf_; }
+
+    char charAt(unsigned int i) const { return i < buf_.size() ? buf_[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    bool concat(const String& s) { buf_ += s.buf_; return true; }
+    bool concat(const char* s) { if (s) buf_ += s; return true; }
+    bool concat(char c) { buf_ += c; return true; }
+
+    String& operator+=(const String& s) { buf_ += s.buf_; return *this; }
+    String& operator+=(const char* s) { if (s) buf_ += s; return *this; }
+    String& operator+=(char c) { buf_ += c; return *this; }
+    template <typename T> String& operator+=(T v) { buf_ += String(v).buf_; return *this; }
+
+    bool operator==(const String& s) const { return buf_ == s.buf_; }
+    bool operator==(const char* s) const { return buf_ == (s ? s : ""); }
+    bool operator!=(const String& s) const { return buf_ != s.buf_; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    bool operator<(const String& s) const { return buf_ < s.buf_; }
+    bool equals(const String& s) const { return buf_ == s.buf_; }
+    bool equalsIgnoreCase(const String& s) const;
+
+    bool startsWith(const String& p) const { return buf_.compare(0, p.buf_.size(), p.buf_) == 0; }
+    bool endsWith(const String& p) const {
+        return buf_.size() >= p.buf_.size() &&
+               buf_.compare(buf_.size() - p.buf_.size(), p.buf_.size(), p.buf_) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return toIndex(buf_.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return toIndex(buf_.find(s.buf_, from)); }
+    int lastIndexOf(char c) const { return toIndex(buf_.rfind(c)); }
+    String substring(unsigned int from) const { return from < buf_.size() ? String(buf_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= buf_.size() || to <= from) return String();
+        return String(buf_.substr(from, to - from));
+    }
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    void replace(const String& from, const String& to);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+        if (index < buf_.size()) buf_.erase(index, count);
+    }
+    long toInt() const { return strtol(buf_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(buf_.c_str(), nullptr); }
+    double toDouble() const { return strtod(buf_.c_str(), nullptr); }
+
+private:
+    static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    void fromSigned(long long v, unsigned char base);
+    void fromUnsigned(unsigned long long v, unsigned char base);
+    void fromDouble(double v, unsigned char decimals);
+
+    std::string buf_;
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(char a, const String& b) { String r(a); r += b; return r; }
+template <typename T> inline String operator+(const String& a, T b) { String r(a); r += String(b); return r; }
+
+// ============================================================================
+// PRINT / SERIAL
+// ============================================================================
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buf++);
+        return n;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* s, size_t size) { return write((const uint8_t*)s, size); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(double v, int digits = 2) { return print(String(v, (unsigned char)digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(T v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    // Sin timeout: solo lo que ya llegó
+    bool find(const char* target);
+    long parseInt();
+};
+
+#define SERIAL_8N1 0x800001c
+
+// UART 0 = consola (stdout/halSerialInject); las demás no tienen nada
+// conectado: descartan lo escrito y no reciben
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart = 0) : uart_(uart) {}
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1) {
+        (void)baud; (void)config; (void)rxPin; (void)txPin;
+    }
+    void end() {}
+    void flush() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    operator bool() const { return true; }
+
+private:
+    int uart_;
+};
+
+extern HardwareSerial Serial;
+
+// ============================================================================
+// ESP (recursos del chip)
+// ============================================================================
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getHeapSize() { return 327680; }
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getSdkVersion() { return "host"; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+uint32_t esp_random();                          // Determinístico en el host
+
+#endif // HOST_ARDUINO_H
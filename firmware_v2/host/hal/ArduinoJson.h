@@ -0,0 +1,845 @@
+/*
+ * ============================================================================
+ * ARDUINOJSON.H - SUSTITUTO MÍNIMO DE ARDUINOJSON v6 (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Implementa el subconjunto de la API v6 que usa el firmware:
+ * - StaticJsonDocument<N> / DynamicJsonDocument
+ * - JsonObject, JsonArray, JsonVariant (lectura, escritura, anidados)
+ * - serializeJson / serializeJsonPretty / measureJson
+ * - deserializeJson + DeserializationError
+ *
+ * A diferencia de la librería real no hay límite de capacidad: el documento
+ * crece en el heap del host. El formato de salida es JSON estándar.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hostjson {
+
+// ============================================================================
+// NODO DEL ÁRBOL JSON
+// ============================================================================
+struct Node {
+    enum Type { Null, Bool, Int, UInt, Float, Str, Object, Array };
+
+    Type type = Null;
+    bool b = false;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double f = 0;
+    bool singlePrecision = false;
+    std::string s;
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> members;
+    std::vector<std::unique_ptr<Node>> elements;
+
+    void reset() {
+        type = Null;
+        s.clear();
+        members.clear();
+        elements.clear();
+    }
+
+    Node* find(const char* key) const {
+        if (type != Object || !key) return nullptr;
+        for (auto& m : members) {
+            if (m.first == key) return m.second.get();
+        }
+        return nullptr;
+    }
+
+    Node* getOrAdd(const char* key) {
+        if (type == Null) type = Object;
+        if (type != Object) return nullptr;
+        Node* n = find(key);
+        if (n) return n;
+        members.emplace_back(key ? key : "", std::unique_ptr<Node>(new Node()));
+        return members.back().second.get();
+    }
+
+    Node* addElement() {
+        if (type == Null) type = Array;
+        if (type != Array) return nullptr;
+        elements.emplace_back(new Node());
+        return elements.back().get();
+    }
+
+    Node* at(size_t index) const {
+        if (type != Array || index >= elements.size()) return nullptr;
+        return elements[index].get();
+    }
+
+    size_t size() const {
+        if (type == Object) return members.size();
+        if (type == Array) return elements.size();
+        return 0;
+    }
+
+    void copyFrom(const Node& o) {
+        reset();
+        type = o.type; b = o.b; i = o.i; u = o.u; f = o.f;
+        singlePrecision = o.singlePrecision; s = o.s;
+        for (auto& m : o.members) {
+            std::unique_ptr<Node> n(new Node());
+            n->copyFrom(*m.second);
+            members.emplace_back(m.first, std::move(n));
+        }
+        for (auto& e : o.elements) {
+            std::unique_ptr<Node> n(new Node());
+            n->copyFrom(*e);
+            elements.push_back(std::move(n));
+        }
+    }
+};
+
+// Escritura de valores escalares en un nodo
+inline void assign(Node* n, bool v) { n->reset(); n->type = Node::Bool; n->b = v; }
+inline void assign(Node* n, const char* v) {
+    n->reset();
+    if (!v) return;
+    n->type = Node::Str; n->s = v;
+}
+inline void assign(Node* n, const String& v) { assign(n, v.c_str()); }
+inline void assign(Node* n, const std::string& v) { n->reset(); n->type = Node::Str; n->s = v; }
+inline void assign(Node* n, float v) { n->reset(); n->type = Node::Float; n->f = v; n->singlePrecision = true; }
+inline void assign(Node* n, double v) { n->reset(); n->type = Node::Float; n->f = v; }
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
+assign(Node* n, T v) {
+    n->reset();
+    if (std::is_signed<T>::value) { n->type = Node::Int; n->i = (int64_t)v; }
+    else { n->type = Node::UInt; n->u = (uint64_t)v; }
+}
+
+// Lectura numérica genérica
+inline double toDouble(const Node* n) {
+    if (!n) return 0;
+    switch (n->type) {
+        case Node::Bool:  return n->b ? 1 : 0;
+        case Node::Int:   return (double)n->i;
+        case Node::UInt:  return (double)n->u;
+        case Node::Float: return n->f;
+        case Node::Str:   return strtod(n->s.c_str(), nullptr);
+        default:          return 0;
+    }
+}
+
+inline int64_t toInt(const Node* n) {
+    if (!n) return 0;
+    switch (n->type) {
+        case Node::Int:   return n->i;
+        case Node::UInt:  return (int64_t)n->u;
+        case Node::Float: return (int64_t)n->f;
+        case Node::Bool:  return n->b ? 1 : 0;
+        case Node::Str:   return strtoll(n->s.c_str(), nullptr, 10);
+        default:          return 0;
+    }
+}
+
+// Serialización (implementada en línea para mantener el shim header-only)
+void write(const Node* n, std::string& out, bool pretty, int indent);
+
+}  // namespace hostjson
+
+class JsonObject;
+class JsonArray;
+
+// ============================================================================
+// JSONVARIANT: referencia a un valor (directa, miembro o elemento)
+// ============================================================================
+class JsonVariant {
+public:
+    JsonVariant() {}
+    explicit JsonVariant(hostjson::Node* n) : node_(n) {}
+    JsonVariant(hostjson::Node* parent, const char* key)
+        : parent_(parent), key_(key ? key : ""), mode_(MEMBER) {}
+    JsonVariant(hostjson::Node* parent, size_t index)
+        : parent_(parent), index_(index), mode_(ELEMENT) {}
+    // Copiar la referencia; asignar (operator=) escribe el valor
+    JsonVariant(const JsonVariant&) = default;
+
+    hostjson::Node* _node() const {
+        switch (mode_) {
+            case MEMBER:  return parent_ ? parent_->find(key_.c_str()) : nullptr;
+            case ELEMENT: return parent_ ? parent_->at(index_) : nullptr;
+            default:      return node_;
+        }
+    }
+
+    hostjson::Node* _nodeForWrite() {
+        if (mode_ == MEMBER && parent_) node_ = parent_->getOrAdd(key_.c_str());
+        else if (mode_ == ELEMENT && parent_) node_ = parent_->at(index_);
+        mode_ = DIRECT;
+        return node_;
+    }
+
+    // Escritura
+    template <typename T> bool set(const T& v) {
+        hostjson::Node* n = _nodeForWrite();
+        if (!n) return false;
+        hostjson::assign(n, v);
+        return true;
+    }
+    bool set(const char* v) {
+        hostjson::Node* n = _nodeForWrite();
+        if (!n) return false;
+        hostjson::assign(n, v);
+        return true;
+    }
+    bool set(const JsonVariant& v) {
+        hostjson::Node* n = _nodeForWrite();
+        const hostjson::Node* src = v._node();
+        if (!n) return false;
+        if (src) n->copyFrom(*src); else n->reset();
+        return true;
+    }
+
+    JsonVariant& operator=(const JsonVariant& v) { set(v); return *this; }
+    JsonVariant& operator=(const char* v) { set(v); return *this; }
+    template <typename T> JsonVariant& operator=(const T& v) { set(v); return *this; }
+
+    // Lectura
+    template <typename T> T as() const;
+    template <typename T> bool is() const;
+
+    template <typename T,
+              typename = typename std::enable_if<!std::is_same<T, JsonVariant>::value>::type>
+    operator T() const { return as<T>(); }
+
+    bool isNull() const {
+        const hostjson::Node* n = _node();
+        return !n || n->type == hostjson::Node::Null;
+    }
+    size_t size() const { const hostjson::Node* n = _node(); return n ? n->size() : 0; }
+    bool containsKey(const char* key) const {
+        const hostjson::Node* n = _node();
+        return n && n->find(key) != nullptr;
+    }
+    bool containsKey(const String& key) const { return containsKey(key.c_str()); }
+
+    // Acceso anidado (crea el objeto padre si hace falta)
+    JsonVariant operator[](const char* key) {
+        hostjson::Node* n = _node();
+        if (!n && mode_ == MEMBER) n = _nodeForWrite();
+        return JsonVariant(n, key);
+    }
+    JsonVariant operator[](const String& key) { return (*this)[key.c_str()]; }
+    template <typename TIndex>
+    typename std::enable_if<std::is_integral<TIndex>::value, JsonVariant>::type
+    operator[](TIndex index) { return JsonVariant(_node(), (size_t)index); }
+
+    JsonObject createNestedObject(const char* key);
+    JsonArray createNestedArray(const char* key);
+    JsonObject createNestedObject();
+    JsonArray createNestedArray();
+    template <typename T> bool add(const T& v);
+    bool add(const char* v);
+
+private:
+    enum Mode { DIRECT, MEMBER, ELEMENT };
+
+    hostjson::Node* node_ = nullptr;
+    hostjson::Node* parent_ = nullptr;
+    std::string key_;
+    size_t index_ = 0;
+    Mode mode_ = DIRECT;
+};
+
+// ============================================================================
+// JSONOBJECT / JSONARRAY
+// ============================================================================
+class JsonPair {
+public:
+    JsonPair(const char* k, hostjson::Node* v) : key_(k), value_(v) {}
+    String key() const { return String(key_); }
+    JsonVariant value() const { return value_; }
+private:
+    const char* key_;
+    JsonVariant value_;
+};
+
+class JsonObject {
+public:
+    JsonObject() {}
+    explicit JsonObject(hostjson::Node* n) : node_(n) {
+        if (node_ && node_->type == hostjson::Node::Null) node_->type = hostjson::Node::Object;
+    }
+
+    hostjson::Node* _node() const { return node_; }
+
+    JsonVariant operator[](const char* key) const { return JsonVariant(node_, key); }
+    JsonVariant operator[](const String& key) const { return JsonVariant(node_, key.c_str()); }
+
+    bool containsKey(const char* key) const { return node_ && node_->find(key) != nullptr; }
+    bool containsKey(const String& key) const { return containsKey(key.c_str()); }
+    bool isNull() const { return !node_ || node_->type != hostjson::Node::Object; }
+    size_t size() const { return node_ ? node_->size() : 0; }
+    void clear() const { if (node_) { node_->reset(); node_->type = hostjson::Node::Object; } }
+
+    JsonObject createNestedObject(const char* key) const;
+    JsonArray createNestedArray(const char* key) const;
+
+    template <typename T> bool set(const char* key, const T& v) const { return JsonVariant(node_, key).set(v); }
+
+    class iterator {
+    public:
+        iterator(hostjson::Node* n, size_t i) : node_(n), i_(i) {}
+        JsonPair operator*() const {
+            return JsonPair(node_->members[i_].first.c_str(), node_->members[i_].second.get());
+        }
+        iterator& operator++() { ++i_; return *this; }
+        bool operator!=(const iterator& o) const { return i_ != o.i_; }
+    private:
+        hostjson::Node* node_;
+        size_t i_;
+    };
+    iterator begin() const { return iterator(node_, 0); }
+    iterator end() const { return iterator(node_, isNull() ? 0 : node_->members.size()); }
+
+private:
+    hostjson::Node* node_ = nullptr;
+};
+
+class JsonArray {
+public:
+    JsonArray() {}
+    explicit JsonArray(hostjson::Node* n) : node_(n) {
+        if (node_ && node_->type == hostjson::Node::Null) node_->type = hostjson::Node::Array;
+    }
+
+    hostjson::Node* _node() const { return node_; }
+
+    template <typename T> bool add(const T& v) const {
+        if (!node_) return false;
+        hostjson::Node* e = node_->addElement();
+        if (!e) return false;
+        return JsonVariant(e).set(v);
+    }
+    bool add(const char* v) const {
+        if (!node_) return false;
+        hostjson::Node* e = node_->addElement();
+        if (!e) return false;
+        hostjson::assign(e, v);
+        return true;
+    }
+
+    JsonObject createNestedObject() const { return JsonObject(node_ ? node_->addElement() : nullptr); }
+    JsonArray createNestedArray() const { return JsonArray(node_ ? node_->addElement() : nullptr); }
+
+    template <typename TIndex>
+    typename std::enable_if<std::is_integral<TIndex>::value, JsonVariant>::type
+    operator[](TIndex index) const { return JsonVariant(node_, (size_t)index); }
+    size_t size() const { return node_ ? node_->size() : 0; }
+    bool isNull() const { return !node_ || node_->type != hostjson::Node::Array; }
+
+    class iterator {
+    public:
+        iterator(hostjson::Node* n, size_t i) : node_(n), i_(i) {}
+        JsonVariant operator*() const { return JsonVariant(node_->elements[i_].get()); }
+        iterator& operator++() { ++i_; return *this; }
+        bool operator!=(const iterator& o) const { return i_ != o.i_; }
+    private:
+        hostjson::Node* node_;
+        size_t i_;
+    };
+    iterator begin() const { return iterator(node_, 0); }
+    iterator end() const { return iterator(node_, isNull() ? 0 : node_->elements.size()); }
+
+private:
+    hostjson::Node* node_ = nullptr;
+};
+
+// ============================================================================
+// CONVERSIONES DE JSONVARIANT
+// ============================================================================
+namespace hostjson {
+
+template <typename T, typename Enable = void> struct Converter;
+
+template <> struct Converter<bool> {
+    static bool get(const Node* n) {
+        if (!n) return false;
+        if (n->type == Node::Bool) return n->b;
+        if (n->type == Node::Int || n->type == Node::UInt || n->type == Node::Float) return toDouble(n) != 0;
+        return false;
+    }
+    static bool is(const Node* n) { return n && n->type == Node::Bool; }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static T get(const Node* n) { return (T)toInt(n); }
+    static bool is(const Node* n) { return n && (n->type == Node::Int || n->type == Node::UInt); }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static T get(const Node* n) { return (T)toDouble(n); }
+    static bool is(const Node* n) {
+        return n && (n->type == Node::Float || n->type == Node::Int || n->type == Node::UInt);
+    }
+};
+
+template <> struct Converter<const char*> {
+    static const char* get(const Node* n) { return (n && n->type == Node::Str) ? n->s.c_str() : nullptr; }
+    static bool is(const Node* n) { return n && n->type == Node::Str; }
+};
+
+template <> struct Converter<String> {
+    static String get(const Node* n) {
+        if (!n) return String("null");
+        if (n->type == Node::Str) return String(n->s);
+        std::string out;
+        write(n, out, false, 0);
+        return String(out);
+    }
+    static bool is(const Node* n) { return n && n->type == Node::Str; }
+};
+
+template <> struct Converter<JsonObject> {
+    static JsonObject get(const Node* n) {
+        return (n && n->type == Node::Object) ? JsonObject(const_cast<Node*>(n)) : JsonObject();
+    }
+    static bool is(const Node* n) { return n && n->type == Node::Object; }
+};
+
+template <> struct Converter<JsonArray> {
+    static JsonArray get(const Node* n) {
+        return (n && n->type == Node::Array) ? JsonArray(const_cast<Node*>(n)) : JsonArray();
+    }
+    static bool is(const Node* n) { return n && n->type == Node::Array; }
+};
+
+template <> struct Converter<JsonVariant> {
+    static JsonVariant get(const Node* n) { return JsonVariant(const_cast<Node*>(n)); }
+    static bool is(const Node*) { return true; }
+};
+
+}  // namespace hostjson
+
+template <typename T> inline T JsonVariant::as() const { return hostjson::Converter<T>::get(_node()); }
+template <typename T> inline bool JsonVariant::is() const { return hostjson::Converter<T>::is(_node()); }
+
+inline JsonObject JsonVariant::createNestedObject(const char* key) {
+    hostjson::Node* n = _nodeForWrite();
+    return n ? JsonObject(n->getOrAdd(key)) : JsonObject();
+}
+inline JsonArray JsonVariant::createNestedArray(const char* key) {
+    hostjson::Node* n = _nodeForWrite();
+    return n ? JsonArray(n->getOrAdd(key)) : JsonArray();
+}
+inline JsonObject JsonVariant::createNestedObject() {
+    hostjson::Node* n = _nodeForWrite();
+    return n ? JsonObject(n->addElement()) : JsonObject();
+}
+inline JsonArray JsonVariant::createNestedArray() {
+    hostjson::Node* n = _nodeForWrite();
+    return n ? JsonArray(n->addElement()) : JsonArray();
+}
+template <typename T> inline bool JsonVariant::add(const T& v) { return JsonArray(_nodeForWrite()).add(v); }
+inline bool JsonVariant::add(const char* v) { return JsonArray(_nodeForWrite()).add(v); }
+
+inline JsonObject JsonObject::createNestedObject(const char* key) const {
+    return node_ ? JsonObject(node_->getOrAdd(key)) : JsonObject();
+}
+inline JsonArray JsonObject::createNestedArray(const char* key) const {
+    return node_ ? JsonArray(node_->getOrAdd(key)) : JsonArray();
+}
+
+// ============================================================================
+// DOCUMENTOS
+// ============================================================================
+class JsonDocument {
+public:
+    explicit JsonDocument(size_t capacity) : capacity_(capacity), root_(new hostjson::Node()) {}
+    JsonDocument(const JsonDocument& o) : capacity_(o.capacity_), root_(new hostjson::Node()) {
+        root_->copyFrom(*o.root_);
+    }
+    JsonDocument& operator=(const JsonDocument& o) {
+        if (this != &o) root_->copyFrom(*o.root_);
+        return *this;
+    }
+
+    hostjson::Node* _node() const { return root_.get(); }
+
+    JsonVariant operator[](const char* key) {
+        if (root_->type == hostjson::Node::Null) root_->type = hostjson::Node::Object;
+        return JsonVariant(root_.get(), key);
+    }
+    JsonVariant operator[](const String& key) { return (*this)[key.c_str()]; }
+    template <typename TIndex>
+    typename std::enable_if<std::is_integral<TIndex>::value, JsonVariant>::type
+    operator[](TIndex index) { return JsonVariant(root_.get(), (size_t)index); }
+
+    JsonObject createNestedObject(const char* key) { return JsonObject(root_->getOrAdd(key)); }
+    JsonArray createNestedArray(const char* key) { return JsonArray(root_->getOrAdd(key)); }
+    JsonObject createNestedObject() { return JsonObject(root_->addElement()); }
+    JsonArray createNestedArray() { return JsonArray(root_->addElement()); }
+
+    template <typename T> bool add(const T& v) { return JsonArray(root_.get()).add(v); }
+    bool add(const char* v) { return JsonArray(root_.get()).add(v); }
+
+    template <typename T> T as() const { return hostjson::Converter<T>::get(root_.get()); }
+    template <typename T> bool is() const { return hostjson::Converter<T>::is(root_.get()); }
+    template <typename T> T to() {
+        root_->reset();
+        return T(root_.get());
+    }
+
+    bool containsKey(const char* key) const { return root_->find(key) != nullptr; }
+    bool containsKey(const String& key) const { return containsKey(key.c_str()); }
+    size_t size() const { return root_->size(); }
+    bool isNull() const { return root_->type == hostjson::Node::Null; }
+    void clear() { root_->reset(); }
+    size_t capacity() const { return capacity_; }
+    size_t memoryUsage() const;
+    bool overflowed() const { return false; }
+
+private:
+    size_t capacity_;
+    std::unique_ptr<hostjson::Node> root_;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(N) {}
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+    explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+// ============================================================================
+// SERIALIZACIÓN
+// ============================================================================
+namespace hostjson {
+
+inline void writeString(const std::string& s, std::string& out) {
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void newline(std::string& out, bool pretty, int indent) {
+    if (!pretty) return;
+    out += "\r\n";
+    out.append((size_t)indent * 2, ' ');
+}
+
+inline void write(const Node* n, std::string& out, bool pretty, int indent) {
+    char buf[40];
+    if (!n) { out += "null"; return; }
+    switch (n->type) {
+        case Node::Null:  out += "null"; break;
+        case Node::Bool:  out += n->b ? "true" : "false"; break;
+        case Node::Int:   snprintf(buf, sizeof(buf), "%lld", (long long)n->i); out += buf; break;
+        case Node::UInt:  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)n->u); out += buf; break;
+        case Node::Float:
+            if (isnan(n->f) || isinf(n->f)) { out += "null"; break; }
+            snprintf(buf, sizeof(buf), n->singlePrecision ? "%.7g" : "%.15g", n->f);
+            out += buf;
+            break;
+        case Node::Str:   writeString(n->s, out); break;
+        case Node::Object: {
+            out += '{';
+            bool first = true;
+            for (auto& m : n->members) {
+                if (!first) out += ',';
+                first = false;
+                newline(out, pretty, indent + 1);
+                writeString(m.first, out);
+                out += pretty ? ": " : ":";
+                write(m.second.get(), out, pretty, indent + 1);
+            }
+            if (!n->members.empty()) newline(out, pretty, indent);
+            out += '}';
+            break;
+        }
+        case Node::Array: {
+            out += '[';
+            bool first = true;
+            for (auto& e : n->elements) {
+                if (!first) out += ',';
+                first = false;
+                newline(out, pretty, indent + 1);
+                write(e.get(), out, pretty, indent + 1);
+            }
+            if (!n->elements.empty()) newline(out, pretty, indent);
+            out += ']';
+            break;
+        }
+    }
+}
+
+}  // namespace hostjson
+
+inline size_t JsonDocument::memoryUsage() const {
+    std::string out;
+    hostjson::write(root_.get(), out, false, 0);
+    return out.size();
+}
+
+template <typename TSource>
+inline size_t serializeJson(const TSource& src, String& output) {
+    std::string out;
+    hostjson::write(src._node(), out, false, 0);
+    output = String(out);
+    return out.size();
+}
+
+template <typename TSource>
+inline size_t serializeJson(const TSource& src, Print& output) {
+    std::string out;
+    hostjson::write(src._node(), out, false, 0);
+    return output.write((const uint8_t*)out.data(), out.size());
+}
+
+template <typename TSource>
+inline size_t serializeJson(const TSource& src, char* buffer, size_t size) {
+    std::string out;
+    hostjson::write(src._node(), out, false, 0);
+    if (size == 0) return 0;
+    size_t n = out.size() < size - 1 ? out.size() : size - 1;
+    memcpy(buffer, out.data(), n);
+    buffer[n] = 0;
+    return n;
+}
+
+template <typename TSource>
+inline size_t serializeJsonPretty(const TSource& src, Print& output) {
+    std::string out;
+    hostjson::write(src._node(), out, true, 0);
+    return output.write((const uint8_t*)out.data(), out.size());
+}
+
+template <typename TSource>
+inline size_t serializeJsonPretty(const TSource& src, String& output) {
+    std::string out;
+    hostjson::write(src._node(), out, true, 0);
+    output = String(out);
+    return out.size();
+}
+
+template <typename TSource>
+inline size_t measureJson(const TSource& src) {
+    std::string out;
+    hostjson::write(src._node(), out, false, 0);
+    return out.size();
+}
+
+// ============================================================================
+// DESERIALIZACIÓN
+// ============================================================================
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code c = Ok) : code_(c) {}
+    explicit operator bool() const { return code_ != Ok; }
+    bool operator==(Code c) const { return code_ == c; }
+    bool operator!=(Code c) const { return code_ != c; }
+    Code code() const { return code_; }
+    const char* c_str() const {
+        static const char* names[] = {"Ok", "EmptyInput", "IncompleteInput",
+                                      "InvalidInput", "NoMemory", "TooDeep"};
+        return names[code_];
+    }
+
+private:
+    Code code_;
+};
+
+namespace hostjson {
+
+class Parser {
+public:
+    Parser(const char* p, const char* end) : p_(p), end_(end) {}
+
+    DeserializationError parse(Node* root) {
+        skipWs();
+        if (p_ >= end_) return DeserializationError::EmptyInput;
+        return parseValue(root, 0);
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+
+    void skipWs() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n')) p_++;
+    }
+
+    bool match(const char* lit) {
+        size_t n = strlen(lit);
+        if ((size_t)(end_ - p_) < n || strncmp(p_, lit, n) != 0) return false;
+        p_ += n;
+        return true;
+    }
+
+    DeserializationError parseValue(Node* n, int depth) {
+        if (depth > 20) return DeserializationError::TooDeep;
+        skipWs();
+        if (p_ >= end_) return DeserializationError::IncompleteInput;
+        char c = *p_;
+        if (c == '{') return parseObject(n, depth);
+        if (c == '[') return parseArray(n, depth);
+        if (c == '"') {
+            std::string s;
+            DeserializationError e = parseString(s);
+            if (e) return e;
+            assign(n, s);
+            return DeserializationError::Ok;
+        }
+        if (match("true")) { assign(n, true); return DeserializationError::Ok; }
+        if (match("false")) { assign(n, false); return DeserializationError::Ok; }
+        if (match("null")) { n->reset(); return DeserializationError::Ok; }
+        return parseNumber(n);
+    }
+
+    DeserializationError parseObject(Node* n, int depth) {
+        n->reset();
+        n->type = Node::Object;
+        p_++;
+        skipWs();
+        if (p_ < end_ && *p_ == '}') { p_++; return DeserializationError::Ok; }
+        while (true) {
+            skipWs();
+            if (p_ >= end_) return DeserializationError::IncompleteInput;
+            if (*p_ != '"') return DeserializationError::InvalidInput;
+            std::string key;
+            DeserializationError e = parseString(key);
+            if (e) return e;
+            skipWs();
+            if (p_ >= end_) return DeserializationError::IncompleteInput;
+            if (*p_ != ':') return DeserializationError::InvalidInput;
+            p_++;
+            e = parseValue(n->getOrAdd(key.c_str()), depth + 1);
+            if (e) return e;
+            skipWs();
+            if (p_ >= end_) return DeserializationError::IncompleteInput;
+            if (*p_ == ',') { p_++; continue; }
+            if (*p_ == '}') { p_++; return DeserializationError::Ok; }
+            return DeserializationError::InvalidInput;
+        }
+    }
+
+    DeserializationError parseArray(Node* n, int depth) {
+        n->reset();
+        n->type = Node::Array;
+        p_++;
+        skipWs();
+        if (p_ < end_ && *p_ == ']') { p_++; return DeserializationError::Ok; }
+        while (true) {
+            DeserializationError e = parseValue(n->addElement(), depth + 1);
+            if (e) return e;
+            skipWs();
+            if (p_ >= end_) return DeserializationError::IncompleteInput;
+            if (*p_ == ',') { p_++; continue; }
+            if (*p_ == ']') { p_++; return DeserializationError::Ok; }
+            return DeserializationError::InvalidInput;
+        }
+    }
+
+    static void appendUtf8(std::string& s, unsigned cp) {
+        if (cp < 0x80) s += (char)cp;
+        else if (cp < 0x800) { s += (char)(0xC0 | (cp >> 6)); s += (char)(0x80 | (cp & 0x3F)); }
+        else { s += (char)(0xE0 | (cp >> 12)); s += (char)(0x80 | ((cp >> 6) & 0x3F)); s += (char)(0x80 | (cp & 0x3F)); }
+    }
+
+    DeserializationError parseString(std::string& s) {
+        p_++;
+        while (p_ < end_) {
+            char c = *p_++;
+            if (c == '"') return DeserializationError::Ok;
+            if (c != '\\') { s += c; continue; }
+            if (p_ >= end_) return DeserializationError::IncompleteInput;
+            char e = *p_++;
+            switch (e) {
+                case '"': s += '"'; break;
+                case '\\': s += '\\'; break;
+                case '/': s += '/'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u': {
+                    if (end_ - p_ < 4) return DeserializationError::IncompleteInput;
+                    char hex[5] = {p_[0], p_[1], p_[2], p_[3], 0};
+                    p_ += 4;
+                    appendUtf8(s, (unsigned)strtoul(hex, nullptr, 16));
+                    break;
+                }
+                default: return DeserializationError::InvalidInput;
+            }
+        }
+        return DeserializationError::IncompleteInput;
+    }
+
+    DeserializationError parseNumber(Node* n) {
+        const char* start = p_;
+        bool isFloat = false;
+        if (p_ < end_ && (*p_ == '-' || *p_ == '+')) p_++;
+        while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' || *p_ == 'e' ||
+                             *p_ == 'E' || *p_ == '-' || *p_ == '+')) {
+            if (*p_ == '.' || *p_ == 'e' || *p_ == 'E') isFloat = true;
+            p_++;
+        }
+        if (p_ == start) return DeserializationError::InvalidInput;
+        std::string num(start, p_);
+        if (isFloat) assign(n, strtod(num.c_str(), nullptr));
+        else if (num[0] == '-') assign(n, (long long)strtoll(num.c_str(), nullptr, 10));
+        else assign(n, (unsigned long long)strtoull(num.c_str(), nullptr, 10));
+        return DeserializationError::Ok;
+    }
+};
+
+}  // namespace hostjson
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+    doc.clear();
+    if (!input) return DeserializationError::EmptyInput;
+    hostjson::Parser parser(input, input + length);
+    return parser.parse(doc._node());
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+    return deserializeJson(doc, input, input ? strlen(input) : 0);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+#endif // HOST_ARDUINOJSON_H
@@ -0,0 +1,29 @@
+/*
+ * ============================================================================
+ * DHT.H - SENSOR DHT22 SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_DHT_H
+#define HOST_DHT_H
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT22 22
+
+class DHT {
+public:
+    DHT(uint8_t pin, uint8_t type) : pin_(pin), type_(type) {}
+
+    void begin() {}
+    float readHumidity();
+    float readTemperature(bool fahrenheit = false);
+
+private:
+    uint8_t pin_;
+    uint8_t type_;
+};
+
+#endif // HOST_DHT_H
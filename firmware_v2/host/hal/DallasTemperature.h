@@ -0,0 +1,79 @@
+/*
+ * ============================================================================
+ * DALLASTEMPERATURE.H - SONDAS DS18B20 SIMULADAS (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Reproduce el comportamiento observable de la librería real:
+ * - Tiempo de conversión según resolución (94/188/375/750 ms)
+ * - Hasta completar la conversión se lee el valor anterior del scratchpad
+ * - getTempCByIndex() busca en el bus hasta el índice pedido (costoso)
+ * - CRC del scratchpad: lectura corrupta = DEVICE_DISCONNECTED_C
+ *
+ * Cada transacción de bus cobra su duración real en el reloj virtual.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_DALLASTEMPERATURE_H
+#define HOST_DALLASTEMPERATURE_H
+
+#include "Arduino.h"
+#include "OneWire.h"
+
+typedef uint8_t DeviceAddress[8];
+typedef uint8_t ScratchPad[9];
+
+#define DEVICE_DISCONNECTED_C   -127
+#define DEVICE_DISCONNECTED_RAW -7040
+
+class DallasTemperature {
+public:
+    explicit DallasTemperature(OneWire* bus) : bus_(bus) {}
+
+    void begin();
+    uint8_t getDeviceCount();
+    uint8_t getDS18Count() { return getDeviceCount(); }
+
+    bool validAddress(const uint8_t* address) {
+        return OneWire::crc8(address, 7) == address[7];
+    }
+    bool getAddress(uint8_t* address, uint8_t index);
+    bool isConnected(const uint8_t* address);
+    bool isConnected(const uint8_t* address, uint8_t* scratchPad);
+    bool readScratchPad(const uint8_t* address, uint8_t* scratchPad);
+
+    void setResolution(uint8_t bits);
+    bool setResolution(const uint8_t* address, uint8_t bits, bool skipGlobalCalc = false);
+    uint8_t getResolution() { return globalResolution_; }
+    uint8_t getResolution(const uint8_t* address);
+
+    void setWaitForConversion(bool wait) { waitForConversion_ = wait; }
+    bool getWaitForConversion() { return waitForConversion_; }
+    void setCheckForConversion(bool check) { checkForConversion_ = check; }
+    void setAutoSaveScratchPad(bool save) { autoSaveScratchPad_ = save; }
+    bool getAutoSaveScratchPad() { return autoSaveScratchPad_; }
+
+    void requestTemperatures();
+    bool requestTemperaturesByAddress(const uint8_t* address);
+    bool requestTemperaturesByIndex(uint8_t index);
+    bool isConversionComplete();
+    int16_t millisToWaitForConversion(uint8_t bits);
+    int16_t millisToWaitForConversion() { return millisToWaitForConversion(globalResolution_); }
+
+    int32_t getTemp(const uint8_t* address);
+    float getTempC(const uint8_t* address);
+    float getTempCByIndex(uint8_t index);
+    static float rawToCelsius(int32_t raw) {
+        return raw <= DEVICE_DISCONNECTED_RAW ? DEVICE_DISCONNECTED_C : (float)raw * 0.0078125f;
+    }
+
+private:
+    OneWire* bus_;
+    uint8_t globalResolution_ = 9;
+    bool waitForConversion_ = true;
+    bool checkForConversion_ = true;
+    bool autoSaveScratchPad_ = true;
+};
+
+#endif // HOST_DALLASTEMPERATURE_H
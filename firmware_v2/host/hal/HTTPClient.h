@@ -0,0 +1,74 @@
+/*
+ * ============================================================================
+ * HTTPCLIENT.H - CLIENTE HTTP(S) SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Cada petición bloquea durante la latencia de red configurada en hal.h
+ * (o durante el timeout si no hay internet), igual que en el ESP32.
+ * Con begin(url) cada petición paga además DNS + TCP (+ TLS en https);
+ * con begin(client, url) se reutiliza la conexión abierta del cliente.
+ * La respuesta la decide el HalHttpHandler activo.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT  5000
+
+class HTTPClient {
+public:
+    bool begin(const String& url) {
+        url_ = url; headers_ = String(); response_ = String(); client_ = nullptr;
+        return true;
+    }
+    bool begin(WiFiClient& client, const String& url) {
+        begin(url);
+        client_ = &client;
+        return true;
+    }
+    void end() {
+        response_ = String();
+        headers_ = String();
+        if (client_ && !reuse_) client_->stop();
+    }
+    void addHeader(const String& name, const String& value) {
+        headers_ += name + ": " + value + "\r\n";
+    }
+    void setTimeout(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) { timeoutMs_ = (uint16_t)timeoutMs; }
+    void setReuse(bool reuse) { reuse_ = reuse; }
+
+    int GET() { return sendRequest("GET", String()); }
+    int POST(const String& payload) { return sendRequest("POST", payload); }
+    int POST(const uint8_t* payload, size_t size) {
+        return sendRequest("POST", String(std::string((const char*)payload, size)));
+    }
+    int PATCH(const String& payload) { return sendRequest("PATCH", payload); }
+    int sendRequest(const char* type, const String& payload);
+
+    String getString() { return response_; }
+    int getSize() { return (int)response_.length(); }
+    static String errorToString(int error) { return String("HTTP error ") + String(error); }
+
+private:
+    String url_;
+    String headers_;
+    String response_;
+    WiFiClient* client_ = nullptr;
+    uint16_t timeoutMs_ = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    bool reuse_ = true;
+};
+
+#endif // HOST_HTTPCLIENT_H
@@ -0,0 +1,18 @@
+/*
+ * ============================================================================
+ * HARDWARESERIAL.H - UARTS SIMULADAS (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * HardwareSerial vive en Arduino.h (como en el core): este header solo
+ * existe para los módulos que lo incluyen directo (sim800.h).
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_HARDWARESERIAL_H
+#define HOST_HARDWARESERIAL_H
+
+#include "Arduino.h"
+
+#endif // HOST_HARDWARESERIAL_H
@@ -0,0 +1,43 @@
+/*
+ * ============================================================================
+ * ONEWIRE.H - BUS 1-WIRE SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_ONEWIRE_H
+#define HOST_ONEWIRE_H
+
+#include "Arduino.h"
+
+class OneWire {
+public:
+    explicit OneWire(uint8_t pin) : pin_(pin) {}
+
+    uint8_t reset();
+    void reset_search() { searchIndex_ = 0; }
+    bool search(uint8_t* newAddr, bool search_mode = true);
+
+    // CRC Dallas/Maxim (polinomio X^8 + X^5 + X^4 + 1), igual que la librería real
+    static uint8_t crc8(const uint8_t* addr, uint8_t len) {
+        uint8_t crc = 0;
+        while (len--) {
+            uint8_t inbyte = *addr++;
+            for (uint8_t i = 8; i; i--) {
+                uint8_t mix = (crc ^ inbyte) & 0x01;
+                crc >>= 1;
+                if (mix) crc ^= 0x8C;
+                inbyte >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    uint8_t pin() const { return pin_; }
+
+private:
+    uint8_t pin_;
+    int searchIndex_ = 0;
+};
+
+#endif // HOST_ONEWIRE_H
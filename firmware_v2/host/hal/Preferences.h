@@ -0,0 +1,73 @@
+/*
+ * ============================================================================
+ * PREFERENCES.H - NVS SIMULADO EN MEMORIA (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Cada namespace es un mapa clave -> bytes. El contenido sobrevive a
+ * begin()/end() durante toda la ejecución del proceso, igual que la NVS
+ * sobrevive a los reinicios en el ESP32.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putULong(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putString(const char* key, const char* value) { return putRaw(key, value, strlen(value)); }
+    size_t putString(const char* key, const String& value) { return putRaw(key, value.c_str(), value.length()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putRaw(key, value, len); }
+
+    bool getBool(const char* key, bool def = false) { return getScalar(key, def); }
+    uint8_t getUChar(const char* key, uint8_t def = 0) { return getScalar(key, def); }
+    int16_t getShort(const char* key, int16_t def = 0) { return getScalar(key, def); }
+    uint16_t getUShort(const char* key, uint16_t def = 0) { return getScalar(key, def); }
+    int32_t getInt(const char* key, int32_t def = 0) { return getScalar(key, def); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return getScalar(key, def); }
+    int32_t getLong(const char* key, int32_t def = 0) { return getScalar(key, def); }
+    uint32_t getULong(const char* key, uint32_t def = 0) { return getScalar(key, def); }
+    uint64_t getULong64(const char* key, uint64_t def = 0) { return getScalar(key, def); }
+    float getFloat(const char* key, float def = NAN) { return getScalar(key, def); }
+    String getString(const char* key, const String& def = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    size_t putRaw(const char* key, const void* value, size_t len);
+    bool getRaw(const char* key, std::string& out);
+
+    template <typename T> T getScalar(const char* key, T def) {
+        std::string raw;
+        if (!getRaw(key, raw) || raw.size() != sizeof(T)) return def;
+        T v;
+        memcpy(&v, raw.data(), sizeof(T));
+        return v;
+    }
+
+    std::string ns_;
+    bool open_ = false;
+    bool readOnly_ = false;
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,75 @@
+/*
+ * ============================================================================
+ * WIFI.H - WIFI SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS   = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED     = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED  = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+class IPAddress {
+public:
+    IPAddress() : b_{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : b_{a, b, c, d} {}
+
+    uint8_t operator[](int i) const { return b_[i]; }
+    bool operator==(const IPAddress& o) const { return memcmp(b_, o.b_, 4) == 0; }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", b_[0], b_[1], b_[2], b_[3]);
+        return String(buf);
+    }
+
+private:
+    uint8_t b_[4];
+};
+
+// Cliente TCP saliente: lo escrito se descarta. WiFiClientSecure modela el
+// costo de conectar.
+class WiFiClient : public Stream {
+public:
+    virtual ~WiFiClient() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    virtual int connect(const char* host, uint16_t port) { (void)host; (void)port; return 0; }
+    virtual uint8_t connected() { return 1; }
+    virtual void stop() {}
+    void setTimeout(uint32_t) {}
+
+    uint64_t halLastIoUs = 0;       // Última petición (cierre por keep-alive del servidor)
+};
+
+class WiFiClass {
+public:
+    wl_status_t status();
+    int8_t RSSI();
+    IPAddress localIP();
+    String SSID() { return String("host-sim"); }
+    String macAddress() { return String("02:00:00:00:00:01"); }
+    bool mode(wifi_mode_t) { return true; }
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool reconnect();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    int hostByName(const char* host, IPAddress& result);
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,36 @@
+/*
+ * ============================================================================
+ * WIFICLIENTSECURE.H - CLIENTE TLS SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Modela el costo de abrir la conexión: TCP (1 RTT) + handshake TLS
+ * (2 RTT + cómputo, ver halSetTlsHandshakeMs). El servidor cierra la
+ * conexión tras halSetServerKeepAliveMs sin peticiones.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char*) {}
+    void setHandshakeTimeout(unsigned long seconds) { timeoutMs_ = seconds * 1000; }
+
+    int connect(IPAddress ip, uint16_t port, const char* host,
+                const char* rootCA, const char* cliCert, const char* cliKey);
+    int connect(const char* host, uint16_t port) override;
+    uint8_t connected() override;
+    void stop() override { open_ = false; }
+
+private:
+    bool open_ = false;
+    unsigned long timeoutMs_ = 120000;
+};
+
+#endif // HOST_WIFICLIENTSECURE_H
@@ -0,0 +1,24 @@
+/*
+ * ============================================================================
+ * WIFIMANAGER.H - PORTAL WIFI SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_WIFIMANAGER_H
+#define HOST_WIFIMANAGER_H
+
+#include "WiFi.h"
+
+class WiFiManager {
+public:
+    void setConfigPortalTimeout(unsigned long seconds) { (void)seconds; }
+    void setConnectTimeout(unsigned long seconds) { (void)seconds; }
+    bool autoConnect(const char* apName, const char* apPassword = nullptr) {
+        (void)apName; (void)apPassword;
+        return WiFi.status() == WL_CONNECTED;
+    }
+    void resetSettings() {}
+};
+
+#endif // HOST_WIFIMANAGER_H
@@ -0,0 +1,26 @@
+/*
+ * ============================================================================
+ * WIFIUDP.H - UDP SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include "WiFi.h"
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t port) { (void)port; return 1; }
+    void stop() {}
+    int parsePacket() { return 0; }
+    int read(char* buf, size_t len) { (void)buf; (void)len; return 0; }
+    int beginPacket(IPAddress ip, uint16_t port) { (void)ip; (void)port; return 1; }
+    size_t write(const uint8_t* buf, size_t size) { (void)buf; return size; }
+    int endPacket() { return 1; }
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+};
+
+#endif // HOST_WIFIUDP_H
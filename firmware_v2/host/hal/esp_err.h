@@ -0,0 +1,19 @@
+/*
+ * ============================================================================
+ * ESP_ERR.H - CÓDIGOS DE ERROR DE ESP-IDF (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#ifndef HOST_ESP_ERR_H
+#define HOST_ESP_ERR_H
+
+typedef int esp_err_t;
+#define ESP_OK                      0
+#define ESP_FAIL                    (-1)
+#define ESP_ERR_NO_MEM              0x101
+#define ESP_ERR_INVALID_ARG         0x102
+#define ESP_ERR_INVALID_SIZE        0x104
+#define ESP_ERR_NOT_FOUND           0x105
+
+#endif // HOST_ESP_ERR_H
@@ -0,0 +1,125 @@
+/*
+ * ============================================================================
+ * ESP_HTTP_SERVER.H - SERVIDOR HTTP DE ESP-IDF SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * El subconjunto de esp_http_server que usa el firmware. Las peticiones se
+ * inyectan con halWebInject(); la tarea del servidor (un hilo de
+ * freertos.cpp) corre el trabajo de httpd_queue_work() y atiende una
+ * petición por vez. Cada petición es una conexión nueva.
+ *
+ * - La respuesta queda en halWebLastResponse() al volver el handler, o al
+ *   llamar a httpd_req_async_handler_complete() si el handler la pasó a
+ *   otra tarea con httpd_req_async_handler_begin().
+ * - Una conexión a la que el handler le dejó sess_ctx sigue abierta:
+ *   httpd_socket_send() escribe en halWebStreamOutput() hasta
+ *   httpd_sess_trigger_close().
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_ESP_HTTP_SERVER_H
+#define HOST_ESP_HTTP_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef void* httpd_handle_t;
+
+// Mismos valores que http_parser.h
+typedef enum http_method {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+    HTTP_OPTIONS = 6
+} httpd_method_t;
+
+#define HTTPD_MAX_URI_LEN           512
+#define HTTPD_RESP_USE_STRLEN       (-1)
+
+#define ESP_ERR_HTTPD_BASE          0xb000
+#define ESP_ERR_HTTPD_RESULT_TRUNC  (ESP_ERR_HTTPD_BASE + 6)
+
+#define HTTPD_SOCK_ERR_FAIL         (-1)
+#define HTTPD_SOCK_ERR_INVALID      (-2)
+#define HTTPD_SOCK_ERR_TIMEOUT      (-3)
+
+typedef void (*httpd_free_ctx_fn_t)(void* ctx);
+typedef void (*httpd_work_fn_t)(void* arg);
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    char uri[HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void* aux;                          // Estado de la simulación
+    void* user_ctx;
+    void* sess_ctx;
+    httpd_free_ctx_fn_t free_ctx;
+    bool ignore_sess_ctx_changes;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char* uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t* r);
+    void* user_ctx;
+} httpd_uri_t;
+
+typedef enum {
+    HTTPD_500_INTERNAL_SERVER_ERROR = 0,
+    HTTPD_400_BAD_REQUEST = 5,
+    HTTPD_404_NOT_FOUND = 7,
+    HTTPD_405_METHOD_NOT_ALLOWED = 8,
+    HTTPD_ERR_CODE_MAX = 13
+} httpd_err_code_t;
+
+typedef esp_err_t (*httpd_err_handler_func_t)(httpd_req_t* req, httpd_err_code_t error);
+
+typedef struct httpd_config {
+    unsigned task_priority;
+    size_t stack_size;
+    BaseType_t core_id;
+    uint16_t server_port;
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    uint16_t max_resp_headers;
+    bool lru_purge_enable;
+    uint16_t recv_wait_timeout;
+    uint16_t send_wait_timeout;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() httpd_config_t{ 5, 4096, tskNO_AFFINITY, 80, 7, 8, 8, false, 5, 5 }
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler);
+esp_err_t httpd_register_err_handler(httpd_handle_t handle, httpd_err_code_t error,
+                                     httpd_err_handler_func_t handler);
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size);
+size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val, size_t val_size);
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len);
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status);
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value);
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len);
+
+int httpd_req_to_sockfd(httpd_req_t* r);
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char* buf, size_t buf_len, int flags);
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg);
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r);
+
+#endif // HOST_ESP_HTTP_SERVER_H
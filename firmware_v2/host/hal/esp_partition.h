@@ -0,0 +1,46 @@
+/*
+ * ============================================================================
+ * ESP_PARTITION.H - PARTICIONES DE FLASH SIMULADAS (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Una sola partición de datos "journal" en memoria (ver halSetJournalSize).
+ * Igual que la flash NOR: escribir solo pasa bits de 1 a 0 y borrar un
+ * sector de 4 KB lo deja en 0xFF y tarda ~45 ms.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    uint8_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size);
+
+#endif // HOST_ESP_PARTITION_H
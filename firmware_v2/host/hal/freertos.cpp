@@ -0,0 +1,236 @@
+/*
+ * ============================================================================
+ * FREERTOS.CPP - TAREAS Y COLAS SOBRE std::thread (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#include "Arduino.h"
+#include "hal.h"
+
+#include <pthread.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// TAREAS
+// ============================================================================
+struct HostTask {
+    std::string name;
+    uint32_t stackDepth;
+    BaseType_t coreId;
+};
+
+static thread_local BaseType_t t_coreId = 1;   // loop() corre en el core 1
+static thread_local HostTask* t_task = nullptr;
+
+BaseType_t xPortGetCoreID() { return t_coreId; }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name,
+                                   uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)priority;
+    HostTask* task = new HostTask{name ? name : "", stackDepth,
+                                  coreId == tskNO_AFFINITY ? 0 : coreId};
+    halSchedulerThreadStart();
+    std::thread([fn, param, task]() {
+        t_coreId = task->coreId;
+        t_task = task;
+        fn(param);
+        halSchedulerThreadExit();
+    }).detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, handle,
+                                   tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Solo se soporta que una tarea se borre a sí misma
+    if (task == nullptr || task == t_task) {
+        halSchedulerThreadExit();
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    HostTask* t = task ? task : t_task;
+    return t ? t->stackDepth : 0;
+}
+
+// ============================================================================
+// SECCIONES CRÍTICAS
+// ============================================================================
+static std::mutex g_muxInitMutex;
+
+static std::recursive_mutex* muxImpl(portMUX_TYPE* mux) {
+    std::lock_guard<std::mutex> lock(g_muxInitMutex);
+    if (!mux->impl) mux->impl = new std::recursive_mutex();
+    return static_cast<std::recursive_mutex*>(mux->impl);
+}
+
+void hostPortEnterCritical(portMUX_TYPE* mux) { muxImpl(mux)->lock(); }
+void hostPortExitCritical(portMUX_TYPE* mux) { muxImpl(mux)->unlock(); }
+
+// ============================================================================
+// COLAS
+// ============================================================================
+struct HostQueue {
+    std::mutex mutex;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+
+static uint64_t deadlineFor(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return UINT64_MAX;
+    return halClockNowUs() + (uint64_t)ticks * 1000ULL;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* q = new HostQueue();
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+static BaseType_t queueSend(QueueHandle_t q, const void* item, TickType_t ticks, bool front) {
+    auto tryPush = [&]() {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        if (q->items.size() >= q->length) return false;
+        const uint8_t* p = static_cast<const uint8_t*>(item);
+        std::vector<uint8_t> v(p, p + q->itemSize);
+        if (front) q->items.push_front(std::move(v));
+        else q->items.push_back(std::move(v));
+        return true;
+    };
+
+    bool ok = tryPush();
+    if (!ok && ticks > 0) ok = halSchedulerWait(tryPush, deadlineFor(ticks));
+    if (ok) halSchedulerNotify();
+    return ok ? pdTRUE : errQUEUE_FULL;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+    return queueSend(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks) {
+    return queueSend(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t ticks) {
+    return queueSend(q, item, ticks, true);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) {
+    {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        const uint8_t* p = static_cast<const uint8_t*>(item);
+        q->items.clear();
+        q->items.emplace_back(p, p + q->itemSize);
+    }
+    halSchedulerNotify();
+    return pdPASS;
+}
+
+static BaseType_t queueReceive(QueueHandle_t q, void* item, TickType_t ticks, bool remove) {
+    auto tryPop = [&]() {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        if (q->items.empty()) return false;
+        memcpy(item, q->items.front().data(), q->itemSize);
+        if (remove) q->items.pop_front();
+        return true;
+    };
+
+    bool ok = tryPop();
+    if (!ok && ticks > 0) ok = halSchedulerWait(tryPop, deadlineFor(ticks));
+    if (ok && remove) halSchedulerNotify();
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+    return queueReceive(q, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks) {
+    return queueReceive(q, item, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->mutex);
+    return (UBaseType_t)q->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->mutex);
+    return q->length - (UBaseType_t)q->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        q->items.clear();
+    }
+    halSchedulerNotify();
+    return pdPASS;
+}
+
+// ============================================================================
+// MUTEX
+// ============================================================================
+struct HostSemaphore {
+    std::mutex mutex;
+    bool taken = false;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore(); }
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    auto tryTake = [sem]() {
+        std::lock_guard<std::mutex> lock(sem->mutex);
+        if (sem->taken) return false;
+        sem->taken = true;
+        return true;
+    };
+
+    if (tryTake()) return pdTRUE;
+    if (ticks == 0) return pdFALSE;
+    uint64_t deadline = deadlineFor(ticks);
+
+    if (halIsMainThread()) {
+        // El hilo principal no se registra como en espera: avanza el reloj
+        // de a 1 ms hasta que la tarea que tiene el mutex lo suelte
+        while (halClockNowUs() < deadline) {
+            delay(1);
+            if (tryTake()) return pdTRUE;
+        }
+        return pdFALSE;
+    }
+    return halSchedulerWait(tryTake, deadline) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    {
+        std::lock_guard<std::mutex> lock(sem->mutex);
+        sem->taken = false;
+    }
+    halSchedulerNotify();
+    return pdTRUE;
+}
@@ -0,0 +1,64 @@
+/*
+ * ============================================================================
+ * FREERTOS.H - SUSTITUTO DE FREERTOS (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Subconjunto de la API de FreeRTOS del ESP32 implementado sobre std::thread:
+ * - Tareas: xTaskCreatePinnedToCore / xTaskCreate / vTaskDelay / vTaskDelete
+ * - Colas: xQueueCreate / Send / SendToFront / Overwrite / Receive / Peek
+ * - Mutex: xSemaphoreCreateMutex / xSemaphoreTake / xSemaphoreGive
+ * - Secciones críticas: portMUX_TYPE + portENTER_CRITICAL / portEXIT_CRITICAL
+ *
+ * Un tick = 1 ms de reloj virtual. Las esperas usan el reloj de hal.h: en
+ * modo determinístico (speed 0) una tarea secundaria que espera N ms se
+ * despierta cuando el hilo principal (setup/loop) avanzó N ms virtuales.
+ *
+ * xPortGetCoreID() devuelve 1 en el hilo principal (como loop() en el
+ * ESP32) y el core pedido en las tareas creadas con PinnedToCore.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define errQUEUE_FULL       0
+#define errQUEUE_EMPTY      0
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define configTICK_RATE_HZ  1000
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+// ============================================================================
+// SECCIONES CRÍTICAS (spinlock del ESP32 -> mutex recursivo)
+// ============================================================================
+struct HostPortMux {
+    void* impl;
+};
+typedef HostPortMux portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {nullptr}
+
+void hostPortEnterCritical(portMUX_TYPE* mux);
+void hostPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)     hostPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      hostPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) hostPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  hostPortExitCritical(mux)
+
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,26 @@
+/*
+ * ============================================================================
+ * QUEUE.H - COLAS FREERTOS (solo build host, ver FreeRTOS.h)
+ * ============================================================================
+ */
+
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct HostQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t q);
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item);
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q);
+BaseType_t xQueueReset(QueueHandle_t q);
+
+#endif // HOST_FREERTOS_QUEUE_H
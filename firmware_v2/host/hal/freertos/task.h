@@ -0,0 +1,26 @@
+/*
+ * ============================================================================
+ * TASK.H - TAREAS FREERTOS (solo build host, ver FreeRTOS.h)
+ * ============================================================================
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef struct HostTask* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name,
+                                   uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#endif // HOST_FREERTOS_TASK_H
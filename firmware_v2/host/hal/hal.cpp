@@ -0,0 +1,1501 @@
+/*
+ * ============================================================================
+ * HAL.CPP - IMPLEMENTACIÓN DEL HARDWARE SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ */
+
+#include "Arduino.h"
+#include "DallasTemperature.h"
+#include "DHT.h"
+#include "ESPmDNS.h"
+#include "HTTPClient.h"
+#include "Preferences.h"
+#include "WiFi.h"
+#include "WiFiClientSecure.h"
+#include "esp_http_server.h"
+#include "esp_partition.h"
+#include "hal.h"
+
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// OBJETOS GLOBALES DEL CORE
+// ============================================================================
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+// ============================================================================
+// RELOJ VIRTUAL
+// ============================================================================
+// tiempo virtual = anclaVirtual + (real - anclaReal) * speed + ajustes
+// Con speed == 0 solo cuentan los ajustes (delay y costo de E/S).
+// El contador de ciclos usa tiempo real de CPU + costo simulado, para que
+// el profiler vea tanto el cómputo como el bloqueo de E/S.
+
+static std::mutex g_clockMutex;
+static double g_speed = 1.0;
+static uint64_t g_anchorRealNs = 0;
+static uint64_t g_anchorVirtualUs = 0;
+static std::atomic<uint64_t> g_extraUs{0};
+static uint64_t g_bootRealNs = 0;
+
+// Costo simulado por hilo: cada core del ESP32 tiene su propio CCOUNT
+static thread_local uint64_t t_chargedNs = 0;
+
+// Hilo principal (setup/loop); las tareas FreeRTOS corren en otros hilos
+static const std::thread::id g_mainThread = std::this_thread::get_id();
+
+// Planificador: despierta a las tareas cuando avanza el reloj o hay datos.
+// Nunca se destruyen: las tareas (hilos detached) pueden seguir esperando
+// mientras el proceso corre los destructores estáticos al salir.
+static std::mutex& g_schedMutex = *new std::mutex();
+static std::condition_variable& g_schedCv = *new std::condition_variable();
+
+uint64_t halRealNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void clockInitOnce() {
+    if (g_bootRealNs == 0) {
+        g_bootRealNs = halRealNowNs();
+        g_anchorRealNs = g_bootRealNs;
+    }
+}
+
+uint64_t halClockNowUs() {
+    std::lock_guard<std::mutex> lock(g_clockMutex);
+    clockInitOnce();
+    uint64_t v = g_anchorVirtualUs + g_extraUs.load();
+    if (g_speed > 0) {
+        v += (uint64_t)((double)(halRealNowNs() - g_anchorRealNs) / 1000.0 * g_speed);
+    }
+    return v;
+}
+
+void halClockSetSpeed(double speed) {
+    uint64_t now = halClockNowUs();
+    {
+        std::lock_guard<std::mutex> lock(g_clockMutex);
+        g_anchorVirtualUs = now - g_extraUs.load();
+        g_anchorRealNs = halRealNowNs();
+        g_speed = speed < 0 ? 0 : speed;
+    }
+    halSchedulerNotify();
+}
+
+double halClockGetSpeed() {
+    std::lock_guard<std::mutex> lock(g_clockMutex);
+    return g_speed;
+}
+
+void halClockAdvanceUs(uint64_t us) {
+    g_extraUs += us;
+    halSchedulerNotify();
+}
+
+bool halIsMainThread() {
+    return std::this_thread::get_id() == g_mainThread;
+}
+
+// ----------------------------------------------------------------------------
+// Hora del sistema
+// ----------------------------------------------------------------------------
+// Como en el ESP32: time() cuenta segundos desde el boot hasta que SNTP
+// sincroniza. configTime() "sincroniza" al instante (con internet) y desde
+// ahí time() avanza con el reloj virtual.
+static std::atomic<int64_t> g_unixOffsetUs{0};
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+    (void)server1; (void)server2; (void)server3;
+    if (!halInternet()) return;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int64_t realUs = (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+    g_unixOffsetUs = realUs - (int64_t)halClockNowUs() +
+                     (int64_t)(gmtOffsetSec + daylightOffsetSec) * 1000000LL;
+}
+
+extern "C" time_t time(time_t* out) {
+    time_t t = (time_t)(((int64_t)halClockNowUs() + g_unixOffsetUs.load()) / 1000000LL);
+    if (out) *out = t;
+    return t;
+}
+
+// ----------------------------------------------------------------------------
+// Planificador en paso sincronizado (lockstep)
+// ----------------------------------------------------------------------------
+// Cada hilo secundario que espera se registra con su plazo. Quien avanza el
+// reloj marca como "despiertos" a los que llegaron al plazo; quien cambia
+// una cola despierta a todos los que esperan una condición (la condición
+// puede consumir datos, así que solo la evalúa el propio hilo). En modo determinístico el hilo principal, después de
+// avanzar el reloj, espera a que todos los hilos secundarios despiertos
+// vuelvan a bloquearse: así una tarea que espera 250 ms virtuales corre
+// exactamente cuando loop() llegó a ese instante.
+struct SchedWaiter {
+    bool hasCondition;
+    uint64_t deadlineUs;
+    bool woken;
+};
+
+static std::vector<SchedWaiter*> g_waiters;     // Protegido por g_schedMutex
+static int g_bgRunning = 0;                      // Hilos secundarios sin bloquear
+
+static void wakeEligibleLocked(bool stateChanged) {
+    uint64_t now = halClockNowUs();
+    for (SchedWaiter* w : g_waiters) {
+        if (w->woken) continue;
+        if (now >= w->deadlineUs || (stateChanged && w->hasCondition)) {
+            w->woken = true;
+            g_bgRunning++;
+        }
+    }
+    g_schedCv.notify_all();
+}
+
+static void settleLocked(std::unique_lock<std::mutex>& lock, bool stateChanged) {
+    wakeEligibleLocked(stateChanged);
+    if (halIsMainThread() && halClockGetSpeed() <= 0) {
+        g_schedCv.wait(lock, [] { return g_bgRunning == 0; });
+    }
+}
+
+void halSchedulerThreadStart() {
+    std::lock_guard<std::mutex> lock(g_schedMutex);
+    g_bgRunning++;
+}
+
+void halSchedulerThreadExit() {
+    std::lock_guard<std::mutex> lock(g_schedMutex);
+    g_bgRunning--;
+    g_schedCv.notify_all();
+}
+
+void halSchedulerNotify() {
+    std::unique_lock<std::mutex> lock(g_schedMutex);
+    settleLocked(lock, true);
+}
+
+static void schedulerClockAdvanced() {
+    std::unique_lock<std::mutex> lock(g_schedMutex);
+    settleLocked(lock, false);
+}
+
+bool halSchedulerWait(const std::function<bool()>& ready, uint64_t deadlineUs) {
+    std::unique_lock<std::mutex> lock(g_schedMutex);
+    for (;;) {
+        if (ready && ready()) return true;
+        uint64_t now = halClockNowUs();
+        if (now >= deadlineUs) return false;
+
+        if (halIsMainThread()) {
+            double speed = halClockGetSpeed();
+            if (speed > 0) {
+                uint64_t realUs = (uint64_t)((double)(deadlineUs - now) / speed);
+                if (realUs < 1) realUs = 1;
+                if (realUs > 20000) realUs = 20000;
+                g_schedCv.wait_for(lock, std::chrono::microseconds(realUs));
+            } else {
+                // Determinístico: el hilo principal "duerme" avanzando el reloj
+                g_extraUs += deadlineUs - now;
+                settleLocked(lock, false);
+            }
+            continue;
+        }
+
+        // Hilo secundario: registrarse y bloquear hasta que lo despierten
+        SchedWaiter w{(bool)ready, deadlineUs, false};
+        g_waiters.push_back(&w);
+        g_bgRunning--;
+        g_schedCv.notify_all();
+
+        double speed = halClockGetSpeed();
+        if (speed > 0) {
+            // El reloj avanza solo: dormir lo que falta (acotado para re-evaluar)
+            uint64_t realUs = (uint64_t)((double)(deadlineUs - now) / speed);
+            if (realUs < 1) realUs = 1;
+            if (realUs > 20000) realUs = 20000;
+            g_schedCv.wait_for(lock, std::chrono::microseconds(realUs), [&] { return w.woken; });
+            if (!w.woken) g_bgRunning++;
+        } else {
+            g_schedCv.wait(lock, [&] { return w.woken; });
+        }
+        g_waiters.erase(std::find(g_waiters.begin(), g_waiters.end(), &w));
+    }
+}
+
+// Cobrar "us" de tiempo de dispositivo: bloqueo real escalado o avance virtual
+static void halCharge(uint64_t us) {
+    t_chargedNs += us * 1000ULL;
+    double speed = halClockGetSpeed();
+    if (speed > 0) {
+        uint64_t realUs = (uint64_t)((double)us / speed);
+        if (realUs > 0) usleep((useconds_t)realUs);
+    } else if (halIsMainThread()) {
+        g_extraUs += us;
+        schedulerClockAdvanced();   // Deja correr a las tareas que llegaron a su plazo
+    } else {
+        halSchedulerWait(nullptr, halClockNowUs() + us);
+    }
+}
+
+unsigned long millis() { return (unsigned long)(halClockNowUs() / 1000ULL); }
+unsigned long micros() { return (unsigned long)halClockNowUs(); }
+void delay(unsigned long ms) { halCharge((uint64_t)ms * 1000ULL); }
+void delayMicroseconds(unsigned int us) { halCharge(us); }
+void yield() {}
+
+// ============================================================================
+// GPIO / ADC
+// ============================================================================
+#define HAL_PIN_COUNT 64
+
+static uint8_t g_pinMode[HAL_PIN_COUNT];
+static int8_t g_pinInput[HAL_PIN_COUNT] = {};
+static bool g_pinInputSet[HAL_PIN_COUNT] = {};
+static uint8_t g_pinOutput[HAL_PIN_COUNT];
+static uint16_t g_analog[HAL_PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HAL_PIN_COUNT) g_pinMode[pin] = mode;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= HAL_PIN_COUNT) return LOW;
+    if (g_pinMode[pin] == OUTPUT) return g_pinOutput[pin];
+    if (g_pinInputSet[pin]) return g_pinInput[pin];
+    return g_pinMode[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HAL_PIN_COUNT) g_pinOutput[pin] = value ? HIGH : LOW;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return pin < HAL_PIN_COUNT ? g_analog[pin] : 0;
+}
+
+void halSetDigitalInput(uint8_t pin, int level) {
+    if (pin >= HAL_PIN_COUNT) return;
+    g_pinInput[pin] = level ? HIGH : LOW;
+    g_pinInputSet[pin] = true;
+}
+
+int halGetDigitalOutput(uint8_t pin) {
+    return pin < HAL_PIN_COUNT ? g_pinOutput[pin] : LOW;
+}
+
+void halSetAnalogInput(uint8_t pin, uint16_t value) {
+    if (pin < HAL_PIN_COUNT) g_analog[pin] = value;
+}
+
+// ============================================================================
+// STRING
+// ============================================================================
+void String::fromSigned(long long v, unsigned char base) {
+    if (v < 0 && base == DEC) {
+        fromUnsigned((unsigned long long)(-v), base);
+        buf_.insert(buf_.begin(), '-');
+    } else {
+        fromUnsigned((unsigned long long)v, base);
+    }
+}
+
+void String::fromUnsigned(unsigned long long v, unsigned char base) {
+    char buf[70];
+    if (base == HEX) snprintf(buf, sizeof(buf), "%llx", v);
+    else snprintf(buf, sizeof(buf), "%llu", v);
+    buf_ = buf;
+}
+
+void String::fromDouble(double v, unsigned char decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    buf_ = buf;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return strcasecmp(buf_.c_str(), s.buf_.c_str()) == 0;
+}
+
+void String::trim() {
+    size_t a = buf_.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) { buf_.clear(); return; }
+    size_t b = buf_.find_last_not_of(" \t\r\n");
+    buf_ = buf_.substr(a, b - a + 1);
+}
+
+void String::toUpperCase() {
+    for (auto& c : buf_) c = (char)toupper((unsigned char)c);
+}
+
+void String::toLowerCase() {
+    for (auto& c : buf_) c = (char)tolower((unsigned char)c);
+}
+
+void String::replace(const String& from, const String& to) {
+    if (from.buf_.empty()) return;
+    size_t pos = 0;
+    while ((pos = buf_.find(from.buf_, pos)) != std::string::npos) {
+        buf_.replace(pos, from.buf_.size(), to.buf_);
+        pos += to.buf_.size();
+    }
+}
+
+// ============================================================================
+// PRINT / SERIAL
+// ============================================================================
+size_t Print::printf(const char* fmt, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(small, sizeof(small), fmt, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, (size_t)len);
+
+    std::string big((size_t)len + 1, '\0');
+    va_start(args, fmt);
+    vsnprintf(&big[0], big.size(), fmt, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), (size_t)len);
+}
+
+static std::atomic<bool> g_serialEcho{true};
+static std::atomic<uint64_t> g_serialBytes{0};
+static std::mutex g_serialMutex;
+static std::deque<char> g_serialInput;
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+    if (uart_ != 0) return size;
+    g_serialBytes += size;
+    if (g_serialEcho) {
+        std::lock_guard<std::mutex> lock(g_serialMutex);
+        fwrite(buf, 1, size, stdout);
+    }
+    return size;
+}
+
+int HardwareSerial::available() {
+    if (uart_ != 0) return 0;
+    std::lock_guard<std::mutex> lock(g_serialMutex);
+    return (int)g_serialInput.size();
+}
+
+int HardwareSerial::read() {
+    if (uart_ != 0) return -1;
+    std::lock_guard<std::mutex> lock(g_serialMutex);
+    if (g_serialInput.empty()) return -1;
+    char c = g_serialInput.front();
+    g_serialInput.pop_front();
+    return (uint8_t)c;
+}
+
+int HardwareSerial::peek() {
+    if (uart_ != 0) return -1;
+    std::lock_guard<std::mutex> lock(g_serialMutex);
+    return g_serialInput.empty() ? -1 : (uint8_t)g_serialInput.front();
+}
+
+bool Stream::find(const char* target) {
+    size_t len = strlen(target);
+    size_t matched = 0;
+    if (len == 0) return true;
+    int c;
+    while ((c = read()) >= 0) {
+        if (c == target[matched]) {
+            if (++matched == len) return true;
+        } else {
+            matched = c == target[0] ? 1 : 0;
+        }
+    }
+    return false;
+}
+
+long Stream::parseInt() {
+    int c;
+    while ((c = peek()) >= 0 && c != '-' && (c < '0' || c > '9')) read();
+    bool negative = c == '-';
+    if (negative) read();
+    long value = 0;
+    while ((c = peek()) >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        read();
+    }
+    return negative ? -value : value;
+}
+
+void halSerialSetEcho(bool echo) { g_serialEcho = echo; }
+
+void halSerialInject(const std::string& input) {
+    std::lock_guard<std::mutex> lock(g_serialMutex);
+    g_serialInput.insert(g_serialInput.end(), input.begin(), input.end());
+}
+
+uint64_t halSerialBytesWritten() { return g_serialBytes; }
+
+// ============================================================================
+// ESP
+// ============================================================================
+static std::function<void()> g_restartHook;
+
+uint32_t EspClass::getFreeHeap() { return 200000; }
+uint32_t EspClass::getMinFreeHeap() { return 180000; }
+
+uint32_t EspClass::getCycleCount() {
+    clockInitOnce();
+    uint64_t ns = (halRealNowNs() - g_bootRealNs) + t_chargedNs;
+    return (uint32_t)(ns * 240ULL / 1000ULL);   // 240 MHz
+}
+
+void EspClass::restart() {
+    if (g_restartHook) {
+        g_restartHook();
+        return;
+    }
+    fflush(stdout);
+    fprintf(stderr, "[HAL] ESP.restart() - fin de la simulación\n");
+    exit(0);
+}
+
+void halSetRestartHook(std::function<void()> hook) { g_restartHook = hook; }
+
+// Secuencia fija: corridas determinísticas reproducibles
+uint32_t esp_random() {
+    static std::atomic<uint32_t> state{0x2545F491u};
+    uint32_t x = state.load();
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+}
+
+// ============================================================================
+// BUS 1-WIRE / DS18B20
+// ============================================================================
+// Tiempos del bus a velocidad estándar (15.4 kbps)
+#define OW_RESET_US       960
+#define OW_BIT_US         65
+#define OW_BYTE_US        (8 * OW_BIT_US)
+#define OW_SEARCH_US      (OW_RESET_US + OW_BYTE_US + 64 * 3 * OW_BIT_US)
+
+struct SimProbe {
+    float temp = -20.0f;
+    bool connected = true;
+    uint8_t resolution = 12;
+    int32_t latchedRaw = 85 * 128;          // Valor de power-on del DS18B20
+    bool converting = false;
+    uint64_t conversionDoneUs = 0;
+    uint8_t address[8];
+};
+
+static SimProbe g_probes[HAL_MAX_PROBES];
+static int g_probeCount = 1;
+static double g_crcErrorRate = 0.0;
+static uint32_t g_rng = 0x12345678;
+static std::atomic<uint32_t> g_oneWireTransactions{0};
+static std::atomic<uint32_t> g_probeEepromWrites{0};
+
+static uint32_t halRandom() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static void probeInitAddress(int i) {
+    uint8_t* a = g_probes[i].address;
+    a[0] = 0x28;                            // Familia DS18B20
+    for (int b = 1; b < 7; b++) a[b] = (uint8_t)(0x10 * i + b);
+    a[7] = OneWire::crc8(a, 7);
+}
+
+static void owTransaction(uint64_t us) {
+    g_oneWireTransactions++;
+    halCharge(us);
+}
+
+static uint16_t conversionMs(uint8_t bits) {
+    switch (bits) {
+        case 9:  return 94;
+        case 10: return 188;
+        case 11: return 375;
+        default: return 750;
+    }
+}
+
+static int findProbe(const uint8_t* address) {
+    for (int i = 0; i < g_probeCount; i++) {
+        if (g_probes[i].connected && memcmp(g_probes[i].address, address, 8) == 0) return i;
+    }
+    return -1;
+}
+
+static void probeUpdateLatch(SimProbe& p) {
+    if (p.converting && halClockNowUs() >= p.conversionDoneUs) {
+        int32_t step = 1 << (12 - p.resolution + 3);     // Unidades de 1/128 °C
+        int32_t raw = (int32_t)lroundf(p.temp * 128.0f);
+        p.latchedRaw = raw & ~(step - 1);              // Trunca como el ADC del sensor
+        p.converting = false;
+    }
+}
+
+static void probeStartConversion(SimProbe& p) {
+    p.converting = true;
+    p.conversionDoneUs = halClockNowUs() + (uint64_t)conversionMs(p.resolution) * 1000ULL;
+}
+
+void halSetProbeCount(int count) {
+    if (count < 0) count = 0;
+    if (count > HAL_MAX_PROBES) count = HAL_MAX_PROBES;
+    g_probeCount = count;
+}
+
+int halGetProbeCount() { return g_probeCount; }
+
+void halSetProbeTemp(int index, float tempC) {
+    if (index >= 0 && index < HAL_MAX_PROBES) g_probes[index].temp = tempC;
+}
+
+void halSetProbeConnected(int index, bool connected) {
+    if (index >= 0 && index < HAL_MAX_PROBES) g_probes[index].connected = connected;
+}
+
+void halSetProbeCrcErrorRate(double rate) { g_crcErrorRate = rate; }
+uint32_t halOneWireTransactions() { return g_oneWireTransactions; }
+uint32_t halProbeEepromWrites() { return g_probeEepromWrites; }
+
+uint8_t OneWire::reset() {
+    owTransaction(OW_RESET_US);
+    return g_probeCount > 0 ? 1 : 0;
+}
+
+bool OneWire::search(uint8_t* newAddr, bool search_mode) {
+    (void)search_mode;
+    // Cada dirección encontrada cuesta un recorrido del árbol de búsqueda
+    while (searchIndex_ < g_probeCount) {
+        int i = searchIndex_++;
+        if (!g_probes[i].connected) continue;
+        owTransaction(OW_SEARCH_US);
+        memcpy(newAddr, g_probes[i].address, 8);
+        return true;
+    }
+    owTransaction(OW_RESET_US);
+    return false;
+}
+
+void DallasTemperature::begin() {
+    for (int i = 0; i < HAL_MAX_PROBES; i++) probeInitAddress(i);
+    // Búsqueda completa + lectura de scratchpad de cada sonda
+    for (int i = 0; i < g_probeCount; i++) {
+        owTransaction(OW_SEARCH_US);
+        owTransaction(OW_RESET_US + 19 * OW_BYTE_US);
+    }
+    globalResolution_ = 9;
+    for (int i = 0; i < g_probeCount; i++) {
+        if (g_probes[i].resolution > globalResolution_) globalResolution_ = g_probes[i].resolution;
+    }
+}
+
+uint8_t DallasTemperature::getDeviceCount() {
+    int n = 0;
+    for (int i = 0; i < g_probeCount; i++) {
+        if (g_probes[i].connected) n++;
+    }
+    return (uint8_t)n;
+}
+
+bool DallasTemperature::getAddress(uint8_t* address, uint8_t index) {
+    // La librería real reinicia la búsqueda y recorre el bus hasta "index"
+    int found = -1;
+    for (int i = 0; i < g_probeCount; i++) {
+        if (!g_probes[i].connected) continue;
+        owTransaction(OW_SEARCH_US);
+        if (++found == index) {
+            memcpy(address, g_probes[i].address, 8);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DallasTemperature::readScratchPad(const uint8_t* address, uint8_t* scratchPad) {
+    // reset + MATCH ROM (9 bytes) + READ SCRATCHPAD (1) + 9 bytes
+    owTransaction(OW_RESET_US + 19 * OW_BYTE_US);
+    int i = findProbe(address);
+    if (i < 0) {
+        memset(scratchPad, 0xFF, 9);
+        return false;
+    }
+    SimProbe& p = g_probes[i];
+    probeUpdateLatch(p);
+    int16_t raw16 = (int16_t)(p.latchedRaw >> 3);      // Registro en 1/16 °C
+    scratchPad[0] = (uint8_t)(raw16 & 0xFF);
+    scratchPad[1] = (uint8_t)((raw16 >> 8) & 0xFF);
+    scratchPad[2] = 0x4B;
+    scratchPad[3] = 0x46;
+    scratchPad[4] = (uint8_t)(((p.resolution - 9) << 5) | 0x1F);
+    scratchPad[5] = 0xFF;
+    scratchPad[6] = 0x0C;
+    scratchPad[7] = 0x10;
+    scratchPad[8] = OneWire::crc8(scratchPad, 8);
+    if (g_crcErrorRate > 0 && (halRandom() % 1000000) < (uint32_t)(g_crcErrorRate * 1000000)) {
+        scratchPad[3] ^= 0x5A;                          // Ruido en el bus
+    }
+    return true;
+}
+
+bool DallasTemperature::isConnected(const uint8_t* address) {
+    ScratchPad sp;
+    return isConnected(address, sp);
+}
+
+bool DallasTemperature::isConnected(const uint8_t* address, uint8_t* scratchPad) {
+    bool ok = readScratchPad(address, scratchPad);
+    return ok && OneWire::crc8(scratchPad, 8) == scratchPad[8];
+}
+
+void DallasTemperature::setResolution(uint8_t bits) {
+    if (bits < 9) bits = 9;
+    if (bits > 12) bits = 12;
+    globalResolution_ = bits;
+    for (int i = 0; i < g_probeCount; i++) {
+        if (g_probes[i].connected) setResolution(g_probes[i].address, bits, true);
+    }
+}
+
+bool DallasTemperature::setResolution(const uint8_t* address, uint8_t bits, bool skipGlobalCalc) {
+    if (bits < 9) bits = 9;
+    if (bits > 12) bits = 12;
+    int i = findProbe(address);
+    if (i < 0) return false;
+    ScratchPad sp;
+    readScratchPad(address, sp);
+    if (g_probes[i].resolution != bits) {
+        // WRITE SCRATCHPAD (+ COPY SCRATCHPAD a EEPROM si autoSave)
+        owTransaction(OW_RESET_US + 13 * OW_BYTE_US);
+        g_probes[i].resolution = bits;
+        if (autoSaveScratchPad_) {
+            owTransaction(OW_RESET_US + 10 * OW_BYTE_US);
+            g_probeEepromWrites++;
+        }
+    }
+    if (!skipGlobalCalc) {
+        globalResolution_ = bits;
+        for (int j = 0; j < g_probeCount; j++) {
+            if (g_probes[j].connected && g_probes[j].resolution > globalResolution_) {
+                globalResolution_ = g_probes[j].resolution;
+            }
+        }
+    }
+    return true;
+}
+
+uint8_t DallasTemperature::getResolution(const uint8_t* address) {
+    int i = findProbe(address);
+    if (i < 0) return 0;
+    ScratchPad sp;
+    readScratchPad(address, sp);
+    return g_probes[i].resolution;
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bits) {
+    return (int16_t)conversionMs(bits);
+}
+
+void DallasTemperature::requestTemperatures() {
+    // reset + SKIP ROM + CONVERT T
+    owTransaction(OW_RESET_US + 2 * OW_BYTE_US);
+    uint8_t maxBits = 9;
+    for (int i = 0; i < g_probeCount; i++) {
+        if (!g_probes[i].connected) continue;
+        probeStartConversion(g_probes[i]);
+        if (g_probes[i].resolution > maxBits) maxBits = g_probes[i].resolution;
+    }
+    if (waitForConversion_) delay(conversionMs(maxBits));
+}
+
+bool DallasTemperature::requestTemperaturesByAddress(const uint8_t* address) {
+    // reset + MATCH ROM + CONVERT T
+    owTransaction(OW_RESET_US + 10 * OW_BYTE_US);
+    int i = findProbe(address);
+    if (i < 0) return false;
+    probeStartConversion(g_probes[i]);
+    if (waitForConversion_) delay(conversionMs(g_probes[i].resolution));
+    return true;
+}
+
+bool DallasTemperature::requestTemperaturesByIndex(uint8_t index) {
+    DeviceAddress address;
+    if (!getAddress(address, index)) return false;
+    return requestTemperaturesByAddress(address);
+}
+
+bool DallasTemperature::isConversionComplete() {
+    owTransaction(OW_BIT_US);
+    uint64_t now = halClockNowUs();
+    for (int i = 0; i < g_probeCount; i++) {
+        if (g_probes[i].converting && now < g_probes[i].conversionDoneUs) return false;
+    }
+    return true;
+}
+
+int32_t DallasTemperature::getTemp(const uint8_t* address) {
+    ScratchPad sp;
+    if (!isConnected(address, sp)) return DEVICE_DISCONNECTED_RAW;
+    int16_t raw16 = (int16_t)((sp[1] << 8) | sp[0]);
+    return (int32_t)raw16 << 3;
+}
+
+float DallasTemperature::getTempC(const uint8_t* address) {
+    return rawToCelsius(getTemp(address));
+}
+
+float DallasTemperature::getTempCByIndex(uint8_t index) {
+    DeviceAddress address;
+    if (!getAddress(address, index)) return DEVICE_DISCONNECTED_C;
+    return getTempC(address);
+}
+
+// ============================================================================
+// DHT22
+// ============================================================================
+static float g_dhtHumidity = NAN;
+static float g_dhtTemp = NAN;
+
+void halSetDHT(float humidity, float tempC) {
+    g_dhtHumidity = humidity;
+    g_dhtTemp = tempC;
+}
+
+float DHT::readHumidity() {
+    delay(5);                                           // Trama de 40 bits
+    return g_dhtHumidity;
+}
+
+float DHT::readTemperature(bool fahrenheit) {
+    delay(5);
+    return fahrenheit ? g_dhtTemp * 1.8f + 32.0f : g_dhtTemp;
+}
+
+// ============================================================================
+// PREFERENCES (NVS en memoria)
+// ============================================================================
+static std::mutex g_prefsMutex;
+static std::map<std::string, std::map<std::string, std::string>> g_nvs;
+static std::atomic<uint32_t> g_flashWrites{0};
+
+uint32_t halFlashWrites() { return g_flashWrites; }
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    ns_ = name ? name : "";
+    readOnly_ = readOnly;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end() { open_ = false; }
+
+bool Preferences::clear() {
+    if (!open_ || readOnly_) return false;
+    std::lock_guard<std::mutex> lock(g_prefsMutex);
+    g_nvs[ns_].clear();
+    g_flashWrites++;
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || readOnly_) return false;
+    std::lock_guard<std::mutex> lock(g_prefsMutex);
+    g_flashWrites++;
+    return g_nvs[ns_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    std::lock_guard<std::mutex> lock(g_prefsMutex);
+    auto ns = g_nvs.find(ns_);
+    return ns != g_nvs.end() && ns->second.count(key) > 0;
+}
+
+size_t Preferences::putRaw(const char* key, const void* value, size_t len) {
+    if (!open_ || readOnly_) return 0;
+    std::lock_guard<std::mutex> lock(g_prefsMutex);
+    g_nvs[ns_][key] = std::string((const char*)value, len);
+    g_flashWrites++;
+    return len;
+}
+
+bool Preferences::getRaw(const char* key, std::string& out) {
+    if (!open_) return false;
+    std::lock_guard<std::mutex> lock(g_prefsMutex);
+    auto ns = g_nvs.find(ns_);
+    if (ns == g_nvs.end()) return false;
+    auto it = ns->second.find(key);
+    if (it == ns->second.end()) return false;
+    out = it->second;
+    return true;
+}
+
+String Preferences::getString(const char* key, const String& def) {
+    std::string raw;
+    return getRaw(key, raw) ? String(raw) : def;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    std::string raw;
+    return getRaw(key, raw) ? raw.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() > maxLen) return 0;
+    memcpy(buf, raw.data(), raw.size());
+    return raw.size();
+}
+
+// ============================================================================
+// PARTICIONES "journal" Y "trace" (flash NOR en memoria)
+// ============================================================================
+struct HalPartition {
+    esp_partition_t part;
+    uint32_t size;                              // Como en partitions.csv
+    std::vector<uint8_t> flash;
+    std::atomic<uint32_t> erases{0};
+};
+
+static std::mutex g_partMutex;
+static HalPartition g_partitions[] = {
+    { { ESP_PARTITION_TYPE_DATA, 0x40, 0x290000, 0, "journal", false }, 0x110000, {}, {} },
+    { { ESP_PARTITION_TYPE_DATA, 0x41, 0x3A0000, 0, "trace", false }, 0x50000, {}, {} },
+};
+
+static HalPartition* findPartition(const char* label) {
+    for (HalPartition& p : g_partitions) {
+        if (strcmp(p.part.label, label) == 0) return &p;
+    }
+    return nullptr;
+}
+
+void halSetJournalSize(uint32_t bytes) { findPartition("journal")->size = bytes; }
+uint32_t halJournalErases() { return findPartition("journal")->erases; }
+void halSetTraceSize(uint32_t bytes) { findPartition("trace")->size = bytes; }
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+    (void)subtype;
+    if (type != ESP_PARTITION_TYPE_DATA || !label) return nullptr;
+    HalPartition* p = findPartition(label);
+    if (!p || p->size == 0) return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_partMutex);
+    if (p->flash.size() != p->size) {
+        p->flash.assign(p->size, 0xFF);
+        p->part.size = p->size;
+    }
+    return &p->part;
+}
+
+static HalPartition* partRange(const esp_partition_t* part, size_t offset, size_t size) {
+    for (HalPartition& p : g_partitions) {
+        if (part == &p.part) return offset + size <= p.flash.size() ? &p : nullptr;
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size) {
+    std::lock_guard<std::mutex> lock(g_partMutex);
+    HalPartition* p = partRange(part, offset, size);
+    if (!p) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, p->flash.data() + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(g_partMutex);
+        HalPartition* p = partRange(part, offset, size);
+        if (!p) return ESP_ERR_INVALID_SIZE;
+        // NOR: solo bits de 1 a 0
+        const uint8_t* b = static_cast<const uint8_t*>(src);
+        for (size_t i = 0; i < size; i++) p->flash[offset + i] &= b[i];
+    }
+    g_flashWrites++;
+    delayMicroseconds(100 + (unsigned)size * 3);        // Programar páginas
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size) {
+    HalPartition* p;
+    {
+        std::lock_guard<std::mutex> lock(g_partMutex);
+        p = partRange(part, offset, size);
+        if (!p || offset % 4096 || size % 4096) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        memset(p->flash.data() + offset, 0xFF, size);
+    }
+    p->erases += (uint32_t)(size / 4096);
+    delay(45 * (size / 4096));                          // ~45 ms por sector
+    return ESP_OK;
+}
+
+// ============================================================================
+// WIFI
+// ============================================================================
+static std::atomic<bool> g_wifiConnected{true};
+static std::atomic<bool> g_internet{true};
+
+void halSetWiFiConnected(bool connected) { g_wifiConnected = connected; }
+bool halWiFiConnected() { return g_wifiConnected; }
+void halSetInternet(bool online) { g_internet = online; }
+bool halInternet() { return g_internet; }
+
+wl_status_t WiFiClass::status() { return g_wifiConnected ? WL_CONNECTED : WL_DISCONNECTED; }
+int8_t WiFiClass::RSSI() { return g_wifiConnected ? -62 : 0; }
+IPAddress WiFiClass::localIP() {
+    return g_wifiConnected ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)wifiOff; (void)eraseAp;
+    g_wifiConnected = false;
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    g_wifiConnected = true;
+    return true;
+}
+
+// ============================================================================
+// HTTP CLIENT
+// ============================================================================
+static std::atomic<uint32_t> g_netLatencyMs{250};
+static std::mutex g_httpMutex;
+static HalHttpHandler g_httpHandler;
+static std::atomic<uint32_t> g_httpCount{0};
+static std::atomic<uint64_t> g_httpBytes{0};
+static FILE* g_httpLog = nullptr;
+static std::atomic<uint32_t> g_tlsCpuMs{300};
+static std::atomic<uint32_t> g_serverKeepAliveMs{60000};
+static std::atomic<uint32_t> g_tlsHandshakes{0};
+static std::atomic<uint32_t> g_dnsLookups{0};
+
+void halSetNetLatencyMs(uint32_t ms) { g_netLatencyMs = ms; }
+void halSetTlsHandshakeMs(uint32_t ms) { g_tlsCpuMs = ms; }
+void halSetServerKeepAliveMs(uint32_t ms) { g_serverKeepAliveMs = ms; }
+uint32_t halHttpRequestCount() { return g_httpCount; }
+uint64_t halHttpBytesSent() { return g_httpBytes; }
+uint32_t halTlsHandshakes() { return g_tlsHandshakes; }
+uint32_t halDnsLookups() { return g_dnsLookups; }
+
+// DNS: 1 RTT
+static bool halResolve(uint32_t timeoutMs) {
+    if (!g_wifiConnected) return false;
+    if (!g_internet) {
+        delay(timeoutMs);
+        return false;
+    }
+    g_dnsLookups++;
+    delay(g_netLatencyMs);
+    return true;
+}
+
+// TCP: 1 RTT; TLS: 2 RTT más el cómputo del handshake
+static bool halOpenConnection(bool tls, uint32_t timeoutMs) {
+    if (!g_wifiConnected) return false;
+    if (!g_internet) {
+        delay(timeoutMs);
+        return false;
+    }
+    delay(g_netLatencyMs);
+    if (tls) {
+        g_tlsHandshakes++;
+        delay(2 * g_netLatencyMs.load() + g_tlsCpuMs.load());
+    }
+    return true;
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+    (void)host;
+    if (!halResolve(HTTPCLIENT_DEFAULT_TCP_TIMEOUT)) return 0;
+    result = IPAddress(104, 18, 38, 10);
+    return 1;
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char* host,
+                              const char* rootCA, const char* cliCert, const char* cliKey) {
+    (void)ip; (void)port; (void)host; (void)rootCA; (void)cliCert; (void)cliKey;
+    open_ = halOpenConnection(true, (uint32_t)timeoutMs_);
+    halLastIoUs = halClockNowUs();
+    return open_ ? 1 : 0;
+}
+
+int WiFiClientSecure::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) return 0;
+    return connect(ip, port, host, nullptr, nullptr, nullptr);
+}
+
+uint8_t WiFiClientSecure::connected() {
+    if (open_ && (!g_wifiConnected ||
+                  halClockNowUs() - halLastIoUs >= (uint64_t)g_serverKeepAliveMs * 1000)) {
+        open_ = false;                                  // Cerrada por el servidor
+    }
+    return open_ ? 1 : 0;
+}
+
+void halSetHttpLog(FILE* log) { g_httpLog = log; }
+
+void halSetHttpHandler(HalHttpHandler handler) {
+    std::lock_guard<std::mutex> lock(g_httpMutex);
+    g_httpHandler = handler;
+}
+
+static int defaultHttpHandler(const HalHttpRequest& req, std::string& response) {
+    if (req.method == "GET") {
+        if (req.url.find("generate_204") != std::string::npos) return 204;
+        response = "[]";
+        return 200;
+    }
+    if (req.method == "POST") return 201;
+    if (req.method == "PATCH") return 204;
+    return 200;
+}
+
+int HTTPClient::sendRequest(const char* type, const String& payload) {
+    g_httpCount++;
+    g_httpBytes += payload.length() + headers_.length() + url_.length();
+    response_ = String();
+
+    if (!g_wifiConnected) return HTTPC_ERROR_CONNECTION_REFUSED;
+    if (!g_internet) {
+        delay(timeoutMs_);                              // DNS/TCP sin respuesta
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    if (client_) {
+        // Conexión del cliente: se abre solo si está cerrada
+        if (!client_->connected()) {
+            std::string url = url_.str();
+            size_t hostStart = url.find("://");
+            hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+            std::string host = url.substr(hostStart, url.find_first_of(":/", hostStart) - hostStart);
+            if (!client_->connect(host.c_str(), 443)) return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+    } else {
+        // Conexión nueva por petición
+        if (!halResolve(timeoutMs_) || !halOpenConnection(url_.startsWith("https"), timeoutMs_)) {
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+    }
+    delay(g_netLatencyMs);
+    if (client_) client_->halLastIoUs = halClockNowUs();
+
+    HalHttpRequest req{type, url_.str(), payload.str()};
+    std::string response;
+    int code;
+    {
+        std::lock_guard<std::mutex> lock(g_httpMutex);
+        code = g_httpHandler ? g_httpHandler(req, response) : defaultHttpHandler(req, response);
+        if (g_httpLog) {
+            fprintf(g_httpLog, "%s %s %s\n", type, req.url.c_str(), req.body.c_str());
+        }
+    }
+    response_ = String(response);
+    return code;
+}
+
+// ============================================================================
+// SERVIDOR WEB (esp_http_server.h)
+// ============================================================================
+struct PendingRequest {
+    std::string method;
+    std::string uri;
+    std::string body;
+    std::string headers;
+};
+
+// Estado de una petición (httpd_req_t::aux)
+struct HostHttpdReq {
+    std::string query;
+    std::string body;
+    size_t bodyRead = 0;
+    std::string headers;                // De la petición, "Nombre: valor\r\n..."
+    int fd = 0;
+    std::string status = "200 OK";
+    std::string type = "text/html";
+    std::string respHeaders;
+    bool chunked = false;
+    bool async = false;                 // Pasada a otra tarea: la termina esa
+    HalWebResponse resp{0, "", "", ""};
+};
+
+struct HostSession {
+    void* ctx;
+    httpd_free_ctx_fn_t freeCtx;
+};
+
+struct HostHttpd {
+    httpd_config_t config;
+    std::vector<httpd_uri_t> uris;
+    httpd_err_handler_func_t notFound = nullptr;
+    std::deque<std::pair<httpd_work_fn_t, void*>> work;
+};
+
+// No se llama a halSchedulerNotify() con g_webMutex tomado
+static std::mutex g_webMutex;
+static std::deque<PendingRequest> g_webQueue;
+static std::deque<HalWebResponse> g_webDone;
+static std::string g_webStreamOut;
+static std::map<int, HostSession> g_webSessions;    // Conexiones abiertas
+static int g_webNextFd = 100;
+
+void halWebInject(const std::string& method, const std::string& uri,
+                  const std::string& body, const std::string& headers) {
+    {
+        std::lock_guard<std::mutex> lock(g_webMutex);
+        g_webQueue.push_back({method, uri, body, headers});
+    }
+    halSchedulerNotify();
+}
+
+bool halWebLastResponse(HalWebResponse& out) {
+    std::lock_guard<std::mutex> lock(g_webMutex);
+    if (g_webDone.empty()) return false;
+    out = g_webDone.front();
+    g_webDone.pop_front();
+    return true;
+}
+
+std::string halWebStreamOutput() {
+    std::lock_guard<std::mutex> lock(g_webMutex);
+    std::string out;
+    out.swap(g_webStreamOut);
+    return out;
+}
+
+static int parseMethod(const std::string& m) {
+    if (m == "GET") return HTTP_GET;
+    if (m == "HEAD") return HTTP_HEAD;
+    if (m == "POST") return HTTP_POST;
+    if (m == "PUT") return HTTP_PUT;
+    if (m == "DELETE") return HTTP_DELETE;
+    if (m == "OPTIONS") return HTTP_OPTIONS;
+    return -1;
+}
+
+static HostHttpdReq* reqState(httpd_req_t* r) {
+    return static_cast<HostHttpdReq*>(r->aux);
+}
+
+static void webCloseSession(void* arg) {
+    int fd = (int)(intptr_t)arg;
+    HostSession sess{nullptr, nullptr};
+    {
+        std::lock_guard<std::mutex> lock(g_webMutex);
+        auto it = g_webSessions.find(fd);
+        if (it == g_webSessions.end()) return;
+        sess = it->second;
+        g_webSessions.erase(it);
+    }
+    if (sess.ctx && sess.freeCtx) sess.freeCtx(sess.ctx);
+}
+
+// Respuesta lista; la conexión sigue abierta si el handler dejó sess_ctx
+static void webFinish(httpd_req_t* r, esp_err_t err) {
+    HostHttpdReq* s = reqState(r);
+    bool keep = r->sess_ctx && err == ESP_OK;
+    {
+        std::lock_guard<std::mutex> lock(g_webMutex);
+        if (keep) g_webSessions[s->fd] = HostSession{r->sess_ctx, r->free_ctx};
+        else g_webSessions.erase(s->fd);
+        g_webDone.push_back(s->resp);
+    }
+    if (!keep && r->sess_ctx && r->free_ctx) r->free_ctx(r->sess_ctx);
+    delete s;
+    delete r;
+}
+
+static void webDispatch(HostHttpd* hd, const PendingRequest& p) {
+    httpd_req_t* r = new httpd_req_t();
+    HostHttpdReq* s = new HostHttpdReq();
+    size_t q = p.uri.find('?');
+    std::string path = p.uri.substr(0, q);
+    s->query = q == std::string::npos ? std::string() : p.uri.substr(q + 1);
+    s->body = p.body;
+    s->headers = p.headers;
+    {
+        std::lock_guard<std::mutex> lock(g_webMutex);
+        s->fd = g_webNextFd++;
+        g_webSessions[s->fd] = HostSession{nullptr, nullptr};
+    }
+    r->handle = hd;
+    r->method = parseMethod(p.method);
+    snprintf(r->uri, sizeof(r->uri), "%s", p.uri.c_str());
+    r->content_len = p.body.size();
+    r->aux = s;
+
+    // Como httpd_uri.c: la ruta sin la query; método distinto = 405
+    const httpd_uri_t* match = nullptr;
+    bool pathFound = false;
+    for (const httpd_uri_t& u : hd->uris) {
+        if (path != u.uri) continue;
+        pathFound = true;
+        if (u.method == r->method) {
+            match = &u;
+            break;
+        }
+    }
+    esp_err_t err;
+    if (match) {
+        r->user_ctx = match->user_ctx;
+        err = match->handler(r);
+    } else if (!pathFound && hd->notFound) {
+        err = hd->notFound(r, HTTPD_404_NOT_FOUND);
+    } else {
+        httpd_resp_set_status(r, pathFound ? "405 Method Not Allowed" : "404 Not Found");
+        err = httpd_resp_send(r, nullptr, 0);
+    }
+
+    if (s->async) {
+        delete s;
+        delete r;
+    } else {
+        webFinish(r, err);
+    }
+}
+
+static void httpdTask(void* param) {
+    HostHttpd* hd = static_cast<HostHttpd*>(param);
+    for (;;) {
+        halSchedulerWait([hd] {
+            std::lock_guard<std::mutex> lock(g_webMutex);
+            return !g_webQueue.empty() || !hd->work.empty();
+        }, UINT64_MAX);
+
+        // Primero el trabajo encolado por otras tareas (httpd_queue_work)
+        for (;;) {
+            std::pair<httpd_work_fn_t, void*> w;
+            {
+                std::lock_guard<std::mutex> lock(g_webMutex);
+                if (hd->work.empty()) break;
+                w = hd->work.front();
+                hd->work.pop_front();
+            }
+            w.first(w.second);
+        }
+
+        PendingRequest p;
+        {
+            std::lock_guard<std::mutex> lock(g_webMutex);
+            if (g_webQueue.empty()) continue;
+            p = g_webQueue.front();
+            g_webQueue.pop_front();
+        }
+        webDispatch(hd, p);
+    }
+}
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+    HostHttpd* hd = new HostHttpd();
+    hd->config = *config;
+    xTaskCreatePinnedToCore(httpdTask, "httpd", (uint32_t)config->stack_size, hd,
+                            config->task_priority, nullptr, config->core_id);
+    *handle = hd;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler) {
+    HostHttpd* hd = static_cast<HostHttpd*>(handle);
+    if (hd->uris.size() >= hd->config.max_uri_handlers) return ESP_ERR_NO_MEM;
+    hd->uris.push_back(*uri_handler);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_err_handler(httpd_handle_t handle, httpd_err_code_t error,
+                                     httpd_err_handler_func_t handler) {
+    if (error == HTTPD_404_NOT_FOUND) static_cast<HostHttpd*>(handle)->notFound = handler;
+    return ESP_OK;
+}
+
+// Copia con truncado, como httpd: ESP_ERR_HTTPD_RESULT_TRUNC si no entra
+static esp_err_t copyResult(const std::string& value, char* out, size_t size) {
+    if (size == 0) return ESP_ERR_INVALID_ARG;
+    size_t n = std::min(value.size(), size - 1);
+    memcpy(out, value.data(), n);
+    out[n] = '\0';
+    return n < value.size() ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len) {
+    const std::string& query = reqState(r)->query;
+    if (query.empty()) return ESP_ERR_NOT_FOUND;
+    return copyResult(query, buf, buf_len);
+}
+
+// Sin decodificar %XX ni '+' (igual que httpd)
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size) {
+    std::string query(qry);
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t amp = query.find('&', pos);
+        std::string pair = query.substr(pos, amp == std::string::npos ? std::string::npos : amp - pos);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == key) {
+            return copyResult(eq == std::string::npos ? std::string() : pair.substr(eq + 1), val, val_size);
+        }
+        if (amp == std::string::npos) break;
+        pos = amp + 1;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static bool findHeader(httpd_req_t* r, const char* field, std::string& value) {
+    const std::string& h = reqState(r)->headers;
+    size_t pos = 0;
+    while (pos < h.size()) {
+        size_t eol = h.find("\r\n", pos);
+        std::string line = h.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos && strcasecmp(line.substr(0, colon).c_str(), field) == 0) {
+            size_t v = line.find_first_not_of(' ', colon + 1);
+            value = v == std::string::npos ? std::string() : line.substr(v);
+            return true;
+        }
+        if (eol == std::string::npos) break;
+        pos = eol + 2;
+    }
+    return false;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field) {
+    std::string value;
+    return findHeader(r, field, value) ? value.size() : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val, size_t val_size) {
+    std::string value;
+    if (!findHeader(r, field, value)) return ESP_ERR_NOT_FOUND;
+    return copyResult(value, val, val_size);
+}
+
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len) {
+    HostHttpdReq* s = reqState(r);
+    size_t n = std::min(buf_len, s->body.size() - s->bodyRead);
+    memcpy(buf, s->body.data() + s->bodyRead, n);
+    s->bodyRead += n;
+    return (int)n;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status) {
+    reqState(r)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type) {
+    reqState(r)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value) {
+    reqState(r)->respHeaders += std::string(field) + ": " + value + "\r\n";
+    return ESP_OK;
+}
+
+static void respStart(HostHttpdReq* s) {
+    s->resp.code = atoi(s->status.c_str());
+    s->resp.contentType = s->type;
+    s->resp.headers = s->respHeaders;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    HostHttpdReq* s = reqState(r);
+    if (buf_len == HTTPD_RESP_USE_STRLEN) buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    respStart(s);
+    s->resp.body.assign(buf ? buf : "", buf ? (size_t)buf_len : 0);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    HostHttpdReq* s = reqState(r);
+    if (!s->chunked) {
+        s->chunked = true;
+        respStart(s);
+        s->resp.headers += "Transfer-Encoding: chunked\r\n";
+    }
+    if (buf_len == HTTPD_RESP_USE_STRLEN) buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    if (buf && buf_len > 0) s->resp.body.append(buf, (size_t)buf_len);
+    return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t* r) {
+    return reqState(r)->fd;
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char* buf, size_t buf_len, int flags) {
+    (void)hd;
+    (void)flags;
+    std::lock_guard<std::mutex> lock(g_webMutex);
+    if (g_webSessions.find(sockfd) == g_webSessions.end()) return HTTPD_SOCK_ERR_INVALID;
+    g_webStreamOut.append(buf, buf_len);
+    return (int)buf_len;
+}
+
+// Como en httpd: el cierre lo hace la tarea del servidor
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+    return httpd_queue_work(handle, webCloseSession, (void*)(intptr_t)sockfd);
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg) {
+    {
+        std::lock_guard<std::mutex> lock(g_webMutex);
+        static_cast<HostHttpd*>(handle)->work.push_back({work, arg});
+    }
+    halSchedulerNotify();
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out) {
+    HostHttpdReq* s = reqState(r);
+    httpd_req_t* copy = new httpd_req_t(*r);
+    copy->aux = new HostHttpdReq(*s);
+    s->async = true;
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r) {
+    webFinish(r, ESP_OK);
+    return ESP_OK;
+}
+
+// Cliente TCP saliente: lo escrito se descarta
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    (void)buf;
+    return size;
+}
@@ -0,0 +1,147 @@
+/*
+ * ============================================================================
+ * HAL.H - CONTROL DEL HARDWARE SIMULADO (solo build host)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * API que usa el ejecutable host (y las herramientas de benchmark/replay)
+ * para manejar el "mundo" que ve el firmware:
+ * - Reloj virtual: tiempo real escalado (x1, x1000...) o determinístico
+ * - Entradas: pines digitales, ADC, sondas DS18B20, DHT22
+ * - Red: WiFi, internet, latencia y códigos HTTP simulados
+ * - Contadores de uso (peticiones HTTP, tráfico 1-Wire, escrituras flash)
+ *
+ * El firmware NUNCA incluye este archivo: solo usa la API Arduino.
+ *
+ * ============================================================================
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+
+// ============================================================================
+// RELOJ VIRTUAL
+// ============================================================================
+// speed > 0 : el tiempo virtual avanza speed veces más rápido que el real.
+//             delay(ms) duerme ms/speed de tiempo real.
+// speed == 0: modo determinístico. El tiempo solo avanza con delay(),
+//             delayMicroseconds() y el costo simulado de E/S.
+void halClockSetSpeed(double speed);
+double halClockGetSpeed();
+void halClockAdvanceUs(uint64_t us);     // Avanzar tiempo virtual sin dormir
+uint64_t halClockNowUs();                // Tiempo virtual en µs desde el arranque
+uint64_t halRealNowNs();                 // Reloj monotónico real (ns)
+
+// Planificador (lo usan el shim FreeRTOS y los hilos del host).
+// En modo determinístico los hilos secundarios avanzan en paso con el
+// hilo principal: cuando loop() avanza el reloj, las tareas cuyo plazo
+// venció corren hasta volver a bloquearse antes de que loop() siga.
+// Espera hasta que ready() sea true o el reloj virtual llegue a deadlineUs;
+// devuelve ready(). Quien cambie el estado observado debe llamar a
+// halSchedulerNotify().
+bool halSchedulerWait(const std::function<bool()>& ready, uint64_t deadlineUs);
+void halSchedulerNotify();
+bool halIsMainThread();
+void halSchedulerThreadStart();              // Antes de lanzar un hilo secundario
+void halSchedulerThreadExit();               // Al terminar ese hilo
+
+// ============================================================================
+// GPIO / ADC
+// ============================================================================
+void halSetDigitalInput(uint8_t pin, int level);
+int halGetDigitalOutput(uint8_t pin);
+void halSetAnalogInput(uint8_t pin, uint16_t value);
+
+// ============================================================================
+// BUS 1-WIRE / DS18B20
+// ============================================================================
+#define HAL_MAX_PROBES 8
+
+void halSetProbeCount(int count);
+int halGetProbeCount();
+void halSetProbeTemp(int index, float tempC);
+void halSetProbeConnected(int index, bool connected);
+void halSetProbeCrcErrorRate(double rate);   // 0.0-1.0, lecturas corruptas
+uint32_t halOneWireTransactions();            // Transacciones de bus acumuladas
+uint32_t halProbeEepromWrites();              // Copias scratchpad -> EEPROM
+
+// ============================================================================
+// DHT22
+// ============================================================================
+void halSetDHT(float humidity, float tempC);  // NAN = sensor ausente
+
+// ============================================================================
+// RED
+// ============================================================================
+struct HalHttpRequest {
+    std::string method;
+    std::string url;
+    std::string body;
+};
+
+// Devuelve el código HTTP (o <0 en error de red) y completa la respuesta
+typedef std::function<int(const HalHttpRequest&, std::string& response)> HalHttpHandler;
+
+void halSetWiFiConnected(bool connected);
+bool halWiFiConnected();
+void halSetInternet(bool online);
+bool halInternet();
+void halSetNetLatencyMs(uint32_t ms);        // Costo de cada petición HTTP (1 RTT)
+void halSetTlsHandshakeMs(uint32_t ms);      // Cómputo del handshake TLS (más 2 RTT)
+void halSetServerKeepAliveMs(uint32_t ms);   // El servidor cierra conexiones ociosas
+void halSetHttpHandler(HalHttpHandler handler);
+void halSetHttpLog(FILE* log);               // "MÉTODO url cuerpo" por petición
+uint32_t halHttpRequestCount();
+uint64_t halHttpBytesSent();
+uint32_t halTlsHandshakes();
+uint32_t halDnsLookups();
+
+// ============================================================================
+// PARTICIONES "journal" Y "trace" (esp_partition.h)
+// ============================================================================
+void halSetJournalSize(uint32_t bytes);      // 0 = sin partición (antes de setup)
+uint32_t halJournalErases();
+void halSetTraceSize(uint32_t bytes);        // 0 = sin partición (antes de setup)
+
+// ============================================================================
+// SERVIDOR WEB (peticiones inyectadas, ver esp_http_server.h)
+// ============================================================================
+struct HalWebResponse {
+    int code;
+    std::string contentType;
+    std::string body;
+    std::string headers;                      // "Nombre: valor\r\n..."
+};
+
+// headers: "Nombre: valor\r\n..." (p.ej. If-None-Match)
+void halWebInject(const std::string& method, const std::string& uri,
+                  const std::string& body = "", const std::string& headers = "");
+// Respuestas terminadas, en orden
+bool halWebLastResponse(HalWebResponse& out);
+// Lo escrito en conexiones que siguen abiertas (/api/stream); se vacía al leerlo
+std::string halWebStreamOutput();
+
+// ============================================================================
+// FLASH (Preferences)
+// ============================================================================
+uint32_t halFlashWrites();                    // put*() acumulados
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+void halSerialSetEcho(bool echo);             // false = descartar salida
+void halSerialInject(const std::string& input);
+uint64_t halSerialBytesWritten();
+
+// ============================================================================
+// REINICIO
+// ============================================================================
+// ESP.restart() llama a este hook; por defecto termina el proceso.
+void halSetRestartHook(std::function<void()> hook);
+
+#endif // HOST_HAL_H
@@ -0,0 +1,269 @@
+/*
+ * ============================================================================
+ * HOST_MAIN.CPP - EJECUTABLE NATIVO DEL FIRMWARE v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Ejecuta setup() y loop() de firmware_v2.ino sin modificar, sobre la HAL
+ * de hal/, con reloj virtual acelerado.
+ *
+ * USO:
+ *   reefer_host [opciones]
+ *
+ *   --speed N        Factor de aceleración del reloj (default 1000)
+ *                    0 = determinístico (lo más rápido posible)
+ *   --hours H        Tiempo virtual a simular (default 24)
+ *   --seconds S      Ídem en segundos
+ *   --probes N       Sondas DS18B20 conectadas (default 1)
+ *   --temp T         Temperatura de las sondas en °C (default -20)
+ *   --ramp R         Subida de temperatura de las sondas en °C/min (default 0)
+ *   --crc-errors R   Fracción de lecturas DS18B20 corruptas (0.0-1.0)
+ *   --latency MS     Latencia de cada petición HTTP (default 250)
+ *   --tls-ms MS      Cómputo de cada handshake TLS (default 300)
+ *   --http-log FILE  Registrar cada petición HTTP (método, URL, cuerpo)
+ *   --offline        Sin internet (WiFi conectado)
+ *   --outage S,D     Cortar internet a los S segundos durante D segundos
+ *   --no-journal     Sin partición del diario (envío directo por la cola)
+ *   --no-trace       Sin partición del grabador de entradas
+ *   --trace-out FILE Al final, guardar la traza grabada (como GET /api/trace)
+ *   --serial         Mostrar la salida Serial del firmware
+ *   --perf           Imprimir el reporte del perfilador de loop() al final
+ *   --get URI        Al final, pedir URI al servidor web e imprimir la
+ *                    respuesta (repetible)
+ *   --post URI BODY  Ídem con POST y cuerpo BODY (en orden con --get)
+ *   --header H       Encabezado "Nombre: valor" para las peticiones web
+ *   --stream         Suscribirse a /api/stream al arrancar e imprimir los
+ *                    eventos recibidos al final
+ *
+ * Al terminar imprime un resumen con el costo de loop() y el uso de E/S.
+ *
+ * ============================================================================
+ */
+
+#include "../firmware_v2.ino"
+
+#include "hal.h"
+
+#include <vector>
+
+// ============================================================================
+// OPCIONES DE LÍNEA DE COMANDOS
+// ============================================================================
+struct HostOptions {
+    double speed = 1000.0;
+    double seconds = 24 * 3600.0;
+    int probes = 1;
+    float temp = -20.0f;
+    float ramp = 0.0f;
+    double crcErrors = 0.0;
+    uint32_t latencyMs = 250;
+    uint32_t tlsMs = 300;
+    const char* httpLog = nullptr;
+    bool offline = false;
+    double outageStart = -1.0;
+    double outageSec = 0.0;
+    bool noJournal = false;
+    bool noTrace = false;
+    const char* traceOut = nullptr;
+    bool serial = false;
+    bool perf = false;
+    bool stream = false;
+    struct WebRequest {
+        const char* method;
+        const char* uri;
+        const char* body;
+    };
+    std::vector<WebRequest> requests;
+    std::string headers;
+};
+
+static void printUsage(const char* prog) {
+    fprintf(stderr,
+            "Uso: %s [--speed N] [--hours H | --seconds S] [--probes N] [--temp T]\n"
+            "          [--ramp R] [--crc-errors R] [--latency MS] [--tls-ms MS]\n"
+            "          [--http-log FILE] [--offline] [--outage S,D] [--no-journal]\n"
+            "          [--no-trace] [--trace-out FILE]\n"
+            "          [--serial] [--perf] [--get URI]... [--post URI BODY]...\n"
+            "          [--header H]... [--stream]\n", prog);
+}
+
+static bool parseArgs(int argc, char** argv, HostOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        String a(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if (a == "--speed" && hasValue) opt.speed = atof(argv[++i]);
+        else if (a == "--hours" && hasValue) opt.seconds = atof(argv[++i]) * 3600.0;
+        else if (a == "--seconds" && hasValue) opt.seconds = atof(argv[++i]);
+        else if (a == "--probes" && hasValue) opt.probes = atoi(argv[++i]);
+        else if (a == "--temp" && hasValue) opt.temp = (float)atof(argv[++i]);
+        else if (a == "--ramp" && hasValue) opt.ramp = (float)atof(argv[++i]);
+        else if (a == "--crc-errors" && hasValue) opt.crcErrors = atof(argv[++i]);
+        else if (a == "--latency" && hasValue) opt.latencyMs = (uint32_t)atol(argv[++i]);
+        else if (a == "--tls-ms" && hasValue) opt.tlsMs = (uint32_t)atol(argv[++i]);
+        else if (a == "--http-log" && hasValue) opt.httpLog = argv[++i];
+        else if (a == "--offline") opt.offline = true;
+        else if (a == "--outage" && hasValue) {
+            if (sscanf(argv[++i], "%lf,%lf", &opt.outageStart, &opt.outageSec) != 2) return false;
+        }
+        else if (a == "--no-journal") opt.noJournal = true;
+        else if (a == "--no-trace") opt.noTrace = true;
+        else if (a == "--trace-out" && hasValue) opt.traceOut = argv[++i];
+        else if (a == "--serial") opt.serial = true;
+        else if (a == "--perf") opt.perf = true;
+        else if (a == "--stream") opt.stream = true;
+        else if (a == "--get" && hasValue) {
+            opt.requests.push_back({"GET", argv[i + 1], ""});
+            i++;
+        }
+        else if (a == "--post" && i + 2 < argc) {
+            opt.requests.push_back({"POST", argv[i + 1], argv[i + 2]});
+            i += 2;
+        }
+        else if (a == "--header" && hasValue) opt.headers += std::string(argv[++i]) + "\r\n";
+        else return false;
+    }
+    return true;
+}
+
+// Petición al servidor web; loop() sigue corriendo (el servidor atiende y
+// loop() aplica los cambios) hasta que hay respuesta
+static bool webRequest(const char* method, const char* uri, const char* body,
+                       const std::string& headers, HalWebResponse& resp) {
+    halWebInject(method, uri, body, headers);
+    for (int i = 0; i < 1000; i++) {
+        loop();
+        if (halWebLastResponse(resp)) return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char** argv) {
+    HostOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    halClockSetSpeed(opt.speed);
+    halSerialSetEcho(opt.serial);
+    halSetProbeCount(opt.probes);
+    for (int i = 0; i < opt.probes; i++) halSetProbeTemp(i, opt.temp);
+    halSetProbeCrcErrorRate(opt.crcErrors);
+    halSetNetLatencyMs(opt.latencyMs);
+    halSetTlsHandshakeMs(opt.tlsMs);
+    halSetInternet(!opt.offline);
+    if (opt.noJournal) halSetJournalSize(0);
+    if (opt.noTrace) halSetTraceSize(0);
+    FILE* httpLog = opt.httpLog ? fopen(opt.httpLog, "w") : nullptr;
+    halSetHttpLog(httpLog);
+
+    uint64_t realStart = halRealNowNs();
+
+    setup();
+
+    if (opt.stream) {
+        HalWebResponse resp;
+        webRequest("GET", "/api/stream", "", opt.headers, resp);
+    }
+
+    uint64_t endUs = halClockNowUs() + (uint64_t)(opt.seconds * 1e6);
+    uint64_t loops = 0;
+    uint64_t loopNsTotal = 0;
+    uint64_t loopNsMax = 0;
+
+    uint64_t rampStartUs = halClockNowUs();
+    uint64_t outageFromUs = (uint64_t)(opt.outageStart * 1e6);
+    uint64_t outageToUs = outageFromUs + (uint64_t)(opt.outageSec * 1e6);
+    bool inOutage = false;
+    while (halClockNowUs() < endUs) {
+        if (opt.outageStart >= 0 && !opt.offline) {
+            uint64_t nowUs = halClockNowUs();
+            bool cut = nowUs >= outageFromUs && nowUs < outageToUs;
+            if (cut != inOutage) {
+                inOutage = cut;
+                halSetInternet(!cut);
+            }
+        }
+        if (opt.ramp != 0.0f) {
+            float t = opt.temp + opt.ramp * (float)(halClockNowUs() - rampStartUs) / 60e6f;
+            for (int i = 0; i < opt.probes; i++) halSetProbeTemp(i, t);
+        }
+        uint64_t t0 = halRealNowNs();
+        loop();
+        uint64_t dt = halRealNowNs() - t0;
+        loopNsTotal += dt;
+        if (dt > loopNsMax) loopNsMax = dt;
+        loops++;
+    }
+
+    if (opt.perf) {
+        halSerialSetEcho(true);
+        printPerfReport();
+    }
+
+    if (opt.stream) {
+        printf("STREAM /api/stream\n%s", halWebStreamOutput().c_str());
+    }
+
+    for (const auto& req : opt.requests) {
+        HalWebResponse resp;
+        if (webRequest(req.method, req.uri, req.body, opt.headers, resp)) {
+            printf("%s %s -> %d %s\n%s%s\n", req.method, req.uri, resp.code,
+                   resp.contentType.c_str(), resp.headers.c_str(), resp.body.c_str());
+        }
+    }
+
+    if (opt.traceOut) {
+        RecorderView view;
+        FILE* out = fopen(opt.traceOut, "wb");
+        if (out && recorderSnapshot(view)) {
+            recorderExport(view, [out](const uint8_t* data, size_t len) { fwrite(data, 1, len, out); });
+        }
+        if (out) fclose(out);
+    }
+
+    double realSec = (double)(halRealNowNs() - realStart) / 1e9;
+    double virtualSec = (double)halClockNowUs() / 1e6;
+
+    fflush(stdout);
+    fprintf(stderr, "\n===== RESUMEN SIMULACIÓN HOST =====\n");
+    fprintf(stderr, "Tiempo virtual:      %.1f s (%.2f h)\n", virtualSec, virtualSec / 3600.0);
+    fprintf(stderr, "Tiempo real:         %.2f s (x%.0f)\n", realSec,
+            realSec > 0 ? virtualSec / realSec : 0.0);
+    fprintf(stderr, "Iteraciones loop():  %llu\n", (unsigned long long)loops);
+    fprintf(stderr, "loop() real prom:    %.2f us\n",
+            loops ? (double)loopNsTotal / loops / 1000.0 : 0.0);
+    fprintf(stderr, "loop() real máx:     %.2f us\n", (double)loopNsMax / 1000.0);
+    fprintf(stderr, "Peticiones HTTP:     %u (%llu bytes)\n", halHttpRequestCount(),
+            (unsigned long long)halHttpBytesSent());
+    fprintf(stderr, "Handshakes TLS:      %u (DNS %u)\n", halTlsHandshakes(), halDnsLookups());
+    uint32_t uplinkDone = uplinkStats.sent + uplinkStats.failed;
+    fprintf(stderr, "Latencia uplink:     %llu ms prom, %lu ms máx\n",
+            uplinkDone ? (unsigned long long)(uplinkStats.totalLatencyMs / uplinkDone) : 0ULL,
+            uplinkStats.maxLatencyMs);
+    fprintf(stderr, "Transacciones 1-Wire:%u\n", halOneWireTransactions());
+    fprintf(stderr, "Ciclos DS18B20:      %u (período %lu ms)\n", tempEngine.cycles,
+            tempEngine.periodMs);
+    fprintf(stderr, "Escrituras flash:    %u\n", halFlashWrites());
+    if (journalReady()) {
+        fprintf(stderr, "Diario:              %u guardados, %u subidos, %u pendientes, %u pisados\n",
+                journal.appended, journal.uploaded, journalPending(), journal.overwritten);
+        fprintf(stderr, "Borrados de sector:  %u\n", halJournalErases());
+    }
+    if (recorder.ready) {
+        fprintf(stderr, "Traza:               %u registros, %u bytes, %u sectores\n",
+                recorder.records, recorder.bytes + recorder.used, recorder.sectorsOpened);
+    }
+    fprintf(stderr, "Salida Serial:       %llu bytes\n",
+            (unsigned long long)halSerialBytesWritten());
+    fprintf(stderr, "Estado final:        %s\n", state.stateName);
+    fprintf(stderr, "Alertas totales:     %d\n", state.totalAlerts);
+    if (httpLog) {
+        halSetHttpLog(nullptr);
+        fclose(httpLog);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * ============================================================================
+ * TLM2JSON.CPP - TRANSCODIFICADOR DE REGISTROS BINARIOS A JSON
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Lee registros de telemetry.h (los mismos que arma el firmware) y escribe
+ * una fila JSON por línea, con las columnas de Supabase.
+ *
+ * USO:
+ *   tlm2json [--device ID] [--hex] [ARCHIVO]
+ *
+ *   --device ID      device_id de las filas (default DEVICE_ID de config.h)
+ *   --hex            Entrada en hexadecimal, un registro por línea
+ *                    (capturas de Serial o del módem GPRS)
+ *   ARCHIVO          Flujo binario de registros concatenados (default stdin)
+ *
+ * Los registros con hueco de secuencia en un flujo delta se marcan con
+ * "time_valid": false.
+ *
+ * ============================================================================
+ */
+
+#include "../config.h"
+#include "../telemetry.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static int hexValue(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static void readAll(FILE* in, bool hex, std::vector<uint8_t>& out) {
+    if (!hex) {
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0) out.insert(out.end(), buf, buf + n);
+        return;
+    }
+    int hi = -1;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        int v = hexValue(c);
+        if (v < 0) continue;                    // Espacios, saltos, separadores
+        if (hi < 0) hi = v;
+        else { out.push_back((uint8_t)(hi << 4 | v)); hi = -1; }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* deviceId = DEVICE_ID;
+    const char* path = nullptr;
+    bool hex = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        if (a == "--device" && i + 1 < argc) deviceId = argv[++i];
+        else if (a == "--hex") hex = true;
+        else if (a[0] != '-' && !path) path = argv[i];
+        else {
+            fprintf(stderr, "Uso: %s [--device ID] [--hex] [ARCHIVO]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* in = path ? fopen(path, "rb") : stdin;
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    readAll(in, hex, data);
+    if (path) fclose(in);
+
+    TlmDecoder dec;
+    tlmDecoderInit(dec);
+    TlmRecord rec;
+    char json[1024];
+    size_t pos = 0;
+    unsigned records = 0;
+
+    while (pos < data.size()) {
+        int n = tlmDecode(dec, data.data() + pos, data.size() - pos, rec);
+        if (n == 0) {
+            fprintf(stderr, "Registro truncado en el byte %zu\n", pos);
+            return 1;
+        }
+        if (n < 0) {
+            fprintf(stderr, "Registro inválido en el byte %zu (v%u tipo %u)\n",
+                    pos, data[pos] >> 4, data[pos] & 0x0F);
+            return 1;
+        }
+        if (tlmRecordToJson(rec, deviceId, nullptr, json, sizeof(json)) < 0) {
+            fprintf(stderr, "JSON demasiado grande en el byte %zu\n", pos);
+            return 1;
+        }
+        if (!rec.timeValid) {
+            // Insertar la marca antes de la llave final
+            size_t l = strlen(json);
+            snprintf(json + l - 1, sizeof(json) - l + 1, ",\"time_valid\":false}");
+        }
+        printf("%s\n", json);
+        pos += n;
+        records++;
+    }
+
+    fprintf(stderr, "%u registros, %zu bytes\n", records, data.size());
+    return 0;
+}
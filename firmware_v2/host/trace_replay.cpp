@@ -0,0 +1,826 @@
+/*
+ * ============================================================================
+ * TRACE_REPLAY.CPP - REPRODUCCIÓN ACELERADA DE TRAZAS DE ENTRADAS
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Reproduce una traza de recorder.h (GET /api/trace o reefer_host
+ * --trace-out) por sensors.h, alerts.h y state_machine.h sin modificar, con
+ * uno o más juegos de umbrales, y escribe cada alerta, cambio de estado y
+ * notificación que habrían producido.
+ *
+ * Las lecturas de la traza se cargan en la HAL (sondas y pines) en su
+ * instante y el reloj virtual avanza de a --tick-ms ejecutando lo que hace
+ * loop() con esos módulos. Cada juego corre en un proceso aparte (fork),
+ * con el estado del firmware desde cero.
+ *
+ * USO:
+ *   trace_replay [opciones] TRAZA
+ *
+ *   --set K=V[,K=V]  Juego de umbrales (repetible). Claves: tempCritical,
+ *                    tempMax, alertDelaySec, doorOpenMaxSec,
+ *                    defrostCooldownSec, defrostMaxDurationSec,
+ *                    configApplyTimeSec, trendHorizonMin. Sin --set: la
+ *                    config grabada
+ *   --sets FILE      Un juego por línea (# = comentario)
+ *   --rules FILE     Reglas de alerta para todos los juegos, en el mismo
+ *                    JSON que POST /api/config ("rules", "interior_probes").
+ *                    Sin --rules: las grabadas (las de fábrica de rules.h
+ *                    en una traza versión 1, que no las tiene)
+ *   --events         Imprimir cada evento de cada juego
+ *   --tick-ms N      Paso de loop() simulado (default 250)
+ *   -j N             Juegos en paralelo (default: núcleos)
+ *   --synth DÍAS     En lugar de reproducir, escribir en TRAZA una traza
+ *                    sintética (defrost cada 6 h, puertas, fallas de frío)
+ *
+ * Al final imprime una tabla con una fila por juego.
+ *
+ * ============================================================================
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <DHT.h>
+
+#include "hal.h"
+#include "../config.h"
+#include "../types.h"
+#include "../telemetry.h"
+
+#include <stdarg.h>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+SystemState state;
+SensorData sensorData;
+Config config;
+
+OneWire oneWire(PIN_ONEWIRE);
+DallasTemperature ds18b20(&oneWire);
+DHT dht(PIN_DHT22, DHT22);
+
+// ============================================================================
+// SALIDAS DEL FIRMWARE (lo que se habría notificado)
+// ============================================================================
+struct ReplayStats {
+    uint32_t alerts;
+    uint32_t doorAlerts;
+    uint32_t telegram;
+    uint32_t supabase;
+    uint32_t defrosts;
+    uint64_t stateMs[STATE_COUNT];
+    int64_t firstAlertMs;               // -1 = ninguna
+};
+
+static FILE* g_events = nullptr;        // nullptr = sin --events
+static ReplayStats g_stats;
+static uint64_t g_startUs = 0;          // Reloj virtual al empezar la traza
+static uint64_t g_stateSinceUs = 0;
+static bool g_lastAlert = false;
+static Config g_rules;                  // Reglas de --rules
+static bool g_haveRules = false;
+
+static uint64_t replayMs() {
+    return (halClockNowUs() - g_startUs) / 1000;
+}
+
+static void event(const char* fmt, ...) {
+    if (!g_events) return;
+    uint64_t s = replayMs() / 1000;
+    fprintf(g_events, "  %3llud %02llu:%02llu:%02llu  ", (unsigned long long)(s / 86400),
+            (unsigned long long)(s / 3600 % 24), (unsigned long long)(s / 60 % 60),
+            (unsigned long long)(s % 60));
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(g_events, fmt, ap);
+    va_end(ap);
+    fputc('\n', g_events);
+}
+
+// Mensajes de varias líneas (Telegram) en una
+static std::string oneLine(const String& s) {
+    std::string out;
+    for (const char* p = s.c_str(); *p; p++) {
+        if (*p == '\n') {
+            if (!out.empty() && out.back() != ' ') out += " | ";
+        } else if (*p != '*') {
+            out += *p;
+        }
+    }
+    return out;
+}
+
+void setRelay(int relayIndex, bool on) {
+    sensorData.relay[relayIndex].state = on;
+    event("RELÉ %d %s", relayIndex + 1, on ? "ON" : "OFF");
+}
+
+void setRelay(bool on) { setRelay(0, on); }
+
+void sendTelegramAlert(String message) {
+    g_stats.telegram++;
+    event("TELEGRAM  %s", oneLine(message).c_str());
+}
+
+// Entregas de la bandeja de salida (outbox.h): siempre 2xx
+int telegramDeliverAlert(const AlertEvent& e) {
+    g_stats.telegram++;
+    if (e.type == tlmLookup(TLM_ALERT_TYPES, TLM_COUNT(TLM_ALERT_TYPES), "door")) g_stats.doorAlerts++;
+    event("TELEGRAM  %s%s", oneLine(e.message).c_str(),
+          e.repeats > 0 ? (" (x" + std::to_string(e.repeats + 1) + ")").c_str() : "");
+    return 200;
+}
+
+int supabaseDeliverAlert(const AlertEvent& e) {
+    g_stats.supabase++;
+    event("SUPABASE  alerta %s/%s: %s", TLM_ALERT_TYPES[e.type], TLM_SEVERITIES[e.severity],
+          oneLine(e.message).c_str());
+    return 200;
+}
+
+void supabaseSendDefrostStart(float tempAtStart, const char* triggeredBy) {
+    g_stats.supabase++;
+    event("SUPABASE  defrost inicio (%s, %.1f°C)", triggeredBy, tempAtStart);
+}
+
+void supabaseSendDefrostEnd(float tempAtEnd, unsigned long durationMin) {
+    g_stats.supabase++;
+    event("SUPABASE  defrost fin (%lu min, %.1f°C)", durationMin, tempAtEnd);
+}
+
+void streamNotifyState() {
+    uint64_t now = halClockNowUs();
+    g_stats.stateMs[state.previousState] += (now - g_stateSinceUs) / 1000;
+    g_stateSinceUs = now;
+    if (state.currentState == STATE_DEFROST) g_stats.defrosts++;
+    event("ESTADO    %s -> %s", getStateName(state.previousState), state.stateName);
+}
+
+void streamNotifyAlert() {
+    if (state.alertActive && !g_lastAlert) {
+        g_stats.alerts++;
+        if (g_stats.firstAlertMs < 0) g_stats.firstAlertMs = (int64_t)replayMs();
+        event("ALERTA    %s", state.alertMessage.c_str());
+    } else if (!state.alertActive && g_lastAlert) {
+        event("ALERTA    resuelta");
+    }
+    g_lastAlert = state.alertActive;
+}
+
+void streamNotifyDoor(int door) {
+    event("PUERTA    %s %s", sensorData.door[door].name,
+          sensorData.door[door].isOpen ? "abierta" : "cerrada");
+}
+
+void streamNotifySample() {}
+
+// Sin hora: las alertas se fechan por su millis()
+uint32_t deviceUnixTime() { return 0; }
+
+// La reproducción no vuelve a grabar
+void recorderProbe(int, float) {}
+void recorderProbeFail(int) {}
+void recorderInput(uint8_t, bool) {}
+
+#include "../state_machine.h"
+#include "../sensors.h"
+#include "../alerts.h"
+#include "../trace.h"
+
+// ============================================================================
+// LECTURA DE LA TRAZA
+// ============================================================================
+struct ReplayRecord {
+    TraceRecord rec;
+    uint64_t atMs;                      // Desde el inicio de la traza
+    bool boot;                          // Clave de un arranque nuevo
+};
+
+// Sectores de TRACE_SECTOR_SIZE, del más viejo al actual
+static bool loadTrace(const char* path, std::vector<ReplayRecord>& out, uint32_t& firstUnix) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "No se puede abrir %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    firstUnix = 0;
+    uint64_t baseMs = 0;                // Inicio del arranque actual en la línea de tiempo
+    uint32_t bootKeyMs = 0;             // Uptime de la clave de ese arranque
+    uint32_t bootUnix = 0;
+    uint64_t lastAtMs = 0;
+    int lastBoot = -1;
+    unsigned skipped = 0;
+    unsigned noRules = 0;               // Sectores versión 1
+
+    for (size_t off = 0; off < data.size(); off += TRACE_SECTOR_SIZE) {
+        size_t len = std::min((size_t)TRACE_SECTOR_SIZE, data.size() - off);
+        uint16_t boot;
+        uint32_t number;
+        uint8_t version;
+        if (len < TRACE_SECTOR_HDR || !traceReadSectorHdr(&data[off], boot, number, version)) {
+            skipped++;
+            continue;
+        }
+        if (version == TRACE_VERSION_NO_RULES) noRules++;
+
+        TraceDecoder dec;
+        traceDecoderInit(dec, version);
+        for (size_t pos = TRACE_SECTOR_HDR; pos < len;) {
+            ReplayRecord r;
+            int used = traceDecode(dec, &data[off + pos], len - pos, r.rec);
+            if (used <= 0) break;
+            pos += used;
+
+            r.boot = false;
+            if (r.rec.type == TRACE_KEY && (int)boot != lastBoot) {
+                // Arranque nuevo: sigue donde terminó el anterior, más el
+                // apagado si las dos claves tienen hora
+                r.boot = true;
+                uint64_t gapMs = 0;
+                if (lastBoot >= 0 && bootUnix != 0 && r.rec.key.unixSec != 0) {
+                    uint64_t prevEnd = (uint64_t)bootUnix * 1000 + (lastAtMs - baseMs);
+                    uint64_t next = (uint64_t)r.rec.key.unixSec * 1000;
+                    if (next > prevEnd) gapMs = next - prevEnd;
+                }
+                baseMs = lastBoot < 0 ? 0 : lastAtMs + gapMs;
+                bootKeyMs = r.rec.key.uptimeMs;
+                bootUnix = r.rec.key.unixSec;
+                lastBoot = boot;
+            }
+            if (bootUnix == 0 && r.rec.type == TRACE_KEY && r.rec.key.unixSec != 0) {
+                // El reloj sincronizó después del arranque
+                bootUnix = r.rec.key.unixSec - (r.rec.key.uptimeMs - bootKeyMs) / 1000;
+            }
+            if (firstUnix == 0 && bootUnix != 0 && out.empty()) firstUnix = bootUnix;
+
+            r.atMs = baseMs + (r.rec.timeMs - bootKeyMs);
+            lastAtMs = r.atMs;
+            out.push_back(r);
+        }
+    }
+    if (skipped > 0) fprintf(stderr, "%u sectores sin encabezado válido (borrados o pisados)\n", skipped);
+    if (noRules > 0 && !g_haveRules) {
+        fprintf(stderr, "%u sectores de versión 1: sin reglas grabadas, se usan las de fábrica\n", noRules);
+    }
+    if (out.empty() || out[0].rec.type != TRACE_KEY) {
+        fprintf(stderr, "La traza no tiene registros\n");
+        return false;
+    }
+    out[0].boot = true;
+    return true;
+}
+
+// ============================================================================
+// JUEGOS DE UMBRALES
+// ============================================================================
+struct ThresholdSet {
+    std::string text;                   // Como se pasó (para la tabla)
+    std::vector<std::pair<std::string, double>> values;
+};
+
+static bool parseSet(const std::string& text, ThresholdSet& set) {
+    static const char* const KEYS[] = {
+        "tempCritical", "tempMax", "alertDelaySec", "doorOpenMaxSec",
+        "defrostCooldownSec", "defrostMaxDurationSec", "configApplyTimeSec",
+        "trendHorizonMin"
+    };
+    set.text = text;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(start, end - start);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = item.substr(0, eq);
+        bool known = false;
+        for (const char* k : KEYS) known |= key == k;
+        if (!known) {
+            fprintf(stderr, "Clave desconocida: %s\n", key.c_str());
+            return false;
+        }
+        set.values.push_back({key, atof(item.c_str() + eq + 1)});
+        start = end + 1;
+    }
+    return true;
+}
+
+static void applySet(const ThresholdSet& set) {
+    for (const auto& kv : set.values) {
+        const std::string& k = kv.first;
+        double v = kv.second;
+        if (k == "tempCritical") config.tempCritical = (float)v;
+        else if (k == "tempMax") config.tempMax = (float)v;
+        else if (k == "alertDelaySec") config.alertDelaySec = (int)v;
+        else if (k == "doorOpenMaxSec") config.doorOpenMaxSec = (int)v;
+        else if (k == "defrostCooldownSec") config.defrostCooldownSec = (int)v;
+        else if (k == "defrostMaxDurationSec") config.defrostMaxDurationSec = (int)v;
+        else if (k == "configApplyTimeSec") config.configApplyTimeSec = (int)v;
+        else if (k == "trendHorizonMin") config.trendHorizonMin = (uint16_t)v;
+    }
+}
+
+// Config grabada y encima el juego
+static void applyConfig(const TraceConfig& c, const ThresholdSet& set) {
+    config.tempMax = c.tempMax / 100.0f;
+    config.tempCritical = c.tempCritical / 100.0f;
+    config.alertDelaySec = (int)c.alertDelaySec;
+    config.doorOpenMaxSec = (int)c.doorOpenMaxSec;
+    config.defrostCooldownSec = (int)c.defrostCooldownSec;
+    config.defrostMaxDurationSec = (int)c.defrostMaxDurationSec;
+    config.configApplyTimeSec = (int)c.configApplyTimeSec;
+    config.defrostRelayNC = c.flags & TRACE_CFG_DEFROST_NC;
+    config.relayEnabled = c.flags & TRACE_CFG_RELAY;
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) config.tempSensorEnabled[i] = c.probeEnabled & (1 << i);
+    for (int i = 0; i < MAX_DOOR_SENSORS; i++) config.doorEnabled[i] = c.doorEnabled & (1 << i);
+    // Reglas: las de --rules, las grabadas (llegan en los TRACE_RULE que
+    // siguen) o, en una traza versión 1, las de fábrica
+    rulesSetDefaults(config);
+    config.interiorProbes = DEFAULT_INTERIOR_PROBES;
+    if (c.hasRules && !g_haveRules) {
+        memset(config.rules, 0, sizeof(config.rules));
+        config.ruleCount = c.ruleCount < MAX_ALERT_RULES ? c.ruleCount : MAX_ALERT_RULES;
+        config.interiorProbes = c.interiorProbes;
+        config.trendHorizonMin = c.trendHorizonMin;
+    }
+    if (g_haveRules) {
+        memcpy(config.rules, g_rules.rules, sizeof(config.rules));
+        config.ruleCount = g_rules.ruleCount;
+        config.interiorProbes = g_rules.interiorProbes;
+        config.trendHorizonMin = g_rules.trendHorizonMin;
+    }
+    applySet(set);
+}
+
+// ============================================================================
+// REPRODUCCIÓN
+// ============================================================================
+static const uint8_t INPUT_PINS[TRACE_MAX_INPUTS] = {
+    PIN_DOOR_1, PIN_DOOR_2, PIN_DOOR_3, PIN_DEFROST_INPUT
+};
+
+static void setProbe(int i, int16_t t) {
+    halSetProbeConnected(i, t != TRACE_TEMP_NULL);
+    if (t != TRACE_TEMP_NULL) halSetProbeTemp(i, traceTempC(t));
+}
+
+// Lo mismo que loop() con estos módulos, hasta el instante atMs de la traza
+static unsigned long lastSensorRead = 0;
+static unsigned long lastAlertCheck = 0;
+
+static void runUntil(uint64_t atMs, uint64_t tickUs) {
+    uint64_t targetUs = g_startUs + atMs * 1000;
+    while (halClockNowUs() < targetUs) {
+        stateMachineLoop();
+        readTempSensors();
+        if (millis() - lastSensorRead >= INTERVAL_SENSOR_READ_MS) {
+            lastSensorRead = millis();
+            readSensors();
+        }
+        if (millis() - lastAlertCheck >= INTERVAL_ALERT_CHECK_MS) {
+            lastAlertCheck = millis();
+            if (isStateMonitoring(state.currentState)) checkAlerts();
+        }
+        // La tarea de enlace, con internet siempre disponible
+        outboxPump();
+        halClockAdvanceUs(tickUs);
+    }
+}
+
+// Como setup(): sensores y máquina de estados desde cero con las entradas
+// de la clave. La config llega en el registro siguiente.
+static void replayBoot(const TraceKey& key, bool first) {
+    if (!first) event("REINICIO");
+    state.alertActive = false;
+    state.alertCritical = false;
+    state.alertAcknowledged = false;
+    state.wifiConnected = true;
+    state.internetAvailable = true;
+    rulesReset();
+    outboxInit();
+    tempEngine = { TEMP_IDLE, 0, 0, 750, 0, 0, 0, 0, false };
+    g_lastAlert = false;
+
+    halSetProbeCount(key.probeCount);
+    for (int i = 0; i < key.probeCount; i++) setProbe(i, key.temp[i]);
+    for (int i = 0; i < TRACE_MAX_INPUTS; i++) {
+        halSetDigitalInput(INPUT_PINS[i], key.inputs & (1 << i) ? HIGH : LOW);
+    }
+}
+
+static void replayStart() {
+    initSensors();
+    initStateMachine();
+    stateDispatch(EV_BOOT_DONE);
+    stateRunEffects(STATE_EFFECT_QUEUE_LEN);
+}
+
+static void replay(const std::vector<ReplayRecord>& trace, const ThresholdSet& set, uint64_t tickUs) {
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.firstAlertMs = -1;
+    config.telegramEnabled = true;
+    config.supabaseEnabled = true;
+    config.buzzerEnabled = false;
+    config.dht22Enabled = false;
+    config.simulationMode = false;
+    for (int i = 0; i < MAX_RELAYS; i++) config.relayOutputEnabled[i] = true;
+
+    g_startUs = halClockNowUs();
+    g_stateSinceUs = g_startUs;
+    bool pendingBoot = false;
+
+    for (const ReplayRecord& r : trace) {
+        runUntil(r.atMs, tickUs);
+        const TraceRecord& rec = r.rec;
+        switch (rec.type) {
+            case TRACE_KEY:
+                if (r.boot) {
+                    replayBoot(rec.key, &r == &trace[0]);
+                    pendingBoot = true;
+                } else {
+                    // Copia al abrir un sector: mismas entradas salvo huecos
+                    for (int i = 0; i < rec.key.probeCount; i++) setProbe(i, rec.key.temp[i]);
+                    for (int i = 0; i < TRACE_MAX_INPUTS; i++) {
+                        halSetDigitalInput(INPUT_PINS[i], rec.key.inputs & (1 << i) ? HIGH : LOW);
+                    }
+                }
+                break;
+            case TRACE_PROBE:
+                setProbe(rec.channel, rec.temp);
+                break;
+            case TRACE_PROBE_FAIL:
+                halSetProbeConnected(rec.channel, false);
+                break;
+            case TRACE_INPUT:
+                halSetDigitalInput(INPUT_PINS[rec.channel >> 1], rec.channel & 1 ? HIGH : LOW);
+                break;
+            case TRACE_CONFIG:
+                applyConfig(rec.config, set);
+                if (pendingBoot) {
+                    pendingBoot = false;
+                    replayStart();
+                } else if (rec.channel & TRACE_CONFIG_SAVED) {
+                    event("CONFIG    guardada");
+                    enterLoadingConfigMode();
+                }
+                break;
+            case TRACE_RULE:
+                // Mismo instante que su TRACE_CONFIG: no corrió ningún tick
+                if (!g_haveRules && rec.channel < config.ruleCount) {
+                    const TraceRule& t = rec.rule;
+                    AlertRule& rule = config.rules[rec.channel];
+                    rule.signal = t.signal;
+                    rule.index = t.index;
+                    rule.kind = t.kind;
+                    rule.flags = t.flags;
+                    rule.threshold = t.threshold;
+                    rule.hysteresis = t.hysteresis;
+                    rule.durationSec = t.durationSec;
+                    rule.repeatSec = t.repeatSec;
+                }
+                break;
+        }
+    }
+    // Lo que queda del último tick (alertas en curso)
+    if (!trace.empty()) runUntil(trace.back().atMs + 1000, tickUs);
+    g_stats.stateMs[state.currentState] += (halClockNowUs() - g_stateSinceUs) / 1000;
+}
+
+// ============================================================================
+// TRAZA SINTÉTICA
+// ============================================================================
+// Escribe sectores como recorder.h: encabezado, clave, config y reglas al abrir
+struct SynthWriter {
+    FILE* out;
+    uint8_t sector[TRACE_SECTOR_SIZE];
+    size_t used;
+    uint32_t number;
+    TraceEncoder enc;
+    TraceKey key;                       // Estado actual (para cada clave)
+    TraceConfig config;
+    TraceRule rules[MAX_ALERT_RULES];
+
+    void open(uint32_t nowMs, uint8_t flags) {
+        if (used > 0) fwrite(sector, 1, sizeof(sector), out);
+        memset(sector, 0xFF, sizeof(sector));
+        traceWriteSectorHdr(sector, 0, ++number);
+        used = TRACE_SECTOR_HDR;
+        key.uptimeMs = nowMs;
+        used += traceEncodeKey(enc, sector + used, flags, key);
+        used += traceEncodeConfig(enc, sector + used, 0, nowMs, config);
+        for (int i = 0; i < config.ruleCount; i++) {
+            used += traceEncodeRule(enc, sector + used, (uint8_t)i, nowMs, rules[i]);
+        }
+    }
+    uint8_t* reserve(uint32_t nowMs) {
+        if (used + TRACE_RECORD_MAX > TRACE_SECTOR_SIZE) open(nowMs, 0);
+        return sector + used;
+    }
+    void probe(uint32_t nowMs, int i, int16_t t) {
+        uint8_t* p = reserve(nowMs);
+        used += traceEncodeProbe(enc, p, nowMs, (uint8_t)i, t);
+        key.temp[i] = t;
+    }
+    void input(uint32_t nowMs, int in, bool level) {
+        uint8_t* p = reserve(nowMs);
+        used += traceEncodeInput(enc, p, nowMs, (uint8_t)in, level);
+        if (level) key.inputs |= 1 << in;
+        else key.inputs &= ~(1 << in);
+    }
+    void close() {
+        if (used > 0) fwrite(sector, 1, used, out);
+    }
+};
+
+static uint32_t g_rng = 2463534242u;
+
+static float synthNoise() {
+    g_rng ^= g_rng << 13; g_rng ^= g_rng >> 17; g_rng ^= g_rng << 5;
+    return (g_rng % 1000) / 1000.0f - 0.5f;
+}
+
+// Reefer a -20 °C con defrost de 25 min cada 6 h, 6 aperturas de puerta por
+// día y una falla de frío de 2 h cada 5 días. Muestras cada 1 s, con la
+// banda muerta del grabador.
+static int synthesize(const char* path, double days) {
+    SynthWriter w;
+    memset(&w, 0, sizeof(w));
+    w.out = fopen(path, "wb");
+    if (!w.out) {
+        fprintf(stderr, "No se puede crear %s\n", path);
+        return 1;
+    }
+    w.config.tempMax = tlmCenti(DEFAULT_TEMP_MAX);
+    w.config.tempCritical = tlmCenti(DEFAULT_TEMP_CRITICAL);
+    w.config.alertDelaySec = DEFAULT_ALERT_DELAY_SEC;
+    w.config.doorOpenMaxSec = DEFAULT_DOOR_OPEN_MAX_SEC;
+    w.config.defrostCooldownSec = DEFAULT_DEFROST_COOLDOWN_SEC;
+    w.config.defrostMaxDurationSec = DEFAULT_DEFROST_MAX_DURATION_SEC;
+    w.config.configApplyTimeSec = CONFIG_APPLY_TIME_SEC;
+    w.config.flags = TRACE_CFG_DEFROST_NC | TRACE_CFG_RELAY;
+    w.config.probeEnabled = 0x03;
+    w.config.doorEnabled = 0x01;
+    // Las reglas de fábrica, como las guarda un equipo nuevo
+    Config factory;
+    memset(&factory, 0, sizeof(factory));
+    rulesSetDefaults(factory);
+    w.config.ruleCount = factory.ruleCount;
+    w.config.interiorProbes = DEFAULT_INTERIOR_PROBES;
+    w.config.trendHorizonMin = factory.trendHorizonMin;
+    for (int i = 0; i < factory.ruleCount; i++) {
+        const AlertRule& r = factory.rules[i];
+        w.rules[i] = { r.signal, r.index, r.kind, r.flags, r.threshold, r.hysteresis,
+                       r.durationSec, r.repeatSec };
+    }
+    w.key.unixSec = 1767225600;         // 2026-01-01 00:00 UTC
+    w.key.probeCount = 2;
+    w.key.temp[0] = w.key.temp[1] = traceTemp16(-20.0f);
+    w.open(0, TRACE_KEY_BOOT);
+
+    const int deadband = (int)(TRACE_TEMP_DEADBAND_C * 16 + 0.5f);
+    float temp = -20.0f;
+    uint32_t doorUntil = 0;
+    uint32_t endSec = (uint32_t)(days * 86400);
+    for (uint32_t s = 1; s < endSec; s++) {
+        uint32_t ms = s * 1000;
+        uint32_t inDay = s % 86400;
+        bool defrost = s % 21600 >= 3600 && s % 21600 < 3600 + 1500;
+        bool failure = s % (5 * 86400) >= 40000 && s % (5 * 86400) < 40000 + 7200;
+
+        // Puerta: 6 aperturas por día de 1 a 8 min
+        if (doorUntil == 0 && inDay % 14400 == 9000 + (s / 86400 % 7) * 600) {
+            doorUntil = s + 60 + (uint32_t)((synthNoise() + 0.5f) * 420);
+        }
+        bool door = doorUntil > s;
+        if (doorUntil != 0 && doorUntil <= s) doorUntil = 0;
+
+        // Modelo de primer orden hacia el objetivo del momento
+        float target = defrost ? 4.0f : failure ? 0.0f : -20.0f;
+        float tau = defrost ? 600.0f : failure ? 5400.0f : 1200.0f;
+        temp += (target - temp) / tau + (door ? 0.005f : 0.0f);
+
+        bool nc = w.config.flags & TRACE_CFG_DEFROST_NC;
+        if (((w.key.inputs >> TRACE_IN_DEFROST) & 1) != (defrost == nc)) w.input(ms, TRACE_IN_DEFROST, defrost == nc);
+        if (((w.key.inputs >> TRACE_IN_DOOR_1) & 1) != door) w.input(ms, TRACE_IN_DOOR_1, door);
+
+        for (int i = 0; i < 2; i++) {
+            // La sonda 2 (evaporador) oscila más
+            int16_t t = traceTemp16(temp + synthNoise() * (i == 0 ? 0.05f : 0.1f));
+            if (abs(t - w.key.temp[i]) >= deadband) w.probe(ms, i, t);
+        }
+    }
+    w.close();
+    long size = ftell(w.out);
+    fclose(w.out);
+    printf("%s: %.1f días, %u sectores, %ld bytes\n", path, days, w.number, size);
+    return 0;
+}
+
+// ============================================================================
+// REGLAS (--rules)
+// ============================================================================
+static bool loadRules(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "No se puede abrir %s\n", path);
+        return false;
+    }
+    std::string text;
+    char buf[1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    fclose(f);
+
+    DynamicJsonDocument doc(8192);
+    if (deserializeJson(doc, text.c_str())) {
+        fprintf(stderr, "%s: JSON inválido\n", path);
+        return false;
+    }
+    rulesSetDefaults(g_rules);
+    g_rules.interiorProbes = DEFAULT_INTERIOR_PROBES;
+    if (doc.containsKey("interior_probes")) {
+        JsonArray arr = doc["interior_probes"];
+        g_rules.interiorProbes = 0;
+        for (JsonVariant v : arr) {
+            int i = v.as<int>();
+            if (i >= 0 && i < MAX_TEMP_SENSORS) g_rules.interiorProbes |= 1 << i;
+        }
+    }
+    if (doc.containsKey("trend_horizon_min")) g_rules.trendHorizonMin = doc["trend_horizon_min"];
+    if (doc.containsKey("rules")) {
+        const char* err = parseRulesJSON(doc["rules"], g_rules);
+        if (err) {
+            fprintf(stderr, "%s: %s\n", path, err);
+            return false;
+        }
+    }
+    g_haveRules = true;
+    return true;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+static void printUsage(const char* prog) {
+    fprintf(stderr,
+            "Uso: %s [--set K=V[,K=V]]... [--sets FILE] [--rules FILE] [--events] [--tick-ms N]\n"
+            "          [-j N] TRAZA\n"
+            "     %s --synth DÍAS TRAZA\n", prog, prog);
+}
+
+struct SetRun {
+    pid_t pid;
+    FILE* events;
+    FILE* summary;
+};
+
+static void printRow(const char* label, const char* row) {
+    printf("%-44s %s", label, row);
+}
+
+int main(int argc, char** argv) {
+    std::vector<ThresholdSet> sets;
+    const char* path = nullptr;
+    bool events = false;
+    double tickMs = 250;
+    double synthDays = 0;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if (a == "--set" && hasValue) {
+            ThresholdSet set;
+            if (!parseSet(argv[++i], set)) return 2;
+            sets.push_back(set);
+        } else if (a == "--sets" && hasValue) {
+            FILE* f = fopen(argv[++i], "r");
+            if (!f) {
+                fprintf(stderr, "No se puede abrir %s\n", argv[i]);
+                return 2;
+            }
+            char line[256];
+            while (fgets(line, sizeof(line), f)) {
+                std::string text(line);
+                size_t hash = text.find('#');
+                if (hash != std::string::npos) text.resize(hash);
+                while (!text.empty() && isspace((unsigned char)text.back())) text.pop_back();
+                while (!text.empty() && isspace((unsigned char)text[0])) text.erase(0, 1);
+                if (text.empty()) continue;
+                ThresholdSet set;
+                if (!parseSet(text, set)) return 2;
+                sets.push_back(set);
+            }
+            fclose(f);
+        }
+        else if (a == "--rules" && hasValue) {
+            if (!loadRules(argv[++i])) return 2;
+        }
+        else if (a == "--events") events = true;
+        else if (a == "--tick-ms" && hasValue) tickMs = atof(argv[++i]);
+        else if (a == "-j" && hasValue) jobs = atol(argv[++i]);
+        else if (a == "--synth" && hasValue) synthDays = atof(argv[++i]);
+        else if (a[0] != '-' && !path) path = argv[i];
+        else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path || tickMs <= 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (synthDays > 0) return synthesize(path, synthDays);
+
+    std::vector<ReplayRecord> trace;
+    uint32_t firstUnix;
+    if (!loadTrace(path, trace, firstUnix)) return 1;
+    if (sets.empty()) sets.push_back(ThresholdSet{"(config grabada)", {}});
+    if (jobs < 1) jobs = 1;
+
+    uint64_t spanSec = trace.back().atMs / 1000;
+    printf("Traza: %zu registros, %.2f días", trace.size(), spanSec / 86400.0);
+    if (firstUnix != 0) {
+        time_t t = firstUnix;
+        char when[32];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M UTC", gmtime(&t));
+        printf(", desde %s", when);
+    }
+    printf("\n");
+    fflush(stdout);
+
+    halSerialSetEcho(false);
+    halClockSetSpeed(0);
+    uint64_t realStart = halRealNowNs();
+
+    // Un proceso por juego: el firmware tiene estado estático
+    std::vector<SetRun> runs(sets.size());
+    size_t next = 0, running = 0, done = 0;
+    while (done < sets.size()) {
+        while (running < (size_t)jobs && next < sets.size()) {
+            SetRun& r = runs[next];
+            r.events = events ? tmpfile() : nullptr;
+            r.summary = tmpfile();
+            r.pid = fork();
+            if (r.pid == 0) {
+                g_events = r.events;
+                replay(trace, sets[next], (uint64_t)(tickMs * 1000));
+                const ReplayStats& s = g_stats;
+                uint64_t alertMin = s.stateMs[STATE_ALERT] / 60000;
+                char first[48] = "-";
+                if (s.firstAlertMs >= 0) {
+                    uint64_t m = (uint64_t)s.firstAlertMs / 60000;
+                    snprintf(first, sizeof(first), "%llud%02lluh%02llu", (unsigned long long)(m / 1440),
+                             (unsigned long long)(m / 60 % 24), (unsigned long long)(m % 60));
+                }
+                fprintf(r.summary, "%7u %8llu %10s %7u %8u %8u %7u %8llu\n",
+                        s.alerts, (unsigned long long)alertMin, first, s.doorAlerts,
+                        s.telegram, s.supabase, s.defrosts,
+                        (unsigned long long)(s.stateMs[STATE_COOLDOWN] / 60000));
+                if (r.events) fflush(r.events);
+                fflush(r.summary);
+                _exit(0);
+            }
+            next++;
+            running++;
+        }
+        int status;
+        if (wait(&status) > 0) {
+            running--;
+            done++;
+        }
+    }
+
+    double realSec = (double)(halRealNowNs() - realStart) / 1e9;
+    char line[512];
+    if (events) {
+        for (size_t i = 0; i < sets.size(); i++) {
+            printf("\n== %s\n", sets[i].text.c_str());
+            rewind(runs[i].events);
+            while (fgets(line, sizeof(line), runs[i].events)) fputs(line, stdout);
+            fclose(runs[i].events);
+        }
+    }
+
+    printf("\n");
+    printRow("Juego", " alertas min.alerta 1ª alerta puertas telegram supabase defrost cooldown\n");
+    for (size_t i = 0; i < sets.size(); i++) {
+        rewind(runs[i].summary);
+        if (!fgets(line, sizeof(line), runs[i].summary)) snprintf(line, sizeof(line), "  (falló)\n");
+        printRow(sets[i].text.c_str(), line);
+        fclose(runs[i].summary);
+    }
+    printf("\n%zu juegos x %.2f días en %.2f s (x%.0f por juego)\n", sets.size(), spanSec / 86400.0,
+           realSec, realSec > 0 ? spanSec * sets.size() / realSec : 0.0);
+    return 0;
+}
@@ -1,210 +1,57 @@
 /*
- * html_ui.h - Página HTML embebida
- * Sistema Monitoreo Reefer v3.0
+ * html_ui.h - Dashboard embebido (gzip en flash)
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * El dashboard está en ui/ (index.html, app.css, app.js). tools/build_ui.py
+ * lo comprime con gzip y genera ui_assets.h: arreglos PROGMEM con un ETag
+ * por contenido. Se envían directo desde flash, sin copiarlos al heap:
+ *
+ * - index.html: Cache-Control no-cache + ETag. Recargar la página desde el
+ *   teléfono es un 304 sin cuerpo si el firmware no cambió.
+ * - app.css / app.js: la URL lleva el hash (?v=...), se cachean un año.
+ *
+ * Todos los navegadores aceptan gzip; no se guarda copia sin comprimir.
  */
 
 #ifndef HTML_UI_H
 #define HTML_UI_H
 
-String getEmbeddedHTML() {
-  return R"rawliteral(
-<!DOCTYPE html>
-<html lang="es">
-<head>
-  <meta charset="UTF-8">
-  <meta name="viewport" content="width=device-width, initial-scale=1.0">
-  <title>Alerta REEFER</title>
-  <style>
-    *{box-sizing:border-box;margin:0;padding:0}
-    body{font-family:-apple-system,BlinkMacSystemFont,'Segoe UI',Roboto,sans-serif;background:#0f172a;min-height:100vh;color:#fff;padding:16px}
-    .container{max-width:500px;margin:0 auto}
-    h1{text-align:center;margin-bottom:4px;font-size:1.8em;color:#60a5fa}
-    .subtitle{text-align:center;color:#64748b;margin-bottom:20px;font-size:.9em}
-    .card{background:#1e293b;border-radius:12px;padding:16px;margin-bottom:12px}
-    .card h2{margin-bottom:12px;color:#fff;font-size:1em}
-    .temp-big{text-align:center;font-size:4em;font-weight:bold;margin:16px 0}
-    .temp-ok{color:#22d3ee}
-    .temp-warn{color:#fbbf24}
-    .temp-crit{color:#ef4444;animation:pulse .5s infinite}
-    @keyframes pulse{0%,100%{opacity:1}50%{opacity:.7}}
-    .status-row{display:flex;justify-content:space-between;padding:10px 0;border-bottom:1px solid #334155}
-    .status-row:last-child{border-bottom:none}
-    .status-label{color:#94a3b8}
-    .status-value{font-weight:bold}
-    .alert-banner{background:#ef4444;padding:16px;border-radius:12px;text-align:center;margin-bottom:12px;display:none}
-    .alert-banner.active{display:block}
-    button{width:100%;padding:14px;border:none;border-radius:10px;font-size:1em;font-weight:600;cursor:pointer;margin-top:8px}
-    .btn-green{background:#22c55e;color:#fff}
-    .btn-blue{background:#3b82f6;color:#fff}
-    .btn-orange{background:#f97316;color:#fff}
-    .btn-red{background:#ef4444;color:#fff}
-    .input-row{margin-bottom:12px}
-    .input-row label{display:block;margin-bottom:6px;color:#94a3b8;font-size:.85em}
-    .input-group{display:flex;gap:8px}
-    .input-group input{flex:1;padding:12px;border-radius:8px;border:1px solid #334155;background:#0f172a;color:#fff;font-size:1em}
-    .input-group span{color:#64748b;padding:12px 0;min-width:40px}
-    .footer{text-align:center;padding:20px;color:#64748b;font-size:.75em}
-  </style>
-</head>
-<body>
-  <div class="container">
-    <h1>❄️ Alerta REEFER</h1>
-    <p class="subtitle">PANDEMONIUM TECH × PAN AMERICAN SILVER</p>
-    
-    <div class="alert-banner" id="alertBanner">
-      <div style="font-size:1.2em;font-weight:bold">🚨 ALERTA ACTIVA</div>
-      <div id="alertMsg" style="margin:8px 0">Temperatura crítica</div>
-      <button class="btn-green" onclick="stopAlert()">🛑 DETENER ALERTA</button>
-    </div>
-    
-    <div class="card">
-      <h2>🌡️ TEMPERATURA</h2>
-      <div class="temp-big temp-ok" id="temp">--.-°C</div>
-    </div>
-    
-    <div class="card">
-      <h2>📊 Estado del Sistema</h2>
-      <div class="status-row"><span class="status-label">Sirena</span><span class="status-value" id="relayStatus">Apagada</span></div>
-      <div class="status-row"><span class="status-label">Señal Descongelamiento</span><span class="status-value" id="defrostSignal">--</span></div>
-      <div class="status-row"><span class="status-label">Supabase</span><span class="status-value" id="supabaseStatus">--</span></div>
-      <div class="status-row"><span class="status-label">Uptime</span><span class="status-value" id="uptime">--</span></div>
-      <div class="status-row"><span class="status-label">WiFi</span><span class="status-value" id="wifiRssi">-- dBm</span></div>
-      <div class="status-row"><span class="status-label">Internet</span><span class="status-value" id="internetStatus">--</span></div>
-      <div class="status-row"><span class="status-label">IP</span><span class="status-value" id="deviceIp">--</span></div>
-    </div>
-    
-    <div class="card">
-      <h2>📋 Valores Configurados</h2>
-      <div class="status-row"><span class="status-label">🌡️ Temp. Crítica</span><span class="status-value" id="cfgTempCrit">--°C</span></div>
-      <div class="status-row"><span class="status-label">⏱️ Tiempo espera</span><span class="status-value" id="cfgAlertDelay">-- min</span></div>
-      <div class="status-row"><span class="status-label">🧊 Post-descongelación</span><span class="status-value" id="cfgDefrostCooldown">-- min</span></div>
-      <div class="status-row"><span class="status-label">🔌 Relé Descong.</span><span class="status-value" id="cfgDefrostRelay">--</span></div>
-    </div>
-    
-    <div class="card">
-      <h2>⚙️ Configuración</h2>
-      <div class="input-row">
-        <label>🌡️ Temperatura Crítica (°C)</label>
-        <div class="input-group"><input type="number" id="inTempCrit" value="-10" step="0.5"><span>°C</span></div>
-      </div>
-      <div class="input-row">
-        <label>⏱️ Tiempo de espera (minutos)</label>
-        <div class="input-group"><input type="number" id="inAlertDelay" value="5" step="1" min="1"><span>min</span></div>
-      </div>
-      <div class="input-row">
-        <label>🧊 Post-descongelación (minutos)</label>
-        <div class="input-group"><input type="number" id="inDefrostCooldown" value="30" step="5" min="5"><span>min</span></div>
-      </div>
-      <button class="btn-blue" onclick="saveConfig()">💾 GUARDAR</button>
-    </div>
-    
-    <div class="card" id="defrostCard">
-      <h2>🧊 Modo Descongelamiento</h2>
-      <div id="defrostStatus" style="display:none;background:#f97316;padding:10px;border-radius:8px;margin-bottom:10px;text-align:center">
-        ⏱️ Activo: <strong id="defrostTime">0</strong> min
-      </div>
-      <button class="btn-orange" id="btnDefrost" onclick="toggleDefrost()">🧊 ACTIVAR DESCONGELAMIENTO</button>
-    </div>
-    
-    <div class="card">
-      <h2>📱 Acciones</h2>
-      <button class="btn-blue" onclick="testTelegram()">📲 Probar Telegram</button>
-      <button class="btn-red" onclick="resetWifi()" style="margin-top:8px">📡 Reset WiFi</button>
-    </div>
-    
-    <div class="footer">
-      <div>Última actualización: <span id="lastUpdate">--</span></div>
-      <div style="margin-top:8px"><strong>PANDEMONIUM TECH</strong> × <strong>PAN AMERICAN SILVER</strong></div>
-    </div>
-  </div>
-  
-  <script>
-    let alertActive=false,defrostMode=false;
-    
-    async function fetchStatus(){
-      try{
-        const r=await fetch('/api/status');
-        const d=await r.json();
-        const t=d.sensor.temp_avg.toFixed(1);
-        const tempEl=document.getElementById('temp');
-        tempEl.textContent=t+'°C';
-        tempEl.className='temp-big';
-        if(parseFloat(t)>-10)tempEl.classList.add('temp-crit');
-        else if(parseFloat(t)>-18)tempEl.classList.add('temp-warn');
-        else tempEl.classList.add('temp-ok');
-        
-        alertActive=d.system.alert_active;
-        const alertAck=d.system.alert_acknowledged||false;
-        document.getElementById('relayStatus').textContent=(alertActive&&!alertAck)?'PRENDIDA':'Apagada';
-        document.getElementById('relayStatus').style.color=(alertActive&&!alertAck)?'#ef4444':'#94a3b8';
-        
-        defrostMode=d.system.defrost_mode||false;
-        document.getElementById('defrostSignal').textContent=defrostMode?'ACTIVA':'Normal';
-        document.getElementById('defrostSignal').style.color=defrostMode?'#f97316':'#22c55e';
-        
-        document.getElementById('supabaseStatus').textContent=d.system.supabase_enabled?'✓ Activo':'Deshabilitado';
-        document.getElementById('supabaseStatus').style.color=d.system.supabase_enabled?'#22c55e':'#64748b';
-        
-        document.getElementById('uptime').textContent=formatUptime(d.system.uptime_sec);
-        document.getElementById('wifiRssi').textContent=d.system.wifi_rssi+' dBm';
-        document.getElementById('internetStatus').textContent=d.system.internet?'✓ Online':'✗ Offline';
-        document.getElementById('internetStatus').style.color=d.system.internet?'#22c55e':'#ef4444';
-        document.getElementById('deviceIp').textContent=d.device.ip;
-        document.getElementById('lastUpdate').textContent=new Date().toLocaleTimeString();
-        
-        const banner=document.getElementById('alertBanner');
-        if(alertActive){banner.classList.add('active');document.getElementById('alertMsg').textContent=d.system.alert_message;}
-        else{banner.classList.remove('active');}
-        
-        document.getElementById('defrostStatus').style.display=defrostMode?'block':'none';
-        document.getElementById('defrostTime').textContent=d.system.defrost_minutes||0;
-        document.getElementById('btnDefrost').textContent=defrostMode?'✅ DESACTIVAR':'🧊 ACTIVAR DESCONGELAMIENTO';
-        document.getElementById('btnDefrost').className=defrostMode?'btn-green':'btn-orange';
-      }catch(e){console.error(e);}
-    }
-    
-    async function loadConfig(){
-      try{
-        const r=await fetch('/api/config');
-        const c=await r.json();
-        document.getElementById('inTempCrit').value=c.temp_critical;
-        document.getElementById('inAlertDelay').value=Math.round(c.alert_delay_sec/60);
-        document.getElementById('inDefrostCooldown').value=Math.round((c.defrost_cooldown_sec||1800)/60);
-        document.getElementById('cfgTempCrit').textContent=c.temp_critical+'°C';
-        document.getElementById('cfgAlertDelay').textContent=Math.round(c.alert_delay_sec/60)+' min';
-        document.getElementById('cfgDefrostCooldown').textContent=Math.round((c.defrost_cooldown_sec||1800)/60)+' min';
-        document.getElementById('cfgDefrostRelay').textContent=c.defrost_relay_nc?'Normal Cerrado (NC)':'Normal Abierto (NO)';
-      }catch(e){}
-    }
-    
-    async function saveConfig(){
-      const tc=parseFloat(document.getElementById('inTempCrit').value);
-      const ad=parseInt(document.getElementById('inAlertDelay').value)*60;
-      const dc=parseInt(document.getElementById('inDefrostCooldown').value)*60;
-      await fetch('/api/config',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({temp_critical:tc,alert_delay_sec:ad,defrost_cooldown_sec:dc})});
-      alert('✅ Configuración guardada');
-      loadConfig();
-    }
-    
-    function formatUptime(s){const h=Math.floor(s/3600),m=Math.floor((s%3600)/60);if(h>0)return h+'h '+m+'m';if(m>0)return m+'m '+(s%60)+'s';return s+'s';}
-    
-    async function stopAlert(){await fetch('/api/alert/ack',{method:'POST'});fetchStatus();}
-    async function testTelegram(){const r=await fetch('/api/telegram/test',{method:'POST'});alert(r.ok?'✅ Mensaje enviado':'❌ Error');}
-    async function resetWifi(){if(confirm('¿Resetear WiFi?'))await fetch('/api/wifi/reset',{method:'POST'});}
-    async function toggleDefrost(){
-      if(confirm(defrostMode?'¿Desactivar descongelamiento?':'¿Activar descongelamiento?\n\nLas alertas se deshabilitarán.')){
-        await fetch('/api/defrost',{method:'POST'});
-        fetchStatus();
-      }
-    }
-    
-    setInterval(fetchStatus,2000);
-    fetchStatus();
-    loadConfig();
-  </script>
-</body>
-</html>
-)rawliteral";
+#include <esp_http_server.h>
+#include "web_response.h"
+
+struct UiAsset {
+  const char* path;
+  const char* contentType;
+  const uint8_t* data;            // gzip, en flash
+  size_t len;
+  const char* etag;               // Con comillas
+  bool immutable;                 // URL versionada: cache largo
+};
+
+#include "ui_assets.h"
+
+const UiAsset* findUiAsset(const String& path) {
+  for (size_t i = 0; i < UI_ASSET_COUNT; i++) {
+    if (path == UI_ASSETS[i].path) return &UI_ASSETS[i];
+  }
+  return NULL;
+}
+
+esp_err_t sendUiAsset(httpd_req_t* req, const UiAsset& asset) {
+  httpd_resp_set_hdr(req, "ETag", asset.etag);
+  httpd_resp_set_hdr(req, "Cache-Control", asset.immutable ? "public, max-age=31536000, immutable"
+                                                          : "no-cache");
+
+  char ifNoneMatch[128];
+  if (webHeader(req, "If-None-Match", ifNoneMatch, sizeof(ifNoneMatch)) &&
+      strstr(ifNoneMatch, asset.etag)) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    return httpd_resp_send(req, NULL, 0);
+  }
+
+  httpd_resp_set_type(req, asset.contentType);
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  return httpd_resp_send(req, (const char*)asset.data, asset.len);
 }
 
 #endif
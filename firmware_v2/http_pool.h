@@ -0,0 +1,265 @@
+/*
+ * ============================================================================
+ * HTTP_POOL.H - CONEXIONES HTTPS PERSISTENTES v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Pool chico de conexiones TLS por host (Supabase, Telegram). Antes cada
+ * petición creaba un HTTPClient y pagaba DNS + TCP + handshake TLS completo
+ * (cientos de ms y decenas de KB de heap) para mandar unos cientos de bytes.
+ *
+ * - Cada host tiene su WiFiClientSecure y su HTTPClient, que se reutilizan;
+ *   la conexión queda abierta entre peticiones (keep-alive).
+ * - La IP resuelta se guarda HTTP_POOL_DNS_TTL_MS; si la conexión a esa IP
+ *   falla se vuelve a resolver.
+ * - Chequeo antes de cada petición: una conexión cerrada o ociosa más de
+ *   HTTP_POOL_IDLE_MS (el servidor ya la pudo cerrar) se reabre antes de
+ *   mandar nada.
+ * - Si el envío falla sobre una conexión reutilizada se reintenta una vez
+ *   con una conexión nueva.
+ * - httpPoolMaintain() cierra las conexiones ociosas (libera el heap de
+ *   TLS) y todas si se cae el WiFi.
+ *
+ * El core ESP32 no expone la reanudación de sesión TLS en WiFiClientSecure:
+ * el ahorro viene de no cerrar la sesión. Una reconexión paga el handshake.
+ *
+ * Todo el HTTP corre en la tarea de enlace (uplink.h), sin locks.
+ *
+ * Uso:
+ *   HttpPoolSlot* c = httpPoolBegin(url);
+ *   c->http.addHeader(...);
+ *   int code = httpPoolSend(c, "POST", body);
+ *   String resp = c->http.getString();
+ *   httpPoolEnd(c);
+ *
+ * ============================================================================
+ */
+
+#ifndef HTTP_POOL_H
+#define HTTP_POOL_H
+
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include "config.h"
+#include "types.h"
+
+extern SystemState state;
+
+// ============================================================================
+// TIPOS
+// ============================================================================
+struct HttpPoolSlot {
+    char host[HTTP_POOL_HOST_MAX];  // Vacío = libre
+    uint16_t port;
+    bool inUse;                     // Entre httpPoolBegin() y httpPoolEnd()
+    bool resolved;
+    IPAddress ip;
+    unsigned long resolvedAt;
+    unsigned long lastUsedAt;
+    WiFiClientSecure client;
+    HTTPClient http;
+};
+
+struct HttpPoolStats {
+    uint32_t requests;
+    uint32_t reused;                // Peticiones sobre una conexión ya abierta
+    uint32_t connects;              // Handshakes TLS
+    uint32_t dnsLookups;
+    uint32_t retries;               // Reintentos por conexión cerrada por el servidor
+    uint32_t failures;
+    uint32_t closedIdle;
+};
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+HttpPoolSlot httpPool[HTTP_POOL_SIZE];
+HttpPoolStats httpPoolStats;
+portMUX_TYPE httpPoolStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+#define HTTP_POOL_COUNT(field) do { \
+    portENTER_CRITICAL(&httpPoolStatsMux); \
+    httpPoolStats.field++; \
+    portEXIT_CRITICAL(&httpPoolStatsMux); \
+} while (0)
+
+// ============================================================================
+// CONEXIÓN
+// ============================================================================
+// "https://host[:puerto]/..." -> host y puerto
+bool httpPoolParseUrl(const char* url, char* host, size_t cap, uint16_t& port) {
+    if (strncmp(url, "https://", 8) != 0) return false;
+    const char* p = url + 8;
+    size_t n = strcspn(p, ":/");
+    if (n == 0 || n >= cap) return false;
+    memcpy(host, p, n);
+    host[n] = '\0';
+    port = p[n] == ':' ? (uint16_t)atoi(p + n + 1) : 443;
+    return true;
+}
+
+bool httpPoolIsAlive(HttpPoolSlot& s) {
+    return s.client.connected() && millis() - s.lastUsedAt < HTTP_POOL_IDLE_MS;
+}
+
+// Abrir la conexión TLS usando la IP cacheada
+bool httpPoolConnect(HttpPoolSlot& s) {
+    s.client.stop();
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!s.resolved || millis() - s.resolvedAt >= HTTP_POOL_DNS_TTL_MS) {
+            HTTP_POOL_COUNT(dnsLookups);
+            if (!WiFi.hostByName(s.host, s.ip)) {
+                s.resolved = false;
+                return false;
+            }
+            s.resolved = true;
+            s.resolvedAt = millis();
+        } else if (attempt > 0) {
+            break;                  // La IP recién resuelta tampoco conecta
+        }
+
+        if (s.client.connect(s.ip, s.port, s.host, NULL, NULL, NULL)) {
+            HTTP_POOL_COUNT(connects);
+            s.lastUsedAt = millis();
+            return true;
+        }
+        s.resolved = false;         // La IP pudo cambiar: resolver de nuevo
+    }
+    return false;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+// Slot del host de la URL, con el HTTPClient listo para agregar headers.
+// NULL si la URL no es https o si todos los slots están en uso.
+HttpPoolSlot* httpPoolBegin(const String& url) {
+    char host[HTTP_POOL_HOST_MAX];
+    uint16_t port;
+    if (!httpPoolParseUrl(url.c_str(), host, sizeof(host), port)) return NULL;
+
+    unsigned long now = millis();
+    HttpPoolSlot* slot = NULL;
+    HttpPoolSlot* victim = NULL;
+
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        HttpPoolSlot& s = httpPool[i];
+        if (s.port == port && strcmp(s.host, host) == 0) {
+            slot = &s;
+            break;
+        }
+        // Libre, o el que lleva más tiempo sin usarse
+        if (s.inUse) continue;
+        if (!victim || s.host[0] == '\0' ||
+            (victim->host[0] != '\0' && now - s.lastUsedAt > now - victim->lastUsedAt)) {
+            victim = &s;
+        }
+    }
+
+    if (!slot) {
+        if (!victim) return NULL;
+        slot = victim;
+        slot->client.stop();
+        strncpy(slot->host, host, sizeof(slot->host));
+        slot->port = port;
+        slot->resolved = false;
+        slot->lastUsedAt = now;
+    }
+    if (slot->inUse) return NULL;
+
+    slot->inUse = true;
+    slot->http.setReuse(true);
+    slot->http.setTimeout(HTTP_POOL_TIMEOUT_MS);
+    slot->http.begin(slot->client, url);
+    return slot;
+}
+
+// Enviar la petición; reabre la conexión si hace falta
+int httpPoolSend(HttpPoolSlot* s, const char* method, const String& body) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = httpPoolIsAlive(*s);
+        if (!reused && !httpPoolConnect(*s)) {
+            HTTP_POOL_COUNT(failures);
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+
+        HTTP_POOL_COUNT(requests);
+        if (reused) HTTP_POOL_COUNT(reused);
+
+        int code = s->http.sendRequest(method, body);
+        s->lastUsedAt = millis();
+        if (code > 0) return code;
+
+        s->client.stop();
+        bool staleConnection = reused && (code == HTTPC_ERROR_SEND_HEADER_FAILED ||
+                                          code == HTTPC_ERROR_SEND_PAYLOAD_FAILED ||
+                                          code == HTTPC_ERROR_CONNECTION_LOST);
+        if (!staleConnection) {
+            HTTP_POOL_COUNT(failures);
+            return code;
+        }
+        HTTP_POOL_COUNT(retries);
+    }
+    HTTP_POOL_COUNT(failures);
+    return HTTPC_ERROR_CONNECTION_LOST;
+}
+
+// Libera el slot; la conexión queda abierta si el servidor lo permite
+void httpPoolEnd(HttpPoolSlot* s) {
+    s->http.end();
+    s->inUse = false;
+}
+
+// Llamar periódicamente desde la tarea de enlace
+void httpPoolMaintain() {
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        HttpPoolSlot& s = httpPool[i];
+        if (s.host[0] == '\0' || s.inUse) continue;
+
+        if (!state.wifiConnected) {
+            s.client.stop();
+            s.resolved = false;     // Otra red puede resolver distinto
+        } else if (s.client.connected() && !httpPoolIsAlive(s)) {
+            s.client.stop();
+            HTTP_POOL_COUNT(closedIdle);
+        }
+    }
+}
+
+void httpPoolInit() {
+    memset(&httpPoolStats, 0, sizeof(httpPoolStats));
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        HttpPoolSlot& s = httpPool[i];
+        s.host[0] = '\0';
+        s.port = 0;
+        s.inUse = false;
+        s.resolved = false;
+        // Igual que antes: sin validar el certificado del servidor
+        s.client.setInsecure();
+        s.client.setHandshakeTimeout(HTTP_POOL_TIMEOUT_MS / 1000);
+    }
+}
+
+void getHttpPoolJSON(JsonObject& obj) {
+    portENTER_CRITICAL(&httpPoolStatsMux);
+    HttpPoolStats st = httpPoolStats;
+    portEXIT_CRITICAL(&httpPoolStatsMux);
+
+    int open = 0;
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        if (httpPool[i].host[0] != '\0' && httpPool[i].client.connected()) open++;
+    }
+
+    obj["open"] = open;
+    obj["requests"] = st.requests;
+    obj["reused"] = st.reused;
+    obj["connects"] = st.connects;
+    obj["dns_lookups"] = st.dnsLookups;
+    obj["retries"] = st.retries;
+    obj["failures"] = st.failures;
+    obj["closed_idle"] = st.closedIdle;
+}
+
+#endif // HTTP_POOL_H
@@ -0,0 +1,499 @@
+/*
+ * ============================================================================
+ * JOURNAL.H - DIARIO DE TELEMETRÍA EN FLASH v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Registro circular de solo-agregado en una partición propia ("journal" en
+ * partitions.csv). Cada lectura y evento para Supabase se escribe acá
+ * primero y la tarea de enlace los sube en orden desde el cursor de subida:
+ * un corte de internet de horas o un reinicio no pierde registros.
+ *
+ * Formato (sectores de JOURNAL_SECTOR_SIZE, little endian):
+ *   Sector:  u32 magia | u16 generación | u16 reservado | u32 número de
+ *            sector | u32 primera secuencia | u32 control
+ *   Entrada: u16 largo | u16 CRC-16 (secuencia + registro) | u32 secuencia |
+ *            registro de telemetry.h (con hora absoluta)
+ *   Largo 0xFFFF = resto del sector libre.
+ *
+ * - Desgaste parejo: los sectores se usan en rueda y cada uno se borra una
+ *   vez por vuelta. El siguiente sector se borra por adelantado desde la
+ *   tarea de enlace (journalMaintain) para no frenar loop(): se reserva con
+ *   el mutex tomado y se borra sin él. journalAppend() solo espera si la
+ *   cabeza se llena justo durante ese borrado.
+ * - Recuperación: al arrancar se busca el sector más nuevo y su última
+ *   entrada válida. Una entrada cortada por un reinicio cierra el sector.
+ * - El cursor de subida se guarda en NVS cada JOURNAL_CURSOR_SAVE_MS. Tras
+ *   un reinicio se puede reenviar lo de ese intervalo: Supabase lo descarta
+ *   por la clave única (device_id, seq).
+ * - Sin internet por más tiempo del que entra en la partición se pisan los
+ *   registros más viejos (contador "overwritten").
+ * - La generación (al azar al formatear) va sobre la secuencia en la
+ *   clave: un diario nuevo no choca con filas de uno anterior.
+ *
+ * journalAppend() corre en loop(); journalRead/Commit/Maintain en la tarea
+ * de enlace. Un mutex protege cabeza y cursor.
+ *
+ * ============================================================================
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <esp_partition.h>
+#include <Preferences.h>
+#include "config.h"
+#include "telemetry.h"
+
+// ============================================================================
+// CONSTANTES
+// ============================================================================
+#define JOURNAL_MAGIC           0x4C4A5252UL    // "RRJL"
+#define JOURNAL_SECTOR_HDR      20
+#define JOURNAL_ENTRY_HDR       8
+#define JOURNAL_FREE            0xFFFF
+
+// ============================================================================
+// TIPOS
+// ============================================================================
+struct JournalPos {
+    uint16_t sector;
+    uint16_t offset;
+    uint32_t seq;                   // Secuencia de la entrada en offset
+};
+
+struct JournalSectorHdr {
+    uint16_t generation;
+    uint32_t number;                // Crece en cada sector abierto
+    uint32_t firstSeq;
+};
+
+struct Journal {
+    const esp_partition_t* part;
+    SemaphoreHandle_t mutex;
+    bool ready;
+    uint16_t sectors;
+    uint16_t generation;
+    uint32_t headNumber;            // Número del sector cabeza
+    JournalPos head;                // Próxima escritura
+    JournalPos read;                // Próxima entrada a subir
+    bool nextErased;                // Sector siguiente a la cabeza ya borrado
+    bool erasing;                   // journalMaintain() lo está borrando (sin el mutex)
+    uint32_t bootSeq;               // Primera secuencia de este arranque
+    uint32_t savedSeq;              // Cursor guardado en NVS
+    unsigned long savedAt;
+    // Contadores
+    uint32_t appended;
+    uint32_t uploaded;
+    uint32_t overwritten;
+    uint32_t writeErrors;
+    uint32_t erases;
+};
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+Journal journal;
+Preferences journalPrefs;           // Propio: se usa desde la tarea de enlace
+
+// ============================================================================
+// ACCESO A FLASH
+// ============================================================================
+inline uint32_t journalAddr(uint16_t sector, uint16_t offset) {
+    return (uint32_t)sector * JOURNAL_SECTOR_SIZE + offset;
+}
+
+inline uint16_t journalNextSector(uint16_t sector) {
+    return (uint16_t)((sector + 1) % journal.sectors);
+}
+
+uint16_t journalCrc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+inline uint32_t journalSectorCheck(const uint8_t* hdr) {
+    uint32_t c = 0xA5A5A5A5UL;
+    for (int i = 0; i < 16; i += 4) {
+        c ^= (uint32_t)hdr[i] | (uint32_t)hdr[i + 1] << 8 |
+             (uint32_t)hdr[i + 2] << 16 | (uint32_t)hdr[i + 3] << 24;
+    }
+    return c;
+}
+
+bool journalReadSector(uint16_t sector, JournalSectorHdr& h) {
+    uint8_t b[JOURNAL_SECTOR_HDR];
+    if (esp_partition_read(journal.part, journalAddr(sector, 0), b, sizeof(b)) != ESP_OK) {
+        return false;
+    }
+    TlmReader r = { b, sizeof(b), 0, false };
+    if (r.u32() != JOURNAL_MAGIC) return false;
+    h.generation = r.u16();
+    r.u16();
+    h.number = r.u32();
+    h.firstSeq = r.u32();
+    return r.u32() == journalSectorCheck(b);
+}
+
+// Largo del registro (>0), 0 = espacio libre, -1 = entrada inválida,
+// -2 = no entra en cap
+int journalReadEntry(uint16_t sector, uint16_t offset, uint32_t& seq,
+                     uint8_t* buf, size_t cap) {
+    if (offset + JOURNAL_ENTRY_HDR > JOURNAL_SECTOR_SIZE) return 0;
+
+    uint8_t h[JOURNAL_ENTRY_HDR];
+    if (esp_partition_read(journal.part, journalAddr(sector, offset), h, sizeof(h)) != ESP_OK) {
+        return -1;
+    }
+    TlmReader r = { h, sizeof(h), 0, false };
+    uint16_t len = r.u16();
+    uint16_t crc = r.u16();
+    seq = r.u32();
+
+    if (len == JOURNAL_FREE) return 0;
+    if (len == 0 || len > TLM_RECORD_MAX ||
+        offset + JOURNAL_ENTRY_HDR + len > JOURNAL_SECTOR_SIZE) return -1;
+    if (len > cap) return -2;
+    if (esp_partition_read(journal.part, journalAddr(sector, offset + JOURNAL_ENTRY_HDR),
+                           buf, len) != ESP_OK) return -1;
+
+    uint16_t c = journalCrc16(h + 4, 4);
+    if (journalCrc16(buf, len, c) != crc) return -1;
+    return len;
+}
+
+// El cursor de subida no puede quedar en un sector que se va a borrar
+// (con el mutex tomado)
+void journalReleaseSector(uint16_t sector) {
+    if (journal.read.sector == sector) {
+        JournalPos pos = journal.head;
+        JournalSectorHdr h;
+        uint16_t next = journalNextSector(sector);
+        if (journal.read.seq != journal.head.seq && journalReadSector(next, h) &&
+            h.generation == journal.generation) {
+            pos = { next, JOURNAL_SECTOR_HDR, h.firstSeq };
+        }
+        journal.overwritten += pos.seq - journal.read.seq;
+        journal.read = pos;
+    }
+}
+
+void journalEraseSector(uint16_t sector) {
+    journalReleaseSector(sector);
+    esp_partition_erase_range(journal.part, journalAddr(sector, 0), JOURNAL_SECTOR_SIZE);
+    journal.erases++;
+}
+
+// Abre un sector ya borrado como nueva cabeza
+bool journalOpenSector(uint16_t sector) {
+    uint8_t b[JOURNAL_SECTOR_HDR];
+    TlmWriter w = { b, sizeof(b), 0, false };
+    w.u32(JOURNAL_MAGIC);
+    w.u16(journal.generation);
+    w.u16(0xFFFF);
+    w.u32(journal.headNumber + 1);
+    w.u32(journal.head.seq);
+    w.u32(journalSectorCheck(b));
+
+    if (esp_partition_write(journal.part, journalAddr(sector, 0), b, sizeof(b)) != ESP_OK) {
+        journal.writeErrors++;
+        return false;
+    }
+    journal.headNumber++;
+    journal.head.sector = sector;
+    journal.head.offset = JOURNAL_SECTOR_HDR;
+    journal.nextErased = false;
+    return true;
+}
+
+// ============================================================================
+// ARRANQUE
+// ============================================================================
+// Posición de la entrada seq (o la siguiente que exista)
+JournalPos journalLocate(uint32_t seq) {
+    JournalSectorHdr h;
+    int best = -1, oldest = -1;
+    uint32_t bestFirst = 0, oldestFirst = 0;
+    for (uint16_t s = 0; s < journal.sectors; s++) {
+        if (!journalReadSector(s, h) || h.generation != journal.generation) continue;
+        if (h.firstSeq <= seq && (best < 0 || h.firstSeq > bestFirst)) {
+            best = s;
+            bestFirst = h.firstSeq;
+        }
+        if (oldest < 0 || h.firstSeq < oldestFirst) {
+            oldest = s;
+            oldestFirst = h.firstSeq;
+        }
+    }
+    // Sin cursor, o ya pisado: desde lo más viejo que queda
+    if (best < 0) {
+        best = oldest;
+        bestFirst = oldestFirst;
+    }
+    if (best < 0) return journal.head;
+
+    static uint8_t scratch[TLM_RECORD_MAX];
+    JournalPos pos = { (uint16_t)best, JOURNAL_SECTOR_HDR, bestFirst };
+    while (pos.seq < seq) {
+        uint32_t entrySeq;
+        int n = journalReadEntry(pos.sector, pos.offset, entrySeq, scratch, sizeof(scratch));
+        if (n <= 0) break;
+        pos.offset += JOURNAL_ENTRY_HDR + n;
+        pos.seq = entrySeq + 1;
+    }
+    return pos;
+}
+
+bool journalInit() {
+    memset(&journal, 0, sizeof(journal));
+
+    #if JOURNAL_ENABLED
+    journal.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                            JOURNAL_PARTITION_LABEL);
+    #endif
+    if (!journal.part || journal.part->size / JOURNAL_SECTOR_SIZE < 3) {
+        Serial.println("[JOURNAL] Sin partición 'journal': lecturas solo con internet");
+        return false;
+    }
+    journal.sectors = (uint16_t)(journal.part->size / JOURNAL_SECTOR_SIZE);
+    journal.mutex = xSemaphoreCreateMutex();
+
+    // Sector más nuevo (cabeza) y más viejo de la misma generación
+    JournalSectorHdr h;
+    int newest = -1;
+    uint32_t newestNumber = 0;
+    for (uint16_t s = 0; s < journal.sectors; s++) {
+        if (journalReadSector(s, h) && (newest < 0 || h.number > newestNumber)) {
+            newest = s;
+            newestNumber = h.number;
+            journal.generation = h.generation;
+        }
+    }
+
+    if (newest < 0) {
+        // Partición nueva: formatear
+        journal.generation = (uint16_t)(esp_random() % 0xFFFF + 1);
+        journal.head.seq = 1;
+        esp_partition_erase_range(journal.part, 0, JOURNAL_SECTOR_SIZE);
+        journal.erases++;
+        if (!journalOpenSector(0)) return false;
+        journal.read = journal.head;
+        Serial.printf("[JOURNAL] Formateado: %u sectores, generación %u\n",
+                      journal.sectors, journal.generation);
+    } else {
+        // Última entrada válida de la cabeza
+        journalReadSector(newest, h);
+        journal.headNumber = h.number;
+        journal.head = { (uint16_t)newest, JOURNAL_SECTOR_HDR, h.firstSeq };
+        static uint8_t scratch[TLM_RECORD_MAX];
+        for (;;) {
+            uint32_t seq;
+            int n = journalReadEntry(journal.head.sector, journal.head.offset, seq,
+                                     scratch, sizeof(scratch));
+            if (n == 0) break;
+            if (n < 0 || seq != journal.head.seq) {
+                // Entrada cortada por un reinicio: cerrar el sector
+                journal.head.offset = JOURNAL_SECTOR_SIZE;
+                break;
+            }
+            journal.head.offset += JOURNAL_ENTRY_HDR + n;
+            journal.head.seq++;
+        }
+
+        // Cursor de subida guardado (de esta misma generación)
+        journalPrefs.begin("journal", true);
+        uint16_t gen = journalPrefs.getUShort("gen", 0);
+        uint32_t cursor = journalPrefs.getUInt("seq", 0);
+        journalPrefs.end();
+        if (gen != journal.generation || cursor > journal.head.seq) cursor = 0;
+
+        journal.read = journalLocate(cursor);
+        journal.savedSeq = cursor;
+    }
+
+    journal.bootSeq = journal.head.seq;
+    journal.ready = true;
+    Serial.printf("[JOURNAL] ✓ Listo: próxima seq %lu, %lu pendientes de subir\n",
+                  (unsigned long)journal.head.seq,
+                  (unsigned long)(journal.head.seq - journal.read.seq));
+    return true;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+inline bool journalReady() { return journal.ready; }
+
+// Clave de idempotencia de una entrada: generación | secuencia
+inline uint64_t journalKey(uint32_t seq) {
+    return (uint64_t)journal.generation << 32 | seq;
+}
+
+// Agregar un registro (loop). Devuelve false si no se pudo escribir.
+bool journalAppend(const uint8_t* record, size_t len) {
+    if (!journal.ready || len == 0 || len > TLM_RECORD_MAX) return false;
+
+    uint8_t e[JOURNAL_ENTRY_HDR + TLM_RECORD_MAX];
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+
+    size_t size = JOURNAL_ENTRY_HDR + len;
+    if (journal.head.offset + size > JOURNAL_SECTOR_SIZE) {
+        // El siguiente se está borrando: esperar a que termine
+        while (journal.erasing) {
+            xSemaphoreGive(journal.mutex);
+            vTaskDelay(1);
+            xSemaphoreTake(journal.mutex, portMAX_DELAY);
+        }
+        uint16_t next = journalNextSector(journal.head.sector);
+        if (!journal.nextErased) journalEraseSector(next);  // No se llegó a borrar antes
+        if (!journalOpenSector(next)) {
+            xSemaphoreGive(journal.mutex);
+            return false;
+        }
+    }
+
+    TlmWriter w = { e, sizeof(e), 0, false };
+    w.u16((uint16_t)len);
+    w.u16(0);
+    w.u32(journal.head.seq);
+    memcpy(e + JOURNAL_ENTRY_HDR, record, len);
+    uint16_t crc = journalCrc16(e + JOURNAL_ENTRY_HDR, len, journalCrc16(e + 4, 4));
+    e[2] = (uint8_t)crc;
+    e[3] = (uint8_t)(crc >> 8);
+
+    bool ok = esp_partition_write(journal.part,
+                                  journalAddr(journal.head.sector, journal.head.offset),
+                                  e, size) == ESP_OK;
+    if (ok) {
+        journal.head.offset += size;
+        journal.head.seq++;
+        journal.appended++;
+    } else {
+        journal.writeErrors++;
+        journal.head.offset = JOURNAL_SECTOR_SIZE;  // Seguir en un sector nuevo
+    }
+
+    xSemaphoreGive(journal.mutex);
+    return ok;
+}
+
+// Posición de la próxima entrada a subir
+JournalPos journalReadPos() {
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    JournalPos pos = journal.read;
+    xSemaphoreGive(journal.mutex);
+    return pos;
+}
+
+uint32_t journalPending() {
+    if (!journal.ready) return 0;
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    uint32_t n = journal.head.seq - journal.read.seq;
+    xSemaphoreGive(journal.mutex);
+    return n;
+}
+
+// Leer la entrada en pos y avanzar pos. Devuelve el largo, 0 si no hay más
+// o -1 si no entra en cap.
+int journalRead(JournalPos& pos, uint32_t& seq, uint8_t* buf, size_t cap) {
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    int result = 0;
+
+    // Como mucho un salto al sector siguiente
+    for (int hop = 0; hop < 2 && pos.seq != journal.head.seq; hop++) {
+        int n = journalReadEntry(pos.sector, pos.offset, seq, buf, cap);
+        if (n == -2) {
+            result = -1;
+            break;
+        }
+        if (n > 0 && seq >= pos.seq) {
+            pos.offset += JOURNAL_ENTRY_HDR + n;
+            pos.seq = seq + 1;
+            result = n;
+            break;
+        }
+        // Fin del sector (o entrada inválida): seguir en el siguiente
+        if (pos.sector == journal.head.sector) break;
+        uint16_t next = journalNextSector(pos.sector);
+        JournalSectorHdr h;
+        if (!journalReadSector(next, h) || h.generation != journal.generation) {
+            pos = journal.head;
+            break;
+        }
+        pos = { next, JOURNAL_SECTOR_HDR, h.firstSeq };
+    }
+
+    xSemaphoreGive(journal.mutex);
+    return result;
+}
+
+// Subido hasta pos (sin incluir)
+void journalCommit(const JournalPos& pos) {
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    // Si mientras tanto se pisaron registros el cursor ya puede estar más adelante
+    if (pos.seq > journal.read.seq) {
+        journal.uploaded += pos.seq - journal.read.seq;
+        journal.read = pos;
+    }
+    xSemaphoreGive(journal.mutex);
+}
+
+// Tarea de enlace: borrar el próximo sector y guardar el cursor. El borrado
+// (decenas de ms) va sin el mutex para no frenar journalAppend() en loop().
+void journalMaintain(bool force = false) {
+    if (!journal.ready) return;
+
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    uint16_t next = journalNextSector(journal.head.sector);
+    bool erase = !journal.nextErased;
+    if (erase) {
+        journalReleaseSector(next);
+        journal.erasing = true;
+    }
+    xSemaphoreGive(journal.mutex);
+
+    if (erase) {
+        esp_partition_erase_range(journal.part, journalAddr(next, 0), JOURNAL_SECTOR_SIZE);
+        xSemaphoreTake(journal.mutex, portMAX_DELAY);
+        journal.erasing = false;
+        journal.nextErased = true;
+        journal.erases++;
+        xSemaphoreGive(journal.mutex);
+    }
+
+    xSemaphoreTake(journal.mutex, portMAX_DELAY);
+    uint32_t cursor = journal.read.seq;
+    xSemaphoreGive(journal.mutex);
+
+    unsigned long now = millis();
+    if (cursor != journal.savedSeq && (force || now - journal.savedAt >= JOURNAL_CURSOR_SAVE_MS)) {
+        journalPrefs.begin("journal", false);
+        journalPrefs.putUShort("gen", journal.generation);
+        journalPrefs.putUInt("seq", cursor);
+        journalPrefs.end();
+        journal.savedSeq = cursor;
+        journal.savedAt = now;
+    }
+}
+
+void getJournalJSON(JsonObject& obj) {
+    obj["ready"] = journal.ready;
+    if (!journal.ready) return;
+
+    obj["sectors"] = journal.sectors;
+    obj["generation"] = journal.generation;
+    obj["next_seq"] = journal.head.seq;
+    obj["pending"] = journalPending();
+    obj["appended"] = journal.appended;
+    obj["uploaded"] = journal.uploaded;
+    obj["overwritten"] = journal.overwritten;
+    obj["write_errors"] = journal.writeErrors;
+    obj["erases"] = journal.erases;
+}
+
+#endif // JOURNAL_H
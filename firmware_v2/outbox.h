@@ -0,0 +1,464 @@
+/*
+ * ============================================================================
+ * OUTBOX.H - BANDEJA DE SALIDA DE ALERTAS
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * triggerAlert() y las reglas (rules.h) no llaman a Telegram ni a Supabase:
+ * dejan la alerta acá (outboxPost, desde loop) y la tarea de enlace la
+ * entrega por cada canal por separado (outboxPump, desde uplinkPeriodic).
+ *
+ * - Lugares: MAX_ALERTS_QUEUE. Cada alerta lleva el estado de entrega de
+ *   cada canal (Telegram, Supabase, SMS): pendiente, entregada (recibo con
+ *   código y hora), abandonada o salteada (canal deshabilitado).
+ * - Prioridad: siempre se entrega primero la de mayor severidad y, entre
+ *   iguales, la más vieja. Un canal caído no frena a los otros.
+ * - Duplicados: una alerta con el mismo tipo y origen (sonda/puerta) que
+ *   otra todavía pendiente no ocupa otro lugar: actualiza el texto y suma
+ *   una repetición. Si sube de severidad, vuelve a salir por los canales
+ *   que ya la habían entregado.
+ * - Reintentos: backoff exponencial desde OUTBOX_RETRY_BASE_MS hasta
+ *   OUTBOX_RETRY_MAX_MS. Sin internet (o sin red GSM) no se intenta ni se
+ *   cuenta. Tras OUTBOX_MAX_ATTEMPTS fallas, o un 4xx que no se arregla
+ *   reintentando, el canal queda abandonado.
+ * - Bandeja llena: se pisa la entregada más vieja; si no hay, la pendiente
+ *   de menor severidad (nunca una más grave que la nueva).
+ * - Persistencia: la bandeja entera va a NVS (namespace "outbox") al
+ *   encolar, subir de severidad, entregar o abandonar; las repeticiones
+ *   juntadas y los reintentos fallidos no escriben.
+ *   Tras un reinicio lo pendiente sale apenas haya red.
+ *
+ * SMS: solo alertas críticas, si sim800.h se incluye antes que este archivo
+ * (firmware_v2.ino lo hace) y el módulo respondió en sim800Init().
+ *
+ * ============================================================================
+ */
+
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <Preferences.h>
+#include "config.h"
+#include "types.h"
+#include "telemetry.h"
+
+extern Config config;
+extern SystemState state;
+extern SensorData sensorData;
+extern uint32_t deviceUnixTime();
+
+// Ejecutores (tarea de enlace): código HTTP, 2xx = entregada
+extern int telegramDeliverAlert(const AlertEvent& e);
+extern int supabaseDeliverAlert(const AlertEvent& e);
+#ifdef SIM800_H
+extern int sim800DeliverAlert(const AlertEvent& e);
+#endif
+
+static const char* const ALERT_CHANNEL_NAMES[ALERT_CH_COUNT] = { "telegram", "supabase", "sms" };
+static const char* const ALERT_DLV_NAMES[] = { "pending", "sent", "failed", "skipped" };
+
+struct OutboxStats {
+    uint32_t posted;
+    uint32_t merged;                    // Juntadas con una pendiente igual
+    uint32_t delivered;                 // Entregas (por canal)
+    uint32_t retries;                   // Intentos fallidos con reintento
+    uint32_t failed;                    // Canales abandonados
+    uint32_t evicted;                   // Pendientes pisadas por bandeja llena
+    uint32_t dropped;                   // Nuevas descartadas por bandeja llena
+};
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+AlertEvent outbox[MAX_ALERTS_QUEUE];
+OutboxStats outboxStats;
+uint32_t outboxNextId = 1;
+bool outboxDirty = false;               // Guardar en NVS (lo hace la tarea)
+portMUX_TYPE outboxMux = portMUX_INITIALIZER_UNLOCKED;
+Preferences outboxPrefs;                // Propio: se usa desde la tarea de enlace
+
+// ============================================================================
+// AUXILIARES (llamar con outboxMux tomado)
+// ============================================================================
+static bool outboxPending(const AlertEvent& e) {
+    for (int c = 0; c < ALERT_CH_COUNT; c++) {
+        if (e.channel[c].status == ALERT_DLV_PENDING) return true;
+    }
+    return false;
+}
+
+// Canales que corresponden a la severidad (config de loop)
+static bool outboxChannelEnabled(int ch, uint8_t severity) {
+    switch (ch) {
+        case ALERT_CH_TELEGRAM:
+            return config.telegramEnabled && strlen(TELEGRAM_BOT_TOKEN) >= 10;
+        case ALERT_CH_SUPABASE:
+            return config.supabaseEnabled;
+        case ALERT_CH_SMS:
+            #ifdef SIM800_H
+            // Módulo ausente o sin respuesta al arrancar: salteado
+            return sim800State.initialized &&
+                   severity >= tlmLookup(TLM_SEVERITIES, TLM_COUNT(TLM_SEVERITIES), "critical");
+            #else
+            (void)severity;
+            return false;
+            #endif
+    }
+    return false;
+}
+
+// Canales entregados o salteados vuelven a pendiente (alerta nueva o
+// que subió de severidad)
+static void outboxArm(AlertEvent& e) {
+    for (int c = 0; c < ALERT_CH_COUNT; c++) {
+        AlertDelivery& d = e.channel[c];
+        if (d.status == ALERT_DLV_PENDING) continue;
+        memset(&d, 0, sizeof(d));
+        d.status = outboxChannelEnabled(c, e.severity) ? ALERT_DLV_PENDING : ALERT_DLV_SKIPPED;
+    }
+}
+
+// ¿a va antes que b? Mayor severidad, después la más vieja
+static bool outboxBefore(const AlertEvent& a, const AlertEvent& b) {
+    if (a.severity != b.severity) return a.severity > b.severity;
+    return a.id < b.id;
+}
+
+// Lugar para una alerta nueva de esa severidad, o -1
+static int outboxFreeSlot(uint8_t severity) {
+    int done = -1, victim = -1;
+    for (int i = 0; i < MAX_ALERTS_QUEUE; i++) {
+        const AlertEvent& e = outbox[i];
+        if (e.id == 0) return i;
+        if (!outboxPending(e)) {
+            if (done < 0 || e.id < outbox[done].id) done = i;
+        } else if (e.severity <= severity && (victim < 0 || outboxBefore(outbox[victim], e))) {
+            victim = i;
+        }
+    }
+    if (done >= 0) return done;
+    if (victim >= 0) outboxStats.evicted++;
+    return victim;
+}
+
+// Texto truncado sin cortar un carácter UTF-8
+static void outboxCopyMessage(char* dst, const String& src) {
+    size_t n = src.length();
+    if (n >= OUTBOX_MSG_MAX) {
+        n = OUTBOX_MSG_MAX - 1;
+        while (n > 0 && ((uint8_t)src[n] & 0xC0) == 0x80) n--;
+    }
+    memcpy(dst, src.c_str(), n);
+    dst[n] = '\0';
+}
+
+// Espera antes del próximo intento tras n fallas
+static uint32_t outboxBackoffMs(uint8_t failures) {
+    uint32_t ms = OUTBOX_RETRY_BASE_MS;
+    for (uint8_t i = 1; i < failures && ms < OUTBOX_RETRY_MAX_MS; i++) ms *= 2;
+    return ms < OUTBOX_RETRY_MAX_MS ? ms : OUTBOX_RETRY_MAX_MS;
+}
+
+// ============================================================================
+// PERSISTENCIA
+// ============================================================================
+// Cargar lo que quedó de antes del reinicio (llamar en setup)
+void outboxInit() {
+    memset(outbox, 0, sizeof(outbox));
+    memset(&outboxStats, 0, sizeof(outboxStats));
+    outboxNextId = 1;
+    outboxDirty = false;
+
+    outboxPrefs.begin("outbox", true);
+    bool loaded = outboxPrefs.getBytesLength("events") == sizeof(outbox) &&
+                  outboxPrefs.getBytes("events", outbox, sizeof(outbox)) == sizeof(outbox);
+    outboxPrefs.end();
+    if (!loaded) memset(outbox, 0, sizeof(outbox));
+
+    int pending = 0;
+    uint32_t now = millis();
+    for (int i = 0; i < MAX_ALERTS_QUEUE; i++) {
+        AlertEvent& e = outbox[i];
+        if (e.id == 0) continue;
+        if (e.id >= outboxNextId) outboxNextId = e.id + 1;
+        // millis() de otro arranque: reintentar apenas haya red
+        e.flags &= ~ALERT_EV_THIS_BOOT;
+        for (int c = 0; c < ALERT_CH_COUNT; c++) {
+            e.channel[c].lastTryAt = now - OUTBOX_RETRY_MAX_MS;
+        }
+        if (outboxPending(e)) pending++;
+    }
+    if (pending > 0) Serial.printf("[OUTBOX] %d alertas pendientes de antes del reinicio\n", pending);
+}
+
+static void outboxSave() {
+    // static: la bandeja es grande para el stack de la tarea
+    static AlertEvent copy[MAX_ALERTS_QUEUE];
+    portENTER_CRITICAL(&outboxMux);
+    if (!outboxDirty) {
+        portEXIT_CRITICAL(&outboxMux);
+        return;
+    }
+    memcpy(copy, outbox, sizeof(copy));
+    outboxDirty = false;
+    portEXIT_CRITICAL(&outboxMux);
+
+    outboxPrefs.begin("outbox", false);
+    outboxPrefs.putBytes("events", copy, sizeof(copy));
+    outboxPrefs.end();
+}
+
+// ============================================================================
+// ENCOLAR (loop)
+// ============================================================================
+// type y severity como en Supabase ("door", "critical"...). false si la
+// bandeja está llena de alertas más graves.
+bool outboxPost(const char* type, const char* severity, uint8_t source, const String& message) {
+    uint8_t t = tlmLookup(TLM_ALERT_TYPES, TLM_COUNT(TLM_ALERT_TYPES), type);
+    uint8_t sev = tlmLookup(TLM_SEVERITIES, TLM_COUNT(TLM_SEVERITIES), severity);
+    int16_t temp = sensorData.tempValid ? tlmCenti(sensorData.tempAvg) : TLM_NULL_I16;
+    uint32_t unixSec = deviceUnixTime();
+
+    portENTER_CRITICAL(&outboxMux);
+    outboxStats.posted++;
+
+    // Misma alerta todavía pendiente: juntar
+    for (int i = 0; i < MAX_ALERTS_QUEUE; i++) {
+        AlertEvent& e = outbox[i];
+        if (e.id == 0 || e.type != t || e.source != source || !outboxPending(e)) continue;
+        outboxCopyMessage(e.message, message);
+        e.temp = temp;
+        if (e.repeats < 0xFF) e.repeats++;
+        // Solo repeticiones/texto/temperatura: van a NVS con el próximo
+        // cambio de estado del evento, no una escritura por repetición
+        if (sev > e.severity) {
+            e.severity = sev;
+            outboxArm(e);
+            outboxDirty = true;
+        }
+        outboxStats.merged++;
+        portEXIT_CRITICAL(&outboxMux);
+        return true;
+    }
+
+    int slot = outboxFreeSlot(sev);
+    if (slot < 0) {
+        outboxStats.dropped++;
+        portEXIT_CRITICAL(&outboxMux);
+        Serial.println("[OUTBOX] ✗ Bandeja llena, alerta descartada");
+        return false;
+    }
+
+    AlertEvent& e = outbox[slot];
+    memset(&e, 0, sizeof(e));
+    e.id = outboxNextId++;
+    e.type = t;
+    e.severity = sev;
+    e.source = source;
+    e.temp = temp;
+    e.flags = ALERT_EV_THIS_BOOT;
+    e.createdUnix = unixSec;
+    e.createdAt = millis();
+    outboxCopyMessage(e.message, message);
+    for (int c = 0; c < ALERT_CH_COUNT; c++) e.channel[c].status = ALERT_DLV_SKIPPED;
+    outboxArm(e);
+    outboxDirty = true;
+    portEXIT_CRITICAL(&outboxMux);
+    return true;
+}
+
+// ============================================================================
+// ENTREGA (tarea de enlace)
+// ============================================================================
+// Segundos desde que se generó, o -1 si no se sabe (otro arranque sin hora)
+long outboxAgeSec(const AlertEvent& e) {
+    if (e.flags & ALERT_EV_THIS_BOOT) return (millis() - e.createdAt) / 1000;
+    uint32_t now = deviceUnixTime();
+    if (e.createdUnix != 0 && now >= e.createdUnix) return now - e.createdUnix;
+    return -1;
+}
+
+// Hora unix de la alerta (la de este arranque la completa si el reloj
+// sincronizó después)
+uint32_t outboxEventUnix(const AlertEvent& e) {
+    if (e.createdUnix != 0 || !(e.flags & ALERT_EV_THIS_BOOT)) return e.createdUnix;
+    uint32_t now = deviceUnixTime();
+    return now != 0 ? now - (millis() - e.createdAt) / 1000 : 0;
+}
+
+static bool outboxChannelReady(int ch) {
+    switch (ch) {
+        case ALERT_CH_TELEGRAM:
+        case ALERT_CH_SUPABASE:
+            return state.internetAvailable;
+        case ALERT_CH_SMS:
+            #ifdef SIM800_H
+            return sim800State.registered;
+            #else
+            return false;
+            #endif
+    }
+    return false;
+}
+
+static int outboxDeliver(int ch, const AlertEvent& e) {
+    switch (ch) {
+        case ALERT_CH_TELEGRAM: return telegramDeliverAlert(e);
+        case ALERT_CH_SUPABASE: return supabaseDeliverAlert(e);
+        #ifdef SIM800_H
+        case ALERT_CH_SMS:      return sim800DeliverAlert(e);
+        #endif
+    }
+    return -1;
+}
+
+// 4xx que no cambia reintentando (texto mal formado, credenciales)
+static bool outboxPermanentError(int code) {
+    return code >= 400 && code < 500 && code != 408 && code != 429;
+}
+
+// Entrega como mucho una alerta por un canal; devuelve true si intentó
+bool outboxPump() {
+    bool ready[ALERT_CH_COUNT];
+    for (int c = 0; c < ALERT_CH_COUNT; c++) ready[c] = outboxChannelReady(c);
+
+    // static: AlertEvent es grande para el stack de la tarea
+    static AlertEvent job;
+    int slot = -1, ch = -1;
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&outboxMux);
+    for (int i = 0; i < MAX_ALERTS_QUEUE; i++) {
+        const AlertEvent& e = outbox[i];
+        if (e.id == 0 || (slot >= 0 && !outboxBefore(e, outbox[slot]))) continue;
+        for (int c = 0; c < ALERT_CH_COUNT; c++) {
+            const AlertDelivery& d = e.channel[c];
+            if (d.status != ALERT_DLV_PENDING || !ready[c]) continue;
+            if (d.attempts > 0 && now - d.lastTryAt < outboxBackoffMs(d.attempts)) continue;
+            slot = i;
+            ch = c;
+            break;
+        }
+    }
+    if (slot >= 0) job = outbox[slot];
+    portEXIT_CRITICAL(&outboxMux);
+
+    if (slot < 0) {
+        outboxSave();
+        return false;
+    }
+
+    int code = outboxDeliver(ch, job);
+    bool ok = code >= 200 && code < 300;
+    uint32_t sentUnix = ok ? deviceUnixTime() : 0;
+    bool gaveUp = false;
+
+    portENTER_CRITICAL(&outboxMux);
+    AlertEvent& e = outbox[slot];
+    // Pisada mientras se entregaba: el resultado ya no corresponde
+    if (e.id == job.id) {
+        AlertDelivery& d = e.channel[ch];
+        d.lastCode = (int16_t)code;
+        d.lastTryAt = millis();
+        if (ok) {
+            d.status = ALERT_DLV_SENT;
+            d.sentUnix = sentUnix;
+            outboxStats.delivered++;
+            outboxDirty = true;
+        } else {
+            if (d.attempts < 0xFF) d.attempts++;
+            if (d.attempts >= OUTBOX_MAX_ATTEMPTS || outboxPermanentError(code)) {
+                d.status = ALERT_DLV_FAILED;
+                outboxStats.failed++;
+                outboxDirty = true;
+                gaveUp = true;
+            } else {
+                outboxStats.retries++;
+            }
+        }
+    }
+    uint8_t attempts = e.channel[ch].attempts;
+    portEXIT_CRITICAL(&outboxMux);
+
+    if (!ok) {
+        if (gaveUp) {
+            Serial.printf("[OUTBOX] ✗ Alerta #%u por %s abandonada: %d\n",
+                          (unsigned)job.id, ALERT_CHANNEL_NAMES[ch], code);
+        } else {
+            Serial.printf("[OUTBOX] ✗ Alerta #%u por %s: %d (reintento en %u s)\n",
+                          (unsigned)job.id, ALERT_CHANNEL_NAMES[ch], code,
+                          (unsigned)(outboxBackoffMs(attempts) / 1000));
+        }
+    }
+    outboxSave();
+    return true;
+}
+
+// ============================================================================
+// JSON (/api/alerts)
+// ============================================================================
+void getOutboxJSON(JsonObject& obj) {
+    // static: copia para no serializar con el mux tomado
+    static AlertEvent copy[MAX_ALERTS_QUEUE];
+    portENTER_CRITICAL(&outboxMux);
+    memcpy(copy, outbox, sizeof(copy));
+    OutboxStats s = outboxStats;
+    portEXIT_CRITICAL(&outboxMux);
+
+    int pending = 0;
+    for (const AlertEvent& e : copy) {
+        if (e.id != 0 && outboxPending(e)) pending++;
+    }
+    obj["size"] = MAX_ALERTS_QUEUE;
+    obj["pending"] = pending;
+    obj["posted"] = s.posted;
+    obj["merged"] = s.merged;
+    obj["delivered"] = s.delivered;
+    obj["retries"] = s.retries;
+    obj["failed"] = s.failed;
+    obj["evicted"] = s.evicted;
+    obj["dropped"] = s.dropped;
+
+    // De mayor a menor prioridad
+    JsonArray arr = obj.createNestedArray("events");
+    bool listed[MAX_ALERTS_QUEUE] = { false };
+    uint32_t now = millis();
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < MAX_ALERTS_QUEUE; i++) {
+            if (copy[i].id != 0 && !listed[i] && (next < 0 || outboxBefore(copy[i], copy[next]))) next = i;
+        }
+        if (next < 0) break;
+        listed[next] = true;
+        const AlertEvent& e = copy[next];
+
+        JsonObject o = arr.createNestedObject();
+        o["id"] = e.id;
+        o["type"] = TLM_ALERT_TYPES[e.type < TLM_COUNT(TLM_ALERT_TYPES) ? e.type : 0];
+        o["severity"] = TLM_SEVERITIES[e.severity < TLM_COUNT(TLM_SEVERITIES) ? e.severity : 0];
+        o["message"] = String(e.message);
+        o["repeats"] = e.repeats;
+        long age = outboxAgeSec(e);
+        if (age >= 0) o["age_sec"] = age;
+        uint32_t unixSec = outboxEventUnix(e);
+        if (unixSec != 0) o["created_unix"] = unixSec;
+
+        JsonObject channels = o.createNestedObject("channels");
+        for (int c = 0; c < ALERT_CH_COUNT; c++) {
+            const AlertDelivery& d = e.channel[c];
+            if (d.status == ALERT_DLV_SKIPPED) continue;
+            JsonObject ch = channels.createNestedObject(ALERT_CHANNEL_NAMES[c]);
+            ch["status"] = ALERT_DLV_NAMES[d.status];
+            ch["attempts"] = d.attempts;
+            if (d.attempts > 0 || d.status == ALERT_DLV_SENT) ch["last_code"] = d.lastCode;
+            if (d.sentUnix != 0) ch["delivered_unix"] = d.sentUnix;
+            if (d.status == ALERT_DLV_PENDING && d.attempts > 0) {
+                uint32_t wait = outboxBackoffMs(d.attempts);
+                uint32_t since = now - d.lastTryAt;
+                ch["retry_in_sec"] = since < wait ? (wait - since) / 1000 : 0;
+            }
+        }
+    }
+}
+
+#endif // OUTBOX_H
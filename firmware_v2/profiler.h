@@ -0,0 +1,253 @@
+/*
+ * ============================================================================
+ * PROFILER.H - PERFILADOR DE LATENCIA DEL LOOP v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Mide cada etapa de loop() (web, máquina de estados, sensores, alertas,
+ * enlace de red, Supabase...) con el contador de ciclos del CPU y guarda:
+ * - min / promedio / p99 / max por etapa
+ * - Histograma logarítmico (4 sub-buckets por octava, de 1 µs a ~16 s)
+ * - Los PERF_WORST_COUNT peores casos con su timestamp
+ *
+ * Consulta: GET /api/perf (web_api.h) o comando "perf" por Serial.
+ * Reset:    POST /api/perf/reset o comando "perf reset".
+ *
+ * El contador de ciclos (32 bits) da la vuelta cada ~17 s a 240 MHz; las
+ * etapas que superan PERF_CYCLE_WRAP_US se miden con micros().
+ *
+ * ============================================================================
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "config.h"
+#include "types.h"
+
+extern SystemState state;
+
+// ============================================================================
+// ETAPAS MEDIDAS
+// ============================================================================
+enum PerfStage {
+    PERF_WEB = 0,           // webApplyCommands() (cambios de la API web)
+    PERF_STATE_MACHINE,     // stateMachineLoop()
+    PERF_SENSORS,           // readSensors() (puertas, DHT22)
+    PERF_TEMP,              // readTempSensors() (motor DS18B20)
+    PERF_ALERTS,            // checkAlerts()
+    PERF_STATUS_PRINT,      // printStatusJSON()
+    PERF_UPLINK,            // uplinkLoop() (checkInternet() si no hay tarea)
+    PERF_HISTORY,           // updateHistory()
+    PERF_SUPABASE,          // supabaseSync()
+    PERF_LED,               // updateStatusLED()
+    PERF_BUTTON,            // checkWiFiResetButton()
+    PERF_SERIAL,            // checkSerialCommands()
+    PERF_LOOP_TOTAL,        // loop() completo (sin el delay final)
+    PERF_STAGE_COUNT
+};
+
+static const char* const PERF_STAGE_NAMES[PERF_STAGE_COUNT] = {
+    "web", "state_machine", "sensors", "temp", "alerts", "status_print",
+    "uplink", "history", "supabase", "led", "button", "serial", "loop_total"
+};
+
+#define PERF_HIST_OCTAVES       24      // 2^24 µs ≈ 16.7 s
+#define PERF_HIST_SUB           4       // Sub-buckets por octava
+#define PERF_HIST_BUCKETS       (PERF_HIST_OCTAVES * PERF_HIST_SUB + 1)
+#define PERF_CYCLE_WRAP_US      10000000UL  // Sobre esto usar micros()
+
+// ============================================================================
+// ESTRUCTURAS
+// ============================================================================
+struct PerfWorst {
+    uint32_t us;                    // Duración
+    unsigned long atMs;             // millis() al terminar la etapa
+    SystemStateEnum systemState;    // Estado del sistema en ese momento
+};
+
+struct PerfStats {
+    uint32_t count;
+    uint64_t sumCycles;
+    uint64_t minCycles;
+    uint64_t maxCycles;
+    uint32_t hist[PERF_HIST_BUCKETS];
+    PerfWorst worst[PERF_WORST_COUNT];  // Ordenados de mayor a menor
+};
+
+struct PerfMark {
+    uint32_t cycles;
+    unsigned long us;
+};
+
+// loop() escribe; /api/perf lee desde la tarea del servidor
+PerfStats perfStats[PERF_STAGE_COUNT];
+unsigned long perfResetAt = 0;
+portMUX_TYPE perfMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// HISTOGRAMA
+// ============================================================================
+// Bucket 0: < 1 µs. Luego octava o (2^o .. 2^(o+1) µs) dividida en 4 partes.
+inline int perfBucketFor(uint32_t us) {
+    if (us == 0) return 0;
+    int octave = 31 - __builtin_clz(us);
+    if (octave >= PERF_HIST_OCTAVES) return PERF_HIST_BUCKETS - 1;
+    int sub = octave >= 2 ? (us >> (octave - 2)) & 0x3 : (us << (2 - octave)) & 0x3;
+    return 1 + octave * PERF_HIST_SUB + sub;
+}
+
+// Límite superior (µs) de un bucket
+inline uint32_t perfBucketUpperUs(int bucket) {
+    if (bucket <= 0) return 1;
+    int octave = (bucket - 1) / PERF_HIST_SUB;
+    int sub = (bucket - 1) % PERF_HIST_SUB;
+    uint64_t base = 1ULL << octave;
+    return (uint32_t)(base + (base * (sub + 1)) / PERF_HIST_SUB);
+}
+
+// ============================================================================
+// MEDICIÓN
+// ============================================================================
+void perfReset() {
+    portENTER_CRITICAL(&perfMux);
+    memset(perfStats, 0, sizeof(perfStats));
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        perfStats[i].minCycles = UINT64_MAX;
+    }
+    perfResetAt = millis();
+    portEXIT_CRITICAL(&perfMux);
+}
+
+inline PerfMark perfStart() {
+    PerfMark m;
+    m.cycles = ESP.getCycleCount();
+    m.us = micros();
+    return m;
+}
+
+void perfEnd(PerfStage stage, const PerfMark& start) {
+    uint32_t cycles = ESP.getCycleCount() - start.cycles;
+    unsigned long elapsedUs = micros() - start.us;
+    uint32_t mhz = ESP.getCpuFreqMHz();
+
+    // Etapas largas: el contador de ciclos pudo dar la vuelta
+    uint64_t c = (elapsedUs >= PERF_CYCLE_WRAP_US) ? (uint64_t)elapsedUs * mhz : cycles;
+    uint32_t us = (uint32_t)(c / mhz);
+    unsigned long atMs = millis();
+
+    portENTER_CRITICAL(&perfMux);
+    PerfStats& s = perfStats[stage];
+    s.count++;
+    s.sumCycles += c;
+    if (c < s.minCycles) s.minCycles = c;
+    if (c > s.maxCycles) s.maxCycles = c;
+    s.hist[perfBucketFor(us)]++;
+
+    // Insertar en la lista de peores (ordenada, descendente)
+    if (us > s.worst[PERF_WORST_COUNT - 1].us) {
+        int pos = PERF_WORST_COUNT - 1;
+        while (pos > 0 && s.worst[pos - 1].us < us) {
+            s.worst[pos] = s.worst[pos - 1];
+            pos--;
+        }
+        s.worst[pos].us = us;
+        s.worst[pos].atMs = atMs;
+        s.worst[pos].systemState = state.currentState;
+    }
+    portEXIT_CRITICAL(&perfMux);
+}
+
+// Envuelve una llamada: PERF_RUN(PERF_SENSORS, readSensors());
+#if PERF_PROFILER_ENABLED
+#define PERF_RUN(stage, call) do { PerfMark _pm = perfStart(); call; perfEnd(stage, _pm); } while (0)
+#else
+#define PERF_RUN(stage, call) do { call; } while (0)
+#endif
+
+// ============================================================================
+// CONSULTAS
+// ============================================================================
+uint32_t perfPercentileUs(const PerfStats& s, float pct) {
+    if (s.count == 0) return 0;
+    uint32_t target = (uint32_t)ceilf(s.count * pct / 100.0f);
+    uint32_t acc = 0;
+    for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+        acc += s.hist[b];
+        if (acc >= target) {
+            // No informar más que el máximo real
+            uint32_t upper = perfBucketUpperUs(b);
+            uint32_t maxUs = (uint32_t)(s.maxCycles / ESP.getCpuFreqMHz());
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return (uint32_t)(s.maxCycles / ESP.getCpuFreqMHz());
+}
+
+void getPerfJSON(JsonObject& obj) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+
+    portENTER_CRITICAL(&perfMux);
+    unsigned long resetAt = perfResetAt;
+    portEXIT_CRITICAL(&perfMux);
+
+    obj["enabled"] = (bool)PERF_PROFILER_ENABLED;
+    obj["cpu_mhz"] = mhz;
+    obj["window_sec"] = (millis() - resetAt) / 1000;
+
+    JsonArray stages = obj.createNestedArray("stages");
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        // Copia: loop() sigue midiendo mientras se arma el JSON
+        PerfStats s;
+        portENTER_CRITICAL(&perfMux);
+        s = perfStats[i];
+        portEXIT_CRITICAL(&perfMux);
+        JsonObject st = stages.createNestedObject();
+        st["name"] = PERF_STAGE_NAMES[i];
+        st["count"] = s.count;
+        if (s.count == 0) continue;
+
+        st["min_us"] = (float)s.minCycles / mhz;
+        st["avg_us"] = (float)(s.sumCycles / s.count) / mhz;
+        st["p99_us"] = perfPercentileUs(s, 99.0f);
+        st["max_us"] = (float)s.maxCycles / mhz;
+
+        JsonArray worst = st.createNestedArray("worst");
+        for (int w = 0; w < PERF_WORST_COUNT; w++) {
+            if (s.worst[w].us == 0) break;
+            JsonObject wo = worst.createNestedObject();
+            wo["us"] = s.worst[w].us;
+            wo["at_sec"] = (s.worst[w].atMs - state.bootTime) / 1000;
+            wo["state"] = getStateName(s.worst[w].systemState);
+        }
+    }
+}
+
+void printPerfReport() {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+
+    Serial.println("\n===== PERF loop() =====");
+    Serial.printf("Ventana: %lu s\n", (millis() - perfResetAt) / 1000);
+    Serial.println("etapa            count      min_us      avg_us      p99_us      max_us  peor@seg");
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        const PerfStats& s = perfStats[i];
+        if (s.count == 0) {
+            Serial.printf("%-14s %7u           -\n", PERF_STAGE_NAMES[i], 0);
+            continue;
+        }
+        Serial.printf("%-14s %7u %11.1f %11.1f %11u %11.1f",
+                      PERF_STAGE_NAMES[i], s.count,
+                      (float)s.minCycles / mhz,
+                      (float)(s.sumCycles / s.count) / mhz,
+                      perfPercentileUs(s, 99.0f),
+                      (float)s.maxCycles / mhz);
+        if (s.worst[0].us > 0) {
+            Serial.printf("  %lu\n", (s.worst[0].atMs - state.bootTime) / 1000);
+        } else {
+            Serial.println("  -");
+        }
+    }
+    Serial.println("=======================\n");
+}
+
+#endif // PROFILER_H
@@ -0,0 +1,365 @@
+/*
+ * ============================================================================
+ * RECORDER.H - GRABADOR DE ENTRADAS EN FLASH v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Graba en la partición "trace" (partitions.csv) una traza de trace.h con
+ * todo lo que entra a la lógica de alertas y estados: cada lectura de sonda
+ * que cambia más que TRACE_TEMP_DEADBAND_C, las lecturas fallidas, los
+ * cambios de nivel de los pines de puerta y defrost, y cada saveConfig()
+ * con las reglas de alerta. trace_replay (host) la reproduce con otros
+ * umbrales.
+ *
+ * - Los registros se juntan en RAM (TRACE_BUFFER_SIZE) y se escriben en
+ *   flash al llenarse el buffer o cada TRACE_FLUSH_MS.
+ * - Anillo de sectores: al llenarse la partición se pisan los más viejos.
+ *   Cada sector abre con una clave (temperaturas, niveles) y la config.
+ * - Cada arranque abre un sector nuevo (clave con TRACE_KEY_BOOT).
+ * - Abrir un sector lo borra (~45 ms en loop(), una vez cada varias horas).
+ *
+ * Hooks (desde sensors.h, state_machine.h y storage.h): recorderProbe,
+ * recorderProbeFail, recorderInput, recorderConfig. Descarga en GET
+ * /api/trace (sectores del más viejo al actual).
+ *
+ * ============================================================================
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <esp_partition.h>
+#include <esp_http_server.h>
+#include "config.h"
+#include "types.h"
+#include "trace.h"
+
+extern Config config;
+extern SensorData sensorData;
+extern uint32_t deviceUnixTime();
+extern void webStateLock();
+extern void webStateUnlock();
+extern esp_err_t sendJsonText(httpd_req_t* req, int code, const char* json);
+
+// ============================================================================
+// TIPOS
+// ============================================================================
+struct Recorder {
+    const esp_partition_t* part;
+    bool ready;
+    uint16_t sectors;
+    uint16_t boot;                      // Arranque actual (va en cada sector)
+    uint16_t head;                      // Sector en escritura
+    uint32_t headNumber;                // Crece en cada sector abierto
+    uint16_t offset;                    // Próxima escritura en flash del sector
+    uint8_t buf[TRACE_BUFFER_SIZE];     // Registros todavía en RAM
+    uint16_t used;
+    unsigned long flushedAt;
+    TraceEncoder enc;
+    int16_t temp[TRACE_MAX_PROBES];     // Último valor grabado (TRACE_TEMP_NULL = falla)
+    uint8_t inputs;                     // Último nivel grabado de cada entrada
+    uint8_t inputsKnown;
+    // Contadores
+    uint32_t records;
+    uint32_t bytes;
+    uint32_t sectorsOpened;
+    uint32_t writeErrors;
+};
+
+// Sectores a descargar (anillo contiguo que termina en la cabeza)
+struct RecorderView {
+    uint16_t first;
+    uint16_t count;
+    uint16_t tail;                      // Bytes del último sector
+};
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+Recorder recorder;
+
+// ============================================================================
+// FLASH
+// ============================================================================
+bool recorderReadHdr(uint16_t sector, uint16_t& boot, uint32_t& number) {
+    uint8_t hdr[TRACE_SECTOR_HDR];
+    if (esp_partition_read(recorder.part, (uint32_t)sector * TRACE_SECTOR_SIZE, hdr, sizeof(hdr)) != ESP_OK) {
+        return false;
+    }
+    uint8_t version;                    // Los de versión 1 siguen en el anillo
+    return traceReadSectorHdr(hdr, boot, number, version);
+}
+
+void recorderFlush() {
+    if (recorder.used == 0) return;
+    uint32_t addr = (uint32_t)recorder.head * TRACE_SECTOR_SIZE + recorder.offset;
+    if (esp_partition_write(recorder.part, addr, recorder.buf, recorder.used) != ESP_OK) {
+        recorder.writeErrors++;
+    }
+    recorder.offset += recorder.used;
+    recorder.bytes += recorder.used;
+    recorder.used = 0;
+    recorder.flushedAt = millis();
+}
+
+// ============================================================================
+// REGISTROS
+// ============================================================================
+void recorderPut(const uint8_t* rec, size_t len) {
+    if (recorder.used + len > sizeof(recorder.buf)) recorderFlush();
+    memcpy(recorder.buf + recorder.used, rec, len);
+    recorder.used += len;
+    recorder.records++;
+}
+
+void recorderPutKey(uint8_t flags) {
+    TraceKey k;
+    k.uptimeMs = millis();
+    k.unixSec = deviceUnixTime();
+    k.probeCount = (uint8_t)(sensorData.tempSensorCount < TRACE_MAX_PROBES ? sensorData.tempSensorCount : TRACE_MAX_PROBES);
+    for (int i = 0; i < TRACE_MAX_PROBES; i++) k.temp[i] = recorder.temp[i];
+    k.inputs = recorder.inputs;
+
+    uint8_t rec[TRACE_RECORD_MAX];
+    recorderPut(rec, traceEncodeKey(recorder.enc, rec, flags, k));
+}
+
+void recorderPutConfig(uint8_t flags) {
+    TraceConfig c;
+    c.tempMax = tlmCenti(config.tempMax);
+    c.tempCritical = tlmCenti(config.tempCritical);
+    c.alertDelaySec = config.alertDelaySec;
+    c.doorOpenMaxSec = config.doorOpenMaxSec;
+    c.defrostCooldownSec = config.defrostCooldownSec;
+    c.defrostMaxDurationSec = config.defrostMaxDurationSec;
+    c.configApplyTimeSec = config.configApplyTimeSec;
+    c.flags = (config.defrostRelayNC ? TRACE_CFG_DEFROST_NC : 0) |
+              (config.simulationMode ? TRACE_CFG_SIMULATION : 0) |
+              (config.relayEnabled ? TRACE_CFG_RELAY : 0);
+    c.probeEnabled = 0;
+    for (int i = 0; i < MAX_TEMP_SENSORS && i < TRACE_MAX_PROBES; i++) {
+        if (config.tempSensorEnabled[i]) c.probeEnabled |= 1 << i;
+    }
+    c.doorEnabled = 0;
+    for (int i = 0; i < MAX_DOOR_SENSORS; i++) {
+        if (config.doorEnabled[i]) c.doorEnabled |= 1 << i;
+    }
+    c.ruleCount = config.ruleCount < TRACE_MAX_RULES ? config.ruleCount : TRACE_MAX_RULES;
+    c.interiorProbes = config.interiorProbes;
+    c.trendHorizonMin = config.trendHorizonMin;
+
+    uint32_t now = millis();
+    uint8_t rec[TRACE_RECORD_MAX];
+    recorderPut(rec, traceEncodeConfig(recorder.enc, rec, flags, now, c));
+
+    for (int i = 0; i < c.ruleCount; i++) {
+        const AlertRule& r = config.rules[i];
+        TraceRule t = { r.signal, r.index, r.kind, r.flags, r.threshold, r.hysteresis,
+                        r.durationSec, r.repeatSec };
+        recorderPut(rec, traceEncodeRule(recorder.enc, rec, (uint8_t)i, now, t));
+    }
+}
+
+// Borra y abre un sector; empieza con clave y config para decodificarse solo
+void recorderOpenSector(uint16_t sector, uint8_t keyFlags) {
+    recorderFlush();
+    esp_partition_erase_range(recorder.part, (uint32_t)sector * TRACE_SECTOR_SIZE, TRACE_SECTOR_SIZE);
+
+    recorder.head = sector;
+    recorder.headNumber++;
+    recorder.offset = 0;
+    traceWriteSectorHdr(recorder.buf, recorder.boot, recorder.headNumber);
+    recorder.used = TRACE_SECTOR_HDR;
+    recorder.sectorsOpened++;
+
+    recorderPutKey(keyFlags);
+    recorderPutConfig(0);
+}
+
+// Lugar para bytes más en el sector; si no, el siguiente
+bool recorderReserve(size_t bytes = TRACE_RECORD_MAX) {
+    if (!recorder.ready) return false;
+    if (recorder.offset + recorder.used + bytes > TRACE_SECTOR_SIZE) {
+        recorderOpenSector((uint16_t)((recorder.head + 1) % recorder.sectors), 0);
+    }
+    return true;
+}
+
+// ============================================================================
+// HOOKS
+// ============================================================================
+// Lectura válida de una sonda (tempReadProbe)
+void recorderProbe(int probe, float tempC) {
+    if (probe >= TRACE_MAX_PROBES) return;
+    int16_t t = traceTemp16(tempC);
+    int16_t last = recorder.temp[probe];
+    const int deadband = (int)(TRACE_TEMP_DEADBAND_C * 16 + 0.5f);
+    if (last != TRACE_TEMP_NULL && abs(t - last) < deadband) return;
+    if (!recorderReserve()) return;
+
+    uint8_t rec[TRACE_RECORD_MAX];
+    recorderPut(rec, traceEncodeProbe(recorder.enc, rec, millis(), (uint8_t)probe, t));
+    recorder.temp[probe] = t;
+}
+
+// Lectura fallida con todos los reintentos; solo la primera de una racha
+void recorderProbeFail(int probe) {
+    if (probe >= TRACE_MAX_PROBES || recorder.temp[probe] == TRACE_TEMP_NULL) return;
+    if (!recorderReserve()) return;
+
+    uint8_t rec[TRACE_RECORD_MAX];
+    recorderPut(rec, traceEncodeProbeFail(recorder.enc, rec, millis(), (uint8_t)probe));
+    recorder.temp[probe] = TRACE_TEMP_NULL;
+}
+
+// Nivel leído de una entrada digital (TRACE_IN_*); solo los cambios
+void recorderInput(uint8_t input, bool level) {
+    uint8_t bit = 1 << input;
+    if ((recorder.inputsKnown & bit) && ((recorder.inputs & bit) != 0) == level) return;
+    if (!recorderReserve()) return;
+
+    uint8_t rec[TRACE_RECORD_MAX];
+    recorderPut(rec, traceEncodeInput(recorder.enc, rec, millis(), input, level));
+    recorder.inputsKnown |= bit;
+    if (level) recorder.inputs |= bit;
+    else recorder.inputs &= ~bit;
+}
+
+// Configuración guardada (saveConfig), con sus reglas
+void recorderConfig() {
+    if (!recorderReserve(TRACE_RECORD_MAX * (1 + (size_t)config.ruleCount))) return;
+    recorderPutConfig(TRACE_CONFIG_SAVED);
+}
+
+// ============================================================================
+// INICIALIZACIÓN Y LOOP
+// ============================================================================
+// Después de initSensors(): la clave de arranque lleva la primera lectura
+bool recorderInit() {
+    memset(&recorder, 0, sizeof(recorder));
+
+    #if TRACE_ENABLED
+    recorder.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                             TRACE_PARTITION_LABEL);
+    #endif
+    if (!recorder.part || recorder.part->size / TRACE_SECTOR_SIZE < 2) {
+        Serial.println("[TRACE] Sin partición 'trace': grabador deshabilitado");
+        return false;
+    }
+    recorder.sectors = (uint16_t)(recorder.part->size / TRACE_SECTOR_SIZE);
+
+    // Sector más nuevo: el de este arranque va a continuación
+    int newest = -1;
+    uint16_t boot;
+    uint32_t number;
+    for (uint16_t s = 0; s < recorder.sectors; s++) {
+        if (recorderReadHdr(s, boot, number) && (newest < 0 || number > recorder.headNumber)) {
+            newest = s;
+            recorder.headNumber = number;
+            recorder.boot = boot;
+        }
+    }
+    if (newest >= 0) recorder.boot++;
+
+    // Estado inicial de las entradas (la clave lo lleva completo)
+    for (int i = 0; i < TRACE_MAX_PROBES; i++) {
+        bool valid = i < sensorData.tempSensorCount && sensorData.temp[i].valid;
+        recorder.temp[i] = valid ? traceTemp16(sensorData.temp[i].value) : TRACE_TEMP_NULL;
+    }
+    for (int i = 0; i < MAX_DOOR_SENSORS; i++) {
+        if (digitalRead(DOOR_PINS[i]) == HIGH) recorder.inputs |= 1 << (TRACE_IN_DOOR_1 + i);
+    }
+    if (digitalRead(PIN_DEFROST_INPUT) == HIGH) recorder.inputs |= 1 << TRACE_IN_DEFROST;
+    recorder.inputsKnown = (1 << TRACE_MAX_INPUTS) - 1;
+
+    recorder.ready = true;
+    recorderOpenSector(newest < 0 ? 0 : (uint16_t)((newest + 1) % recorder.sectors), TRACE_KEY_BOOT);
+    recorderFlush();
+
+    Serial.printf("[TRACE] Grabando en sector %u/%u (arranque %u)\n",
+                  recorder.head, recorder.sectors, recorder.boot);
+    return true;
+}
+
+// Desde loop(): lo pendiente en RAM no espera más de TRACE_FLUSH_MS
+void recorderLoop() {
+    if (recorder.ready && recorder.used > 0 && millis() - recorder.flushedAt >= TRACE_FLUSH_MS) {
+        recorderFlush();
+    }
+}
+
+void printRecorderStats() {
+    Serial.printf("[TRACE] %s | sector %u/%u n°%lu | arranque %u\n",
+                  recorder.ready ? "grabando" : "deshabilitado",
+                  recorder.head, recorder.sectors, (unsigned long)recorder.headNumber, recorder.boot);
+    Serial.printf("[TRACE] %lu registros, %lu bytes en flash, %u en RAM, %lu sectores, %lu errores\n",
+                  (unsigned long)recorder.records, (unsigned long)recorder.bytes, recorder.used,
+                  (unsigned long)recorder.sectorsOpened, (unsigned long)recorder.writeErrors);
+}
+
+// ============================================================================
+// DESCARGA
+// ============================================================================
+// Con el estado bloqueado: escribe lo pendiente y fija qué sectores enviar
+bool recorderSnapshot(RecorderView& v) {
+    if (!recorder.ready) return false;
+    recorderFlush();
+
+    v.first = recorder.head;
+    v.count = 1;
+    v.tail = recorder.offset;
+    uint32_t expected = recorder.headNumber;
+    while (v.count < recorder.sectors) {
+        uint16_t prev = (uint16_t)((v.first + recorder.sectors - 1) % recorder.sectors);
+        uint16_t boot;
+        uint32_t number;
+        if (!recorderReadHdr(prev, boot, number) || number != expected - 1) break;
+        v.first = prev;
+        v.count++;
+        expected = number;
+    }
+    return true;
+}
+
+// Sectores del más viejo al actual, de a WEB_CHUNK_SIZE bytes. Si el anillo
+// pisa un sector durante la descarga llega borrado y el decodificador lo salta.
+template <typename Sink>
+void recorderExport(const RecorderView& v, Sink sink) {
+    uint8_t chunk[WEB_CHUNK_SIZE];
+    for (uint16_t k = 0; k < v.count; k++) {
+        uint32_t base = (uint32_t)((v.first + k) % recorder.sectors) * TRACE_SECTOR_SIZE;
+        uint32_t len = k == v.count - 1 ? v.tail : TRACE_SECTOR_SIZE;
+        for (uint32_t off = 0; off < len; off += sizeof(chunk)) {
+            size_t n = min((uint32_t)sizeof(chunk), len - off);
+            if (esp_partition_read(recorder.part, base + off, chunk, n) != ESP_OK) memset(chunk, 0xFF, n);
+            sink(chunk, n);
+        }
+    }
+}
+
+// ============================================================================
+// HANDLER: GET /api/trace
+// ============================================================================
+// Por partes: el largo se conoce, pero httpd no envía cuerpos con
+// Content-Length de a pedazos
+esp_err_t handleApiTrace(httpd_req_t* req) {
+    RecorderView v;
+    webStateLock();
+    bool ok = recorderSnapshot(v);
+    webStateUnlock();
+    if (!ok) {
+        return sendJsonText(req, 404, "{\"error\":\"Trace disabled\"}");
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+    bool failed = false;
+    recorderExport(v, [req, &failed](const uint8_t* data, size_t len) {
+        if (!failed && httpd_resp_send_chunk(req, (const char*)data, len) != ESP_OK) failed = true;
+    });
+    if (failed || httpd_resp_send_chunk(req, NULL, 0) != ESP_OK) return ESP_FAIL;
+    return ESP_OK;
+}
+
+#endif // RECORDER_H
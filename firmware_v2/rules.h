@@ -0,0 +1,510 @@
+/*
+ * ============================================================================
+ * RULES.H - MOTOR DE REGLAS DE ALERTA
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Cada regla de config.rules mira una señal y dispara cuando la condición
+ * se sostiene:
+ *
+ *   señal:      probe (sonda N), door (puerta N, 1 = abierta), interior
+ *               (promedio de las sondas de config.interiorProbes), ambient
+ *               y humidity (DHT22)
+ *   tipo:       above (valor > umbral), below (valor < umbral), rise
+ *               (subida en °C/min sobre RULE_RATE_WINDOW_MS > umbral),
+ *               trend (según la tendencia de trend.h, la señal llega al
+ *               umbral en menos de config.trendHorizonMin; solo sondas e
+ *               interior, histéresis en minutos)
+ *   histéresis: una vez cumplida, la condición sigue hasta cruzar
+ *               umbral ∓ histéresis; el ruido en el umbral no reinicia
+ *               la espera
+ *   duración:   segundos sostenida antes de disparar
+ *   repetir:    re-avisar cada N seg mientras siga activa (0 = una vez)
+ *   crítica:    triggerAlert() (estado ALERT, sirena); si no, aviso por
+ *               la bandeja de salida (outbox.h)
+ *   defaults:   umbral temp_critical y duración alert_delay_sec de la
+ *               config (door_open_max_sec en puertas), así la web y la app
+ *               siguen ajustando la regla de siempre
+ *
+ * El estado de las reglas es un arreglo fijo paralelo a config.rules;
+ * evaluar una regla es O(1) y los String se arman recién al disparar.
+ * Las reglas de fábrica (rulesSetDefaults) hacen lo mismo que alerts.h
+ * antes (interior > temp_critical crítica y una por puerta) más un aviso
+ * de tendencia del interior hacia temp_critical.
+ *
+ * Cada sonda y el interior tienen su estimador de tendencia, actualizado
+ * en cada evaluación y reiniciado junto con las reglas (un defrost no
+ * cuenta como subida).
+ *
+ * ============================================================================
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <ArduinoJson.h>
+#include "config.h"
+#include "types.h"
+#include "trend.h"
+#include "outbox.h"
+
+extern Config config;
+extern SensorData sensorData;
+extern SystemState state;
+
+extern void triggerAlert(String message, bool critical, uint8_t source, const char* type);
+
+const char* const RULE_SIGNAL_NAMES[RULE_SIG_COUNT] = {
+    "probe", "door", "interior", "ambient", "humidity"
+};
+
+const char* const RULE_KIND_NAMES[RULE_KIND_COUNT] = {
+    "above", "below", "rise", "trend"
+};
+
+struct RuleState {
+    unsigned long since;            // millis() desde que se cumple la condición
+    unsigned long notifiedAt;       // Último aviso
+    unsigned long rateRefAt;        // Inicio de la ventana (rise)
+    float rateRefValue;
+    float rate;                     // °C/min de la ventana (rise) o la tendencia (trend)
+    float eta;                      // Minutos hasta el umbral (trend), -1 = no llega
+    float value;                    // Último valor de la señal
+    bool valid;                     // Hubo lectura de la señal
+    bool held;                      // La condición se cumple desde 'since'
+    bool active;                    // Disparada y sin despejar
+    uint32_t fires;
+};
+
+static RuleState ruleState[MAX_ALERT_RULES];
+
+// Tendencia de cada sonda y del interior
+#define TREND_INTERIOR      MAX_TEMP_SENSORS
+#define TREND_TAU_MIN       (TREND_TAU_SEC / 60.0f)
+static TrendEstimator trend[MAX_TEMP_SENSORS + 1];
+
+// Temperatura interior de esta evaluación
+static float rulesInterior = 0;
+static bool rulesInteriorValid = false;
+
+// ============================================================================
+// REGLAS DE FÁBRICA
+// ============================================================================
+void rulesSetDefaults(Config& c) {
+    memset(c.rules, 0, sizeof(c.rules));
+
+    AlertRule& temp = c.rules[0];
+    temp.signal = RULE_SIG_INTERIOR;
+    temp.kind = RULE_ABOVE;
+    temp.flags = RULE_F_ENABLED | RULE_F_CRITICAL | RULE_F_DEFAULTS;
+
+    // Aviso temprano: el interior llega a temp_critical antes del horizonte
+    AlertRule& early = c.rules[1];
+    early.signal = RULE_SIG_INTERIOR;
+    early.kind = RULE_TREND;
+    early.flags = RULE_F_ENABLED | RULE_F_DEFAULTS;
+    early.hysteresis = 5;
+    early.durationSec = 60;
+
+    for (int i = 0; i < MAX_DOOR_SENSORS; i++) {
+        AlertRule& door = c.rules[2 + i];
+        door.signal = RULE_SIG_DOOR;
+        door.index = i;
+        door.kind = RULE_ABOVE;
+        door.threshold = 0.5;
+        door.flags = RULE_F_ENABLED | RULE_F_DEFAULTS;
+        door.repeatSec = DEFAULT_DOOR_REPEAT_SEC;
+    }
+    c.ruleCount = 2 + MAX_DOOR_SENSORS;
+    c.trendHorizonMin = DEFAULT_TREND_HORIZON_MIN;
+}
+
+// Al volver de DEFROST/COOLDOWN/LOADING_CONFIG (stateDispatch) las reglas
+// esperan su duración desde cero. Una demora de loop() no las toca.
+void rulesReset() {
+    memset(ruleState, 0, sizeof(ruleState));
+    for (int i = 0; i <= TREND_INTERIOR; i++) trendReset(trend[i]);
+}
+
+// ============================================================================
+// SEÑALES
+// ============================================================================
+inline float ruleThreshold(const AlertRule& r) {
+    bool defaults = (r.flags & RULE_F_DEFAULTS) && (r.kind == RULE_ABOVE || r.kind == RULE_TREND) &&
+                    r.signal != RULE_SIG_DOOR;
+    return defaults ? config.tempCritical : r.threshold;
+}
+
+// En trend la duración es siempre la propia (alert_delay_sec anularía el aviso temprano)
+inline unsigned long ruleDurationSec(const AlertRule& r) {
+    if (!(r.flags & RULE_F_DEFAULTS) || r.kind == RULE_TREND) return r.durationSec;
+    return r.signal == RULE_SIG_DOOR ? config.doorOpenMaxSec : config.alertDelaySec;
+}
+
+// Estimador de la señal de una regla trend (-1 = la señal no tiene)
+inline int ruleTrendIndex(const AlertRule& r) {
+    if (r.signal == RULE_SIG_PROBE && r.index < MAX_TEMP_SENSORS) return r.index;
+    if (r.signal == RULE_SIG_INTERIOR) return TREND_INTERIOR;
+    return -1;
+}
+
+// Promedio de las sondas interiores. Si ninguna de ellas está habilitada
+// (instalación con otra numeración) se usa el promedio de todas.
+static void rulesUpdateInterior() {
+    float sum = 0;
+    int enabled = 0, valid = 0;
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+        if (!(config.interiorProbes & (1 << i)) || !sensorData.temp[i].enabled) continue;
+        enabled++;
+        if (!sensorData.temp[i].valid) continue;
+        sum += sensorData.temp[i].value;
+        valid++;
+    }
+    if (enabled == 0) {
+        rulesInterior = sensorData.tempAvg;
+        rulesInteriorValid = sensorData.tempValid;
+    } else {
+        rulesInterior = valid > 0 ? sum / valid : 0;
+        rulesInteriorValid = valid > 0;
+    }
+}
+
+static void rulesUpdateTrends(unsigned long now) {
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+        const TempSensor& s = sensorData.temp[i];
+        if (s.enabled && s.valid) trendUpdate(trend[i], s.value, now, TREND_TAU_MIN);
+    }
+    if (rulesInteriorValid) trendUpdate(trend[TREND_INTERIOR], rulesInterior, now, TREND_TAU_MIN);
+}
+
+// Minutos hasta target según la tendencia; -1 si no llega, si ya llegó o
+// si el ajuste no es confiable todavía
+static float trendEtaMin(int t, float target, TrendFit& fit) {
+    if (!trendFit(trend[t], TREND_TAU_MIN, fit) || fit.confidence < TREND_MIN_CONFIDENCE) return -1;
+    return trendMinutesTo(fit, target, TREND_MIN_SLOPE_C_MIN);
+}
+
+static bool ruleSignal(const AlertRule& r, float& v) {
+    switch (r.signal) {
+        case RULE_SIG_PROBE: {
+            if (r.index >= MAX_TEMP_SENSORS) return false;
+            const TempSensor& s = sensorData.temp[r.index];
+            if (!s.enabled || !s.valid) return false;
+            v = s.value;
+            return true;
+        }
+        case RULE_SIG_DOOR: {
+            if (r.index >= MAX_DOOR_SENSORS || !sensorData.door[r.index].enabled) return false;
+            v = sensorData.door[r.index].isOpen ? 1 : 0;
+            return true;
+        }
+        case RULE_SIG_INTERIOR:
+            v = rulesInterior;
+            return rulesInteriorValid;
+        case RULE_SIG_AMBIENT:
+            if (!config.dht22Enabled || !sensorData.dhtValid) return false;
+            v = sensorData.tempAmbient;
+            return true;
+        case RULE_SIG_HUMIDITY:
+            if (!config.dht22Enabled || !sensorData.dhtValid) return false;
+            v = sensorData.humidity;
+            return true;
+    }
+    return false;
+}
+
+// Subida sobre una ventana fija, como tempUpdateRate() en sensors.h
+static void ruleUpdateRate(RuleState& st, float v, unsigned long now) {
+    if (st.rateRefAt == 0) {
+        st.rateRefValue = v;
+        st.rateRefAt = now;
+        return;
+    }
+    unsigned long span = now - st.rateRefAt;
+    if (span < RULE_RATE_WINDOW_MS) return;
+    st.rate = (v - st.rateRefValue) * 60000.0f / span;
+    st.rateRefValue = v;
+    st.rateRefAt = now;
+}
+
+// ============================================================================
+// DISPARO (único lugar con String)
+// ============================================================================
+static String ruleLabel(const AlertRule& r) {
+    switch (r.signal) {
+        case RULE_SIG_PROBE:    return "Sonda " + String(sensorData.temp[r.index].name);
+        case RULE_SIG_AMBIENT:  return "Temp. ambiente";
+        case RULE_SIG_HUMIDITY: return "Humedad";
+        default:                return "Temperatura";
+    }
+}
+
+static String ruleMessage(const AlertRule& r, const RuleState& st, unsigned long heldMs) {
+    if (r.signal == RULE_SIG_DOOR) {
+        const DoorSensor& d = sensorData.door[r.index];
+        unsigned long sec = d.isOpen && d.openSince > 0 ? (millis() - d.openSince) / 1000 : heldMs / 1000;
+        String msg = "🚪 Puerta " + String(d.name);
+        msg += r.kind == RULE_BELOW ? " cerrada por " : " abierta por ";
+        msg += String(sec / 60) + " minutos";
+        msg += " (máximo: " + String(ruleDurationSec(r) / 60) + " min)";
+        return msg;
+    }
+
+    float thr = ruleThreshold(r);
+    if (r.kind == RULE_TREND) {
+        TrendFit fit;
+        int t = ruleTrendIndex(r);
+        float confidence = t >= 0 && trendFit(trend[t], TREND_TAU_MIN, fit) ? fit.confidence : 0;
+        String msg = "📈 " + ruleLabel(r) + " en tendencia a crítica: " + String(st.value, 1) + "°C";
+        msg += ", subiendo " + String(st.rate, 2) + "°C/min";
+        msg += ". Llega a " + String(thr, 1) + "°C en ~" + String((int)(st.eta + 0.5f)) + " min";
+        msg += " (confianza " + String((int)(confidence * 100)) + "%)";
+        return msg;
+    }
+    if (r.kind == RULE_RISE) {
+        String msg = "📈 " + ruleLabel(r) + " subiendo " + String(st.rate, 2) + "°C/min";
+        msg += " (límite: " + String(thr, 2) + "°C/min)";
+        return msg;
+    }
+
+    const char* unit = r.signal == RULE_SIG_HUMIDITY ? "%" : "°C";
+    const char* level = r.kind == RULE_BELOW ? " BAJA: " : (r.flags & RULE_F_CRITICAL) ? " CRÍTICA: " : " ALTA: ";
+    String msg = String(r.signal == RULE_SIG_HUMIDITY ? "💧 " : "🌡️ ") + ruleLabel(r) + level;
+    msg += String(st.value, 1) + unit;
+    msg += " (límite: " + String(thr, 1) + unit + ")";
+    msg += " - Sostenida por " + String(heldMs / 60000) + " min";
+    return msg;
+}
+
+static void ruleFire(const AlertRule& r, const RuleState& st, unsigned long heldMs) {
+    String msg = ruleMessage(r, st, heldMs);
+    bool door = r.signal == RULE_SIG_DOOR;
+    const char* type = door ? "door" : r.signal == RULE_SIG_HUMIDITY ? "humidity" : "temperature";
+
+    if (r.flags & RULE_F_CRITICAL) {
+        triggerAlert(msg, true, ALERT_SOURCE(r.signal, r.index), type);
+        return;
+    }
+
+    outboxPost(type, "warning", ALERT_SOURCE(r.signal, r.index), msg);
+    Serial.println((door ? "⚠️ [PUERTA] " : "⚠️ [REGLA] ") + msg);
+}
+
+// ============================================================================
+// EVALUACIÓN (llamar desde checkAlerts)
+// ============================================================================
+// Devuelve true si alguna regla crítica sigue activa
+bool rulesEvaluate() {
+    unsigned long now = millis();
+    bool anyCritical = false;
+
+    rulesUpdateInterior();
+    rulesUpdateTrends(now);
+
+    for (int i = 0; i < config.ruleCount && i < MAX_ALERT_RULES; i++) {
+        const AlertRule& r = config.rules[i];
+        RuleState& st = ruleState[i];
+        if (!(r.flags & RULE_F_ENABLED)) continue;
+
+        // Sin lectura la regla queda como estaba
+        float v;
+        st.valid = ruleSignal(r, v);
+        if (!st.valid) {
+            if (st.active && (r.flags & RULE_F_CRITICAL)) anyCritical = true;
+            continue;
+        }
+        st.value = v;
+        if (r.kind == RULE_RISE) {
+            ruleUpdateRate(st, v, now);
+            v = st.rate;
+        }
+
+        float thr = ruleThreshold(r);
+        float margin = st.held ? r.hysteresis : 0;
+        bool holds;
+        if (r.kind == RULE_TREND) {
+            int t = ruleTrendIndex(r);
+            TrendFit fit;
+            st.eta = t >= 0 ? trendEtaMin(t, thr, fit) : -1;
+            st.rate = st.eta >= 0 ? fit.slope : 0;
+            holds = st.eta >= 0 && st.eta < config.trendHorizonMin + margin;
+        } else {
+            holds = r.kind == RULE_BELOW ? v < thr + margin : v > thr - margin;
+        }
+
+        if (!holds) {
+            if (st.active) {
+                Serial.printf("[REGLA] %d despejada (%s %s)\n", i,
+                              RULE_SIGNAL_NAMES[r.signal], RULE_KIND_NAMES[r.kind]);
+            }
+            st.held = false;
+            st.active = false;
+            continue;
+        }
+        if (!st.held) {
+            st.held = true;
+            st.since = now;
+        }
+
+        unsigned long heldMs = now - st.since;
+        if (!st.active) {
+            if (heldMs >= ruleDurationSec(r) * 1000UL) {
+                st.active = true;
+                st.fires++;
+                st.notifiedAt = now;
+                ruleFire(r, st, heldMs);
+            }
+        } else if (r.repeatSec > 0 && now - st.notifiedAt >= r.repeatSec * 1000UL) {
+            st.notifiedAt = now;
+            ruleFire(r, st, heldMs);
+        }
+        if (st.active && (r.flags & RULE_F_CRITICAL)) anyCritical = true;
+    }
+    return anyCritical;
+}
+
+// Segundos que lleva cumpliéndose la regla i (0 = no se cumple)
+unsigned long ruleHeldSec(int i) {
+    if (i < 0 || i >= MAX_ALERT_RULES || !ruleState[i].held) return 0;
+    return (millis() - ruleState[i].since) / 1000;
+}
+
+// Primera regla crítica "interior above" habilitada (la alerta de
+// temperatura de siempre), -1 si no hay
+int rulesInteriorRule() {
+    for (int i = 0; i < config.ruleCount && i < MAX_ALERT_RULES; i++) {
+        const AlertRule& r = config.rules[i];
+        if ((r.flags & RULE_F_ENABLED) && (r.flags & RULE_F_CRITICAL) &&
+            r.signal == RULE_SIG_INTERIOR && r.kind == RULE_ABOVE) return i;
+    }
+    return -1;
+}
+
+// ============================================================================
+// JSON (/api/config y /api/alerts)
+// ============================================================================
+void getRulesConfigJSON(JsonObject& obj, const Config& c) {
+    JsonArray interior = obj.createNestedArray("interior_probes");
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+        if (c.interiorProbes & (1 << i)) interior.add(i);
+    }
+
+    obj["trend_horizon_min"] = c.trendHorizonMin;
+
+    JsonArray rules = obj.createNestedArray("rules");
+    for (int i = 0; i < c.ruleCount && i < MAX_ALERT_RULES; i++) {
+        const AlertRule& r = c.rules[i];
+        JsonObject o = rules.createNestedObject();
+        o["signal"] = RULE_SIGNAL_NAMES[r.signal];
+        if (r.signal == RULE_SIG_PROBE || r.signal == RULE_SIG_DOOR) o["index"] = r.index;
+        o["kind"] = RULE_KIND_NAMES[r.kind];
+        o["threshold"] = r.threshold;
+        o["hysteresis"] = r.hysteresis;
+        o["duration_sec"] = r.durationSec;
+        o["repeat_sec"] = r.repeatSec;
+        o["critical"] = (r.flags & RULE_F_CRITICAL) != 0;
+        o["enabled"] = (r.flags & RULE_F_ENABLED) != 0;
+        o["defaults"] = (r.flags & RULE_F_DEFAULTS) != 0;
+    }
+}
+
+static int ruleLookup(const char* const* names, int count, const char* name) {
+    if (!name) return -1;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// Reemplaza la lista completa. Devuelve nullptr o el motivo del rechazo
+// (c queda sin tocar).
+const char* parseRulesJSON(JsonArray arr, Config& c) {
+    if (arr.size() > MAX_ALERT_RULES) return "too many rules";
+
+    AlertRule rules[MAX_ALERT_RULES];
+    memset(rules, 0, sizeof(rules));
+    int count = 0;
+
+    for (JsonVariant item : arr) {
+        JsonObject o = item.as<JsonObject>();
+        if (o.isNull()) return "rule must be an object";
+        AlertRule& r = rules[count++];
+
+        int signal = ruleLookup(RULE_SIGNAL_NAMES, RULE_SIG_COUNT, o["signal"].as<const char*>());
+        if (signal < 0) return "unknown rule signal";
+        int kind = o.containsKey("kind") ? ruleLookup(RULE_KIND_NAMES, RULE_KIND_COUNT, o["kind"].as<const char*>()) : RULE_ABOVE;
+        if (kind < 0) return "unknown rule kind";
+        int index = o.containsKey("index") ? o["index"].as<int>() : 0;
+        int maxIndex = signal == RULE_SIG_PROBE ? MAX_TEMP_SENSORS : signal == RULE_SIG_DOOR ? MAX_DOOR_SENSORS : 1;
+        if (index < 0 || index >= maxIndex) return "rule index out of range";
+        if (kind == RULE_TREND && signal != RULE_SIG_PROBE && signal != RULE_SIG_INTERIOR) {
+            return "trend rules need a probe or interior signal";
+        }
+        long duration = o.containsKey("duration_sec") ? o["duration_sec"].as<long>() : 0;
+        long repeat = o.containsKey("repeat_sec") ? o["repeat_sec"].as<long>() : 0;
+        if (duration < 0 || duration > 65535 || repeat < 0 || repeat > 65535) return "rule time out of range";
+        float hysteresis = o.containsKey("hysteresis") ? o["hysteresis"].as<float>() : 0;
+        if (hysteresis < 0) return "negative hysteresis";
+
+        r.signal = signal;
+        r.index = index;
+        r.kind = kind;
+        r.threshold = o["threshold"].as<float>();
+        r.hysteresis = hysteresis;
+        r.durationSec = duration;
+        r.repeatSec = repeat;
+        if (!o.containsKey("enabled") || o["enabled"].as<bool>()) r.flags |= RULE_F_ENABLED;
+        if (o["critical"].as<bool>()) r.flags |= RULE_F_CRITICAL;
+        if (o["defaults"].as<bool>()) r.flags |= RULE_F_DEFAULTS;
+    }
+
+    memcpy(c.rules, rules, sizeof(rules));
+    c.ruleCount = count;
+    return nullptr;
+}
+
+// Estado de cada regla (para getAlertsJSON)
+void getRulesStateJSON(JsonArray& arr) {
+    for (int i = 0; i < config.ruleCount && i < MAX_ALERT_RULES; i++) {
+        const AlertRule& r = config.rules[i];
+        const RuleState& st = ruleState[i];
+        JsonObject o = arr.createNestedObject();
+        o["signal"] = RULE_SIGNAL_NAMES[r.signal];
+        if (r.signal == RULE_SIG_PROBE || r.signal == RULE_SIG_DOOR) o["index"] = r.index;
+        o["kind"] = RULE_KIND_NAMES[r.kind];
+        o["enabled"] = (r.flags & RULE_F_ENABLED) != 0;
+        o["threshold"] = ruleThreshold(r);
+        o["duration_sec"] = ruleDurationSec(r);
+        if (st.valid) o["value"] = st.value;
+        if (r.kind == RULE_RISE || r.kind == RULE_TREND) o["rate_c_min"] = st.rate;
+        if (r.kind == RULE_TREND && st.eta >= 0) o["eta_min"] = st.eta;
+        o["held_sec"] = ruleHeldSec(i);
+        o["active"] = st.active;
+        o["fires"] = st.fires;
+    }
+}
+
+// Tendencia de cada sonda y del interior hacia temp_critical
+// (critical_in_min solo si sube con confianza suficiente y todavía no llegó)
+void getTrendJSON(JsonArray& arr) {
+    for (int t = 0; t <= TREND_INTERIOR; t++) {
+        TrendFit fit;
+        if (!trendFit(trend[t], TREND_TAU_MIN, fit)) continue;
+        JsonObject o = arr.createNestedObject();
+        if (t == TREND_INTERIOR) {
+            o["signal"] = "interior";
+        } else {
+            o["signal"] = "probe";
+            o["index"] = t;
+            o["name"] = sensorData.temp[t].name;
+        }
+        o["value"] = fit.value;
+        o["slope_c_min"] = fit.slope;
+        o["confidence"] = fit.confidence;
+        float eta = fit.confidence >= TREND_MIN_CONFIDENCE ?
+            trendMinutesTo(fit, config.tempCritical, TREND_MIN_SLOPE_C_MIN) : -1;
+        if (eta >= 0) o["critical_in_min"] = eta;
+    }
+}
+
+#endif // RULES_H
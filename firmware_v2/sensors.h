@@ -22,6 +22,7 @@
 #include <DHT.h>
 #include "config.h"
 #include "types.h"
+#include "trace.h"
 
 // Referencias externas
 extern OneWire oneWire;
@@ -30,6 +31,10 @@ extern DHT dht;
 extern Config config;
 extern SensorData sensorData;
 extern SystemState state;
+extern uint8_t getStateTempResolution(SystemStateEnum s);
+extern void recorderProbe(int probe, float tempC);
+extern void recorderProbeFail(int probe);
+extern void recorderInput(uint8_t input, bool level);
 
 // ============================================================================
 // NOMBRES DE SENSORES (arrays para acceso por índice)
@@ -64,13 +69,31 @@ const bool DOOR_ENABLED_DEFAULT[MAX_DOOR_SENSORS] = {
 // ============================================================================
 // INICIALIZACIÓN DE SENSORES DE TEMPERATURA
 // ============================================================================
+// Una sola búsqueda en el bus: las direcciones quedan cacheadas y las
+// lecturas posteriores van directo a cada sonda (MATCH ROM), sin re-buscar.
+int discoverTempSensors() {
+    DeviceAddress addr;
+    int count = 0;
+    
+    oneWire.reset_search();
+    while (count < MAX_TEMP_SENSORS && oneWire.search(addr)) {
+        if (!ds18b20.validAddress(addr)) {
+            Serial.println("[SENSOR] ⚠️ Dirección con CRC inválido, ignorada");
+            continue;
+        }
+        memcpy(sensorData.temp[count].address, addr, 8);
+        count++;
+    }
+    return count;
+}
+
 void initTempSensors() {
     Serial.println("[SENSOR] Iniciando sensores DS18B20...");
     
     ds18b20.begin();
     delay(500);
     
-    int count = ds18b20.getDeviceCount();
+    int count = discoverTempSensors();
     sensorData.tempSensorCount = count;
     
     Serial.printf("[SENSOR] Sensores DS18B20 detectados: %d\n", count);
@@ -80,7 +103,7 @@ void initTempSensors() {
         delay(1000);
         ds18b20.begin();
         delay(500);
-        count = ds18b20.getDeviceCount();
+        count = discoverTempSensors();
         sensorData.tempSensorCount = count;
         Serial.printf("[SENSOR] Segundo intento: %d sensores\n", count);
     }
@@ -93,20 +116,25 @@ void initTempSensors() {
         sensorData.temp[i].valid = false;
         sensorData.temp[i].name = TEMP_SENSOR_NAMES[i];
         sensorData.temp[i].enabled = config.tempSensorEnabled[i] && (i < count);
-        
-        // Obtener dirección del sensor si existe
-        if (i < count) {
-            ds18b20.getAddress(sensorData.temp[i].address, i);
-        }
+        sensorData.temp[i].readErrors = 0;
+        sensorData.temp[i].failStreak = 0;
+        sensorData.temp[i].resolution = TEMP_RES_NORMAL;
+        sensorData.temp[i].resolutionSince = millis();
+        sensorData.temp[i].riseRate = 0;
+        sensorData.temp[i].rateRefAt = 0;
+        if (i >= count) memset(sensorData.temp[i].address, 0, 8);
     }
     
     // Configurar resolución y hacer primera lectura
     if (count > 0) {
-        ds18b20.setResolution(12);  // 12 bits = 0.0625°C precisión
+        // La resolución cambia seguido (política adaptativa): solo en el
+        // scratchpad, sin copiar a la EEPROM de la sonda
+        ds18b20.setAutoSaveScratchPad(false);
+        ds18b20.setResolution(TEMP_RES_NORMAL);  // 12 bits = 0.0625°C precisión
         ds18b20.setWaitForConversion(true);
         ds18b20.requestTemperatures();
         
-        float t = ds18b20.getTempCByIndex(0);
+        float t = ds18b20.getTempC(sensorData.temp[0].address);
         Serial.printf("[SENSOR] >>> TEMPERATURA INICIAL: %.2f°C <<<\n", t);
         
         if (t > -55 && t < 125) {
@@ -166,13 +194,186 @@ void initSensors() {
 }
 
 // ============================================================================
-// LECTURA DE TEMPERATURAS (NO BLOQUEANTE)
+// MOTOR DE ADQUISICIÓN DS18B20 (NO BLOQUEANTE)
 // ============================================================================
-// Usa máquina de estados interna para lectura asíncrona
+// Tiene su propio deadline (TEMP_SAMPLE_INTERVAL_MS), independiente del
+// intervalo de puertas/DHT22; llamar readTempSensors() en cada loop().
+//
+//   IDLE ──deadline──> CONVERT T a todas las sondas (SKIP ROM)
+//   CONVERTING ──tiempo de conversión──> READING
+//   READING: una sonda por llamada, por dirección cacheada con CRC
+//   última sonda ──> publicar agregados ──> IDLE (si el deadline siguiente
+//   ya venció, la próxima conversión sale en la misma llamada)
+//
+// Leer de a una sonda acota el tiempo de bus por iteración de loop()
+// (~11 ms) aunque haya 6 sondas.
+//
+// Resolución adaptativa por sonda (antes de cada CONVERT T):
+// - Base según el estado (getStateTempResolution, state_machine.h):
+//   NORMAL 12 bits, DEFROST/COOLDOWN 10, ALERT 9
+// - Subida >= TEMP_RATE_MODERATE_C_MIN baja a 11 bits, >= TEMP_RATE_FAST_C_MIN a 9
+// - Con alguna sonda en 9 bits el ciclo pasa a TEMP_SAMPLE_FAST_INTERVAL_MS
+// - Bajar bits es inmediato; volver a más bits espera TEMP_RES_HOLD_MS
+
+enum TempReadState { TEMP_IDLE, TEMP_CONVERTING, TEMP_READING };
 
-enum TempReadState { TEMP_IDLE, TEMP_REQUESTING, TEMP_READING };
-static TempReadState tempReadState = TEMP_IDLE;
-static unsigned long tempRequestTime = 0;
+struct TempEngine {
+    TempReadState phase;
+    unsigned long nextSampleAt;     // Deadline del próximo CONVERT T
+    unsigned long conversionStart;
+    unsigned long conversionMs;     // Según la resolución configurada
+    uint8_t readIndex;              // Próxima sonda a leer
+    uint32_t cycles;                // Ciclos completos
+    unsigned long lastCycleAt;      // Inicio del último ciclo publicado
+    unsigned long periodMs;         // Período real entre ciclos
+    bool fast;                      // Alguna sonda en TEMP_RES_FAST
+};
+
+static TempEngine tempEngine = { TEMP_IDLE, 0, 0, 750, 0, 0, 0, 0, false };
+
+// Resolución deseada para una sonda: la menor entre estado y tasa de subida
+static uint8_t tempTargetResolution(const TempSensor& s) {
+    uint8_t bits = getStateTempResolution(state.currentState);
+    uint8_t byRate = TEMP_RES_NORMAL;
+    if (s.riseRate >= TEMP_RATE_FAST_C_MIN) byRate = TEMP_RES_FAST;
+    else if (s.riseRate >= TEMP_RATE_MODERATE_C_MIN) byRate = TEMP_RES_MODERATE;
+    return bits < byRate ? bits : byRate;
+}
+
+// Aplica como máximo un cambio de resolución por llamada (escritura de
+// scratchpad ~7 ms). Devuelve true si usó el bus.
+static bool tempApplyResolution(unsigned long now) {
+    for (int i = 0; i < sensorData.tempSensorCount && i < MAX_TEMP_SENSORS; i++) {
+        TempSensor& s = sensorData.temp[i];
+        if (!s.enabled) continue;
+        
+        uint8_t target = tempTargetResolution(s);
+        if (target == s.resolution) continue;
+        if (target > s.resolution && now - s.resolutionSince < TEMP_RES_HOLD_MS) continue;
+        
+        if (!ds18b20.setResolution(s.address, target, true)) continue;
+        Serial.printf("[SENSOR] %s: %d → %d bits (subida %.2f°C/min)\n",
+                      s.name, s.resolution, target, s.riseRate);
+        s.resolution = target;
+        s.resolutionSince = now;
+        return true;
+    }
+    return false;
+}
+
+// Subida en °C/min sobre una ventana fija (a 9 bits un escalón de 0.5°C
+// en la ventana no alcanza para TEMP_RATE_FAST_C_MIN)
+static void tempUpdateRate(TempSensor& s, float t, unsigned long now) {
+    if (s.rateRefAt == 0) {
+        s.rateRefValue = t;
+        s.rateRefAt = now;
+        return;
+    }
+    unsigned long span = now - s.rateRefAt;
+    if (span < TEMP_RATE_WINDOW_MS) return;
+    s.riseRate = (t - s.rateRefValue) * 60000.0f / span;
+    s.rateRefValue = t;
+    s.rateRefAt = now;
+}
+
+// Inicia la conversión en todas las sondas a la vez
+static void tempStartConversion(unsigned long now) {
+    // La conversión termina cuando termina la sonda con más bits
+    uint8_t maxBits = TEMP_RES_FAST;
+    for (int i = 0; i < sensorData.tempSensorCount && i < MAX_TEMP_SENSORS; i++) {
+        if (sensorData.temp[i].enabled && sensorData.temp[i].resolution > maxBits) {
+            maxBits = sensorData.temp[i].resolution;
+        }
+    }
+    tempEngine.fast = false;
+    for (int i = 0; i < sensorData.tempSensorCount && i < MAX_TEMP_SENSORS; i++) {
+        if (sensorData.temp[i].enabled && sensorData.temp[i].resolution == TEMP_RES_FAST) {
+            tempEngine.fast = true;
+        }
+    }
+    
+    ds18b20.requestTemperatures();
+    tempEngine.conversionStart = now;
+    tempEngine.conversionMs = ds18b20.millisToWaitForConversion(maxBits);
+    tempEngine.readIndex = 0;
+    tempEngine.phase = TEMP_CONVERTING;
+    
+    // Deadline fijo; si nos atrasamos no se acumulan ciclos pendientes
+    unsigned long interval = tempEngine.fast ? TEMP_SAMPLE_FAST_INTERVAL_MS : TEMP_SAMPLE_INTERVAL_MS;
+    tempEngine.nextSampleAt += interval;
+    if ((long)(now - tempEngine.nextSampleAt) >= 0) {
+        tempEngine.nextSampleAt = now + interval;
+    }
+}
+
+// Lee una sonda por dirección. getTempC() verifica el CRC del scratchpad
+// y devuelve DEVICE_DISCONNECTED_C si no coincide.
+static void tempReadProbe(int i) {
+    TempSensor& s = sensorData.temp[i];
+    
+    for (int attempt = 0; attempt <= TEMP_READ_RETRIES; attempt++) {
+        float t = ds18b20.getTempC(s.address);
+        
+        if (t != DEVICE_DISCONNECTED_C && t > -55 && t < 125) {
+            s.value = t;
+            s.valid = true;
+            s.failStreak = 0;
+            tempUpdateRate(s, t, millis());
+            recorderProbe(i, t);
+            
+            // Actualizar min/max del día
+            if (t < s.minToday) s.minToday = t;
+            if (t > s.maxToday) s.maxToday = t;
+            return;
+        }
+        s.readErrors++;
+    }
+    
+    recorderProbeFail(i);
+    
+    // Un error aislado (ruido en el bus) conserva el último valor
+    if (s.failStreak < 255) s.failStreak++;
+    if (s.failStreak >= TEMP_MAX_FAIL_STREAK) {
+        if (s.valid) {
+            Serial.printf("[SENSOR] ✗ %s sin lectura válida\n", s.name);
+        }
+        s.valid = false;
+    }
+}
+
+// Calcular promedios globales con las sondas válidas
+static void tempPublish() {
+    float sum = 0;
+    int validCount = 0;
+    float minTemp = 999.0;
+    float maxTemp = -999.0;
+    
+    for (int i = 0; i < sensorData.tempSensorCount && i < MAX_TEMP_SENSORS; i++) {
+        if (!sensorData.temp[i].enabled || !sensorData.temp[i].valid) continue;
+        float t = sensorData.temp[i].value;
+        sum += t;
+        validCount++;
+        if (t < minTemp) minTemp = t;
+        if (t > maxTemp) maxTemp = t;
+    }
+    
+    if (validCount > 0) {
+        sensorData.tempAvg = sum / validCount;
+        sensorData.tempMin = minTemp;
+        sensorData.tempMax = maxTemp;
+        sensorData.tempValid = true;
+    } else {
+        sensorData.tempValid = false;
+    }
+    
+    if (tempEngine.cycles > 0) {
+        tempEngine.periodMs = tempEngine.conversionStart - tempEngine.lastCycleAt;
+    }
+    tempEngine.lastCycleAt = tempEngine.conversionStart;
+    tempEngine.cycles++;
+    
+    streamNotifySample();
+}
 
 void readTempSensors() {
     // Modo simulación
@@ -184,66 +385,44 @@ void readTempSensors() {
         return;
     }
     
-    switch (tempReadState) {
+    if (sensorData.tempSensorCount == 0) return;
+    
+    unsigned long now = millis();
+    
+    switch (tempEngine.phase) {
         case TEMP_IDLE:
-            // Iniciar solicitud de conversión
-            ds18b20.requestTemperatures();
-            tempRequestTime = millis();
-            tempReadState = TEMP_REQUESTING;
+            if ((long)(now - tempEngine.nextSampleAt) >= 0) {
+                // Cambios de resolución pendientes primero (uno por llamada)
+                if (tempApplyResolution(now)) break;
+                tempStartConversion(now);
+            }
             break;
             
-        case TEMP_REQUESTING:
-            // Esperar 750ms para conversión de 12 bits
-            if (millis() - tempRequestTime >= 750) {
-                tempReadState = TEMP_READING;
+        case TEMP_CONVERTING:
+            if (now - tempEngine.conversionStart >= tempEngine.conversionMs) {
+                tempEngine.phase = TEMP_READING;
             }
             break;
             
         case TEMP_READING:
-            // Leer todos los sensores
-            float sum = 0;
-            int validCount = 0;
-            float minTemp = 999.0;
-            float maxTemp = -999.0;
-            
-            for (int i = 0; i < sensorData.tempSensorCount && i < MAX_TEMP_SENSORS; i++) {
-                if (!sensorData.temp[i].enabled) continue;
-                
-                float t = ds18b20.getTempCByIndex(i);
+            // Saltar deshabilitadas y leer la siguiente habilitada
+            while (tempEngine.readIndex < sensorData.tempSensorCount &&
+                   !sensorData.temp[tempEngine.readIndex].enabled) {
+                tempEngine.readIndex++;
+            }
+            if (tempEngine.readIndex < sensorData.tempSensorCount) {
+                tempReadProbe(tempEngine.readIndex++);
+            }
+            if (tempEngine.readIndex >= sensorData.tempSensorCount) {
+                tempPublish();
+                tempEngine.phase = TEMP_IDLE;
                 
-                if (t > -55 && t < 125) {
-                    sensorData.temp[i].value = t;
-                    sensorData.temp[i].valid = true;
-                    
-                    // Actualizar min/max del día
-                    if (t < sensorData.temp[i].minToday) {
-                        sensorData.temp[i].minToday = t;
-                    }
-                    if (t > sensorData.temp[i].maxToday) {
-                        sensorData.temp[i].maxToday = t;
-                    }
-                    
-                    sum += t;
-                    validCount++;
-                    
-                    if (t < minTemp) minTemp = t;
-                    if (t > maxTemp) maxTemp = t;
-                } else {
-                    sensorData.temp[i].valid = false;
+                // Pipeline: la conversión siguiente sale apenas se leyó la anterior
+                if ((long)(millis() - tempEngine.nextSampleAt) >= 0 &&
+                    !tempApplyResolution(millis())) {
+                    tempStartConversion(millis());
                 }
             }
-            
-            // Calcular promedios globales
-            if (validCount > 0) {
-                sensorData.tempAvg = sum / validCount;
-                sensorData.tempMin = minTemp;
-                sensorData.tempMax = maxTemp;
-                sensorData.tempValid = true;
-            } else {
-                sensorData.tempValid = false;
-            }
-            
-            tempReadState = TEMP_IDLE;
             break;
     }
 }
@@ -267,6 +446,7 @@ void readDoorSensors() {
         
         bool wasOpen = sensorData.door[i].isOpen;
         bool isOpen = digitalRead(sensorData.door[i].pin) == HIGH;
+        recorderInput(TRACE_IN_DOOR_1 + i, isOpen);
         
         sensorData.door[i].isOpen = isOpen;
         
@@ -279,6 +459,7 @@ void readDoorSensors() {
                 sensorData.door[i].openSince = millis();
                 sensorData.door[i].opensToday++;
                 Serial.printf("[PUERTA] %s ABIERTA\n", sensorData.door[i].name);
+                streamNotifyDoor(i);
             }
         } else {
             // Registrar cierre
@@ -288,6 +469,7 @@ void readDoorSensors() {
                 sensorData.door[i].openSince = 0;
                 Serial.printf("[PUERTA] %s CERRADA (estuvo abierta %lu seg)\n", 
                               sensorData.door[i].name, openDuration);
+                streamNotifyDoor(i);
             }
         }
     }
@@ -314,8 +496,8 @@ void readDHT22() {
 // ============================================================================
 // LECTURA COMPLETA DE SENSORES (llamar desde loop)
 // ============================================================================
+// Las sondas DS18B20 tienen su propio motor (readTempSensors)
 void readSensors() {
-    readTempSensors();
     readDoorSensors();
     readDHT22();
     
@@ -333,6 +515,9 @@ void getSensorsJSON(JsonObject& obj) {
     temps["max"] = sensorData.tempMax;
     temps["valid"] = sensorData.tempValid;
     temps["sensor_count"] = sensorData.tempSensorCount;
+    temps["sample_period_ms"] = tempEngine.periodMs;
+    temps["cycles"] = tempEngine.cycles;
+    temps["fast_sampling"] = tempEngine.fast;
     
     JsonArray tempArray = temps.createNestedArray("sensors");
     for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
@@ -345,6 +530,9 @@ void getSensorsJSON(JsonObject& obj) {
         sensor["valid"] = sensorData.temp[i].valid;
         sensor["min_today"] = sensorData.temp[i].minToday;
         sensor["max_today"] = sensorData.temp[i].maxToday;
+        sensor["read_errors"] = sensorData.temp[i].readErrors;
+        sensor["resolution"] = sensorData.temp[i].resolution;
+        sensor["rise_c_min"] = sensorData.temp[i].riseRate;
     }
     
     // DHT22
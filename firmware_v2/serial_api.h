@@ -1,14 +1,15 @@
 /*
  * serial_api.h - API de comandos por Serial/COM, Web y App
- * Sistema Monitoreo Reefer v3.0
- * 
- * NOTA: Este módulo NO está integrado aún. Solo definiciones.
+ * Sistema Monitoreo Reefer v4.0
  * 
  * Permite controlar el ESP32 mediante:
  * 1. Puerto Serial (COM) - Para debug y configuración local
- * 2. API Web - Endpoints HTTP para control remoto
+ *    (checkSerialCommands() pasa acá lo que no es perf/status/trace)
+ * 2. API Web - POST /api/command (web_api.h, aplicado en loop())
  * 3. App Android - Mismos endpoints que la web
  * 
+ * processCommand() corre siempre en loop() con el lock de estado tomado.
+ * 
  * COMANDOS DISPONIBLES:
  * - RESTART     : Reiniciar el ESP32
  * - RESET_WIFI  : Borrar configuración WiFi y reiniciar en modo AP
@@ -28,28 +29,47 @@
 #ifndef SERIAL_API_H
 #define SERIAL_API_H
 
-#include <WebServer.h>
+#include <Preferences.h>
+#include "config.h"
+#include "types.h"
 
 // Forward declarations
-extern WebServer server;
 extern Config config;
+extern SensorData sensorData;
 extern SystemState state;
+extern Preferences prefs;
+extern void loadConfig();
 extern void saveConfig();
 extern void setRelay(bool on);
 extern void acknowledgeAlert();
 extern void clearAlert();
+extern void resetWiFi();
+extern void enterDefrostMode(const char* triggeredBy);
+extern void exitDefrostMode();
 
 // ============================================
 // CONFIGURACIÓN
 // ============================================
-#define SERIAL_API_BAUD 115200
-#define SERIAL_BUFFER_SIZE 128
+#define SERIAL_API_ACTION_DELAY_MS 2000   // Reinicios: tiempo para enviar la respuesta
 
 // ============================================
 // VARIABLES
 // ============================================
-char serialBuffer[SERIAL_BUFFER_SIZE];
-int serialBufferIndex = 0;
+// RESTART y RESET_WIFI no reinician dentro de processCommand(): la
+// respuesta (Serial o HTTP) tiene que salir antes
+enum SerialApiAction : uint8_t {
+  SERIAL_ACTION_NONE = 0,
+  SERIAL_ACTION_RESTART,
+  SERIAL_ACTION_WIFI_RESET
+};
+
+SerialApiAction serialApiPending = SERIAL_ACTION_NONE;
+unsigned long serialApiPendingAt = 0;
+
+void serialApiSchedule(SerialApiAction action) {
+  serialApiPending = action;
+  serialApiPendingAt = millis();
+}
 
 // ============================================
 // PROCESAR COMANDO
@@ -63,17 +83,14 @@ String processCommand(String cmd) {
   // RESTART - Reiniciar ESP32
   if (cmd == "RESTART" || cmd == "REBOOT") {
     Serial.println("[CMD] Reiniciando en 2 segundos...");
-    delay(2000);
-    ESP.restart();
+    serialApiSchedule(SERIAL_ACTION_RESTART);
     return "OK: Reiniciando...";
   }
   
   // RESET_WIFI - Borrar WiFi y reiniciar en modo AP
   if (cmd == "RESET_WIFI" || cmd == "WIFI_RESET") {
     Serial.println("[CMD] Borrando configuración WiFi...");
-    WiFi.disconnect(true, true);
-    delay(1000);
-    ESP.restart();
+    serialApiSchedule(SERIAL_ACTION_WIFI_RESET);
     return "OK: WiFi reseteado, reiniciando en modo AP...";
   }
   
@@ -81,22 +98,11 @@ String processCommand(String cmd) {
   if (cmd == "RESET_CONFIG" || cmd == "FACTORY_RESET") {
     Serial.println("[CMD] Restaurando configuración de fábrica...");
     
-    // Valores por defecto
-    config.tempMax = -15.0;
-    config.tempCritical = -10.0;
-    config.alertDelaySec = 300;
-    config.doorOpenMaxSec = 120;
-    config.defrostCooldownSec = 1800;
-    config.defrostRelayNC = false;
-    config.relayEnabled = true;
-    config.buzzerEnabled = true;
-    config.telegramEnabled = true;
-    config.supabaseEnabled = false;
-    config.sensor1Enabled = true;
-    config.sensor2Enabled = false;
-    config.dht22Enabled = false;
-    config.doorEnabled = true;
-    config.simulationMode = false;
+    // Sin claves guardadas, loadConfig() toma los valores de config.h
+    prefs.begin("reefer", false);
+    prefs.clear();
+    prefs.end();
+    loadConfig();
     
     saveConfig();
     return "OK: Configuración restaurada a valores de fábrica";
@@ -105,16 +111,17 @@ String processCommand(String cmd) {
   // STATUS - Estado del sistema
   if (cmd == "STATUS") {
     String status = "\n=== ESTADO DEL SISTEMA ===\n";
+    status += "Estado: " + String(state.stateName) + "\n";
     status += "Temperatura: " + String(sensorData.tempAvg, 1) + "°C\n";
     status += "Temp Crítica: " + String(config.tempCritical, 1) + "°C\n";
     status += "Alerta: " + String(state.alertActive ? "ACTIVA" : "Normal") + "\n";
-    status += "Relay: " + String(state.relayState ? "ON" : "OFF") + "\n";
-    status += "Defrost: " + String(state.defrostMode ? "ACTIVO" : "OFF") + "\n";
+    status += "Relay: " + String(sensorData.relay[0].state ? "ON" : "OFF") + "\n";
+    status += "Defrost: " + String(state.currentState == STATE_DEFROST ? "ACTIVO" : "OFF") + "\n";
     status += "WiFi: " + String(state.wifiConnected ? "Conectado" : "Desconectado") + "\n";
     status += "Internet: " + String(state.internetAvailable ? "OK" : "Sin conexión") + "\n";
     status += "Supabase: " + String(config.supabaseEnabled ? "Habilitado" : "Deshabilitado") + "\n";
     status += "IP: " + state.localIP + "\n";
-    status += "Uptime: " + String((millis() - state.uptime) / 60000) + " min\n";
+    status += "Uptime: " + String((millis() - state.bootTime) / 60000) + " min\n";
     return status;
   }
   
@@ -129,19 +136,19 @@ String processCommand(String cmd) {
     return "OK: Temperatura crítica = " + String(newTemp, 1) + "°C";
   }
   
-  // DEFROST_ON - Activar descongelamiento
+  // DEFROST_ON - Activar descongelamiento (la máquina de estados apaga
+  // alertas y relé)
   if (cmd == "DEFROST_ON") {
-    state.defrostMode = true;
-    state.defrostStartTime = millis();
-    state.alertActive = false;
-    setRelay(false);
+    if (state.currentState != STATE_DEFROST) enterDefrostMode("manual");
+    if (state.currentState != STATE_DEFROST) {
+      return "ERROR: No se puede iniciar el descongelamiento ahora";
+    }
     return "OK: Modo descongelamiento ACTIVADO";
   }
   
-  // DEFROST_OFF - Desactivar descongelamiento
+  // DEFROST_OFF - Desactivar descongelamiento (pasa a COOLDOWN)
   if (cmd == "DEFROST_OFF") {
-    state.defrostMode = false;
-    state.defrostStartTime = 0;
+    if (state.currentState == STATE_DEFROST) exitDefrostMode();
     return "OK: Modo descongelamiento DESACTIVADO";
   }
   
@@ -207,18 +214,11 @@ String processCommand(String cmd) {
     return "OK: Modo simulación DESACTIVADO";
   }
   
-  // SET_SIM_TEMP <temp1> <temp2> - Configurar temperaturas simuladas
+  // SET_SIM_TEMP <temp> - Configurar temperatura simulada
   if (cmd.startsWith("SET_SIM_TEMP ")) {
-    int spacePos = cmd.indexOf(' ', 13);
-    if (spacePos > 0) {
-      config.simTemp1 = cmd.substring(13, spacePos).toFloat();
-      config.simTemp2 = cmd.substring(spacePos + 1).toFloat();
-    } else {
-      config.simTemp1 = cmd.substring(13).toFloat();
-      config.simTemp2 = config.simTemp1;
-    }
+    config.simTemp = cmd.substring(13).toFloat();
     saveConfig();
-    return "OK: Temp simulada = " + String(config.simTemp1, 1) + "°C / " + String(config.simTemp2, 1) + "°C";
+    return "OK: Temp simulada = " + String(config.simTemp, 1) + "°C";
   }
   
   // HELP - Mostrar ayuda
@@ -244,98 +244,19 @@ String processCommand(String cmd) {
 }
 
 // ============================================
-// LEER COMANDOS DEL SERIAL
+// REINICIOS PENDIENTES (desde loop())
 // ============================================
 void serialApiLoop() {
-  while (Serial.available()) {
-    char c = Serial.read();
-    
-    if (c == '\n' || c == '\r') {
-      if (serialBufferIndex > 0) {
-        serialBuffer[serialBufferIndex] = '\0';
-        String response = processCommand(String(serialBuffer));
-        Serial.println(response);
-        serialBufferIndex = 0;
-      }
-    } else if (serialBufferIndex < SERIAL_BUFFER_SIZE - 1) {
-      serialBuffer[serialBufferIndex++] = c;
-    }
-  }
-}
-
-// ============================================
-// HANDLER WEB: /api/command
-// ============================================
-void handleApiCommand() {
-  String cmd = "";
-  
-  // Obtener comando de query string o body
-  if (server.hasArg("cmd")) {
-    cmd = server.arg("cmd");
-  } else if (server.hasArg("plain")) {
-    cmd = server.arg("plain");
-  }
+  if (serialApiPending == SERIAL_ACTION_NONE) return;
+  if (millis() - serialApiPendingAt < SERIAL_API_ACTION_DELAY_MS) return;
   
-  if (cmd.length() == 0) {
-    server.sendHeader("Access-Control-Allow-Origin", "*");
-    server.send(400, "application/json", "{\"error\":\"No command provided\"}");
-    return;
+  SerialApiAction action = serialApiPending;
+  serialApiPending = SERIAL_ACTION_NONE;
+  if (action == SERIAL_ACTION_WIFI_RESET) {
+    resetWiFi();
+  } else {
+    ESP.restart();
   }
-  
-  String response = processCommand(cmd);
-  
-  // Formatear respuesta como JSON
-  String json = "{";
-  json += "\"command\":\"" + cmd + "\",";
-  json += "\"response\":\"" + response + "\",";
-  json += "\"success\":" + String(response.startsWith("OK") ? "true" : "false");
-  json += "}";
-  
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", json);
-}
-
-// ============================================
-// HANDLER WEB: /api/restart
-// ============================================
-void handleApiRestart() {
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true,\"message\":\"Reiniciando en 2 segundos...\"}");
-  delay(2000);
-  ESP.restart();
-}
-
-// ============================================
-// HANDLER WEB: /api/factory_reset
-// ============================================
-void handleApiFactoryReset() {
-  processCommand("RESET_CONFIG");
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true,\"message\":\"Configuración restaurada\"}");
-}
-
-// ============================================
-// CONFIGURAR RUTAS WEB PARA COMANDOS
-// ============================================
-void setupSerialApiRoutes() {
-  // Endpoint genérico para comandos
-  server.on("/api/command", HTTP_GET, handleApiCommand);
-  server.on("/api/command", HTTP_POST, handleApiCommand);
-  
-  // Endpoints específicos
-  server.on("/api/restart", HTTP_POST, handleApiRestart);
-  server.on("/api/factory_reset", HTTP_POST, handleApiFactoryReset);
-  
-  Serial.println("[SERIAL_API] Rutas configuradas");
-}
-
-// ============================================
-// INICIALIZACIÓN
-// ============================================
-void serialApiInit() {
-  serialBufferIndex = 0;
-  Serial.println("[SERIAL_API] API de comandos inicializada");
-  Serial.println("[SERIAL_API] Escribe HELP para ver comandos disponibles");
 }
 
 #endif
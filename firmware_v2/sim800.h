@@ -1,8 +1,12 @@
 /*
  * sim800.h - Módulo GSM SIM800L para SMS de emergencia
- * Sistema Monitoreo Reefer v3.0
+ * Sistema Monitoreo Reefer v4.0
  * 
- * NOTA: Este módulo NO está integrado aún. Solo definiciones.
+ * firmware_v2.ino lo incluye antes de outbox.h: las alertas críticas de la
+ * bandeja salen también por SMS (sim800DeliverAlert, en la tarea de enlace).
+ * Con SIM800_ENABLED (config.h) setup() llama a sim800Init(); si el módulo
+ * no responde, el canal SMS queda salteado. sim800Loop() corre en
+ * uplinkPeriodic() (los comandos AT bloquean).
  * 
  * CONEXIONES SIM800L:
  * - VCC: 3.7-4.2V (usar regulador, NO conectar directo a 5V)
@@ -16,6 +20,8 @@
 #define SIM800_H
 
 #include <HardwareSerial.h>
+#include "config.h"
+#include "types.h"
 
 // ============================================
 // CONFIGURACIÓN SIM800
@@ -51,6 +57,9 @@ struct SIM800State {
 
 SIM800State sim800State;
 
+int sim800GetSignal();
+bool sim800IsRegistered();
+
 // ============================================
 // INICIALIZACIÓN
 // ============================================
@@ -81,9 +90,10 @@ bool sim800Init() {
     sim800Serial.println("AT+CMGF=1");
     delay(500);
     
-    // Verificar registro en red
-    sim800Serial.println("AT+CREG?");
-    delay(500);
+    // Registro en red y señal (sin esperar al primer sim800Loop())
+    sim800IsRegistered();
+    sim800GetSignal();
+    sim800State.lastCheck = millis();
     
     return true;
   } else {
@@ -179,6 +189,25 @@ void sim800SendAlert(String alertMessage) {
   sim800State.smsSent = true;
 }
 
+// ============================================
+// ENTREGAR ALERTA DE LA BANDEJA (outbox.h)
+// ============================================
+// Incluir este archivo antes de outbox.h habilita el canal SMS para las
+// alertas críticas. 200 si llegó a todos los números, -1 si no.
+int sim800DeliverAlert(const AlertEvent& e) {
+  String msg = "ALERTA REEFER\n";
+  msg += e.message;
+  msg += "\n\nSistema Monitoreo Reefer";
+  
+  bool ok = true;
+  for (int i = 0; i < SMS_PHONE_COUNT; i++) {
+    if (i > 0) delay(2000);  // Pausa entre SMS
+    ok = sim800SendSMS(SMS_PHONES[i], msg) && ok;
+  }
+  if (ok) sim800State.smsSent = true;
+  return ok ? 200 : -1;
+}
+
 // ============================================
 // ENVIAR SMS DE CORTE DE LUZ
 // ============================================
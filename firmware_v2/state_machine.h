@@ -15,6 +15,13 @@
  * 
  * Todas las operaciones son NO BLOQUEANTES usando millis()
  * 
+ * Las transiciones están en STATE_TABLE (motor de fsm.h). Los cambios de
+ * estado se piden con stateDispatch(evento); las condiciones que se miran en
+ * cada loop (señal de defrost, timers, conexión) son guardas del evento
+ * EV_POLL. Las acciones de la tabla solo tocan RAM: el relé, los reportes a
+ * Supabase y el log van como efectos a una cola que stateMachineLoop()
+ * vacía (a lo sumo STATE_EFFECTS_PER_LOOP por vuelta).
+ * 
  * ============================================================================
  */
 
@@ -23,6 +30,8 @@
 
 #include "config.h"
 #include "types.h"
+#include "fsm.h"
+#include "trace.h"
 
 // Referencias externas
 extern SystemState state;
@@ -34,6 +43,9 @@ extern void setRelay(bool on);
 extern void sendTelegramAlert(String message);
 extern void supabaseSendDefrostStart(float tempAtStart, const char* triggeredBy);
 extern void supabaseSendDefrostEnd(float tempAtEnd, unsigned long durationMin);
+extern void streamNotifyState();
+extern void recorderInput(uint8_t input, bool level);
+extern void rulesReset();
 
 // ============================================================================
 // TIMERS NO BLOQUEANTES GLOBALES
@@ -43,153 +55,286 @@ NonBlockingTimer configLoadTimer;
 NonBlockingTimer defrostMaxTimer;
 
 // ============================================================================
-// CAMBIO DE ESTADO
+// EVENTOS Y EFECTOS
 // ============================================================================
-void changeState(SystemStateEnum newState, const char* reason = "") {
-    if (state.currentState == newState) return;
-    
-    state.previousState = state.currentState;
-    state.currentState = newState;
-    state.stateChangedAt = millis();
-    state.stateName = getStateName(newState);
-    
-    Serial.printf("\n[STATE] ═══════════════════════════════════════\n");
-    Serial.printf("[STATE] %s → %s\n", 
-                  getStateName(state.previousState), 
-                  getStateName(newState));
-    if (strlen(reason) > 0) {
-        Serial.printf("[STATE] Razón: %s\n", reason);
-    }
-    Serial.printf("[STATE] ═══════════════════════════════════════\n\n");
-}
+enum StateEvent : uint8_t {
+    EV_POLL = 0,                    // Cada loop: guardas de señal, timers y red
+    EV_BOOT_DONE,                   // setup() terminó
+    EV_DEFROST_MANUAL,              // Pedido desde la API
+    EV_DEFROST_STOP,                // Fin manual desde la API
+    EV_CONFIG_SAVED,                // saveConfig()
+    EV_ALERT_RAISED,                // triggerAlert()
+    EV_ALERT_CLEARED,               // clearAlert()
+    EV_COUNT
+};
+
+// E/S que pide una transición; corre fuera del despacho
+enum StateEffectBits : uint16_t {
+    FX_RELAY_OFF            = 1 << 0,   // Apagar sirena
+    FX_REPORT_DEFROST_START = 1 << 1,   // supabaseSendDefrostStart()
+    FX_REPORT_DEFROST_END   = 1 << 2,   // supabaseSendDefrostEnd()
+    FX_LOG_DEFROST_START    = 1 << 3,
+    FX_LOG_DEFROST_END      = 1 << 4,   // Incluye el inicio del cooldown
+    FX_LOG_DEFROST_TIMEOUT  = 1 << 5,
+    FX_LOG_COOLDOWN_END     = 1 << 6,
+    FX_LOG_CONFIG_START     = 1 << 7,
+    FX_LOG_CONFIG_END       = 1 << 8
+};
+
+struct StateEffect {
+    uint8_t from, to;
+    uint16_t effects;
+    float temp;                     // sensorData.tempAvg al despachar
+    unsigned long minutes;          // Duración del defrost (FX_REPORT_DEFROST_END)
+    char reason[48];
+};
+
+StateEffect stateEffects[STATE_EFFECT_QUEUE_LEN];
+uint8_t stateEffectHead = 0;        // Próximo a ejecutar
+uint8_t stateEffectCount = 0;
 
 // ============================================================================
-// INICIALIZACIÓN DE LA MÁQUINA DE ESTADOS
+// GUARDAS (sin efectos)
 // ============================================================================
-void initStateMachine() {
-    state.currentState = STATE_INITIALIZING;
-    state.previousState = STATE_INITIALIZING;
-    state.stateChangedAt = millis();
-    state.stateName = getStateName(STATE_INITIALIZING);
-    
-    state.defrostStartTime = 0;
-    state.cooldownStartTime = 0;
-    state.cooldownEndTime = 0;
-    state.cooldownRemainingSeconds = 0;
-    state.configLoadStartTime = 0;
-    state.configLoadEndTime = 0;
-    state.configLoadRemainingSeconds = 0;
-    
-    Serial.println("[STATE] Máquina de estados inicializada");
-}
+bool guardDefrostSignal(const SystemState&) { return sensorData.defrostSignalActive; }
+bool guardDefrostSignalOff(const SystemState&) { return !sensorData.defrostSignalActive; }
+bool guardDefrostTimeout(const SystemState&) { return defrostMaxTimer.due(); }
+bool guardCooldownDone(const SystemState&) { return cooldownTimer.due(); }
+bool guardConfigApplied(const SystemState&) { return configLoadTimer.due(); }
+bool guardLinkRestored(const SystemState& s) { return s.wifiConnected && s.internetAvailable; }
 
 // ============================================================================
-// ENTRAR EN MODO DESCONGELAMIENTO
+// ACCIONES (solo RAM)
 // ============================================================================
-void enterDefrostMode(const char* triggeredBy) {
-    if (state.currentState == STATE_DEFROST) return;
-    
-    changeState(STATE_DEFROST, triggeredBy);
-    
-    state.defrostStartTime = millis();
+void actionEnterDefrost(SystemState& s) {
+    s.defrostStartTime = millis();
     
     // Suspender alertas durante defrost
-    state.alertActive = false;
-    state.alertCritical = false;
-    state.alertAcknowledged = false;
-    state.alertMessage = "";
-    
-    // Apagar sirena si estaba encendida
-    setRelay(false);
+    s.alertActive = false;
+    s.alertCritical = false;
+    s.alertAcknowledged = false;
+    s.alertMessage = "";
     
     // Timer de seguridad: máximo tiempo en defrost
     defrostMaxTimer.start(config.defrostMaxDurationSec * 1000UL);
+}
+
+// Fin del defrost (señal, API o timeout) → cooldown
+void actionEnterCooldown(SystemState& s) {
+    defrostMaxTimer.stop();
     
-    // Registrar en Supabase
-    supabaseSendDefrostStart(sensorData.tempAvg, triggeredBy);
-    
-    Serial.printf("[DEFROST] ⚡ INICIADO - Temp actual: %.1f°C\n", sensorData.tempAvg);
-    Serial.printf("[DEFROST] Máximo permitido: %d minutos\n", config.defrostMaxDurationSec / 60);
+    s.cooldownStartTime = millis();
+    s.cooldownEndTime = s.cooldownStartTime + (config.defrostCooldownSec * 1000UL);
+    s.cooldownRemainingSeconds = config.defrostCooldownSec;
+    cooldownTimer.start(config.defrostCooldownSec * 1000UL);
+}
+
+void actionExitCooldown(SystemState& s) {
+    cooldownTimer.stop();
+    s.cooldownRemainingSeconds = 0;
+}
+
+void actionEnterLoadingConfig(SystemState& s) {
+    s.configLoadStartTime = millis();
+    s.configLoadEndTime = s.configLoadStartTime + (config.configApplyTimeSec * 1000UL);
+    s.configLoadRemainingSeconds = config.configApplyTimeSec;
+    configLoadTimer.start(config.configApplyTimeSec * 1000UL);
+}
+
+void actionExitLoadingConfig(SystemState& s) {
+    configLoadTimer.stop();
+    s.configLoadRemainingSeconds = 0;
 }
 
 // ============================================================================
-// SALIR DE MODO DESCONGELAMIENTO → ENTRAR EN COOLDOWN
+// TABLA DE TRANSICIONES
 // ============================================================================
-void exitDefrostMode() {
-    if (state.currentState != STATE_DEFROST) return;
-    
-    unsigned long defrostDuration = millis() - state.defrostStartTime;
-    unsigned long defrostMinutes = defrostDuration / 60000;
-    
-    // Registrar fin de defrost en Supabase
-    supabaseSendDefrostEnd(sensorData.tempAvg, defrostMinutes);
-    
-    Serial.printf("[DEFROST] ✓ FINALIZADO - Duró %lu minutos\n", defrostMinutes);
-    Serial.printf("[DEFROST] Temp al finalizar: %.1f°C\n", sensorData.tempAvg);
-    
-    // Iniciar período de cooldown
-    enterCooldownMode();
-}
+typedef FsmTransition<SystemState> StateTransition;
+
+#define FX_DEFROST_START (FX_RELAY_OFF | FX_REPORT_DEFROST_START | FX_LOG_DEFROST_START)
+#define FX_DEFROST_END   (FX_REPORT_DEFROST_END | FX_LOG_DEFROST_END)
+
+constexpr StateTransition STATE_TABLE[] = {
+    // desde                 evento             hacia                 guarda                 acción                    efectos
+    { STATE_INITIALIZING,   EV_BOOT_DONE,      STATE_NORMAL,         nullptr,               nullptr,                  0,                    "Inicialización completa" },
+    
+    { STATE_NORMAL,         EV_POLL,           STATE_DEFROST,        guardDefrostSignal,    actionEnterDefrost,       FX_DEFROST_START,     "relay_signal" },
+    { STATE_DEFROST,        EV_POLL,           STATE_COOLDOWN,       guardDefrostSignalOff, actionEnterCooldown,      FX_DEFROST_END,       "Post-descongelamiento" },
+    { STATE_DEFROST,        EV_POLL,           STATE_COOLDOWN,       guardDefrostTimeout,   actionEnterCooldown,      FX_DEFROST_END | FX_LOG_DEFROST_TIMEOUT, "Timeout de defrost" },
+    { STATE_COOLDOWN,       EV_POLL,           STATE_NORMAL,         guardCooldownDone,     actionExitCooldown,       FX_LOG_COOLDOWN_END,  "Cooldown completado" },
+    { STATE_LOADING_CONFIG, EV_POLL,           STATE_NORMAL,         guardConfigApplied,    actionExitLoadingConfig,  FX_LOG_CONFIG_END,    "Configuración aplicada" },
+    { STATE_OFFLINE,        EV_POLL,           STATE_NORMAL,         guardLinkRestored,     nullptr,                  0,                    "Conexión restaurada" },
+    
+    // Defrost manual desde cualquier estado salvo DEFROST
+    { STATE_NORMAL,         EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_COOLDOWN,       EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_LOADING_CONFIG, EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_ALERT,          EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_OFFLINE,        EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_INITIALIZING,   EV_DEFROST_MANUAL, STATE_DEFROST,        nullptr,               actionEnterDefrost,       FX_DEFROST_START,     "manual" },
+    { STATE_DEFROST,        EV_DEFROST_STOP,   STATE_COOLDOWN,       nullptr,               actionEnterCooldown,      FX_DEFROST_END,       "Post-descongelamiento" },
+    
+    // Desde cualquier estado (en LOADING_CONFIG reinicia el timer)
+    { FSM_ANY,              EV_CONFIG_SAVED,   STATE_LOADING_CONFIG, nullptr,               actionEnterLoadingConfig, FX_LOG_CONFIG_START,  "Aplicando nueva configuración" },
+    { FSM_ANY,              EV_ALERT_RAISED,   STATE_ALERT,          nullptr,               nullptr,                  0,                    "Alerta" },
+    { FSM_ANY,              EV_ALERT_CLEARED,  STATE_NORMAL,         nullptr,               nullptr,                  0,                    "Alerta resuelta" },
+};
+
+#define STATE_TABLE_ROWS (sizeof(STATE_TABLE) / sizeof(STATE_TABLE[0]))
+
+static_assert(fsmTableValid<STATE_COUNT, EV_COUNT>(STATE_TABLE), "STATE_TABLE inválida");
+constexpr FsmIndex<STATE_COUNT, EV_COUNT> STATE_INDEX = fsmBuildIndex<STATE_COUNT, EV_COUNT>(STATE_TABLE);
 
 // ============================================================================
-// ENTRAR EN MODO COOLDOWN (POST-DESCONGELAMIENTO)
+// COLA DE EFECTOS
 // ============================================================================
-void enterCooldownMode() {
-    changeState(STATE_COOLDOWN, "Post-descongelamiento");
+void stateRunEffect(const StateEffect& e) {
+    if (e.from != e.to) {
+        Serial.printf("\n[STATE] ═══════════════════════════════════════\n");
+        Serial.printf("[STATE] %s → %s\n",
+                      getStateName((SystemStateEnum)e.from),
+                      getStateName((SystemStateEnum)e.to));
+        if (e.reason[0] != '\0') {
+            Serial.printf("[STATE] Razón: %s\n", e.reason);
+        }
+        Serial.printf("[STATE] ═══════════════════════════════════════\n\n");
+    }
     
-    state.cooldownStartTime = millis();
-    state.cooldownEndTime = state.cooldownStartTime + (config.defrostCooldownSec * 1000UL);
-    state.cooldownRemainingSeconds = config.defrostCooldownSec;
+    if (e.effects & FX_RELAY_OFF) setRelay(false);
+    if (e.effects & FX_REPORT_DEFROST_START) supabaseSendDefrostStart(e.temp, e.reason);
+    if (e.effects & FX_REPORT_DEFROST_END) supabaseSendDefrostEnd(e.temp, e.minutes);
     
-    // Iniciar timer de cooldown
-    cooldownTimer.start(config.defrostCooldownSec * 1000UL);
+    if (e.effects & FX_LOG_DEFROST_START) {
+        Serial.printf("[DEFROST] ⚡ INICIADO - Temp actual: %.1f°C\n", e.temp);
+        Serial.printf("[DEFROST] Máximo permitido: %d minutos\n", config.defrostMaxDurationSec / 60);
+    }
+    if (e.effects & FX_LOG_DEFROST_TIMEOUT) {
+        Serial.println("[DEFROST] ⚠️ TIMEOUT - Forzando salida de defrost");
+    }
+    if (e.effects & FX_LOG_DEFROST_END) {
+        Serial.printf("[DEFROST] ✓ FINALIZADO - Duró %lu minutos\n", e.minutes);
+        Serial.printf("[DEFROST] Temp al finalizar: %.1f°C\n", e.temp);
+        Serial.printf("[COOLDOWN] ⏳ INICIADO - Esperando %d minutos\n", config.defrostCooldownSec / 60);
+        Serial.printf("[COOLDOWN] El sistema se enfriará antes de reactivar monitoreo\n");
+    }
+    if (e.effects & FX_LOG_COOLDOWN_END) {
+        Serial.println("[COOLDOWN] ✓ COMPLETADO - Volviendo a monitoreo normal");
+    }
+    if (e.effects & FX_LOG_CONFIG_START) {
+        Serial.printf("[CONFIG] ⚙️ APLICANDO - Esperando %d segundos\n", config.configApplyTimeSec);
+    }
+    if (e.effects & FX_LOG_CONFIG_END) {
+        Serial.println("[CONFIG] ✓ CONFIGURACIÓN APLICADA");
+    }
+}
+
+void stateQueueEffect(const StateTransition& t, uint8_t from, const char* reason) {
+    // Cola llena: el más viejo se ejecuta ya en lugar de perderse
+    if (stateEffectCount == STATE_EFFECT_QUEUE_LEN) {
+        stateRunEffect(stateEffects[stateEffectHead]);
+        stateEffectHead = (stateEffectHead + 1) % STATE_EFFECT_QUEUE_LEN;
+        stateEffectCount--;
+    }
     
-    Serial.printf("[COOLDOWN] ⏳ INICIADO - Esperando %d minutos\n", config.defrostCooldownSec / 60);
-    Serial.printf("[COOLDOWN] El sistema se enfriará antes de reactivar monitoreo\n");
+    StateEffect& e = stateEffects[(stateEffectHead + stateEffectCount) % STATE_EFFECT_QUEUE_LEN];
+    e.from = from;
+    e.to = t.to;
+    e.effects = t.effects;
+    e.temp = sensorData.tempAvg;
+    e.minutes = (t.effects & FX_REPORT_DEFROST_END) ? (millis() - state.defrostStartTime) / 60000 : 0;
+    snprintf(e.reason, sizeof(e.reason), "%s", reason);
+    stateEffectCount++;
+}
+
+void stateRunEffects(uint8_t max) {
+    while (stateEffectCount > 0 && max-- > 0) {
+        StateEffect& e = stateEffects[stateEffectHead];
+        stateEffectHead = (stateEffectHead + 1) % STATE_EFFECT_QUEUE_LEN;
+        stateEffectCount--;
+        stateRunEffect(e);
+    }
 }
 
 // ============================================================================
-// SALIR DE MODO COOLDOWN → VOLVER A NORMAL
+// DESPACHO DE EVENTOS
 // ============================================================================
-void exitCooldownMode() {
-    if (state.currentState != STATE_COOLDOWN) return;
-    
-    cooldownTimer.stop();
-    state.cooldownRemainingSeconds = 0;
-    
-    changeState(STATE_NORMAL, "Cooldown completado");
+// true si el evento produjo una transición (aunque sea interna)
+bool stateDispatch(StateEvent event, const char* reason = nullptr) {
+    uint8_t from = state.currentState;
+    const StateTransition* t = fsmFind(STATE_TABLE, STATE_INDEX, from, event, state);
+    if (!t) return false;
+    
+    if (t->action) t->action(state);
+    
+    if (t->to != from) {
+        state.previousState = state.currentState;
+        state.currentState = (SystemStateEnum)t->to;
+        state.stateChangedAt = millis();
+        state.stateName = getStateName(state.currentState);
+        // Sin evaluar durante la suspensión: reglas y tendencias de cero
+        if (isStateSuspended((SystemStateEnum)from) && !isStateSuspended(state.currentState)) {
+            rulesReset();
+        }
+        streamNotifyState();
+    }
     
-    Serial.println("[COOLDOWN] ✓ COMPLETADO - Volviendo a monitoreo normal");
+    if (t->to != from || t->effects) {
+        stateQueueEffect(*t, from, reason ? reason : t->reason);
+    }
+    return true;
 }
 
 // ============================================================================
-// ENTRAR EN MODO CARGANDO CONFIGURACIÓN
+// RESOLUCIÓN DS18B20 POR ESTADO
 // ============================================================================
-void enterLoadingConfigMode() {
-    changeState(STATE_LOADING_CONFIG, "Aplicando nueva configuración");
-    
-    state.configLoadStartTime = millis();
-    state.configLoadEndTime = state.configLoadStartTime + (config.configApplyTimeSec * 1000UL);
-    state.configLoadRemainingSeconds = config.configApplyTimeSec;
-    
-    // Iniciar timer
-    configLoadTimer.start(config.configApplyTimeSec * 1000UL);
-    
-    Serial.printf("[CONFIG] ⚙️ APLICANDO - Esperando %d segundos\n", config.configApplyTimeSec);
+// Base de la política de resolución de sensors.h; una subida rápida de
+// temperatura puede bajarla más (menos bits = conversión más corta).
+uint8_t getStateTempResolution(SystemStateEnum s) {
+    switch (s) {
+        case STATE_ALERT:           return TEMP_RES_FAST;       // Muestreo más rápido
+        case STATE_DEFROST:
+        case STATE_COOLDOWN:
+        case STATE_LOADING_CONFIG:  return TEMP_RES_DEFROST;    // Alertas suspendidas
+        default:                    return TEMP_RES_NORMAL;
+    }
 }
 
 // ============================================================================
-// SALIR DE MODO CARGANDO CONFIGURACIÓN
+// INICIALIZACIÓN DE LA MÁQUINA DE ESTADOS
 // ============================================================================
-void exitLoadingConfigMode() {
-    if (state.currentState != STATE_LOADING_CONFIG) return;
+void initStateMachine() {
+    state.currentState = STATE_INITIALIZING;
+    state.previousState = STATE_INITIALIZING;
+    state.stateChangedAt = millis();
+    state.stateName = getStateName(STATE_INITIALIZING);
     
-    configLoadTimer.stop();
+    state.defrostStartTime = 0;
+    state.cooldownStartTime = 0;
+    state.cooldownEndTime = 0;
+    state.cooldownRemainingSeconds = 0;
+    state.configLoadStartTime = 0;
+    state.configLoadEndTime = 0;
     state.configLoadRemainingSeconds = 0;
     
-    changeState(STATE_NORMAL, "Configuración aplicada");
+    stateEffectHead = 0;
+    stateEffectCount = 0;
     
-    Serial.println("[CONFIG] ✓ CONFIGURACIÓN APLICADA");
+    Serial.println("[STATE] Máquina de estados inicializada");
+}
+
+// ============================================================================
+// PEDIDOS DESDE LA API Y STORAGE
+// ============================================================================
+void enterDefrostMode(const char* triggeredBy) {
+    stateDispatch(EV_DEFROST_MANUAL, triggeredBy);
+}
+
+void exitDefrostMode() {
+    stateDispatch(EV_DEFROST_STOP);
+}
+
+void enterLoadingConfigMode() {
+    stateDispatch(EV_CONFIG_SAVED);
 }
 
 // ============================================================================
@@ -216,62 +361,6 @@ void updateStateTimers() {
     }
 }
 
-// ============================================================================
-// VERIFICAR TRANSICIONES DE ESTADO (llamar en cada loop)
-// ============================================================================
-void checkStateTransitions() {
-    switch (state.currentState) {
-        case STATE_INITIALIZING:
-            // Transición automática a NORMAL después de inicialización
-            // (se hace manualmente desde setup())
-            break;
-            
-        case STATE_NORMAL:
-            // Verificar si hay señal de defrost
-            if (sensorData.defrostSignalActive) {
-                enterDefrostMode("relay_signal");
-            }
-            break;
-            
-        case STATE_DEFROST:
-            // Verificar si terminó el defrost (señal desactivada)
-            if (!sensorData.defrostSignalActive) {
-                exitDefrostMode();
-            }
-            // Verificar timeout de seguridad
-            else if (defrostMaxTimer.check()) {
-                Serial.println("[DEFROST] ⚠️ TIMEOUT - Forzando salida de defrost");
-                exitDefrostMode();
-            }
-            break;
-            
-        case STATE_COOLDOWN:
-            // Verificar si terminó el cooldown
-            if (cooldownTimer.check()) {
-                exitCooldownMode();
-            }
-            break;
-            
-        case STATE_LOADING_CONFIG:
-            // Verificar si terminó la carga de config
-            if (configLoadTimer.check()) {
-                exitLoadingConfigMode();
-            }
-            break;
-            
-        case STATE_ALERT:
-            // Las alertas se manejan en alerts.h
-            break;
-            
-        case STATE_OFFLINE:
-            // Verificar si volvió la conexión
-            if (state.wifiConnected && state.internetAvailable) {
-                changeState(STATE_NORMAL, "Conexión restaurada");
-            }
-            break;
-    }
-}
-
 // ============================================================================
 // VERIFICAR SEÑAL DE DEFROST DEL REEFER
 // ============================================================================
@@ -281,6 +370,7 @@ void checkDefrostSignal() {
     
     // Leer pin
     bool pinState = digitalRead(PIN_DEFROST_INPUT);
+    recorderInput(TRACE_IN_DEFROST, pinState);
     
     // Determinar si está en defrost según configuración NC/NA
     bool defrostDetected;
@@ -336,6 +426,9 @@ void getStateJSON(JsonObject& obj) {
             obj["alert_critical"] = state.alertCritical;
             obj["alert_acknowledged"] = state.alertAcknowledged;
             break;
+            
+        default:
+            break;
     }
 }
 
@@ -354,7 +447,10 @@ void stateMachineLoop() {
     updateStateTimers();
     
     // Verificar transiciones
-    checkStateTransitions();
+    stateDispatch(EV_POLL);
+    
+    // E/S de las transiciones (también las pedidas por API y alertas)
+    stateRunEffects(STATE_EFFECTS_PER_LOOP);
 }
 
 #endif // STATE_MACHINE_H
@@ -18,6 +18,9 @@ extern SystemState state;
 
 // Forward declaration
 extern void enterLoadingConfigMode();
+extern void recorderConfig();
+extern void rulesSetDefaults(Config& c);
+extern void getRulesConfigJSON(JsonObject& obj, const Config& c);
 
 // ============================================================================
 // CARGAR CONFIGURACIÓN DESDE FLASH
@@ -70,12 +73,22 @@ void loadConfig() {
     config.simTemp = prefs.getFloat("simTemp", SIM_TEMP_DEFAULT);
     config.simDoorOpen = prefs.getBool("simDoor", SIM_DOOR_OPEN);
     
+    // Reglas de alerta (rules.h): sin reglas guardadas, las de fábrica
+    rulesSetDefaults(config);
+    if (prefs.getBytesLength("rules") == sizeof(config.rules)) {
+        prefs.getBytes("rules", config.rules, sizeof(config.rules));
+        config.ruleCount = prefs.getUChar("ruleCount", 0);
+    }
+    config.interiorProbes = prefs.getUChar("interior", DEFAULT_INTERIOR_PROBES);
+    config.trendHorizonMin = prefs.getUShort("trendHorizon", DEFAULT_TREND_HORIZON_MIN);
+    
     prefs.end();
     
     Serial.println("[STORAGE] ✓ Configuración cargada");
     Serial.printf("[STORAGE] Temp crítica: %.1f°C\n", config.tempCritical);
     Serial.printf("[STORAGE] Delay alerta: %d seg\n", config.alertDelaySec);
     Serial.printf("[STORAGE] Cooldown defrost: %d seg\n", config.defrostCooldownSec);
+    Serial.printf("[STORAGE] Reglas de alerta: %d\n", config.ruleCount);
 }
 
 // ============================================================================
@@ -132,8 +145,17 @@ void saveConfig() {
     prefs.putFloat("simTemp", config.simTemp);
     prefs.putBool("simDoor", config.simDoorOpen);
     
+    // Reglas de alerta
+    prefs.putBytes("rules", config.rules, sizeof(config.rules));
+    prefs.putUChar("ruleCount", config.ruleCount);
+    prefs.putUChar("interior", config.interiorProbes);
+    prefs.putUShort("trendHorizon", config.trendHorizonMin);
+    
     prefs.end();
     
+    // Los umbrales nuevos quedan en la traza (trace_replay)
+    recorderConfig();
+    
     Serial.println("[STORAGE] ✓ Configuración guardada");
 }
 
@@ -189,6 +211,9 @@ void getConfigJSON(JsonObject& obj) {
     for (int i = 0; i < MAX_RELAYS; i++) {
         relays.add(config.relayOutputEnabled[i]);
     }
+    
+    // Reglas de alerta y sondas interiores
+    getRulesConfigJSON(obj, config);
 }
 
 #endif // STORAGE_H
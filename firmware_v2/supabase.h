@@ -1,8 +1,9 @@
 /*
  * supabase.h - Integración completa con Supabase
- * Sistema Monitoreo Reefer v3.0
+ * Sistema Monitoreo Reefer v4.0
  * 
  * Envía TODOS los datos posibles cada 5 segundos a la tabla 'readings'
+ * (en lotes de varias filas si el dispositivo tiene hora, ver más abajo)
  * Preparado para expansión futura con múltiples sensores
  * 
  * Tablas utilizadas:
@@ -12,6 +13,20 @@
  * - door_events: Apertura/cierre de puertas
  * - defrost_sessions: Sesiones de descongelamiento
  * - commands: Comandos remotos pendientes
+ * 
+ * Las funciones supabaseSend*() solo arman el payload y lo encolan en la
+ * tarea de enlace (uplink.h); supabaseExecute() hace el HTTP en esa tarea.
+ * Lecturas, puertas, defrost, energía y mantenimiento se encolan como
+ * registros binarios (telemetry.h) y supabaseExecuteRecord() los pasa a
+ * JSON en la tarea.
+ * Las alertas salen de la bandeja de salida (outbox.h) con reintentos:
+ * supabaseDeliverAlert() las sube directo y devuelve el código como recibo.
+ * La conexión HTTPS con Supabase se reutiliza (http_pool.h).
+ *
+ * Con el diario en flash (journal.h) esos registros se guardan ahí aunque
+ * no haya internet y supabaseJournalPump() los sube en orden desde la tarea
+ * de enlace, con la clave (device_id, seq) para que un reenvío no duplique
+ * filas (supabase/add_journal_seq.sql).
  */
 
 #ifndef SUPABASE_H
@@ -21,6 +36,11 @@
 #include <ArduinoJson.h>
 #include "config.h"
 #include "types.h"
+#include "uplink.h"
+#include "http_pool.h"
+#include "telemetry.h"
+#include "journal.h"
+#include "outbox.h"
 
 extern Config config;
 extern SystemState state;
@@ -32,122 +52,416 @@ extern float __attribute__((weak)) currentAmps;
 extern bool __attribute__((weak)) compressorRunning;
 extern bool __attribute__((weak)) acPowerPresent;
 extern float __attribute__((weak)) batteryVoltage;
-extern int __attribute__((weak)) gsmSignal;
+
+extern const char* DOOR_NAMES[MAX_DOOR_SENSORS];
+extern uint32_t deviceUnixTime();
+
+// Flujo de registros hacia la cola del uplink: hora absoluta en cada uno
+// porque la cola puede descartar trabajos
+TlmEncoder supabaseTlm = { 0, 0, false, true };
 
 // ============================================
-// ENVIAR LECTURA COMPLETA A SUPABASE
+// EJECUTAR PETICIÓN (tarea de enlace)
 // ============================================
-bool supabaseSendReading() {
-  if (!config.supabaseEnabled || !state.internetAvailable) {
-    return false;
+// Prefer de los inserts con clave del diario: una fila (device_id, seq) que
+// ya está en la tabla se ignora en vez de dar error
+#define SUPABASE_PREFER_IDEMPOTENT "return=minimal,resolution=ignore-duplicates"
+
+int supabaseRequest(const char* method, const char* path, const char* body, const char* prefer) {
+  String url = String(SUPABASE_URL) + "/rest/v1/" + path;
+  HttpPoolSlot* conn = httpPoolBegin(url);
+  if (!conn) return HTTPC_ERROR_CONNECTION_REFUSED;
+  
+  conn->http.addHeader("Content-Type", "application/json");
+  conn->http.addHeader("apikey", SUPABASE_ANON_KEY);
+  conn->http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
+  conn->http.addHeader("Prefer", prefer);
+  
+  int code = httpPoolSend(conn, method, String(body));
+  httpPoolEnd(conn);
+  return code;
+}
+
+int supabaseExecute(const char* method, const char* path, const char* body) {
+  return supabaseRequest(method, path, body, "return=minimal");
+}
+
+// Lote de lecturas -> un POST con un array JSON (tarea de enlace).
+// keys: clave del diario de cada fila, o NULL.
+int supabaseExecuteBatch(const uint8_t* records, size_t len, const uint64_t* keys) {
+  static TlmRecord rec;
+  static char rows[SUPABASE_BATCH_JSON_MAX];
+  static char row[UPLINK_BODY_MAX];
+  TlmDecoder dec;
+  
+  // Primera pasada: unión de columnas de todas las filas
+  uint8_t tempMask = 0, doorMask = 0;
+  uint16_t flags = 0;
+  bool withTime = true;
+  tlmDecoderInit(dec);
+  for (size_t pos = 0; pos < len; ) {
+    int n = tlmDecode(dec, records + pos, len - pos, rec);
+    if (n <= 0 || rec.type != TLM_READING) return -1;
+    tempMask |= rec.reading.tempMask;
+    doorMask |= rec.reading.doorEnabled;
+    flags |= rec.reading.flags;
+    if (rec.unixSec == 0) withTime = false;
+    pos += n;
+  }
+  
+  // ?columns= permite filas con claves distintas (sondas inválidas = NULL)
+  char path[384];
+  int p = snprintf(path, sizeof(path), "readings?columns=");
+  int c = tlmReadingColumns(tempMask, doorMask, flags, withTime, keys != NULL,
+                            path + p, sizeof(path) - p);
+  if (c < 0) return -1;
+  if (keys) snprintf(path + p + c, sizeof(path) - p - c, "&on_conflict=device_id,seq");
+  
+  // Segunda pasada: filas
+  size_t used = 0;
+  int count = 0;
+  rows[used++] = '[';
+  tlmDecoderInit(dec);
+  for (size_t pos = 0; pos < len; ) {
+    int n = tlmDecode(dec, records + pos, len - pos, rec);
+    int rowLen = tlmRecordToJson(rec, DEVICE_ID, NULL, row, sizeof(row),
+                                 keys ? keys[count] : 0);
+    if (rowLen < 0 || used + rowLen + 2 >= sizeof(rows)) return -1;
+    if (count++ > 0) rows[used++] = ',';
+    memcpy(rows + used, row, rowLen);
+    used += rowLen;
+    pos += n;
+  }
+  rows[used++] = ']';
+  rows[used] = '\0';
+  
+  return supabaseRequest("POST", path, rows,
+                         keys ? SUPABASE_PREFER_IDEMPOTENT : "return=minimal");
+}
+
+// Registro binario -> JSON -> tabla correspondiente (tarea de enlace).
+// Varios registros concatenados son un lote de lecturas. keys: clave del
+// diario de cada registro, o NULL.
+int supabaseExecuteRecords(const uint8_t* record, size_t len, const uint64_t* keys) {
+  static TlmRecord rec;
+  static char json[UPLINK_BODY_MAX];
+  TlmDecoder dec;
+  tlmDecoderInit(dec);
+  
+  int used = tlmDecode(dec, record, len, rec);
+  if (used <= 0) return -1;
+  if ((size_t)used < len) return supabaseExecuteBatch(record, len, keys);
+  
+  // El cierre de defrost es un PATCH: no lleva clave
+  bool patch = rec.type == TLM_DEFROST && rec.defrost.end;
+  uint64_t key = keys && !patch ? keys[0] : 0;
+  if (tlmRecordToJson(rec, DEVICE_ID, DOOR_NAMES, json, sizeof(json), key) < 0) return -1;
+  
+  const char* table = NULL;
+  switch (rec.type) {
+    case TLM_READING:    table = "readings"; break;
+    case TLM_DOOR_EVENT: table = "door_events"; break;
+    case TLM_ALERT:      table = "alerts"; break;
+    case TLM_POWER_EVENT: table = "power_events"; break;
+    case TLM_MAINTENANCE: table = "maintenance_logs"; break;
+    case TLM_DEFROST:    table = "defrost_sessions"; break;
+    default:             return -1;
+  }
+  
+  char path[UPLINK_PATH_MAX];
+  if (patch) {
+    // Cierra la última sesión abierta del dispositivo
+    snprintf(path, sizeof(path), "defrost_sessions?device_id=eq.%s&ended_at=is.null", DEVICE_ID);
+    return supabaseExecute("PATCH", path, json);
+  }
+  if (key) {
+    snprintf(path, sizeof(path), "%s?on_conflict=device_id,seq", table);
+    return supabaseRequest("POST", path, json, SUPABASE_PREFER_IDEMPOTENT);
+  }
+  return supabaseExecute("POST", table, json);
+}
+
+int supabaseExecuteRecord(const uint8_t* record, size_t len) {
+  return supabaseExecuteRecords(record, len, NULL);
+}
+
+// ms desde el boot para el encabezado de los registros
+inline uint32_t supabaseTlmNow() { return millis() - state.bootTime; }
+
+// ============================================
+// LOTE DE LECTURAS (bulk insert)
+// ============================================
+// Con hora del dispositivo las lecturas se juntan como registros binarios
+// (flujo delta, ~30 bytes c/u) y salen en un solo POST de varias filas, cada
+// una con su created_at. Se envía al juntar SUPABASE_BATCH_MAX_ROWS, al
+// pasar SUPABASE_BATCH_INTERVAL_MS, y enseguida con alerta activa o cambio
+// de estado. Sin hora se envían de a una: el servidor pondría a todo el
+// lote la hora del envío.
+struct ReadingBatch {
+  uint8_t buf[UPLINK_BODY_MAX - 1];
+  size_t len;
+  uint8_t rows;
+  unsigned long firstAt;
+  TlmEncoder enc;                 // Flujo delta dentro del lote
+};
+
+ReadingBatch readingBatch = { {0}, 0, 0, 0, { 0, 0, false, false } };
+
+void supabaseFlushReadings(bool urgent) {
+  if (readingBatch.rows == 0) return;
+  uplinkSubmitRecord(urgent ? UPLINK_PRIO_CRITICAL : UPLINK_PRIO_NORMAL,
+                     readingBatch.buf, readingBatch.len);
+  readingBatch.len = 0;
+  readingBatch.rows = 0;
+}
+
+bool supabaseBatchReading(const TlmReading& r, uint32_t unixSec, bool urgent) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (readingBatch.rows == 0) {
+      tlmEncoderResync(readingBatch.enc);
+      readingBatch.firstAt = millis();
+    }
+    size_t n = tlmEncodeReading(readingBatch.enc, supabaseTlmNow(), unixSec, r,
+                                readingBatch.buf + readingBatch.len,
+                                sizeof(readingBatch.buf) - readingBatch.len);
+    if (n > 0) {
+      readingBatch.len += n;
+      readingBatch.rows++;
+      break;
+    }
+    // No entra: enviar lo juntado y empezar otro lote
+    if (readingBatch.rows == 0) return false;
+    supabaseFlushReadings(false);
   }
   
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/readings";
+  if (urgent || readingBatch.rows >= SUPABASE_BATCH_MAX_ROWS ||
+      millis() - readingBatch.firstAt >= SUPABASE_BATCH_INTERVAL_MS) {
+    supabaseFlushReadings(urgent);
+  }
+  return true;
+}
+
+// ============================================
+// SUBIDA DESDE EL DIARIO (tarea de enlace)
+// ============================================
+// Sube en orden desde el cursor del diario: cada evento en su propio POST,
+// lecturas seguidas en lotes de hasta SUPABASE_BATCH_MAX_ROWS. Con el
+// diario al día las lecturas esperan a completar el lote o
+// SUPABASE_BATCH_INTERVAL_MS, salvo urgencia (alerta, cambio de estado,
+// evento); con atraso (volvió internet) sale un lote cada
+// JOURNAL_REPLAY_GAP_MS. Un error deja el cursor donde está y se reintenta
+// a los JOURNAL_RETRY_MS: nada se descarta.
+volatile bool supabaseJournalUrgent = false;
+
+struct JournalUplink {
+  unsigned long lastSendAt;
+  unsigned long waitMs;
+  uint32_t headSeq;               // Primera entrada pendiente ...
+  unsigned long headSince;        // ... y desde cuándo
+};
+
+JournalUplink journalUplink = { 0, 0, 0, 0 };
+
+// Registro de este arranque guardado sin hora (NTP todavía sin sincronizar)
+void supabaseJournalFixTime(uint8_t* record, size_t len, uint32_t seq) {
+  if (seq < journal.bootSeq) return;    // millis() de otro arranque
+  tlmPatchUnixTime(record, len, supabaseTlmNow(), deviceUnixTime());
+}
+
+void supabaseJournalPump() {
+  if (!journalReady() || !config.supabaseEnabled || !state.internetAvailable) return;
   
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
+  unsigned long now = millis();
+  if (now - journalUplink.lastSendAt < journalUplink.waitMs) return;
   
-  // Documento JSON grande para todos los datos
-  StaticJsonDocument<1024> doc;
+  uint32_t pending = journalPending();
+  if (pending == 0) return;
   
-  // Identificación
-  doc["device_id"] = DEVICE_ID;
+  JournalPos start = journalReadPos();
+  if (start.seq != journalUplink.headSeq) {
+    journalUplink.headSeq = start.seq;
+    journalUplink.headSince = now;
+  }
   
-  // Temperaturas (hasta 4 sensores DS18B20)
-  doc["temp1"] = sensorData.temp1;
-  doc["temp2"] = sensorData.temp2;
-  // doc["temp3"] = sensorData.temp3;  // Futuro
-  // doc["temp4"] = sensorData.temp4;  // Futuro
-  doc["temp_avg"] = sensorData.tempAvg;
-  doc["temp_dht"] = sensorData.tempDHT;
-  doc["humidity"] = sensorData.humidity;
+  // Sin hora cada lectura va sola: el servidor le pone la hora del envío
+  int maxRows = deviceUnixTime() != 0 ? SUPABASE_BATCH_MAX_ROWS : 1;
+  bool due = supabaseJournalUrgent || maxRows == 1 || pending >= (uint32_t)maxRows ||
+             now - journalUplink.headSince >= SUPABASE_BATCH_INTERVAL_MS;
+  if (!due) return;
+  supabaseJournalUrgent = false;
+  
+  static uint8_t buf[UPLINK_BODY_MAX - 1];
+  static uint64_t keys[SUPABASE_BATCH_MAX_ROWS];
+  JournalPos end = start;
+  size_t len = 0;
+  int rows = 0;
+  
+  while (rows < maxRows) {
+    JournalPos next = end;
+    uint32_t seq;
+    int n = journalRead(next, seq, buf + len, sizeof(buf) - len);
+    if (n <= 0) {
+      // Sin más, o no entra en este lote. journalRead() saltea lo ilegible:
+      // si no quedó nada que subir, avanzar el cursor igual
+      if (rows == 0 && n == 0 && next.seq != start.seq) journalCommit(next);
+      break;
+    }
+    bool reading = (buf[len] & 0x0F) == TLM_READING;
+    if (rows > 0 && !reading) break;  // El evento sale en el próximo envío
+    supabaseJournalFixTime(buf + len, n, seq);
+    keys[rows++] = journalKey(seq);
+    len += n;
+    end = next;
+    if (!reading) break;
+  }
   
-  // Estado de puertas (hasta 4)
-  doc["door1_open"] = sensorData.doorOpen;
-  // doc["door2_open"] = door2Open;  // Futuro
-  // doc["door3_open"] = door3Open;  // Futuro
-  // doc["door4_open"] = door4Open;  // Futuro
+  if (rows == 0) return;
+  
+  unsigned long sendStart = millis();
+  int code = supabaseExecuteRecords(buf, len, keys);
+  bool ok = uplinkCountResult(code, millis() - sendStart);
+  // 409: ya estaba (tabla sin ignore-duplicates)
+  if (code == 409) ok = true;
+  state.supabaseSyncOk = ok;
+  
+  journalUplink.lastSendAt = millis();
+  if (ok) {
+    journalCommit(end);
+    journalUplink.waitMs = journalPending() > 0 ? JOURNAL_REPLAY_GAP_MS : 0;
+  } else {
+    journalUplink.waitMs = JOURNAL_RETRY_MS;
+    Serial.printf("[SUPABASE] ✗ Diario: %d filas desde #%u: %d (reintento en %u s)\n",
+                  rows, (unsigned)start.seq, code, (unsigned)(JOURNAL_RETRY_MS / 1000));
+  }
+}
+
+// Registro hacia Supabase: al diario si está disponible (sobrevive cortes
+// de internet y reinicios); si no, a la cola del uplink con internet
+bool supabaseEmitRecord(UplinkPriority priority, const uint8_t* record, size_t len) {
+  if (journalReady() && journalAppend(record, len)) {
+    supabaseJournalUrgent = true;
+    return true;
+  }
+  if (!state.internetAvailable) return false;
+  return uplinkSubmitRecord(priority, record, len);
+}
+
+// ============================================
+// ENVIAR LECTURA COMPLETA A SUPABASE
+// ============================================
+bool supabaseSendReading() {
+  if (!config.supabaseEnabled || (!journalReady() && !state.internetAvailable)) {
+    return false;
+  }
+  
+  TlmReading r;
+  memset(&r, 0, sizeof(r));
+  
+  // Temperaturas (sondas DS18B20 habilitadas)
+  for (int i = 0; i < MAX_TEMP_SENSORS && i < TLM_MAX_TEMPS; i++) {
+    if (sensorData.temp[i].enabled && sensorData.temp[i].valid) {
+      r.tempMask |= 1 << i;
+      r.tempC[i] = tlmCenti(sensorData.temp[i].value);
+    }
+  }
+  r.tempAvg = tlmCenti(sensorData.tempAvg);
+  r.tempDht = tlmCenti(sensorData.tempAmbient);
+  r.humidity = isnan(sensorData.humidity) ? 0xFFFF : (uint16_t)tlmCenti(sensorData.humidity);
+  
+  // Estado de puertas
+  for (int i = 0; i < MAX_DOOR_SENSORS && i < TLM_MAX_DOORS; i++) {
+    if (sensorData.door[i].enabled) {
+      r.doorEnabled |= 1 << i;
+      if (sensorData.door[i].isOpen) r.doorOpen |= 1 << i;
+    }
+  }
   
   // Estado eléctrico (si power_monitor está habilitado)
   #ifdef POWER_MONITOR_H
-    doc["ac_power"] = acPowerPresent;
-    doc["battery_voltage"] = batteryVoltage;
+    if (acPowerPresent) r.flags |= TLM_F_AC_POWER;
+    r.flags |= TLM_F_HAS_BATTERY;
+    r.batteryCv = (uint16_t)tlmCenti(batteryVoltage);
   #else
-    doc["ac_power"] = true;  // Asumir que hay luz si no hay sensor
+    r.flags |= TLM_F_AC_POWER;  // Asumir que hay luz si no hay sensor
   #endif
   
   // Corriente del compresor (si current_sensor está habilitado)
   #ifdef CURRENT_SENSOR_H
-    doc["current_amps"] = currentAmps;
-    doc["compressor_running"] = compressorRunning;
+    r.flags |= TLM_F_HAS_CURRENT;
+    r.currentCa = tlmCenti(currentAmps);
+    if (compressorRunning) r.flags |= TLM_F_COMPRESSOR;
   #endif
   
   // Estado del sistema
-  doc["relay_on"] = state.relayState;
-  doc["buzzer_on"] = false;  // TODO: agregar variable
-  doc["alert_active"] = state.alertActive;
-  doc["defrost_mode"] = state.defrostMode;
-  doc["simulation_mode"] = config.simulationMode;
+  if (sensorData.relay[0].state) r.flags |= TLM_F_RELAY;
+  if (state.alertActive) r.flags |= TLM_F_ALERT;
+  if (state.currentState == STATE_DEFROST) r.flags |= TLM_F_DEFROST;
+  if (config.simulationMode) r.flags |= TLM_F_SIMULATION;
+  r.flags |= (uint16_t)(state.currentState & 0x0F) << TLM_F_STATE_SHIFT;
   
   // Conectividad
-  doc["wifi_rssi"] = WiFi.RSSI();
+  r.wifiRssi = (int8_t)WiFi.RSSI();
   #ifdef SIM800_H
-    doc["gsm_signal"] = gsmSignal;
+  if (sim800State.initialized && sim800State.signalStrength >= 0) {
+    r.flags |= TLM_F_HAS_GSM;
+    r.gsmSignal = (uint8_t)sim800State.signalStrength;
+  }
   #endif
   
-  // Metadata del sistema
-  doc["uptime_sec"] = (millis() - state.uptime) / 1000;
-  doc["free_heap"] = ESP.getFreeHeap();
+  // Metadata del sistema (el uptime sale de la hora del registro)
+  uint32_t heap = ESP.getFreeHeap() / 16;
+  r.freeHeap16 = heap > 0xFFFF ? 0xFFFF : (uint16_t)heap;
   
-  String body;
-  serializeJson(doc, body);
+  // Subir enseguida con alerta activa o cambio de estado
+  static SystemStateEnum lastState = STATE_INITIALIZING;
+  bool urgent = state.alertActive || state.currentState != lastState;
+  lastState = state.currentState;
   
-  int code = http.POST(body);
-  http.end();
+  uint32_t unixSec = deviceUnixTime();
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len;
   
-  if (code == 201 || code == 200) {
-    Serial.println("[SUPABASE] ✓ Lectura enviada");
-    return true;
-  } else {
-    Serial.printf("[SUPABASE] ✗ Error: %d\n", code);
-    return false;
+  if (journalReady()) {
+    len = tlmEncodeReading(supabaseTlm, supabaseTlmNow(), unixSec, r, buf, sizeof(buf));
+    if (len > 0 && journalAppend(buf, len)) {
+      if (urgent) supabaseJournalUrgent = true;
+      return true;
+    }
+    if (!state.internetAvailable) return false;
+  }
+  
+  if (unixSec != 0 && SUPABASE_BATCH_MAX_ROWS > 1) {
+    return supabaseBatchReading(r, unixSec, urgent);
   }
+  
+  len = tlmEncodeReading(supabaseTlm, supabaseTlmNow(), unixSec, r, buf, sizeof(buf));
+  if (len == 0) return false;
+  
+  return uplinkSubmitReading(buf, len);
 }
 
 // ============================================
-// ENVIAR ALERTA A SUPABASE
+// ENTREGAR ALERTA DE LA BANDEJA (tarea de enlace)
 // ============================================
-void sendAlertToSupabase(String alertType, String severity, String message) {
-  if (!config.supabaseEnabled || !state.internetAvailable) return;
-  
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/alerts";
-  
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
-  
-  StaticJsonDocument<256> doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["alert_type"] = alertType;
-  doc["severity"] = severity;
-  doc["message"] = message;
-  
-  String body;
-  serializeJson(doc, body);
-  
-  int code = http.POST(body);
-  http.end();
-  
-  if (code == 201 || code == 200) {
-    Serial.println("[SUPABASE] ✓ Alerta enviada");
-  }
+// Directo, sin el diario: el código es el recibo de la bandeja (outbox.h)
+int supabaseDeliverAlert(const AlertEvent& e) {
+  // Propio de la tarea: supabaseTlm es de loop()
+  static TlmEncoder enc = { 0, 0, false, true };
+  static TlmAlert a;
+  a.type = e.type;
+  a.severity = e.severity;
+  a.temp = e.temp;
+  strncpy(a.message, e.message, TLM_MSG_MAX);
+  a.message[TLM_MSG_MAX] = '\0';
+  
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodeAlert(enc, supabaseTlmNow(), outboxEventUnix(e), a, buf, sizeof(buf));
+  if (len == 0) return -1;
+  
+  unsigned long start = millis();
+  int code = supabaseExecuteRecord(buf, len);
+  state.supabaseSyncOk = uplinkCountResult(code, millis() - start);
+  return code;
 }
 
 // ============================================
@@ -158,15 +472,6 @@ bool supabaseUpdateDeviceStatus(bool isOnline) {
     return false;
   }
   
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/devices?device_id=eq." + String(DEVICE_ID);
-  
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
-  
   // Enviar estado online e IP
   StaticJsonDocument<256> doc;
   doc["is_online"] = isOnline;
@@ -175,14 +480,8 @@ bool supabaseUpdateDeviceStatus(bool isOnline) {
   String payload;
   serializeJson(doc, payload);
   
-  int code = http.PATCH(payload);
-  http.end();
-  
-  if (code == 200 || code == 204) {
-    Serial.printf("[SUPABASE] ✓ Estado actualizado (IP: %s)\n", state.localIP.c_str());
-    return true;
-  }
-  return false;
+  String path = "devices?device_id=eq." + String(DEVICE_ID);
+  return uplinkSubmit(UPLINK_SUPABASE_PATCH, UPLINK_PRIO_NORMAL, path.c_str(), payload);
 }
 
 // ============================================
@@ -190,34 +489,21 @@ bool supabaseUpdateDeviceStatus(bool isOnline) {
 // ============================================
 void supabaseSendDoorEvent(int doorNumber, const char* doorName, bool opened, 
                            int openDurationSec = 0, float tempAtOpen = 0, float tempAtClose = 0) {
-  if (!config.supabaseEnabled || !state.internetAvailable) return;
-  
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/door_events";
+  if (!config.supabaseEnabled) return;
   
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
+  if (doorNumber < 1 || doorNumber > TLM_MAX_DOORS) return;
+  (void)doorName;  // El nombre sale de DOOR_NAMES al pasar a JSON
   
-  StaticJsonDocument<256> doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["door_number"] = doorNumber;
-  doc["door_name"] = doorName;
-  doc["event_type"] = opened ? "opened" : "closed";
-  
-  if (!opened && openDurationSec > 0) {
-    doc["open_duration_sec"] = openDurationSec;
-    doc["temp_at_open"] = tempAtOpen;
-    doc["temp_at_close"] = tempAtClose;
-    doc["temp_rise"] = tempAtClose - tempAtOpen;
-  }
+  TlmDoorEvent d;
+  d.door = (uint8_t)(doorNumber - 1);
+  d.opened = opened;
+  d.openDurationSec = openDurationSec > 0xFFFF ? 0xFFFF : (uint16_t)openDurationSec;
+  d.tempAtOpen = tlmCenti(tempAtOpen);
+  d.tempAtClose = tlmCenti(tempAtClose);
   
-  String body;
-  serializeJson(doc, body);
-  http.POST(body);
-  http.end();
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodeDoorEvent(supabaseTlm, supabaseTlmNow(), deviceUnixTime(), d, buf, sizeof(buf));
+  if (len > 0) supabaseEmitRecord(UPLINK_PRIO_NORMAL, buf, len);
 }
 
 // ============================================
@@ -225,31 +511,17 @@ void supabaseSendDoorEvent(int doorNumber, const char* doorName, bool opened,
 // ============================================
 void supabaseSendPowerEvent(bool powerLost, int outageDurationSec = 0, 
                             float minBatteryVoltage = 0, int batteryUsedPercent = 0) {
-  if (!config.supabaseEnabled || !state.internetAvailable) return;
-  
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/power_events";
-  
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
-  
-  StaticJsonDocument<256> doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["event_type"] = powerLost ? "power_lost" : "power_restored";
+  if (!config.supabaseEnabled) return;
   
-  if (!powerLost) {
-    doc["outage_duration_sec"] = outageDurationSec;
-    doc["min_battery_voltage"] = minBatteryVoltage;
-    doc["battery_used_percent"] = batteryUsedPercent;
-  }
+  TlmPowerEvent p;
+  p.lost = powerLost;
+  p.outageSec = outageDurationSec > 0 ? (uint32_t)outageDurationSec : 0;
+  p.minBatteryCv = minBatteryVoltage > 0 ? (uint16_t)tlmCenti(minBatteryVoltage) : 0;
+  p.batteryUsedPct = batteryUsedPercent < 0 ? 0 : batteryUsedPercent > 100 ? 100 : (uint8_t)batteryUsedPercent;
   
-  String body;
-  serializeJson(doc, body);
-  http.POST(body);
-  http.end();
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodePowerEvent(supabaseTlm, supabaseTlmNow(), deviceUnixTime(), p, buf, sizeof(buf));
+  if (len > 0) supabaseEmitRecord(UPLINK_PRIO_CRITICAL, buf, len);
   
   Serial.printf("[SUPABASE] Evento de energía: %s\n", powerLost ? "CORTE" : "RESTAURADO");
 }
@@ -258,26 +530,35 @@ void supabaseSendPowerEvent(bool powerLost, int outageDurationSec = 0,
 // INICIAR SESIÓN DE DESCONGELAMIENTO
 // ============================================
 void supabaseSendDefrostStart(float tempAtStart, const char* triggeredBy = "manual") {
-  if (!config.supabaseEnabled || !state.internetAvailable) return;
+  if (!config.supabaseEnabled) return;
+  
+  TlmDefrost d;
+  d.end = false;
+  d.trigger = tlmLookup(TLM_TRIGGERS, TLM_COUNT(TLM_TRIGGERS), triggeredBy);
+  d.temp = tlmCenti(tempAtStart);
+  d.durationMin = 0;
   
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/defrost_sessions";
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodeDefrost(supabaseTlm, supabaseTlmNow(), deviceUnixTime(), d, buf, sizeof(buf));
+  if (len > 0) supabaseEmitRecord(UPLINK_PRIO_NORMAL, buf, len);
+}
+
+// ============================================
+// CERRAR SESIÓN DE DESCONGELAMIENTO
+// ============================================
+void supabaseSendDefrostEnd(float tempAtEnd, unsigned long durationMin) {
+  if (!config.supabaseEnabled) return;
   
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
+  // supabaseExecuteRecord() lo aplica a la última sesión abierta
+  TlmDefrost d;
+  d.end = true;
+  d.trigger = 0;
+  d.temp = tlmCenti(tempAtEnd);
+  d.durationMin = durationMin > 0xFFFF ? 0xFFFF : (uint16_t)durationMin;
   
-  StaticJsonDocument<256> doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["temp_at_start"] = tempAtStart;
-  doc["triggered_by"] = triggeredBy;
-  
-  String body;
-  serializeJson(doc, body);
-  http.POST(body);
-  http.end();
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodeDefrost(supabaseTlm, supabaseTlmNow(), deviceUnixTime(), d, buf, sizeof(buf));
+  if (len > 0) supabaseEmitRecord(UPLINK_PRIO_NORMAL, buf, len);
 }
 
 // ============================================
@@ -285,53 +566,42 @@ void supabaseSendDefrostStart(float tempAtStart, const char* triggeredBy = "manu
 // ============================================
 void supabaseSendMaintenanceLog(float compressorHours, int compressorStarts, 
                                  float maxCurrentEver, const char* notes = "") {
-  if (!config.supabaseEnabled || !state.internetAvailable) return;
-  
-  HTTPClient http;
-  String url = String(SUPABASE_URL) + "/rest/v1/maintenance_logs";
+  if (!config.supabaseEnabled) return;
   
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-  http.addHeader("Prefer", "return=minimal");
+  static TlmMaintenance m;
+  m.compressorHoursDeci = compressorHours > 0 ? (uint32_t)(compressorHours * 10 + 0.5f) : 0;
+  m.compressorStarts = compressorStarts > 0 ? (uint32_t)compressorStarts : 0;
+  m.maxCurrentCa = tlmCenti(maxCurrentEver);
+  strncpy(m.notes, notes, TLM_MSG_MAX);
+  m.notes[TLM_MSG_MAX] = '\0';
   
-  StaticJsonDocument<256> doc;
-  doc["device_id"] = DEVICE_ID;
-  doc["maintenance_type"] = "compressor_hours";
-  doc["compressor_hours"] = compressorHours;
-  doc["compressor_starts"] = compressorStarts;
-  doc["max_current_ever"] = maxCurrentEver;
-  doc["notes"] = notes;
-  
-  String body;
-  serializeJson(doc, body);
-  http.POST(body);
-  http.end();
+  uint8_t buf[TLM_RECORD_MAX];
+  size_t len = tlmEncodeMaintenance(supabaseTlm, supabaseTlmNow(), deviceUnixTime(), m, buf, sizeof(buf));
+  if (len > 0) supabaseEmitRecord(UPLINK_PRIO_NORMAL, buf, len);
 }
 
 // ============================================
-// VERIFICAR COMANDOS PENDIENTES
+// VERIFICAR COMANDOS PENDIENTES (tarea de enlace)
 // ============================================
 String supabaseCheckCommands() {
   if (!config.supabaseEnabled || !state.internetAvailable) return "";
   
-  HTTPClient http;
   String url = String(SUPABASE_URL) + "/rest/v1/commands";
   url += "?device_id=eq." + String(DEVICE_ID);
   url += "&status=eq.pending";
   url += "&order=created_at.asc";
   url += "&limit=1";
   
-  http.begin(url);
-  http.addHeader("apikey", SUPABASE_ANON_KEY);
-  http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
+  HttpPoolSlot* conn = httpPoolBegin(url);
+  if (!conn) return "";
+  conn->http.addHeader("apikey", SUPABASE_ANON_KEY);
+  conn->http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
   
-  int code = http.GET();
+  int code = httpPoolSend(conn, "GET", "");
   String command = "";
   
   if (code == 200) {
-    String response = http.getString();
+    String response = conn->http.getString();
     StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, response);
     
@@ -339,21 +609,23 @@ String supabaseCheckCommands() {
       command = doc[0]["command"].as<String>();
       int cmdId = doc[0]["id"];
       
-      // Marcar como ejecutado
-      http.end();
+      // Marcar como ejecutado (misma conexión)
+      httpPoolEnd(conn);
       
       String updateUrl = String(SUPABASE_URL) + "/rest/v1/commands?id=eq." + String(cmdId);
-      http.begin(updateUrl);
-      http.addHeader("Content-Type", "application/json");
-      http.addHeader("apikey", SUPABASE_ANON_KEY);
-      http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
-      http.PATCH("{\"status\":\"executed\"}");
+      conn = httpPoolBegin(updateUrl);
+      if (conn) {
+        conn->http.addHeader("Content-Type", "application/json");
+        conn->http.addHeader("apikey", SUPABASE_ANON_KEY);
+        conn->http.addHeader("Authorization", "Bearer " + String(SUPABASE_ANON_KEY));
+        httpPoolSend(conn, "PATCH", "{\"status\":\"executed\"}");
+      }
       
       Serial.printf("[SUPABASE] Comando recibido: %s\n", command.c_str());
     }
   }
   
-  http.end();
+  if (conn) httpPoolEnd(conn);
   return command;
 }
 
@@ -369,11 +641,17 @@ void supabaseSync() {
   if (now - state.lastSupabaseSync >= SUPABASE_SYNC_INTERVAL) {
     state.lastSupabaseSync = now;
     
-    if (state.internetAvailable) {
+    // Con diario se guarda también sin internet
+    if (state.internetAvailable || journalReady()) {
       supabaseSendReading();
     }
   }
   
+  // Lote de lecturas vencido (p.ej. se cortó internet a mitad del lote)
+  if (readingBatch.rows > 0 && now - readingBatch.firstAt >= SUPABASE_BATCH_INTERVAL_MS) {
+    supabaseFlushReadings(false);
+  }
+  
   // Actualizar estado del dispositivo (online + IP) cada 60 segundos
   static unsigned long lastDeviceUpdate = 0;
   if (now - lastDeviceUpdate >= 60000) {
@@ -384,19 +662,7 @@ void supabaseSync() {
     }
   }
   
-  // Verificar comandos cada 30 segundos
-  static unsigned long lastCommandCheck = 0;
-  if (now - lastCommandCheck >= 30000) {
-    lastCommandCheck = now;
-    
-    if (state.internetAvailable) {
-      String cmd = supabaseCheckCommands();
-      if (cmd.length() > 0) {
-        // Procesar comando (integrar con serial_api.h)
-        // processCommand(cmd);
-      }
-    }
-  }
+  // Los comandos remotos se consultan desde la tarea de enlace (uplink.h)
 }
 
 #endif
@@ -1,6 +1,10 @@
 /*
  * telegram.h - Notificaciones Telegram
- * Sistema Monitoreo Reefer v3.0
+ * Sistema Monitoreo Reefer v4.0
+ * 
+ * Los mensajes se encolan en la tarea de enlace (uplink.h), que los
+ * entrega por una conexión HTTPS persistente (http_pool.h). Las alertas
+ * llegan por la bandeja de salida (outbox.h), con reintentos.
  */
 
 #ifndef TELEGRAM_H
@@ -10,26 +14,31 @@
 #include <ArduinoJson.h>
 #include "config.h"
 #include "types.h"
+#include "uplink.h"
+#include "http_pool.h"
+#include "outbox.h"
 
 extern Config config;
 extern SystemState state;
 extern SensorData sensorData;
 
 // ============================================
-// ENVIAR MENSAJE A TELEGRAM
+// ENTREGAR MENSAJE (tarea de enlace)
 // ============================================
-void sendTelegramMessage(String message) {
-  if (strlen(TELEGRAM_BOT_TOKEN) < 10) return;
-  if (millis() - state.lastTelegramAlert < 300000) return;
-  
-  HTTPClient http;
+// Devuelve el peor código HTTP entre todos los destinatarios
+int telegramDeliver(const char* message) {
   String url = "https://api.telegram.org/bot" + String(TELEGRAM_BOT_TOKEN) + "/sendMessage";
+  int worst = 200;
   
   for (int i = 0; i < TELEGRAM_CHAT_COUNT; i++) {
-    http.begin(url);
-    http.addHeader("Content-Type", "application/json");
+    HttpPoolSlot* conn = httpPoolBegin(url);
+    if (!conn) {
+      worst = HTTPC_ERROR_CONNECTION_REFUSED;
+      continue;
+    }
+    conn->http.addHeader("Content-Type", "application/json");
     
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<1024> doc;
     doc["chat_id"] = TELEGRAM_CHAT_IDS[i];
     doc["text"] = message;
     doc["parse_mode"] = "Markdown";
@@ -37,11 +46,54 @@ void sendTelegramMessage(String message) {
     String body;
     serializeJson(doc, body);
     
-    int code = http.POST(body);
+    int code = httpPoolSend(conn, "POST", body);
     Serial.printf("[TELEGRAM] Enviado a %s: %d\n", TELEGRAM_CHAT_IDS[i], code);
-    http.end();
+    httpPoolEnd(conn);
+    
+    if (code < 200 || code >= 300) worst = code;
+  }
+  
+  return worst;
+}
+
+// ============================================
+// ENTREGAR ALERTA DE LA BANDEJA (tarea de enlace)
+// ============================================
+int telegramDeliverAlert(const AlertEvent& e) {
+  bool critical = e.severity >= tlmLookup(TLM_SEVERITIES, TLM_COUNT(TLM_SEVERITIES), "critical");
+  bool door = e.type == tlmLookup(TLM_ALERT_TYPES, TLM_COUNT(TLM_ALERT_TYPES), "door");
+  
+  String msg = "🏔️ *" + String(DEVICE_NAME) + "*\n\n";
+  if (critical) {
+    msg += "🚨 *ALERTA CRÍTICA*\n\n";
+    msg += "📍 *Dispositivo:* " + String(DEVICE_ID) + "\n";
+    msg += "📝 " + String(e.message);
+  } else {
+    msg += door ? "⚠️ *ALERTA PUERTA*\n\n" : "⚠️ *ALERTA*\n\n";
+    msg += e.message;
   }
+  if (e.repeats > 0) msg += "\n🔁 Repetida " + String(e.repeats) + " veces";
+  
+  // Entregada tarde (sin internet, reintentos): aclarar cuándo fue
+  long age = outboxAgeSec(e);
+  if (age >= 120) msg += "\n🕐 Hace " + String(age / 60) + " min";
+  
+  msg += "\n\n📍 " + String(LOCATION_DETAIL);
+  if (e.temp != TLM_NULL_I16) msg += "\n🌡️ Temp: " + String(e.temp / 100.0f, 1) + "°C";
+  
+  // Corre en la tarea de enlace: no toca state (el límite de 5 min de
+  // sendTelegramMessage es para los mensajes sueltos de loop())
+  return telegramDeliver(msg.c_str());
+}
+
+// ============================================
+// ENVIAR MENSAJE A TELEGRAM (encola)
+// ============================================
+void sendTelegramMessage(String message) {
+  if (strlen(TELEGRAM_BOT_TOKEN) < 10) return;
+  if (millis() - state.lastTelegramAlert < 300000) return;
   
+  uplinkSubmit(UPLINK_TELEGRAM, UPLINK_PRIO_CRITICAL, "", message);
   state.lastTelegramAlert = millis();
 }
 
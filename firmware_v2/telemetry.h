@@ -0,0 +1,732 @@
+/*
+ * ============================================================================
+ * TELEMETRY.H - REGISTROS BINARIOS DE TELEMETRÍA v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Formato compacto y versionado para lecturas, eventos de puerta, sesiones
+ * de defrost, alertas, cortes de luz y registros de mantenimiento. Lo
+ * comparten el firmware (uplink, buffers locales, GPRS) y las herramientas
+ * host (tlm2json). No depende de Arduino.
+ *
+ * Encabezado (little endian):
+ *   u8  versión (4 bits altos) | tipo (4 bits bajos)
+ *   u8  banderas de encabezado (TLM_HDR_*)
+ *   u16 secuencia
+ *   Si TLM_HDR_ABS_TIME: u32 ms desde el boot + u32 hora unix (0 = sin hora)
+ *   Si no:               u16 delta en 10 ms desde el registro anterior
+ *
+ * Temperaturas en centésimas de °C (int16, TLM_NULL_I16 = sin dato).
+ *
+ * Un TlmEncoder lleva secuencia y tiempo de un flujo. En modo independiente
+ * (cola del uplink, que puede descartar trabajos) cada registro lleva su
+ * hora absoluta; en un flujo continuo (buffers) solo el primero y los que
+ * siguen a un salto de más de TLM_DELTA_MAX.
+ *
+ * Cambiar el layout de un tipo = subir TLM_VERSION.
+ *
+ * ============================================================================
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// CONSTANTES
+// ============================================================================
+#define TLM_VERSION             1
+#define TLM_RECORD_MAX          192     // Mayor registro posible (alerta, mantenimiento)
+#define TLM_MSG_MAX             160     // Texto de alerta
+#define TLM_MAX_TEMPS           6
+#define TLM_MAX_DOORS           3
+#define TLM_DELTA_UNIT_MS       10
+#define TLM_DELTA_MAX           0xFFFF  // En TLM_DELTA_UNIT_MS (~655 s)
+#define TLM_NULL_I16            INT16_MIN
+
+#define TLM_HDR_ABS_TIME        0x01
+
+enum TlmType {
+    TLM_READING = 1,
+    TLM_DOOR_EVENT,
+    TLM_DEFROST,
+    TLM_ALERT,
+    TLM_POWER_EVENT,
+    TLM_MAINTENANCE
+};
+
+// Banderas de lectura (u16)
+#define TLM_F_RELAY             0x0001
+#define TLM_F_BUZZER            0x0002
+#define TLM_F_ALERT             0x0004
+#define TLM_F_DEFROST           0x0008
+#define TLM_F_SIMULATION        0x0010
+#define TLM_F_AC_POWER          0x0020
+#define TLM_F_COMPRESSOR        0x0040
+#define TLM_F_HAS_BATTERY       0x0080  // Sigue u16 batería en cV
+#define TLM_F_HAS_CURRENT       0x0100  // Siguen int16 corriente en cA
+#define TLM_F_HAS_GSM           0x0200  // Sigue u8 señal GSM
+#define TLM_F_STATE_SHIFT       12      // 4 bits altos: SystemStateEnum
+
+// Catálogos (código <-> texto de las columnas de Supabase)
+static const char* const TLM_ALERT_TYPES[] = {
+    "other", "temperature", "door", "power", "current", "offline", "maintenance"
+};
+static const char* const TLM_SEVERITIES[] = {
+    "info", "warning", "critical", "emergency"
+};
+static const char* const TLM_TRIGGERS[] = {
+    "other", "manual", "relay_signal", "scheduled", "auto"
+};
+
+#define TLM_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+// ============================================================================
+// REGISTROS DECODIFICADOS
+// ============================================================================
+struct TlmReading {
+    uint8_t tempMask;                   // Bit i: tempC[i] presente
+    int16_t tempC[TLM_MAX_TEMPS];       // Centésimas de °C
+    int16_t tempAvg;
+    int16_t tempDht;
+    uint16_t humidity;                  // Centésimas de %, 0xFFFF = sin dato
+    uint8_t doorEnabled;                // Bit i: puerta i habilitada
+    uint8_t doorOpen;                   // Bit i: puerta i abierta
+    uint16_t flags;                     // TLM_F_*
+    int8_t wifiRssi;
+    uint16_t freeHeap16;                // Heap libre / 16
+    uint16_t batteryCv;
+    int16_t currentCa;
+    uint8_t gsmSignal;
+};
+
+struct TlmDoorEvent {
+    uint8_t door;                       // 0..TLM_MAX_DOORS-1
+    bool opened;
+    uint16_t openDurationSec;           // Solo al cerrar
+    int16_t tempAtOpen;
+    int16_t tempAtClose;
+};
+
+struct TlmDefrost {
+    bool end;                           // false = inicio, true = fin
+    uint8_t trigger;                    // Índice en TLM_TRIGGERS
+    int16_t temp;                       // Al inicio o al fin
+    uint16_t durationMin;               // Solo al fin
+};
+
+struct TlmAlert {
+    uint8_t type;                       // Índice en TLM_ALERT_TYPES
+    uint8_t severity;                   // Índice en TLM_SEVERITIES
+    int16_t temp;
+    char message[TLM_MSG_MAX + 1];
+};
+
+struct TlmPowerEvent {
+    bool lost;                          // true = corte, false = vuelta
+    uint32_t outageSec;                 // Solo a la vuelta
+    uint16_t minBatteryCv;              // Solo a la vuelta
+    uint8_t batteryUsedPct;             // Solo a la vuelta
+};
+
+struct TlmMaintenance {
+    uint32_t compressorHoursDeci;       // Décimas de hora
+    uint32_t compressorStarts;
+    int16_t maxCurrentCa;
+    char notes[TLM_MSG_MAX + 1];
+};
+
+struct TlmRecord {
+    uint8_t version;
+    uint8_t type;
+    uint16_t seq;
+    uint32_t timeMs;                    // ms desde el boot
+    uint32_t unixSec;                   // 0 si el dispositivo no tiene hora
+    bool timeValid;                     // false si se perdió un registro delta
+    union {
+        TlmReading reading;
+        TlmDoorEvent door;
+        TlmDefrost defrost;
+        TlmAlert alert;
+        TlmPowerEvent power;
+        TlmMaintenance maintenance;
+    };
+};
+
+// ============================================================================
+// CONVERSIONES
+// ============================================================================
+inline int16_t tlmCenti(float v) {
+    if (isnan(v)) return TLM_NULL_I16;
+    float c = roundf(v * 100.0f);
+    if (c > 32767.0f) c = 32767.0f;
+    if (c < -32767.0f) c = -32767.0f;
+    return (int16_t)c;
+}
+
+inline uint8_t tlmLookup(const char* const* table, size_t count, const char* text) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(table[i], text) == 0) return (uint8_t)i;
+    }
+    return 0;
+}
+
+// ============================================================================
+// ESCRITURA / LECTURA DE BYTES
+// ============================================================================
+struct TlmWriter {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+
+    void u8(uint8_t v) {
+        if (len + 1 > cap) { overflow = true; return; }
+        buf[len++] = v;
+    }
+    void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); }
+    void i16(int16_t v) { u16((uint16_t)v); }
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+};
+
+struct TlmReader {
+    const uint8_t* buf;
+    size_t len;
+    size_t pos;
+    bool underflow;
+
+    uint8_t u8() {
+        if (pos + 1 > len) { underflow = true; return 0; }
+        return buf[pos++];
+    }
+    uint16_t u16() { uint16_t lo = u8(); return (uint16_t)(lo | (u8() << 8)); }
+    int16_t i16() { return (int16_t)u16(); }
+    uint32_t u32() { uint32_t lo = u16(); return lo | ((uint32_t)u16() << 16); }
+};
+
+// ============================================================================
+// CODIFICADOR
+// ============================================================================
+struct TlmEncoder {
+    uint16_t seq;
+    uint32_t lastMs;
+    bool synced;
+    bool independent;                   // Todos los registros con hora absoluta
+};
+
+inline void tlmEncoderInit(TlmEncoder& enc, bool independent) {
+    enc.seq = 0;
+    enc.lastMs = 0;
+    enc.synced = false;
+    enc.independent = independent;
+}
+
+// Forzar hora absoluta en el próximo registro (p.ej. tras perder datos)
+inline void tlmEncoderResync(TlmEncoder& enc) { enc.synced = false; }
+
+inline void tlmWriteHeader(TlmEncoder& enc, TlmWriter& w, uint8_t type,
+                           uint32_t nowMs, uint32_t unixSec) {
+    uint32_t delta = (nowMs - enc.lastMs) / TLM_DELTA_UNIT_MS;
+    bool abs = enc.independent || !enc.synced || delta > TLM_DELTA_MAX ||
+               nowMs < enc.lastMs;
+
+    w.u8((uint8_t)((TLM_VERSION << 4) | (type & 0x0F)));
+    w.u8(abs ? TLM_HDR_ABS_TIME : 0);
+    w.u16(enc.seq);
+    if (abs) {
+        w.u32(nowMs);
+        w.u32(unixSec);
+        enc.lastMs = nowMs;
+    } else {
+        w.u16((uint16_t)delta);
+        // Avanzar en unidades enteras para no acumular error de redondeo
+        enc.lastMs += delta * TLM_DELTA_UNIT_MS;
+    }
+}
+
+// Devuelve los bytes escritos, o 0 si no entra en cap (el flujo no avanza)
+inline size_t tlmFinish(TlmEncoder& enc, const TlmEncoder& before, const TlmWriter& w) {
+    if (w.overflow) {
+        enc = before;
+        return 0;
+    }
+    enc.seq++;
+    enc.synced = true;
+    return w.len;
+}
+
+// Completar la hora unix de un registro con hora absoluta guardado sin
+// hora (antes de sincronizar el reloj). nowMs/nowUnix: el mismo instante en
+// ambas bases. Devuelve true si lo modificó.
+inline bool tlmPatchUnixTime(uint8_t* rec, size_t len, uint32_t nowMs, uint32_t nowUnix) {
+    if (len < 12 || !(rec[1] & TLM_HDR_ABS_TIME) || nowUnix == 0) return false;
+    uint32_t unixSec = rec[8] | (uint32_t)rec[9] << 8 | (uint32_t)rec[10] << 16 | (uint32_t)rec[11] << 24;
+    if (unixSec != 0) return false;
+    uint32_t ms = rec[4] | (uint32_t)rec[5] << 8 | (uint32_t)rec[6] << 16 | (uint32_t)rec[7] << 24;
+    if (nowMs < ms) return false;
+    unixSec = nowUnix - (nowMs - ms) / 1000;
+    for (int i = 0; i < 4; i++) rec[8 + i] = (uint8_t)(unixSec >> (8 * i));
+    return true;
+}
+
+inline size_t tlmEncodeReading(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                               const TlmReading& r, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_READING, nowMs, unixSec);
+
+    w.u8(r.tempMask);
+    for (int i = 0; i < TLM_MAX_TEMPS; i++) {
+        if (r.tempMask & (1 << i)) w.i16(r.tempC[i]);
+    }
+    w.i16(r.tempAvg);
+    w.i16(r.tempDht);
+    w.u16(r.humidity);
+    w.u8((uint8_t)((r.doorEnabled << 4) | (r.doorOpen & 0x0F)));
+    w.u16(r.flags);
+    w.u8((uint8_t)r.wifiRssi);
+    w.u16(r.freeHeap16);
+    if (r.flags & TLM_F_HAS_BATTERY) w.u16(r.batteryCv);
+    if (r.flags & TLM_F_HAS_CURRENT) w.i16(r.currentCa);
+    if (r.flags & TLM_F_HAS_GSM) w.u8(r.gsmSignal);
+
+    return tlmFinish(enc, before, w);
+}
+
+inline size_t tlmEncodeDoorEvent(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                                 const TlmDoorEvent& d, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_DOOR_EVENT, nowMs, unixSec);
+
+    bool closeData = !d.opened && d.openDurationSec > 0;
+    w.u8((uint8_t)((d.door & 0x07) | (closeData ? 0x40 : 0) | (d.opened ? 0x80 : 0)));
+    if (closeData) {
+        w.u16(d.openDurationSec);
+        w.i16(d.tempAtOpen);
+        w.i16(d.tempAtClose);
+    }
+    return tlmFinish(enc, before, w);
+}
+
+inline size_t tlmEncodeDefrost(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                               const TlmDefrost& d, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_DEFROST, nowMs, unixSec);
+
+    w.u8((uint8_t)((d.end ? 0x01 : 0) | (d.trigger << 4)));
+    w.i16(d.temp);
+    if (d.end) w.u16(d.durationMin);
+    return tlmFinish(enc, before, w);
+}
+
+inline size_t tlmEncodeAlert(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                             const TlmAlert& a, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_ALERT, nowMs, unixSec);
+
+    size_t msgLen = strnlen(a.message, TLM_MSG_MAX);
+    w.u8(a.type);
+    w.u8(a.severity);
+    w.i16(a.temp);
+    w.u8((uint8_t)msgLen);
+    for (size_t i = 0; i < msgLen; i++) w.u8((uint8_t)a.message[i]);
+    return tlmFinish(enc, before, w);
+}
+
+inline size_t tlmEncodePowerEvent(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                                  const TlmPowerEvent& p, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_POWER_EVENT, nowMs, unixSec);
+
+    w.u8(p.lost ? 0x01 : 0);
+    if (!p.lost) {
+        w.u32(p.outageSec);
+        w.u16(p.minBatteryCv);
+        w.u8(p.batteryUsedPct);
+    }
+    return tlmFinish(enc, before, w);
+}
+
+inline size_t tlmEncodeMaintenance(TlmEncoder& enc, uint32_t nowMs, uint32_t unixSec,
+                                   const TlmMaintenance& m, uint8_t* out, size_t cap) {
+    TlmEncoder before = enc;
+    TlmWriter w = { out, cap, 0, false };
+    tlmWriteHeader(enc, w, TLM_MAINTENANCE, nowMs, unixSec);
+
+    size_t notesLen = strnlen(m.notes, TLM_MSG_MAX);
+    w.u32(m.compressorHoursDeci);
+    w.u32(m.compressorStarts);
+    w.i16(m.maxCurrentCa);
+    w.u8((uint8_t)notesLen);
+    for (size_t i = 0; i < notesLen; i++) w.u8((uint8_t)m.notes[i]);
+    return tlmFinish(enc, before, w);
+}
+
+// ============================================================================
+// DECODIFICADOR
+// ============================================================================
+struct TlmDecoder {
+    uint32_t lastMs;
+    uint32_t unixBase;                  // Hora unix en baseMs (0 = sin hora)
+    uint32_t baseMs;
+    uint16_t nextSeq;
+    bool synced;
+};
+
+inline void tlmDecoderInit(TlmDecoder& dec) {
+    memset(&dec, 0, sizeof(dec));
+}
+
+// Decodifica un registro. Devuelve los bytes consumidos, 0 si faltan
+// bytes, o -1 si el registro es inválido (versión/tipo desconocidos).
+inline int tlmDecode(TlmDecoder& dec, const uint8_t* buf, size_t len, TlmRecord& rec) {
+    TlmReader r = { buf, len, 0, false };
+    memset(&rec, 0, sizeof(rec));
+
+    uint8_t vt = r.u8();
+    rec.version = vt >> 4;
+    rec.type = vt & 0x0F;
+    uint8_t hdr = r.u8();
+    rec.seq = r.u16();
+    if (r.underflow) return 0;
+    if (rec.version != TLM_VERSION || rec.type < TLM_READING || rec.type > TLM_MAINTENANCE) return -1;
+
+    uint32_t timeMs, unixBase = dec.unixBase, baseMs = dec.baseMs;
+    bool timeValid;
+    if (hdr & TLM_HDR_ABS_TIME) {
+        timeMs = r.u32();
+        unixBase = r.u32();
+        baseMs = timeMs;
+        timeValid = true;
+    } else {
+        timeMs = dec.lastMs + (uint32_t)r.u16() * TLM_DELTA_UNIT_MS;
+        // Un hueco en la secuencia deja el delta sin referencia
+        timeValid = dec.synced && rec.seq == dec.nextSeq;
+    }
+
+    switch (rec.type) {
+        case TLM_READING: {
+            TlmReading& rd = rec.reading;
+            rd.tempMask = r.u8();
+            for (int i = 0; i < TLM_MAX_TEMPS; i++) {
+                rd.tempC[i] = (rd.tempMask & (1 << i)) ? r.i16() : TLM_NULL_I16;
+            }
+            rd.tempAvg = r.i16();
+            rd.tempDht = r.i16();
+            rd.humidity = r.u16();
+            uint8_t doors = r.u8();
+            rd.doorEnabled = doors >> 4;
+            rd.doorOpen = doors & 0x0F;
+            rd.flags = r.u16();
+            rd.wifiRssi = (int8_t)r.u8();
+            rd.freeHeap16 = r.u16();
+            if (rd.flags & TLM_F_HAS_BATTERY) rd.batteryCv = r.u16();
+            if (rd.flags & TLM_F_HAS_CURRENT) rd.currentCa = r.i16();
+            if (rd.flags & TLM_F_HAS_GSM) rd.gsmSignal = r.u8();
+            break;
+        }
+        case TLM_DOOR_EVENT: {
+            uint8_t b = r.u8();
+            rec.door.door = b & 0x07;
+            rec.door.opened = (b & 0x80) != 0;
+            if (b & 0x40) {
+                rec.door.openDurationSec = r.u16();
+                rec.door.tempAtOpen = r.i16();
+                rec.door.tempAtClose = r.i16();
+            }
+            break;
+        }
+        case TLM_DEFROST: {
+            uint8_t b = r.u8();
+            rec.defrost.end = (b & 0x01) != 0;
+            rec.defrost.trigger = b >> 4;
+            rec.defrost.temp = r.i16();
+            if (rec.defrost.end) rec.defrost.durationMin = r.u16();
+            break;
+        }
+        case TLM_ALERT: {
+            rec.alert.type = r.u8();
+            rec.alert.severity = r.u8();
+            rec.alert.temp = r.i16();
+            uint8_t n = r.u8();
+            if (n > TLM_MSG_MAX) return -1;
+            for (uint8_t i = 0; i < n; i++) rec.alert.message[i] = (char)r.u8();
+            rec.alert.message[n] = '\0';
+            break;
+        }
+        case TLM_POWER_EVENT: {
+            rec.power.lost = (r.u8() & 0x01) != 0;
+            if (!rec.power.lost) {
+                rec.power.outageSec = r.u32();
+                rec.power.minBatteryCv = r.u16();
+                rec.power.batteryUsedPct = r.u8();
+            }
+            break;
+        }
+        case TLM_MAINTENANCE: {
+            rec.maintenance.compressorHoursDeci = r.u32();
+            rec.maintenance.compressorStarts = r.u32();
+            rec.maintenance.maxCurrentCa = r.i16();
+            uint8_t n = r.u8();
+            if (n > TLM_MSG_MAX) return -1;
+            for (uint8_t i = 0; i < n; i++) rec.maintenance.notes[i] = (char)r.u8();
+            rec.maintenance.notes[n] = '\0';
+            break;
+        }
+    }
+    if (r.underflow) return 0;
+
+    rec.timeMs = timeMs;
+    rec.timeValid = timeValid;
+    rec.unixSec = (timeValid && unixBase) ? unixBase + (timeMs - baseMs) / 1000 : 0;
+
+    dec.lastMs = timeMs;
+    dec.unixBase = unixBase;
+    dec.baseMs = baseMs;
+    dec.nextSeq = (uint16_t)(rec.seq + 1);
+    dec.synced = timeValid;
+    return (int)r.pos;
+}
+
+// ============================================================================
+// TRANSCODIFICACIÓN A JSON (columnas de Supabase)
+// ============================================================================
+struct TlmJson {
+    char* out;
+    size_t cap;
+    size_t len;
+    bool first;
+
+    void raw(const char* s) {
+        size_t n = strlen(s);
+        if (len + n < cap) { memcpy(out + len, s, n); len += n; out[len] = '\0'; }
+        else len = cap;
+    }
+    void key(const char* k) {
+        if (!first) raw(",");
+        first = false;
+        raw("\"");
+        raw(k);
+        raw("\":");
+    }
+    void str(const char* k, const char* v) {
+        key(k);
+        raw("\"");
+        // Escapar comillas, barras y controles
+        for (const char* p = v; *p; p++) {
+            char esc[8];
+            unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\') { esc[0] = '\\'; esc[1] = (char)c; esc[2] = '\0'; }
+            else if (c == '\n') strcpy(esc, "\\n");
+            else if (c < 0x20) snprintf(esc, sizeof(esc), "\\u%04x", c);
+            else { esc[0] = (char)c; esc[1] = '\0'; }
+            raw(esc);
+        }
+        raw("\"");
+    }
+    void num(const char* k, long v) {
+        char b[16];
+        snprintf(b, sizeof(b), "%ld", v);
+        key(k);
+        raw(b);
+    }
+    void num64(const char* k, uint64_t v) {
+        char b[24];
+        snprintf(b, sizeof(b), "%llu", (unsigned long long)v);
+        key(k);
+        raw(b);
+    }
+    void boolean(const char* k, bool v) { key(k); raw(v ? "true" : "false"); }
+    void centi(const char* k, int32_t v) {
+        key(k);
+        if (v == TLM_NULL_I16) { raw("null"); return; }
+        // Sin ceros de más: -20, -20.5, -20.25
+        char b[16];
+        int32_t a = v < 0 ? -v : v;
+        int32_t frac = a % 100;
+        if (frac == 0) snprintf(b, sizeof(b), "%s%ld", v < 0 ? "-" : "", (long)(a / 100));
+        else if (frac % 10 == 0) snprintf(b, sizeof(b), "%s%ld.%ld", v < 0 ? "-" : "", (long)(a / 100), (long)(frac / 10));
+        else snprintf(b, sizeof(b), "%s%ld.%02ld", v < 0 ? "-" : "", (long)(a / 100), (long)frac);
+        raw(b);
+    }
+    void timestamp(const char* k, uint32_t unixSec) {
+        key(k);
+        if (unixSec == 0) { raw("\"now\""); return; }
+        // Fecha civil UTC desde días unix (algoritmo de H. Hinnant)
+        long z = (long)(unixSec / 86400) + 719468;
+        long era = z / 146097;
+        long doe = z - era * 146097;
+        long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        long mp = (5 * doy + 2) / 153;
+        long d = doy - (153 * mp + 2) / 5 + 1;
+        long m = mp < 10 ? mp + 3 : mp - 9;
+        long y = yoe + era * 400 + (m <= 2);
+        uint32_t sod = unixSec % 86400;
+        char b[32];
+        snprintf(b, sizeof(b), "\"%04ld-%02ld-%02ldT%02lu:%02lu:%02luZ\"", y, m, d,
+                 (unsigned long)(sod / 3600), (unsigned long)(sod / 60 % 60),
+                 (unsigned long)(sod % 60));
+        raw(b);
+    }
+};
+
+// Columnas que emite tlmRecordToJson() para lecturas con estas máscaras y
+// banderas (unión de un lote): PostgREST exige las mismas claves en todas
+// las filas de un insert masivo salvo que se indique ?columns=.
+inline int tlmReadingColumns(uint8_t tempMask, uint8_t doorMask, uint16_t flags,
+                             bool withTime, bool withSeq, char* out, size_t cap) {
+    if (cap == 0) return -1;
+    out[0] = '\0';
+    TlmJson j = { out, cap, 0, true };
+    char k[16];
+    j.raw("device_id");
+    for (int i = 0; i < TLM_MAX_TEMPS; i++) {
+        if (!(tempMask & (1 << i))) continue;
+        snprintf(k, sizeof(k), ",temp%d", i + 1);
+        j.raw(k);
+    }
+    j.raw(",temp_avg,temp_dht,humidity");
+    for (int i = 0; i < TLM_MAX_DOORS; i++) {
+        if (!(doorMask & (1 << i))) continue;
+        snprintf(k, sizeof(k), ",door%d_open", i + 1);
+        j.raw(k);
+    }
+    j.raw(",ac_power");
+    if (flags & TLM_F_HAS_BATTERY) j.raw(",battery_voltage");
+    if (flags & TLM_F_HAS_CURRENT) j.raw(",current_amps,compressor_running");
+    j.raw(",relay_on,buzzer_on,alert_active,defrost_mode,simulation_mode,wifi_rssi");
+    if (flags & TLM_F_HAS_GSM) j.raw(",gsm_signal");
+    j.raw(",uptime_sec,free_heap");
+    if (withTime) j.raw(",created_at");
+    if (withSeq) j.raw(",seq");
+    return j.len >= cap ? -1 : (int)j.len;
+}
+
+// Arma el JSON de la fila. doorNames puede ser NULL (se omite door_name).
+// seq != 0 agrega la clave de idempotencia (columna seq).
+// Devuelve la longitud, o -1 si no entra en cap.
+inline int tlmRecordToJson(const TlmRecord& rec, const char* deviceId,
+                           const char* const* doorNames, char* out, size_t cap,
+                           uint64_t seq = 0) {
+    if (cap == 0) return -1;
+    out[0] = '\0';
+    TlmJson j = { out, cap, 0, true };
+    j.raw("{");
+    // El fin de defrost es un PATCH sobre la sesión abierta: sin device_id
+    if (!(rec.type == TLM_DEFROST && rec.defrost.end)) j.str("device_id", deviceId);
+
+    switch (rec.type) {
+        case TLM_READING: {
+            const TlmReading& r = rec.reading;
+            char k[16];
+            for (int i = 0; i < TLM_MAX_TEMPS; i++) {
+                if (!(r.tempMask & (1 << i))) continue;
+                snprintf(k, sizeof(k), "temp%d", i + 1);
+                j.centi(k, r.tempC[i]);
+            }
+            j.centi("temp_avg", r.tempAvg);
+            j.centi("temp_dht", r.tempDht);
+            j.centi("humidity", r.humidity == 0xFFFF ? TLM_NULL_I16 : r.humidity);
+            for (int i = 0; i < TLM_MAX_DOORS; i++) {
+                if (!(r.doorEnabled & (1 << i))) continue;
+                snprintf(k, sizeof(k), "door%d_open", i + 1);
+                j.boolean(k, (r.doorOpen & (1 << i)) != 0);
+            }
+            j.boolean("ac_power", (r.flags & TLM_F_AC_POWER) != 0);
+            if (r.flags & TLM_F_HAS_BATTERY) j.centi("battery_voltage", r.batteryCv);
+            if (r.flags & TLM_F_HAS_CURRENT) {
+                j.centi("current_amps", r.currentCa);
+                j.boolean("compressor_running", (r.flags & TLM_F_COMPRESSOR) != 0);
+            }
+            j.boolean("relay_on", (r.flags & TLM_F_RELAY) != 0);
+            j.boolean("buzzer_on", (r.flags & TLM_F_BUZZER) != 0);
+            j.boolean("alert_active", (r.flags & TLM_F_ALERT) != 0);
+            j.boolean("defrost_mode", (r.flags & TLM_F_DEFROST) != 0);
+            j.boolean("simulation_mode", (r.flags & TLM_F_SIMULATION) != 0);
+            j.num("wifi_rssi", r.wifiRssi);
+            if (r.flags & TLM_F_HAS_GSM) j.num("gsm_signal", r.gsmSignal);
+            j.num("uptime_sec", (long)(rec.timeMs / 1000));
+            j.num("free_heap", (long)r.freeHeap16 * 16);
+            break;
+        }
+        case TLM_DOOR_EVENT: {
+            const TlmDoorEvent& d = rec.door;
+            j.num("door_number", d.door + 1);
+            if (doorNames) j.str("door_name", doorNames[d.door]);
+            j.str("event_type", d.opened ? "opened" : "closed");
+            if (!d.opened && d.openDurationSec > 0) {
+                j.num("open_duration_sec", d.openDurationSec);
+                j.centi("temp_at_open", d.tempAtOpen);
+                j.centi("temp_at_close", d.tempAtClose);
+                j.centi("temp_rise", (int32_t)d.tempAtClose - d.tempAtOpen);
+            }
+            break;
+        }
+        case TLM_DEFROST: {
+            const TlmDefrost& d = rec.defrost;
+            if (d.end) {
+                j.timestamp("ended_at", rec.unixSec);
+                j.centi("temp_at_end", d.temp);
+                j.num("duration_minutes", d.durationMin);
+            } else {
+                j.timestamp("started_at", rec.unixSec);
+                j.centi("temp_at_start", d.temp);
+                j.str("triggered_by", d.trigger < TLM_COUNT(TLM_TRIGGERS) ?
+                                      TLM_TRIGGERS[d.trigger] : "other");
+            }
+            break;
+        }
+        case TLM_ALERT: {
+            const TlmAlert& a = rec.alert;
+            j.str("alert_type", a.type < TLM_COUNT(TLM_ALERT_TYPES) ?
+                                TLM_ALERT_TYPES[a.type] : "other");
+            j.str("severity", a.severity < TLM_COUNT(TLM_SEVERITIES) ?
+                              TLM_SEVERITIES[a.severity] : "warning");
+            j.str("message", a.message);
+            if (a.temp != TLM_NULL_I16) j.centi("temperature", a.temp);
+            break;
+        }
+        case TLM_POWER_EVENT: {
+            const TlmPowerEvent& p = rec.power;
+            j.str("event_type", p.lost ? "power_lost" : "power_restored");
+            if (!p.lost) {
+                j.num("outage_duration_sec", (long)p.outageSec);
+                j.centi("min_battery_voltage", p.minBatteryCv);
+                j.num("battery_used_percent", p.batteryUsedPct);
+            }
+            break;
+        }
+        case TLM_MAINTENANCE: {
+            const TlmMaintenance& m = rec.maintenance;
+            char hours[16];
+            snprintf(hours, sizeof(hours), "%lu.%lu", (unsigned long)(m.compressorHoursDeci / 10),
+                     (unsigned long)(m.compressorHoursDeci % 10));
+            j.str("maintenance_type", "compressor_hours");
+            j.key("compressor_hours");
+            j.raw(hours);
+            j.num("compressor_starts", (long)m.compressorStarts);
+            j.centi("max_current_ever", m.maxCurrentCa);
+            j.str("notes", m.notes);
+            break;
+        }
+    }
+
+    // Filas con hora del dispositivo (el defrost ya la lleva en su columna)
+    if (rec.type != TLM_DEFROST && rec.unixSec != 0) {
+        j.timestamp("created_at", rec.unixSec);
+    }
+    if (seq != 0) j.num64("seq", seq);
+    j.raw("}");
+    return j.len >= cap ? -1 : (int)j.len;
+}
+
+#endif // TELEMETRY_H
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Genera ui_assets.h a partir de ui/ (dashboard embebido)
+
+Cada archivo se comprime con gzip y queda como arreglo PROGMEM con su
+ETag (hash del contenido). index.html referencia app.css y app.js con
+{{app.css}} / {{app.js}}, que se reemplazan por la URL versionada
+(/app.css?v=<hash>): esos dos se pueden cachear para siempre y solo
+index.html se revalida (304 si no cambió).
+
+Uso (desde firmware_v2/, después de editar ui/):
+    python3 tools/build_ui.py
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+FIRMWARE_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+UI_DIR = os.path.join(FIRMWARE_DIR, "ui")
+OUTPUT = os.path.join(FIRMWARE_DIR, "ui_assets.h")
+
+# (archivo, ruta HTTP, Content-Type, versionado en la URL)
+ASSETS = [
+    ("app.css", "/app.css", "text/css", True),
+    ("app.js", "/app.js", "application/javascript", True),
+    ("index.html", "/", "text/html; charset=utf-8", False),
+]
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "const uint8_t %s[] PROGMEM = {\n%s\n};\n" % (name, "\n".join(lines))
+
+def main():
+    hashes = {}
+    entries = []
+    arrays = []
+
+    for filename, path, content_type, versioned in ASSETS:
+        with open(os.path.join(UI_DIR, filename), "rb") as f:
+            raw = f.read()
+
+        # Referencias a los otros archivos (ya procesados)
+        for ref, h in hashes.items():
+            raw = raw.replace(("{{%s}}" % ref).encode(), ("/%s?v=%s" % (ref, h)).encode())
+        if b"{{" in raw:
+            sys.exit("[ERROR] %s: referencia sin resolver" % filename)
+
+        h = content_hash(raw)
+        hashes[filename] = h
+        # mtime=0: misma entrada -> mismos bytes
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+
+        name = "UI_" + filename.upper().replace(".", "_") + "_GZ"
+        arrays.append("// %s: %d bytes, %d con gzip\n" % (filename, len(raw), len(gz)) + c_array(name, gz))
+        entries.append('  { "%s", "%s", %s, sizeof(%s), "\\"%s\\"", %s },'
+                       % (path, content_type, name, name, h, "true" if versioned else "false"))
+        print("%-12s %6d -> %5d bytes  ETag %s" % (filename, len(raw), len(gz), h))
+
+    with open(OUTPUT, "w") as f:
+        f.write("/*\n"
+                " * ui_assets.h - Dashboard embebido comprimido (GENERADO)\n"
+                " * Sistema Monitoreo Reefer v4.0\n"
+                " *\n"
+                " * No editar: se genera desde ui/ con tools/build_ui.py\n"
+                " */\n\n"
+                "#ifndef UI_ASSETS_H\n"
+                "#define UI_ASSETS_H\n\n")
+        f.write("\n".join(arrays))
+        f.write("\nconst UiAsset UI_ASSETS[] = {\n%s\n};\n\n" % "\n".join(entries))
+        f.write("#define UI_ASSET_COUNT (sizeof(UI_ASSETS) / sizeof(UI_ASSETS[0]))\n\n")
+        f.write("#endif\n")
+
+    print("[OK] %s" % os.path.relpath(OUTPUT, FIRMWARE_DIR))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,409 @@
+/*
+ * ============================================================================
+ * TRACE.H - FORMATO DE TRAZAS DE ENTRADAS v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Traza compacta de lo que entra a sensors.h, alerts.h y state_machine.h:
+ * lecturas de cada sonda, nivel de los pines de puerta y de defrost, y la
+ * configuración con las reglas de alerta. La escribe el firmware
+ * (recorder.h) y la reproducen las herramientas host (trace_replay). No
+ * depende de Arduino.
+ *
+ * Registro:
+ *   u8      tipo (3 bits altos) | canal (5 bits bajos); 0xFF = fin del sector
+ *   varint  ms desde el registro anterior
+ *   datos según el tipo:
+ *     TRACE_KEY         u32 ms desde el boot | u32 hora unix (0 = sin hora) |
+ *                       u8 sondas | int16 por sonda | u8 niveles de entradas
+ *                       (canal: TRACE_KEY_*)
+ *     TRACE_PROBE       varint zigzag: cambio en 1/16 °C (canal: sonda)
+ *     TRACE_PROBE_FAIL  sin datos: lectura fallida (canal: sonda)
+ *     TRACE_INPUT       sin datos (canal: entrada << 1 | nivel)
+ *     TRACE_CONFIG      TRACE_CONFIG_SIZE bytes (canal: TRACE_CONFIG_*)
+ *     TRACE_RULE        u8 señal | u8 índice | u8 tipo | u8 banderas |
+ *                       f32 umbral | f32 histéresis | u16 duración |
+ *                       u16 repetir (canal: número de regla)
+ *
+ * Temperaturas en 1/16 °C (la resolución del DS18B20): sin pérdida salvo la
+ * banda muerta del grabador. TRACE_TEMP_NULL = sin lectura válida.
+ *
+ * Cada sector empieza con TRACE_KEY + TRACE_CONFIG con el estado completo:
+ * se puede decodificar solo, aunque el anillo haya pisado los anteriores.
+ * Cada TRACE_CONFIG va seguido de sus ruleCount TRACE_RULE, con el mismo
+ * tiempo.
+ *
+ * Cambiar el layout de un tipo = subir TRACE_VERSION. Versión 1: sin
+ * reglas (TRACE_CONFIG de 27 bytes, sin TRACE_RULE); se sigue leyendo.
+ *
+ * ============================================================================
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "telemetry.h"
+
+// ============================================================================
+// CONSTANTES
+// ============================================================================
+#define TRACE_VERSION           2
+#define TRACE_VERSION_NO_RULES  1       // Trazas anteriores a las reglas
+#define TRACE_MAGIC             0x52545252UL    // "RRTR"
+#define TRACE_SECTOR_HDR        12
+#define TRACE_END               0xFF
+#define TRACE_RECORD_MAX        48      // Mayor registro (clave con 6 sondas)
+#define TRACE_MAX_PROBES        6
+#define TRACE_MAX_INPUTS        4
+#define TRACE_TEMP_NULL         INT16_MIN
+#define TRACE_CONFIG_SIZE       31
+#define TRACE_MAX_RULES         32      // Canal de 5 bits
+
+enum TraceType {
+    TRACE_KEY = 0,
+    TRACE_PROBE,
+    TRACE_PROBE_FAIL,
+    TRACE_INPUT,
+    TRACE_CONFIG,
+    TRACE_RULE
+};
+
+// Entradas digitales (canal de TRACE_INPUT)
+enum TraceInput {
+    TRACE_IN_DOOR_1 = 0,
+    TRACE_IN_DOOR_2,
+    TRACE_IN_DOOR_3,
+    TRACE_IN_DEFROST
+};
+
+#define TRACE_KEY_BOOT          0x01    // Primer registro tras un arranque
+#define TRACE_CONFIG_SAVED      0x01    // saveConfig() (no copia de sector)
+
+// Banderas de configuración
+#define TRACE_CFG_DEFROST_NC    0x01
+#define TRACE_CFG_SIMULATION    0x02
+#define TRACE_CFG_RELAY         0x04
+
+// ============================================================================
+// REGISTROS DECODIFICADOS
+// ============================================================================
+// Lo que la traza necesita de Config (lo que usan alertas y estados)
+struct TraceConfig {
+    int16_t tempMax;                    // Centésimas de °C
+    int16_t tempCritical;
+    uint32_t alertDelaySec;
+    uint32_t doorOpenMaxSec;
+    uint32_t defrostCooldownSec;
+    uint32_t defrostMaxDurationSec;
+    uint32_t configApplyTimeSec;
+    uint8_t flags;                      // TRACE_CFG_*
+    uint8_t probeEnabled;               // Bit i: sonda i habilitada
+    uint8_t doorEnabled;                // Bit i: puerta i habilitada
+    // Desde la versión 2 (hasRules = false en una traza versión 1)
+    bool hasRules;
+    uint8_t ruleCount;                  // TRACE_RULE que siguen
+    uint8_t interiorProbes;
+    uint16_t trendHorizonMin;
+};
+
+// Una regla de alerta (AlertRule de types.h, sin depender de Arduino)
+struct TraceRule {
+    uint8_t signal;
+    uint8_t index;
+    uint8_t kind;
+    uint8_t flags;
+    float threshold;
+    float hysteresis;
+    uint16_t durationSec;
+    uint16_t repeatSec;
+};
+
+struct TraceKey {
+    uint32_t uptimeMs;
+    uint32_t unixSec;
+    uint8_t probeCount;
+    int16_t temp[TRACE_MAX_PROBES];     // 1/16 °C
+    uint8_t inputs;                     // Bit i: nivel de la entrada i
+};
+
+struct TraceRecord {
+    uint8_t type;
+    uint8_t channel;
+    uint32_t timeMs;                    // ms desde el boot
+    int16_t temp;                       // TRACE_PROBE: valor absoluto
+    TraceKey key;
+    TraceConfig config;
+    TraceRule rule;
+};
+
+// ============================================================================
+// CONVERSIONES
+// ============================================================================
+inline int16_t traceTemp16(float c) {
+    if (isnan(c)) return TRACE_TEMP_NULL;
+    float q = roundf(c * 16.0f);
+    if (q > 32767.0f) q = 32767.0f;
+    if (q < -32767.0f) q = -32767.0f;
+    return (int16_t)q;
+}
+
+inline float traceTempC(int16_t q) {
+    return q / 16.0f;
+}
+
+inline void traceVarint(TlmWriter& w, uint32_t v) {
+    while (v >= 0x80) {
+        w.u8((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    w.u8((uint8_t)v);
+}
+
+// float tal cual (umbrales de reglas: el replay los necesita exactos)
+inline void traceF32(TlmWriter& w, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, 4);
+    w.u32(bits);
+}
+
+inline float traceReadF32(TlmReader& r) {
+    uint32_t bits = r.u32();
+    float v;
+    memcpy(&v, &bits, 4);
+    return v;
+}
+
+inline uint32_t traceReadVarint(TlmReader& r) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t b = r.u8();
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r.underflow = true;
+    return 0;
+}
+
+// ============================================================================
+// CODIFICADOR
+// ============================================================================
+// Lleva el tiempo y el último valor de cada sonda (los cambios son deltas)
+struct TraceEncoder {
+    uint32_t lastMs;
+    int16_t temp[TRACE_MAX_PROBES];
+};
+
+inline void traceHeader(TraceEncoder& enc, TlmWriter& w, uint8_t type, uint8_t channel, uint32_t nowMs) {
+    w.u8((uint8_t)(type << 5 | (channel & 0x1F)));
+    traceVarint(w, nowMs - enc.lastMs);
+    enc.lastMs = nowMs;
+}
+
+// Devuelven los bytes escritos (out de TRACE_RECORD_MAX)
+// La clave reinicia la base de tiempo: los deltas siguientes son desde k.uptimeMs
+inline size_t traceEncodeKey(TraceEncoder& enc, uint8_t* out, uint8_t flags, const TraceKey& k) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    enc.lastMs = k.uptimeMs;
+    traceHeader(enc, w, TRACE_KEY, flags, k.uptimeMs);
+    w.u32(k.uptimeMs);
+    w.u32(k.unixSec);
+    uint8_t count = k.probeCount < TRACE_MAX_PROBES ? k.probeCount : TRACE_MAX_PROBES;
+    w.u8(count);
+    for (int i = 0; i < count; i++) w.i16(k.temp[i]);
+    w.u8(k.inputs);
+    for (int i = 0; i < TRACE_MAX_PROBES; i++) enc.temp[i] = i < count ? k.temp[i] : TRACE_TEMP_NULL;
+    return w.len;
+}
+
+inline size_t traceEncodeProbe(TraceEncoder& enc, uint8_t* out, uint32_t nowMs, uint8_t probe, int16_t temp) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    int32_t prev = enc.temp[probe] == TRACE_TEMP_NULL ? 0 : enc.temp[probe];
+    int32_t d = (int32_t)temp - prev;
+    traceHeader(enc, w, TRACE_PROBE, probe, nowMs);
+    traceVarint(w, (uint32_t)((d << 1) ^ (d >> 31)));
+    enc.temp[probe] = temp;
+    return w.len;
+}
+
+inline size_t traceEncodeProbeFail(TraceEncoder& enc, uint8_t* out, uint32_t nowMs, uint8_t probe) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    traceHeader(enc, w, TRACE_PROBE_FAIL, probe, nowMs);
+    return w.len;
+}
+
+inline size_t traceEncodeInput(TraceEncoder& enc, uint8_t* out, uint32_t nowMs, uint8_t input, bool level) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    traceHeader(enc, w, TRACE_INPUT, (uint8_t)(input << 1 | (level ? 1 : 0)), nowMs);
+    return w.len;
+}
+
+inline size_t traceEncodeConfig(TraceEncoder& enc, uint8_t* out, uint8_t flags, uint32_t nowMs,
+                                const TraceConfig& c) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    traceHeader(enc, w, TRACE_CONFIG, flags, nowMs);
+    w.i16(c.tempMax);
+    w.i16(c.tempCritical);
+    w.u32(c.alertDelaySec);
+    w.u32(c.doorOpenMaxSec);
+    w.u32(c.defrostCooldownSec);
+    w.u32(c.defrostMaxDurationSec);
+    w.u32(c.configApplyTimeSec);
+    w.u8(c.flags);
+    w.u8(c.probeEnabled);
+    w.u8(c.doorEnabled);
+    w.u8(c.ruleCount);
+    w.u8(c.interiorProbes);
+    w.u16(c.trendHorizonMin);
+    return w.len;
+}
+
+// Después de traceEncodeConfig, con el mismo nowMs (delta 0)
+inline size_t traceEncodeRule(TraceEncoder& enc, uint8_t* out, uint8_t index, uint32_t nowMs,
+                              const TraceRule& rule) {
+    TlmWriter w = { out, TRACE_RECORD_MAX, 0, false };
+    traceHeader(enc, w, TRACE_RULE, index, nowMs);
+    w.u8(rule.signal);
+    w.u8(rule.index);
+    w.u8(rule.kind);
+    w.u8(rule.flags);
+    traceF32(w, rule.threshold);
+    traceF32(w, rule.hysteresis);
+    w.u16(rule.durationSec);
+    w.u16(rule.repeatSec);
+    return w.len;
+}
+
+// ============================================================================
+// SECTORES
+// ============================================================================
+// Encabezado: u32 magia | u8 versión | u8 reservado | u16 arranque | u32 número
+inline void traceWriteSectorHdr(uint8_t* out, uint16_t boot, uint32_t number) {
+    TlmWriter w = { out, TRACE_SECTOR_HDR, 0, false };
+    w.u32(TRACE_MAGIC);
+    w.u8(TRACE_VERSION);
+    w.u8(0);
+    w.u16(boot);
+    w.u32(number);
+}
+
+// version: la del sector (se aceptan desde TRACE_VERSION_NO_RULES)
+inline bool traceReadSectorHdr(const uint8_t* in, uint16_t& boot, uint32_t& number,
+                               uint8_t& version) {
+    TlmReader r = { in, TRACE_SECTOR_HDR, 0, false };
+    if (r.u32() != TRACE_MAGIC) return false;
+    version = r.u8();
+    if (version < TRACE_VERSION_NO_RULES || version > TRACE_VERSION) return false;
+    r.u8();
+    boot = r.u16();
+    number = r.u32();
+    return true;
+}
+
+// ============================================================================
+// DECODIFICADOR
+// ============================================================================
+// Recorre los registros de un sector. Un sector empieza siempre con
+// TRACE_KEY: el decodificador no necesita nada del anterior.
+struct TraceDecoder {
+    uint8_t version;                    // Del encabezado del sector
+    uint32_t lastMs;                    // Tiempo del registro anterior
+    int16_t temp[TRACE_MAX_PROBES];
+    bool keyed;                         // Ya se leyó la clave del sector
+};
+
+inline void traceDecoderInit(TraceDecoder& dec, uint8_t version = TRACE_VERSION) {
+    memset(&dec, 0, sizeof(dec));
+    dec.version = version;
+}
+
+// Devuelve los bytes leídos, 0 al llegar al fin del sector o -1 si el
+// registro está cortado o no se entiende (el resto del sector se descarta)
+inline int traceDecode(TraceDecoder& dec, const uint8_t* in, size_t len, TraceRecord& rec) {
+    if (len == 0 || in[0] == TRACE_END) return 0;
+    TlmReader r = { in, len, 0, false };
+    uint8_t head = r.u8();
+    rec.type = head >> 5;
+    rec.channel = head & 0x1F;
+    uint32_t delta = traceReadVarint(r);
+
+    if (rec.type != TRACE_KEY && !dec.keyed) return -1;
+
+    switch (rec.type) {
+        case TRACE_KEY: {
+            TraceKey& k = rec.key;
+            k.uptimeMs = r.u32();
+            k.unixSec = r.u32();
+            k.probeCount = r.u8();
+            if (k.probeCount > TRACE_MAX_PROBES) return -1;
+            for (int i = 0; i < TRACE_MAX_PROBES; i++) {
+                k.temp[i] = i < k.probeCount ? r.i16() : TRACE_TEMP_NULL;
+                dec.temp[i] = k.temp[i];
+            }
+            k.inputs = r.u8();
+            dec.lastMs = k.uptimeMs;
+            dec.keyed = true;
+            rec.timeMs = k.uptimeMs;
+            break;
+        }
+        case TRACE_PROBE: {
+            if (rec.channel >= TRACE_MAX_PROBES) return -1;
+            uint32_t z = traceReadVarint(r);
+            int32_t d = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            int32_t prev = dec.temp[rec.channel] == TRACE_TEMP_NULL ? 0 : dec.temp[rec.channel];
+            rec.temp = (int16_t)(prev + d);
+            dec.temp[rec.channel] = rec.temp;
+            break;
+        }
+        case TRACE_PROBE_FAIL:
+            if (rec.channel >= TRACE_MAX_PROBES) return -1;
+            break;
+        case TRACE_INPUT:
+            if ((rec.channel >> 1) >= TRACE_MAX_INPUTS) return -1;
+            break;
+        case TRACE_CONFIG: {
+            TraceConfig& c = rec.config;
+            c.tempMax = r.i16();
+            c.tempCritical = r.i16();
+            c.alertDelaySec = r.u32();
+            c.doorOpenMaxSec = r.u32();
+            c.defrostCooldownSec = r.u32();
+            c.defrostMaxDurationSec = r.u32();
+            c.configApplyTimeSec = r.u32();
+            c.flags = r.u8();
+            c.probeEnabled = r.u8();
+            c.doorEnabled = r.u8();
+            c.hasRules = dec.version > TRACE_VERSION_NO_RULES;
+            c.ruleCount = c.hasRules ? r.u8() : 0;
+            c.interiorProbes = c.hasRules ? r.u8() : 0;
+            c.trendHorizonMin = c.hasRules ? r.u16() : 0;
+            break;
+        }
+        case TRACE_RULE: {
+            if (dec.version == TRACE_VERSION_NO_RULES) return -1;
+            TraceRule& rule = rec.rule;
+            rule.signal = r.u8();
+            rule.index = r.u8();
+            rule.kind = r.u8();
+            rule.flags = r.u8();
+            rule.threshold = traceReadF32(r);
+            rule.hysteresis = traceReadF32(r);
+            rule.durationSec = r.u16();
+            rule.repeatSec = r.u16();
+            break;
+        }
+        default:
+            return -1;
+    }
+    if (r.underflow) return -1;
+
+    if (rec.type != TRACE_KEY) {
+        dec.lastMs += delta;
+        rec.timeMs = dec.lastMs;
+    }
+    return (int)r.pos;
+}
+
+#endif // TRACE_H
@@ -0,0 +1,106 @@
+/*
+ * ============================================================================
+ * TREND.H - TENDENCIA DE TEMPERATURA (MÍNIMOS CUADRADOS EXPONENCIALES)
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Recta y = a + m·t ajustada por mínimos cuadrados con peso exp(-edad/tau)
+ * por muestra. Se guardan solo las sumas ponderadas (S0, St, Stt, Sy, Sty,
+ * Syy) con t en minutos relativo a la última muestra: cada muestra nueva
+ * corre el origen, olvida con exp(-dt/tau) y suma; O(1) y sin historial.
+ *
+ *   m = (S0·Sty - St·Sy) / (S0·Stt - St²)     pendiente en °C/min
+ *   a = (Sy - m·St) / S0                      valor ajustado ahora
+ *
+ * La confianza es el r² ponderado del ajuste (cuánto de la variación
+ * explica la recta) por la fracción de tau ya observada desde el último
+ * reset. Las temperaturas se guardan relativas a la primera muestra para
+ * que Syy no pierda precisión en float.
+ *
+ * No depende de Arduino (lo usan rules.h y las herramientas host).
+ *
+ * ============================================================================
+ */
+
+#ifndef TREND_H
+#define TREND_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+struct TrendEstimator {
+    float s0, st, stt, sy, sty, syy;    // Sumas ponderadas
+    float y0;                           // Referencia de las temperaturas
+    uint32_t startMs;                   // Primera muestra desde el reset
+    uint32_t lastMs;                    // Origen de t
+    bool started;
+};
+
+struct TrendFit {
+    float slope;                        // °C/min
+    float value;                        // °C ajustados en la última muestra
+    float confidence;                   // 0-1
+};
+
+inline void trendReset(TrendEstimator& e) {
+    memset(&e, 0, sizeof(e));
+}
+
+inline void trendUpdate(TrendEstimator& e, float y, uint32_t nowMs, float tauMin) {
+    if (!e.started) {
+        trendReset(e);
+        e.started = true;
+        e.y0 = y;
+        e.startMs = nowMs;
+    } else {
+        // Correr el origen a la muestra nueva (t -> t - dt) y olvidar
+        float dt = (uint32_t)(nowMs - e.lastMs) / 60000.0f;
+        float k = expf(-dt / tauMin);
+        e.stt = k * (e.stt - 2 * dt * e.st + dt * dt * e.s0);
+        e.st = k * (e.st - dt * e.s0);
+        e.sty = k * (e.sty - dt * e.sy);
+        e.s0 *= k;
+        e.sy *= k;
+        e.syy *= k;
+    }
+    e.lastMs = nowMs;
+
+    // Muestra en t = 0
+    float dy = y - e.y0;
+    e.s0 += 1;
+    e.sy += dy;
+    e.syy += dy * dy;
+}
+
+// false mientras no haya datos para una recta
+inline bool trendFit(const TrendEstimator& e, float tauMin, TrendFit& f) {
+    if (!e.started || e.s0 < 3) return false;
+    float den = e.s0 * e.stt - e.st * e.st;
+    if (den <= 1e-9f) return false;
+
+    float m = (e.s0 * e.sty - e.st * e.sy) / den;
+    float a = (e.sy - m * e.st) / e.s0;
+
+    float sst = e.syy - e.sy * e.sy / e.s0;
+    float sse = e.syy - a * e.sy - m * e.sty;
+    float r2 = sst > 1e-6f ? 1 - sse / sst : 0;
+    if (r2 < 0) r2 = 0;
+    if (r2 > 1) r2 = 1;
+
+    float seen = (uint32_t)(e.lastMs - e.startMs) / 60000.0f / tauMin;
+    f.slope = m;
+    f.value = e.y0 + a;
+    f.confidence = r2 * (seen < 1 ? seen : 1);
+    return true;
+}
+
+// Minutos hasta que la recta cruce target subiendo; -1 si ya lo cruzó (eso
+// lo avisa la regla de umbral) o si no sube (pendiente menor a minSlope)
+inline float trendMinutesTo(const TrendFit& f, float target, float minSlope) {
+    if (f.value >= target) return -1;
+    if (f.slope < minSlope) return -1;
+    return (target - f.value) / f.slope;
+}
+
+#endif // TREND_H
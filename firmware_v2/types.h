@@ -20,7 +20,14 @@ struct TempSensor {
     bool valid;                     // Lectura válida
     bool enabled;                   // Sensor habilitado
     const char* name;               // Nombre descriptivo
-    uint8_t address[8];             // Dirección 1-Wire (para identificación)
+    uint8_t address[8];             // Dirección 1-Wire (cacheada al descubrir)
+    uint32_t readErrors;            // Lecturas fallidas (CRC o desconexión)
+    uint8_t failStreak;             // Ciclos seguidos sin lectura válida
+    uint8_t resolution;             // Bits activos en la sonda (9-12)
+    unsigned long resolutionSince;  // millis() del último cambio de resolución
+    float riseRate;                 // Subida en °C/min (negativo = bajando)
+    float rateRefValue;             // Inicio de la ventana de subida
+    unsigned long rateRefAt;
 };
 
 // ============================================================================
@@ -46,6 +53,41 @@ struct RelayOutput {
     uint8_t pin;                    // Pin GPIO
 };
 
+// ============================================================================
+// ESTRUCTURA: Regla de alerta (ver rules.h)
+// ============================================================================
+enum RuleSignal : uint8_t {
+    RULE_SIG_PROBE = 0,             // Sonda DS18B20 (index)
+    RULE_SIG_DOOR,                  // Puerta (index), 1 = abierta
+    RULE_SIG_INTERIOR,              // Promedio de las sondas interiores
+    RULE_SIG_AMBIENT,               // Temperatura DHT22
+    RULE_SIG_HUMIDITY,              // Humedad DHT22
+    RULE_SIG_COUNT
+};
+
+enum RuleKind : uint8_t {
+    RULE_ABOVE = 0,                 // valor > umbral
+    RULE_BELOW,                     // valor < umbral
+    RULE_RISE,                      // subida en °C/min > umbral
+    RULE_TREND,                     // llega al umbral antes del horizonte (trend.h)
+    RULE_KIND_COUNT
+};
+
+#define RULE_F_ENABLED      0x01
+#define RULE_F_CRITICAL     0x02    // Dispara triggerAlert() (estado ALERT)
+#define RULE_F_DEFAULTS     0x04    // Umbral y duración de la config clásica
+
+struct AlertRule {
+    uint8_t signal;                 // RuleSignal
+    uint8_t index;                  // Sonda o puerta
+    uint8_t kind;                   // RuleKind
+    uint8_t flags;                  // RULE_F_*
+    float threshold;
+    float hysteresis;               // Margen para despejar
+    uint16_t durationSec;           // Sostenida antes de disparar
+    uint16_t repeatSec;             // Re-avisar mientras siga activa (0 = una vez)
+};
+
 // ============================================================================
 // ESTRUCTURA: Configuración del sistema (persistente en flash)
 // ============================================================================
@@ -80,6 +122,12 @@ struct Config {
     // Relés habilitados
     bool relayOutputEnabled[MAX_RELAYS];
     
+    // Reglas de alerta
+    AlertRule rules[MAX_ALERT_RULES];
+    uint8_t ruleCount;
+    uint8_t interiorProbes;         // Bits de las sondas que forman el interior
+    uint16_t trendHorizonMin;       // Aviso de tendencia a crítica (RULE_TREND)
+    
     // Modo simulación
     bool simulationMode;
     float simTemp;
@@ -173,17 +221,6 @@ struct SystemState {
     unsigned long lastInternetCheck;
 };
 
-// ============================================================================
-// ESTRUCTURA: Punto de historial
-// ============================================================================
-struct HistoryPoint {
-    float temp;
-    float humidity;
-    bool doorOpen;
-    bool alertActive;
-    unsigned long timestamp;
-};
-
 // ============================================================================
 // ESTRUCTURA: Timer no bloqueante
 // ============================================================================
@@ -225,18 +262,57 @@ struct NonBlockingTimer {
     unsigned long remainingSeconds() {
         return remaining() / 1000;
     }
+    
+    // Como check() pero sin consumir el vencimiento (guardas de la máquina de estados)
+    bool due() const {
+        return running && millis() - startTime >= duration;
+    }
 };
 
 // ============================================================================
-// ESTRUCTURA: Cola de eventos/alertas
+// ESTRUCTURA: Cola de eventos/alertas (ver outbox.h)
 // ============================================================================
+enum AlertChannel : uint8_t {
+    ALERT_CH_TELEGRAM = 0,
+    ALERT_CH_SUPABASE,
+    ALERT_CH_SMS,                   // SIM800 (solo alertas críticas)
+    ALERT_CH_COUNT
+};
+
+enum AlertDeliveryStatus : uint8_t {
+    ALERT_DLV_PENDING = 0,          // Esperando entrega o reintento
+    ALERT_DLV_SENT,                 // Entregada (recibo en sentUnix)
+    ALERT_DLV_FAILED,               // Sin más reintentos
+    ALERT_DLV_SKIPPED               // Canal deshabilitado para esta alerta
+};
+
+#define ALERT_EV_THIS_BOOT  0x01    // createdAt es de este arranque
+
+// Dispositivo de origen: señal de la regla (RuleSignal) e índice
+#define ALERT_SOURCE(signal, index) ((uint8_t)(((signal) << 4) | ((index) & 0x0F)))
+#define ALERT_SOURCE_SYSTEM 0xFF    // Alerta de prueba, sin sensor
+
+struct AlertDelivery {
+    uint8_t status;                 // AlertDeliveryStatus
+    uint8_t attempts;               // Intentos fallidos
+    int16_t lastCode;               // Último código HTTP (SMS: 200 / -1)
+    uint32_t lastTryAt;             // millis() del último intento
+    uint32_t sentUnix;              // Recibo: hora de la entrega (0 = sin hora)
+};
+
+// POD: la bandeja completa se guarda tal cual en NVS
 struct AlertEvent {
-    String type;                    // "temperature", "door", "power", "offline"
-    String severity;                // "info", "warning", "critical", "emergency"
-    String message;
-    float value;                    // Valor que disparó la alerta
-    unsigned long timestamp;
-    bool sent;                      // Ya enviada a Supabase/Telegram
+    uint32_t id;                    // Creciente; 0 = lugar libre
+    uint8_t type;                   // Índice en TLM_ALERT_TYPES ("temperature", "door"...)
+    uint8_t severity;               // Índice en TLM_SEVERITIES ("warning", "critical"...)
+    uint8_t source;                 // ALERT_SOURCE(); con type forma la clave de duplicados
+    uint8_t repeats;                // Repeticiones juntadas mientras seguía pendiente
+    int16_t temp;                   // °C x 100 al generarse (INT16_MIN = sin dato)
+    uint8_t flags;                  // ALERT_EV_*
+    uint32_t createdUnix;           // Hora unix al generarse (0 = sin hora)
+    uint32_t createdAt;             // millis() al generarse
+    AlertDelivery channel[ALERT_CH_COUNT];
+    char message[OUTBOX_MSG_MAX];
 };
 
 // ============================================================================
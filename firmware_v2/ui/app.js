@@ -0,0 +1,106 @@
+let alertActive=false,defrostMode=false,status=null;
+
+async function fetchStatus(){
+  try{
+    const r=await fetch('/api/status');
+    status=await r.json();
+    render(status);
+  }catch(e){console.error(e);}
+}
+
+// /api/stream: snapshot al conectar y después solo los cambios, que se
+// copian sobre la sección de /api/status que corresponde
+const STREAM_SECTIONS={state:'system',alert:'system',system:'system',door:'sensor',sample:'sensor'};
+
+function connectStream(){
+  if(!window.EventSource){setInterval(fetchStatus,2000);fetchStatus();return;}
+  const es=new EventSource('/api/stream');
+  es.addEventListener('snapshot',e=>{status=JSON.parse(e.data);render(status);});
+  for(const name in STREAM_SECTIONS){
+    es.addEventListener(name,e=>{
+      if(!status)return;
+      Object.assign(status[STREAM_SECTIONS[name]],JSON.parse(e.data));
+      render(status);
+    });
+  }
+  // Cupo lleno (503) o sin soporte: volver a consultar cada 2 s
+  es.onerror=()=>{if(es.readyState===EventSource.CLOSED){setInterval(fetchStatus,2000);fetchStatus();}};
+}
+
+function render(d){
+  try{
+    const t=d.sensor.temp_avg.toFixed(1);
+    const tempEl=document.getElementById('temp');
+    tempEl.textContent=t+'°C';
+    tempEl.className='temp-big';
+    if(parseFloat(t)>-10)tempEl.classList.add('temp-crit');
+    else if(parseFloat(t)>-18)tempEl.classList.add('temp-warn');
+    else tempEl.classList.add('temp-ok');
+    
+    alertActive=d.system.alert_active;
+    const alertAck=d.system.alert_acknowledged||false;
+    document.getElementById('relayStatus').textContent=(alertActive&&!alertAck)?'PRENDIDA':'Apagada';
+    document.getElementById('relayStatus').style.color=(alertActive&&!alertAck)?'#ef4444':'#94a3b8';
+    
+    defrostMode=d.system.defrost_mode||false;
+    document.getElementById('defrostSignal').textContent=defrostMode?'ACTIVA':'Normal';
+    document.getElementById('defrostSignal').style.color=defrostMode?'#f97316':'#22c55e';
+    
+    document.getElementById('supabaseStatus').textContent=d.system.supabase_enabled?'✓ Activo':'Deshabilitado';
+    document.getElementById('supabaseStatus').style.color=d.system.supabase_enabled?'#22c55e':'#64748b';
+    
+    document.getElementById('uptime').textContent=formatUptime(d.system.uptime_sec);
+    document.getElementById('wifiRssi').textContent=d.system.wifi_rssi+' dBm';
+    document.getElementById('internetStatus').textContent=d.system.internet?'✓ Online':'✗ Offline';
+    document.getElementById('internetStatus').style.color=d.system.internet?'#22c55e':'#ef4444';
+    document.getElementById('deviceIp').textContent=d.device.ip;
+    document.getElementById('lastUpdate').textContent=new Date().toLocaleTimeString();
+    
+    const banner=document.getElementById('alertBanner');
+    if(alertActive){banner.classList.add('active');document.getElementById('alertMsg').textContent=d.system.alert_message;}
+    else{banner.classList.remove('active');}
+    
+    document.getElementById('defrostStatus').style.display=defrostMode?'block':'none';
+    document.getElementById('defrostTime').textContent=d.system.defrost_minutes||0;
+    document.getElementById('btnDefrost').textContent=defrostMode?'✅ DESACTIVAR':'🧊 ACTIVAR DESCONGELAMIENTO';
+    document.getElementById('btnDefrost').className=defrostMode?'btn-green':'btn-orange';
+  }catch(e){console.error(e);}
+}
+
+async function loadConfig(){
+  try{
+    const r=await fetch('/api/config');
+    const c=await r.json();
+    document.getElementById('inTempCrit').value=c.temp_critical;
+    document.getElementById('inAlertDelay').value=Math.round(c.alert_delay_sec/60);
+    document.getElementById('inDefrostCooldown').value=Math.round((c.defrost_cooldown_sec||1800)/60);
+    document.getElementById('cfgTempCrit').textContent=c.temp_critical+'°C';
+    document.getElementById('cfgAlertDelay').textContent=Math.round(c.alert_delay_sec/60)+' min';
+    document.getElementById('cfgDefrostCooldown').textContent=Math.round((c.defrost_cooldown_sec||1800)/60)+' min';
+    document.getElementById('cfgDefrostRelay').textContent=c.defrost_relay_nc?'Normal Cerrado (NC)':'Normal Abierto (NO)';
+  }catch(e){}
+}
+
+async function saveConfig(){
+  const tc=parseFloat(document.getElementById('inTempCrit').value);
+  const ad=parseInt(document.getElementById('inAlertDelay').value)*60;
+  const dc=parseInt(document.getElementById('inDefrostCooldown').value)*60;
+  await fetch('/api/config',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({temp_critical:tc,alert_delay_sec:ad,defrost_cooldown_sec:dc})});
+  alert('✅ Configuración guardada');
+  loadConfig();
+}
+
+function formatUptime(s){const h=Math.floor(s/3600),m=Math.floor((s%3600)/60);if(h>0)return h+'h '+m+'m';if(m>0)return m+'m '+(s%60)+'s';return s+'s';}
+
+async function stopAlert(){await fetch('/api/alert/ack',{method:'POST'});fetchStatus();}
+async function testTelegram(){const r=await fetch('/api/telegram/test',{method:'POST'});alert(r.ok?'✅ Mensaje enviado':'❌ Error');}
+async function resetWifi(){if(confirm('¿Resetear WiFi?'))await fetch('/api/wifi/reset',{method:'POST'});}
+async function toggleDefrost(){
+  if(confirm(defrostMode?'¿Desactivar descongelamiento?':'¿Activar descongelamiento?\n\nLas alertas se deshabilitarán.')){
+    await fetch('/api/defrost',{method:'POST'});
+    fetchStatus();
+  }
+}
+
+connectStream();
+loadConfig();
@@ -0,0 +1,279 @@
+/*
+ * ui_assets.h - Dashboard embebido comprimido (GENERADO)
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * No editar: se genera desde ui/ con tools/build_ui.py
+ */
+
+#ifndef UI_ASSETS_H
+#define UI_ASSETS_H
+
+// app.css: 1789 bytes, 748 con gzip
+const uint8_t UI_APP_CSS_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x55, 0x4d, 0x8f, 0x9b, 0x30,
+  0x10, 0xbd, 0xef, 0xaf, 0x40, 0x5a, 0xad, 0x56, 0xaa, 0x42, 0x04, 0x04, 0xf2, 0x61, 0x2e, 0x55,
+  0x0f, 0x95, 0x7a, 0xe8, 0xa5, 0x55, 0x7f, 0xc0, 0x18, 0xc6, 0xc4, 0x8d, 0xb1, 0x91, 0x6d, 0x36,
+  0x49, 0x51, 0xfe, 0x7b, 0x0d, 0x09, 0x01, 0x12, 0xd4, 0xe6, 0x14, 0x98, 0xe7, 0xf1, 0x9b, 0x37,
+  0x6f, 0x86, 0x4f, 0x0d, 0x55, 0x27, 0xdf, 0xf0, 0x3f, 0x5c, 0x16, 0x84, 0x2a, 0x9d, 0xa3, 0xf6,
+  0xdd, 0x9b, 0xb4, 0x04, 0x5d, 0x70, 0x49, 0x82, 0xb4, 0x82, 0x3c, 0x6f, 0x63, 0xc1, 0xe5, 0x85,
+  0xaa, 0xfc, 0xdc, 0x30, 0x25, 0xad, 0xcf, 0xa0, 0xe4, 0xe2, 0x4c, 0x7c, 0xa8, 0x2a, 0x81, 0xbe,
+  0x39, 0x1b, 0x8b, 0xe5, 0xe2, 0x8b, 0xe0, 0xf2, 0xf0, 0x1d, 0xb2, 0x9f, 0xdd, 0xe3, 0x57, 0x87,
+  0x5b, 0xbc, 0xff, 0xc4, 0x42, 0xa1, 0xf7, 0xeb, 0xdb, 0xfb, 0xe2, 0x87, 0xa2, 0xca, 0xaa, 0x85,
+  0x01, 0x69, 0x7c, 0x83, 0x9a, 0xb3, 0x94, 0x42, 0x76, 0x28, 0xb4, 0xaa, 0x65, 0x4e, 0x5e, 0x03,
+  0x16, 0x6e, 0x22, 0x48, 0x4b, 0x2e, 0xfd, 0x3d, 0xf2, 0x62, 0x6f, 0x49, 0x18, 0x04, 0x1f, 0xfb,
+  0x34, 0x53, 0x42, 0x69, 0xf2, 0xca, 0x18, 0xbb, 0x13, 0x09, 0xd7, 0xd5, 0xe9, 0xf2, 0xb2, 0xcc,
+  0x5c, 0x7e, 0xe0, 0x12, 0x75, 0x53, 0xc2, 0xc9, 0x3f, 0xf2, 0xdc, 0xee, 0x49, 0x12, 0x04, 0xd5,
+  0x40, 0xdd, 0x83, 0xda, 0xaa, 0xcb, 0xcb, 0x3e, 0x6c, 0x2c, 0x9e, 0xac, 0x0f, 0x82, 0x17, 0x92,
+  0x64, 0x28, 0x2d, 0xea, 0x1b, 0xc6, 0x55, 0x6a, 0xad, 0x2a, 0x49, 0xec, 0x4e, 0x75, 0x75, 0x39,
+  0x1d, 0x90, 0x84, 0xcb, 0x2d, 0x96, 0xfd, 0xcd, 0xeb, 0x00, 0x12, 0x06, 0xee, 0x3e, 0x53, 0x53,
+  0xcb, 0xad, 0xc0, 0x99, 0x64, 0x3d, 0x34, 0xde, 0xc4, 0x5b, 0xfa, 0x90, 0x3a, 0x0a, 0x26, 0xb9,
+  0x97, 0x3b, 0x2c, 0x5b, 0xf2, 0xa0, 0xf3, 0x66, 0x5c, 0x7f, 0x88, 0xd1, 0x6e, 0x45, 0xd3, 0x5b,
+  0x03, 0x34, 0xe4, 0xbc, 0x36, 0x24, 0x8c, 0xdc, 0xd9, 0x71, 0xd9, 0x0f, 0xb9, 0xdb, 0xf8, 0x2d,
+  0x99, 0xb7, 0x8f, 0x9a, 0xe7, 0xe0, 0x58, 0xbe, 0x51, 0x7d, 0x1d, 0x05, 0xd7, 0xa2, 0xca, 0xa7,
+  0xbc, 0x98, 0xa9, 0x67, 0x80, 0xc6, 0x4e, 0x88, 0xee, 0xe9, 0x78, 0x6d, 0x0a, 0x55, 0x22, 0xef,
+  0xf5, 0x6d, 0x09, 0x79, 0x41, 0x9f, 0x49, 0x1d, 0x9a, 0xdb, 0x65, 0x51, 0x94, 0xaf, 0x10, 0xfb,
+  0xf7, 0x47, 0xd0, 0xb2, 0x8f, 0x30, 0x4a, 0x59, 0x14, 0xf7, 0x91, 0x4c, 0x73, 0xdb, 0x47, 0x90,
+  0xc5, 0xee, 0x97, 0x82, 0xe4, 0x25, 0x58, 0xae, 0x24, 0xa9, 0x6a, 0x61, 0xd0, 0x5b, 0x26, 0xc6,
+  0xe3, 0x92, 0x71, 0xc9, 0xad, 0x4b, 0xf8, 0xf9, 0x80, 0x67, 0xa6, 0xa1, 0x44, 0xe3, 0x75, 0xe1,
+  0x26, 0x78, 0x5b, 0x38, 0x97, 0xbc, 0x35, 0xaa, 0x82, 0x8c, 0xdb, 0x33, 0x09, 0x2f, 0xc9, 0xe8,
+  0x69, 0xb9, 0xb9, 0xb4, 0x6d, 0xb3, 0x60, 0x6b, 0xe3, 0x6b, 0x75, 0x6c, 0x72, 0x6e, 0x2a, 0x01,
+  0x67, 0xc2, 0x04, 0x9e, 0xd2, 0xdf, 0xb5, 0xb1, 0x9c, 0x9d, 0xfd, 0xd6, 0x46, 0xae, 0x6a, 0x62,
+  0xdc, 0x29, 0xf4, 0x29, 0xda, 0x23, 0xa2, 0x1c, 0x44, 0x0f, 0xda, 0x1a, 0xd3, 0xfb, 0x5c, 0x5c,
+  0x95, 0x75, 0xef, 0x8c, 0x12, 0x3c, 0xf7, 0x5e, 0x57, 0xab, 0x38, 0x4c, 0x92, 0xc9, 0x35, 0x44,
+  0x80, 0xb1, 0x7e, 0xb6, 0xe7, 0xc2, 0x75, 0x78, 0x72, 0x4e, 0x2a, 0x89, 0x03, 0x54, 0x00, 0x45,
+  0xd1, 0xd7, 0xbf, 0x8b, 0x61, 0x45, 0xb7, 0x43, 0xf0, 0x03, 0x44, 0x8d, 0xcd, 0xa3, 0xf2, 0x2e,
+  0x0e, 0x02, 0xb5, 0xf5, 0x29, 0xc8, 0xd6, 0xf8, 0x63, 0x03, 0xdd, 0x14, 0x9c, 0xb8, 0x65, 0xc6,
+  0x4d, 0xff, 0x9b, 0x84, 0x0e, 0xd4, 0x0b, 0x75, 0x23, 0x3c, 0xbe, 0x73, 0x09, 0x99, 0xe5, 0x1f,
+  0x78, 0xd7, 0x92, 0x0a, 0x95, 0x1d, 0xdc, 0x66, 0xa8, 0xdd, 0x69, 0xd9, 0x5c, 0xa7, 0xb0, 0xed,
+  0xc9, 0x40, 0x24, 0xbe, 0x13, 0xe9, 0xf2, 0x3d, 0x92, 0x9a, 0x8e, 0x47, 0xf8, 0xe0, 0xb7, 0x75,
+  0x10, 0xa4, 0x59, 0xad, 0x8d, 0xd3, 0xa8, 0x52, 0x7c, 0xcc, 0xd7, 0xaa, 0x8a, 0x6c, 0x3b, 0xfb,
+  0x53, 0x2b, 0xfd, 0x42, 0xbb, 0xae, 0x4d, 0xf4, 0x88, 0xa2, 0x2c, 0x49, 0x70, 0x34, 0x00, 0x37,
+  0x24, 0x6d, 0x85, 0x1d, 0x03, 0x9d, 0xee, 0x11, 0x5b, 0x3f, 0x03, 0x95, 0x06, 0x59, 0x4c, 0xa1,
+  0x6c, 0xb7, 0x59, 0x85, 0x33, 0x50, 0x8d, 0xf9, 0x5c, 0x2f, 0x26, 0x38, 0x2e, 0xab, 0xda, 0x76,
+  0x36, 0x9c, 0x9d, 0xe1, 0x7b, 0xd8, 0xbb, 0xfa, 0x62, 0xa2, 0xef, 0x43, 0x8f, 0xd6, 0xc3, 0x60,
+  0x5f, 0x7d, 0x33, 0xde, 0x2f, 0xdb, 0xa4, 0x9b, 0xee, 0x6b, 0xbe, 0x96, 0x50, 0x35, 0xf5, 0x7d,
+  0x01, 0xbd, 0x6e, 0x23, 0x88, 0xd7, 0xfd, 0x6f, 0x5a, 0x00, 0x09, 0x87, 0xd6, 0x45, 0x4f, 0x1e,
+  0xda, 0x0e, 0xcd, 0x7c, 0x9a, 0x82, 0xb9, 0x7d, 0xfe, 0x8f, 0xfd, 0x33, 0xbe, 0xde, 0x0d, 0xdf,
+  0x7d, 0x49, 0xdc, 0xb6, 0xe8, 0x98, 0x84, 0x9b, 0xc0, 0xf6, 0xc3, 0x70, 0x75, 0x57, 0x1c, 0x74,
+  0xec, 0x99, 0x52, 0xce, 0x0d, 0x33, 0xcb, 0xab, 0x3f, 0xd8, 0x2d, 0xde, 0x69, 0xce, 0x91, 0x4c,
+  0x9b, 0x4e, 0xa6, 0xbf, 0x5f, 0x94, 0x72, 0xc9, 0xfd, 0x06, 0x00, 0x00,
+};
+
+// app.js: 5338 bytes, 1854 con gzip
+const uint8_t UI_APP_JS_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x58, 0xcd, 0x6e, 0x23, 0x37,
+  0x12, 0xbe, 0xfb, 0x29, 0x18, 0x0c, 0x92, 0xee, 0x5e, 0xcb, 0x2d, 0xcd, 0x9f, 0x33, 0x91, 0xa1,
+  0x31, 0x3c, 0xb2, 0x66, 0xe1, 0x85, 0x6d, 0x05, 0x96, 0x76, 0x73, 0x48, 0x02, 0x83, 0xea, 0x2e,
+  0xb5, 0x38, 0xee, 0x26, 0x3b, 0x24, 0x25, 0x47, 0xb0, 0x75, 0xcc, 0x25, 0xc8, 0x2d, 0x87, 0xbd,
+  0xcc, 0x62, 0xb1, 0xa7, 0xc5, 0xde, 0x16, 0xc8, 0x03, 0x0c, 0x30, 0xf3, 0x26, 0xf3, 0x04, 0xfb,
+  0x08, 0x5b, 0x24, 0x5b, 0x72, 0xb7, 0x7e, 0x2c, 0xdb, 0x80, 0x2c, 0x35, 0x59, 0xfc, 0x8a, 0x55,
+  0xf5, 0xb1, 0x58, 0xd5, 0x29, 0x68, 0x42, 0x53, 0x90, 0xfa, 0x28, 0xd2, 0x6c, 0x02, 0xad, 0x21,
+  0x4d, 0x15, 0xd4, 0x62, 0x18, 0x4a, 0xa1, 0xf4, 0x99, 0x88, 0xe7, 0x23, 0x4a, 0x53, 0x3d, 0x56,
+  0x2d, 0x3e, 0x4e, 0xd3, 0x83, 0x9d, 0x1d, 0xaa, 0xa6, 0x3c, 0x22, 0xc3, 0x31, 0xc7, 0x45, 0x82,
+  0x93, 0x21, 0xe8, 0x68, 0xd4, 0xb3, 0x12, 0x7e, 0x70, 0xb3, 0x43, 0x88, 0x96, 0x53, 0xf3, 0x45,
+  0x48, 0x24, 0xb8, 0xd2, 0x44, 0xb6, 0xe8, 0x35, 0x65, 0xda, 0xc9, 0xf9, 0x5e, 0x9d, 0xe6, 0xac,
+  0xee, 0x00, 0xbd, 0xe0, 0xc0, 0xca, 0x15, 0xf0, 0x4e, 0x4c, 0x86, 0xef, 0x94, 0xe0, 0x7e, 0x31,
+  0x25, 0x81, 0xc7, 0x20, 0x7d, 0x27, 0x61, 0xc7, 0x66, 0x11, 0x35, 0x38, 0x10, 0xdc, 0x18, 0x78,
+  0x91, 0x42, 0x08, 0x52, 0x0a, 0x89, 0x03, 0x07, 0xb3, 0x9d, 0xd9, 0xce, 0x4e, 0xbd, 0x4e, 0x0a,
+  0x15, 0x12, 0x68, 0xd6, 0x24, 0x8a, 0xd3, 0x5c, 0x8d, 0x84, 0x31, 0xd4, 0x6c, 0x08, 0x22, 0x4d,
+  0x25, 0x99, 0x92, 0x18, 0x54, 0x3e, 0xfe, 0xf4, 0x1f, 0x45, 0x10, 0x42, 0x90, 0x54, 0x28, 0x12,
+  0xd1, 0x6c, 0xc0, 0x84, 0xaa, 0x91, 0x9f, 0xc6, 0x40, 0x14, 0x18, 0xa0, 0x48, 0xe4, 0x8c, 0x72,
+  0x14, 0x19, 0x48, 0x20, 0x29, 0xc5, 0xd1, 0x28, 0x62, 0x9f, 0xfe, 0xe0, 0xb8, 0x9a, 0x94, 0xec,
+  0xb0, 0x2b, 0x22, 0x21, 0x25, 0x62, 0x0a, 0xdc, 0xef, 0x8e, 0x33, 0xbc, 0xd7, 0xbf, 0xe8, 0x1c,
+  0x9d, 0x5d, 0xf6, 0x3a, 0xed, 0xfe, 0x49, 0xf7, 0xbc, 0xd7, 0xba, 0x31, 0xd2, 0xd0, 0xf4, 0xd4,
+  0x54, 0x69, 0xc8, 0xbc, 0x9a, 0xf5, 0xfc, 0xdd, 0xa3, 0xfb, 0xbe, 0x7b, 0x8e, 0x85, 0x90, 0xf8,
+  0x04, 0x68, 0xa4, 0xc4, 0x59, 0x9a, 0xe5, 0x29, 0x2c, 0x9e, 0x67, 0x18, 0x87, 0x45, 0x04, 0x50,
+  0x9d, 0xb1, 0xab, 0x67, 0x2d, 0x76, 0x31, 0x60, 0x43, 0xff, 0x8b, 0x6b, 0xc6, 0x63, 0x71, 0x1d,
+  0x76, 0x26, 0xc0, 0x75, 0x4f, 0x8c, 0x65, 0x84, 0x3e, 0x53, 0xa0, 0x4f, 0xb8, 0x06, 0x39, 0xa1,
+  0xa9, 0x5f, 0x0a, 0x5c, 0xed, 0x59, 0xa3, 0xd1, 0x08, 0x0e, 0x2a, 0xa1, 0x3c, 0x90, 0xa0, 0xc7,
+  0x92, 0xa3, 0x57, 0xe7, 0x91, 0x04, 0xa4, 0x00, 0x5c, 0x93, 0x12, 0xe0, 0x22, 0x9c, 0x46, 0xb3,
+  0x0b, 0x27, 0xa8, 0x90, 0xc6, 0xb1, 0x95, 0x39, 0x65, 0x68, 0x09, 0xc7, 0xf0, 0x79, 0xf3, 0x20,
+  0x78, 0x35, 0x68, 0xbd, 0xbe, 0x29, 0xe2, 0xfd, 0x97, 0x5e, 0xf7, 0x3c, 0xcc, 0xa9, 0x54, 0xe0,
+  0x43, 0x18, 0x53, 0x4d, 0x8d, 0xca, 0x4a, 0xb8, 0x67, 0x16, 0x71, 0x88, 0xd1, 0x75, 0x1b, 0xe0,
+  0x34, 0x03, 0xc2, 0xf8, 0xb2, 0x67, 0x03, 0x47, 0xb7, 0x75, 0x9a, 0xcd, 0x0a, 0xab, 0xd3, 0x4a,
+  0x38, 0xbf, 0x14, 0xe8, 0x85, 0x79, 0xc5, 0x44, 0x77, 0xf0, 0x0e, 0x5d, 0x18, 0x52, 0xa5, 0x58,
+  0xc2, 0x8b, 0x0d, 0x7c, 0xbf, 0xa4, 0xe7, 0x7b, 0x83, 0xf6, 0xe3, 0x8f, 0xb5, 0xd5, 0x8d, 0x07,
+  0x73, 0x98, 0x55, 0xbe, 0x22, 0x63, 0x1d, 0x6f, 0xf1, 0x83, 0x94, 0x6a, 0x8f, 0x73, 0xa4, 0x5b,
+  0x0a, 0x5c, 0x10, 0xff, 0x65, 0xe3, 0x79, 0x40, 0x04, 0x51, 0xcc, 0x50, 0x2c, 0x17, 0x12, 0xc9,
+  0x41, 0x26, 0x22, 0x9d, 0x80, 0x24, 0xd4, 0xba, 0x7c, 0x9c, 0x1a, 0xb2, 0x46, 0x34, 0xa6, 0xe4,
+  0x19, 0x51, 0xce, 0xb9, 0x48, 0x61, 0xc3, 0xf7, 0x96, 0x1f, 0xa0, 0x55, 0x68, 0x0e, 0x0e, 0xa1,
+  0xf3, 0xe3, 0xa9, 0x09, 0x1b, 0xb4, 0x5a, 0xad, 0x52, 0x74, 0xc2, 0xf6, 0x69, 0xb7, 0xd7, 0x39,
+  0x7e, 0x5c, 0xd4, 0x67, 0x48, 0xad, 0x59, 0x89, 0x5c, 0x85, 0x45, 0xf1, 0xba, 0xa3, 0xad, 0x5b,
+  0x71, 0xe8, 0x08, 0x19, 0x22, 0x65, 0xf3, 0x4b, 0x3a, 0x49, 0x42, 0x2d, 0xde, 0xb2, 0x9f, 0x21,
+  0xf6, 0x9f, 0x16, 0xd6, 0x17, 0x92, 0x38, 0xdd, 0x49, 0x5b, 0xb1, 0x88, 0xc6, 0x19, 0xee, 0x2f,
+  0x4c, 0x40, 0x77, 0x52, 0x30, 0x3f, 0xdf, 0x4c, 0x4f, 0x62, 0xdf, 0x33, 0xf3, 0xf3, 0x74, 0xe0,
+  0x64, 0x11, 0xf1, 0x67, 0xdd, 0x16, 0xb8, 0x6d, 0xae, 0x5b, 0x7a, 0xd7, 0xfb, 0xf8, 0xdf, 0xb6,
+  0x57, 0x99, 0x8f, 0x52, 0x0c, 0xd6, 0x39, 0x46, 0xa4, 0x65, 0x57, 0xef, 0x0d, 0x58, 0x52, 0x08,
+  0xa0, 0x57, 0x6c, 0x74, 0xde, 0xa6, 0x82, 0x6a, 0x5f, 0x07, 0xaf, 0xf7, 0x9e, 0x36, 0x82, 0xf2,
+  0x2a, 0x43, 0x0f, 0xc3, 0x15, 0xa7, 0x77, 0x2f, 0x92, 0x4c, 0xcf, 0x95, 0x03, 0xe6, 0xbb, 0x75,
+  0x00, 0xaf, 0xee, 0x03, 0xb8, 0xa6, 0x92, 0x57, 0x00, 0xee, 0x91, 0x15, 0x57, 0x73, 0x49, 0xfb,
+  0xaf, 0x9c, 0x7e, 0xd1, 0x99, 0xf6, 0xec, 0x87, 0x76, 0xf0, 0x92, 0xda, 0xd1, 0xb2, 0x17, 0x0b,
+  0xe1, 0xab, 0x55, 0xc9, 0x2b, 0x2e, 0xae, 0x53, 0x88, 0x13, 0x88, 0x6f, 0x6f, 0x6d, 0xce, 0x76,
+  0xcb, 0x36, 0xfa, 0x5b, 0x42, 0x4a, 0xa7, 0xbd, 0x22, 0x0b, 0x57, 0x5c, 0xed, 0x97, 0x76, 0xf4,
+  0xd5, 0x57, 0x5f, 0xcc, 0x55, 0x06, 0x87, 0xde, 0xb7, 0x17, 0x9d, 0xf3, 0xe3, 0x93, 0xe3, 0x23,
+  0xaf, 0xe9, 0x1d, 0xe5, 0x34, 0x41, 0x56, 0x7a, 0x8f, 0xd2, 0xa2, 0xf4, 0x14, 0xb3, 0x75, 0x84,
+  0xf9, 0x56, 0xde, 0xa3, 0xe5, 0x09, 0x0c, 0x5f, 0xe0, 0x1f, 0x2a, 0x79, 0xf2, 0xcd, 0x0b, 0xfa,
+  0x7c, 0xf0, 0xca, 0x2b, 0x79, 0xab, 0x7c, 0x35, 0x2d, 0x7c, 0x50, 0x0c, 0x5e, 0x66, 0x38, 0xfa,
+  0x30, 0xeb, 0x8b, 0x15, 0x3d, 0x3c, 0xea, 0x34, 0x5d, 0xb2, 0xbf, 0xa4, 0xe2, 0xd0, 0x3b, 0xc2,
+  0x83, 0xff, 0x37, 0x63, 0xf0, 0xb9, 0x90, 0x19, 0x8a, 0x3e, 0x12, 0xb7, 0x6c, 0x71, 0x05, 0xf7,
+  0xc9, 0xf0, 0x9b, 0xaf, 0x9f, 0x3f, 0xdd, 0x37, 0x46, 0x3e, 0x7b, 0x16, 0xbd, 0x7c, 0x09, 0x15,
+  0x23, 0x37, 0xc1, 0xab, 0x71, 0x4e, 0x07, 0x54, 0xc1, 0xda, 0xb8, 0x2d, 0xdc, 0x31, 0x97, 0xba,
+  0x04, 0x4e, 0x07, 0xc8, 0x89, 0x43, 0xef, 0xf3, 0xfb, 0xdf, 0x89, 0x75, 0xb5, 0x40, 0x85, 0xc7,
+  0xa0, 0x46, 0x74, 0xc0, 0x52, 0xa6, 0x69, 0x2c, 0xb6, 0x19, 0xb4, 0xa2, 0xb1, 0x62, 0xd1, 0x66,
+  0x8d, 0x73, 0xab, 0xd0, 0xbe, 0xfd, 0x17, 0x5f, 0xbf, 0x78, 0x35, 0x78, 0x90, 0x7d, 0xe3, 0x5c,
+  0xb3, 0x0c, 0x96, 0xec, 0x1a, 0x1a, 0xcf, 0xeb, 0xbf, 0xda, 0x29, 0x7f, 0xa1, 0xd2, 0x89, 0x5e,
+  0xe2, 0x85, 0x1c, 0x6c, 0x31, 0xe1, 0x9a, 0x0d, 0xd9, 0x05, 0x66, 0xf5, 0x4d, 0xee, 0x32, 0xf3,
+  0x97, 0x12, 0x05, 0x76, 0x3d, 0x12, 0xbf, 0xc9, 0xb6, 0x79, 0x84, 0x99, 0x3c, 0xca, 0x41, 0xdf,
+  0x1f, 0x83, 0xb9, 0x94, 0xf3, 0x7d, 0x97, 0xa7, 0x8c, 0x1b, 0x67, 0x7c, 0x7e, 0xff, 0x77, 0xd2,
+  0x1d, 0x0e, 0xed, 0xd3, 0x63, 0xf5, 0xac, 0xf5, 0xfc, 0x9d, 0x9e, 0x92, 0xc7, 0x8b, 0x03, 0xb4,
+  0x95, 0xab, 0x13, 0x16, 0xc1, 0x49, 0xbe, 0x62, 0x82, 0x9b, 0x08, 0x59, 0xbe, 0x05, 0x00, 0x73,
+  0x1b, 0x86, 0x05, 0xaf, 0xbf, 0xe5, 0x88, 0x99, 0x1a, 0xe1, 0x18, 0x87, 0x7d, 0x1c, 0x16, 0xa7,
+  0x22, 0xc2, 0xc3, 0xdd, 0xc7, 0x60, 0x61, 0x79, 0xc2, 0x78, 0xe2, 0x97, 0x93, 0x9f, 0xcb, 0x6a,
+  0x03, 0x8a, 0xe5, 0x8b, 0xdc, 0x7c, 0x37, 0xd8, 0xe4, 0xf0, 0xc6, 0x0a, 0xcd, 0x53, 0x27, 0x26,
+  0xe8, 0x52, 0x02, 0x09, 0x6e, 0x1c, 0xc4, 0x72, 0xbe, 0x75, 0x09, 0x14, 0xd7, 0xdc, 0x0f, 0x7d,
+  0xa6, 0x92, 0x4d, 0x71, 0x74, 0xe9, 0x35, 0x03, 0xa5, 0x68, 0x02, 0xb6, 0x12, 0x72, 0x09, 0x7e,
+  0x55, 0xa1, 0x84, 0x4c, 0x4c, 0xa0, 0xa4, 0x73, 0xf6, 0x00, 0xc2, 0xcf, 0xf3, 0x45, 0x35, 0xc6,
+  0x31, 0x53, 0x39, 0xe6, 0xcd, 0x6a, 0xc6, 0x18, 0xa4, 0x22, 0xba, 0xc2, 0xe8, 0x72, 0xb1, 0x9d,
+  0x3b, 0xc5, 0xc2, 0xfe, 0xea, 0x61, 0x5a, 0xcd, 0x99, 0x8c, 0x8f, 0x35, 0xa8, 0xdb, 0xdb, 0xc6,
+  0x16, 0xcc, 0x81, 0xe6, 0xc7, 0x6e, 0xcd, 0x7d, 0xf9, 0xf2, 0xf3, 0xfb, 0x5f, 0xc8, 0x71, 0xa7,
+  0xe7, 0xd2, 0xe6, 0x05, 0x6e, 0xf7, 0x7f, 0xff, 0xfc, 0xf7, 0xaf, 0xa4, 0x78, 0x34, 0x33, 0xed,
+  0xee, 0xf9, 0x9f, 0x3b, 0xa7, 0x47, 0x67, 0x27, 0x9d, 0xf3, 0x7e, 0xd7, 0x7b, 0x8c, 0xce, 0xbb,
+  0xeb, 0xbe, 0xea, 0x17, 0xcd, 0xf7, 0x12, 0x09, 0xc0, 0x51, 0x99, 0xf9, 0x2d, 0x24, 0xe5, 0x89,
+  0xf3, 0xd0, 0xb6, 0x4e, 0x61, 0xa9, 0x8f, 0xc1, 0xbb, 0x3e, 0x46, 0xa3, 0x86, 0x2c, 0x79, 0x70,
+  0x1b, 0x13, 0x59, 0x71, 0xaf, 0x52, 0xe9, 0x44, 0x6b, 0xfb, 0x98, 0x7b, 0xce, 0x79, 0x1f, 0xab,
+  0x82, 0xb6, 0xad, 0x40, 0x42, 0xac, 0xcf, 0xc6, 0xd0, 0x8a, 0x5c, 0x31, 0x65, 0xaa, 0x12, 0x86,
+  0x87, 0x67, 0x2b, 0xc0, 0x91, 0x21, 0xe9, 0xb1, 0xb9, 0x6a, 0x17, 0x10, 0x67, 0x54, 0x8f, 0x42,
+  0x29, 0xc6, 0x3c, 0xf6, 0xa3, 0x82, 0xc4, 0xb1, 0x11, 0x30, 0x09, 0xb3, 0xbe, 0xdf, 0xd8, 0xbe,
+  0xa9, 0xc2, 0xef, 0x6d, 0x21, 0x52, 0xec, 0x21, 0xf8, 0x3a, 0x60, 0x44, 0x9e, 0xb3, 0x28, 0x2a,
+  0xc4, 0x0c, 0xfc, 0xed, 0xed, 0xd3, 0x57, 0x58, 0x55, 0x3e, 0x40, 0x4b, 0x34, 0x4c, 0x4a, 0xb6,
+  0x97, 0x39, 0xb5, 0xe4, 0x81, 0x72, 0xf1, 0x77, 0x1f, 0x5a, 0xc5, 0x11, 0x65, 0xbc, 0x6d, 0xee,
+  0xc0, 0xd4, 0x8f, 0x07, 0xe1, 0x01, 0x1a, 0x56, 0xdd, 0xb2, 0x41, 0xcd, 0x76, 0xe7, 0x3c, 0x56,
+  0xe7, 0xc5, 0x1a, 0xbb, 0xee, 0x94, 0xd8, 0x4a, 0xeb, 0x92, 0x47, 0x87, 0x45, 0xa5, 0x42, 0xda,
+  0xc8, 0x75, 0xbc, 0xe0, 0x89, 0x7f, 0xde, 0x0e, 0x16, 0xf5, 0x0b, 0x39, 0x1a, 0x30, 0x34, 0xde,
+  0x8c, 0x76, 0x83, 0xa5, 0x33, 0xb2, 0xee, 0x48, 0x28, 0x3a, 0x81, 0xf2, 0x91, 0x28, 0x6a, 0xf9,
+  0xa8, 0x55, 0xaa, 0x8e, 0x1f, 0xc1, 0x6c, 0x4b, 0x88, 0xa2, 0x92, 0x8d, 0x1d, 0x06, 0xb6, 0x25,
+  0xfe, 0xa3, 0xa8, 0x1d, 0xfc, 0x69, 0xbf, 0x71, 0x07, 0x13, 0x47, 0x0f, 0x82, 0xd9, 0xc0, 0xe6,
+  0x39, 0xd6, 0xc6, 0x83, 0x5d, 0xbb, 0xc9, 0x40, 0x8f, 0x44, 0xdc, 0xf4, 0xbe, 0xed, 0xf6, 0xfa,
+  0x5e, 0x6d, 0x84, 0x8d, 0x16, 0x48, 0xd5, 0xbc, 0xf1, 0x8a, 0x08, 0xec, 0xf5, 0xa7, 0xb9, 0xb9,
+  0x73, 0x69, 0x9e, 0xa7, 0xc8, 0x54, 0xe3, 0xb4, 0xba, 0x39, 0xf6, 0xde, 0xac, 0x36, 0x10, 0xf1,
+  0xb4, 0x69, 0x3b, 0x45, 0x65, 0x2f, 0x3e, 0x36, 0x9c, 0xfa, 0x37, 0x15, 0x5a, 0x37, 0x75, 0x54,
+  0x5b, 0x22, 0x63, 0x93, 0xc6, 0xb5, 0x75, 0xbc, 0x69, 0xc6, 0xd1, 0x2c, 0x70, 0x7d, 0xa4, 0x5d,
+  0xe1, 0xdb, 0x4c, 0xeb, 0x42, 0x33, 0x96, 0xd4, 0xbd, 0x94, 0x48, 0xc6, 0x54, 0xc6, 0xa6, 0x2a,
+  0xb7, 0x72, 0xe5, 0x74, 0x56, 0xed, 0xe8, 0x2a, 0x15, 0x95, 0x72, 0xd9, 0x51, 0x93, 0x91, 0xa3,
+  0xef, 0x30, 0x15, 0x98, 0x22, 0x55, 0xfd, 0xf9, 0x3e, 0xf2, 0xb4, 0x96, 0x95, 0x07, 0x7d, 0xf5,
+  0xa5, 0x1d, 0xb5, 0x47, 0x1b, 0x6f, 0xe0, 0xd1, 0xeb, 0x46, 0xd1, 0x44, 0x93, 0xd1, 0xae, 0x37,
+  0x22, 0xde, 0x6e, 0xb6, 0xeb, 0x61, 0x01, 0x85, 0x53, 0xd9, 0xdd, 0x94, 0x19, 0xc3, 0x29, 0x5c,
+  0x6c, 0x49, 0xaf, 0xbc, 0xe2, 0xbd, 0x02, 0x51, 0xf6, 0x61, 0x0d, 0xe9, 0xb4, 0xc8, 0x6d, 0xdc,
+  0x91, 0x73, 0xab, 0x91, 0xb1, 0xe6, 0xd7, 0xb1, 0xe1, 0x59, 0x0e, 0xce, 0x6c, 0xa5, 0x91, 0x5d,
+  0x06, 0xc6, 0x7b, 0x4e, 0xf7, 0x21, 0x85, 0x44, 0xda, 0xb7, 0x24, 0x9b, 0xd3, 0xba, 0x2e, 0x84,
+  0xea, 0x66, 0xc5, 0x1a, 0x3d, 0x2e, 0x04, 0x32, 0x14, 0x57, 0xee, 0xc6, 0x3b, 0xc3, 0x16, 0x98,
+  0xbe, 0x03, 0x02, 0x7c, 0xc2, 0x4c, 0x51, 0x8d, 0x85, 0xde, 0x3f, 0x7e, 0x23, 0x1d, 0x73, 0xd9,
+  0x78, 0x6b, 0xf6, 0x21, 0x01, 0xfb, 0xf1, 0xef, 0xb0, 0xec, 0xc4, 0x4d, 0xa0, 0xaf, 0x2c, 0xd7,
+  0x64, 0xe6, 0x7b, 0x1f, 0x3f, 0x5c, 0x98, 0x19, 0xc0, 0x96, 0xff, 0x3b, 0xf6, 0x96, 0x1d, 0x7a,
+  0x41, 0xb0, 0xba, 0x37, 0x53, 0xae, 0xd6, 0x2d, 0xc2, 0x9a, 0x8d, 0xad, 0x9a, 0x2c, 0x92, 0x24,
+  0x85, 0x82, 0xfe, 0x8b, 0x37, 0x43, 0x73, 0x8d, 0x95, 0x8b, 0xf4, 0xe3, 0x07, 0xec, 0x0c, 0x6c,
+  0xf5, 0x82, 0xfa, 0x63, 0x50, 0x28, 0x94, 0x20, 0x2d, 0x33, 0x86, 0x34, 0x17, 0x87, 0x68, 0xd3,
+  0xc7, 0x0f, 0x47, 0x9b, 0x66, 0x7f, 0xe0, 0x3f, 0xf0, 0x53, 0xaa, 0x1c, 0x37, 0xf1, 0x1b, 0x3b,
+  0xe0, 0xf8, 0xae, 0xcd, 0x90, 0x9f, 0xfe, 0xc5, 0x43, 0x34, 0xc6, 0xdd, 0xa6, 0xab, 0x26, 0x15,
+  0xdb, 0x58, 0x63, 0x8f, 0x5d, 0x50, 0x8d, 0xaa, 0x7d, 0x93, 0x82, 0xa4, 0x59, 0x7a, 0xe7, 0x75,
+  0xb0, 0x53, 0xe5, 0xfb, 0xff, 0x01, 0x10, 0x2e, 0x63, 0x21, 0xda, 0x14, 0x00, 0x00,
+};
+
+// index.html: 4310 bytes, 1358 con gzip
+const uint8_t UI_INDEX_HTML_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x58, 0xcd, 0x6e, 0x1b, 0x37,
+  0x10, 0xbe, 0xe7, 0x29, 0xd8, 0xed, 0x25, 0x01, 0xba, 0xb2, 0x64, 0xc7, 0xb5, 0x2d, 0x4b, 0x2a,
+  0x36, 0xd2, 0x26, 0x11, 0x10, 0xd9, 0xc6, 0x5a, 0x4e, 0xd0, 0x23, 0x77, 0x77, 0xb4, 0x62, 0xbd,
+  0x4b, 0x2e, 0x48, 0xae, 0x1c, 0xe7, 0xdc, 0x53, 0x1a, 0x20, 0x68, 0x53, 0xa0, 0x68, 0x8a, 0x22,
+  0xc8, 0xa9, 0xed, 0xa1, 0x40, 0xd3, 0x5e, 0x7a, 0xea, 0xa1, 0x7e, 0x93, 0xbc, 0x40, 0xf3, 0x08,
+  0x1d, 0xee, 0x8f, 0x2c, 0x59, 0x76, 0x2a, 0x37, 0x3a, 0x69, 0x49, 0x0e, 0x87, 0xdf, 0xcc, 0x7c,
+  0x1c, 0xce, 0xa8, 0xf5, 0x51, 0x6f, 0xbf, 0x3b, 0xfc, 0xfc, 0xc0, 0x25, 0x63, 0x9d, 0xc4, 0x9d,
+  0x1b, 0x2d, 0xf3, 0x43, 0x62, 0xca, 0xa3, 0xb6, 0x05, 0xca, 0x32, 0x13, 0x40, 0xc3, 0xce, 0x0d,
+  0x42, 0x5a, 0x09, 0x68, 0x4a, 0x82, 0x31, 0x95, 0x0a, 0x74, 0xdb, 0x3a, 0x1a, 0xde, 0xb5, 0xb7,
+  0xad, 0xf3, 0x05, 0x4e, 0x13, 0x68, 0x5b, 0x13, 0x06, 0x27, 0xa9, 0x90, 0xda, 0x22, 0x81, 0xe0,
+  0x1a, 0x38, 0x0a, 0x9e, 0xb0, 0x50, 0x8f, 0xdb, 0x21, 0x4c, 0x58, 0x00, 0x76, 0x3e, 0xf8, 0x84,
+  0x30, 0xce, 0x34, 0xa3, 0xb1, 0xad, 0x02, 0x1a, 0x43, 0xbb, 0x51, 0xab, 0x17, 0x8a, 0x34, 0xd3,
+  0x31, 0x74, 0x9c, 0x18, 0x24, 0x2a, 0xf4, 0x5c, 0xf7, 0xae, 0xeb, 0xb5, 0xd6, 0x8a, 0x49, 0xb3,
+  0x1c, 0x33, 0x7e, 0x4c, 0x24, 0xc4, 0x6d, 0x4b, 0xe9, 0xd3, 0x18, 0xd4, 0x18, 0x00, 0x0f, 0x1a,
+  0x4b, 0x18, 0xb5, 0xad, 0x35, 0x9a, 0xa6, 0xb5, 0x40, 0xa9, 0xcf, 0x26, 0xed, 0xdb, 0xb0, 0xbe,
+  0xb5, 0xbd, 0x05, 0x7e, 0xb0, 0x4d, 0x77, 0x1a, 0xe1, 0xed, 0x0d, 0x63, 0xc4, 0x5a, 0x61, 0x45,
+  0xcb, 0x17, 0xe1, 0x69, 0xae, 0x2b, 0x64, 0x13, 0x12, 0xc4, 0x54, 0xa9, 0xb6, 0x65, 0x90, 0x52,
+  0xc6, 0x41, 0xe6, 0x20, 0x70, 0x6d, 0xdc, 0xe8, 0xbc, 0xfd, 0xf1, 0xcb, 0x7f, 0xfe, 0x7c, 0x4e,
+  0x2e, 0x40, 0xc1, 0x85, 0x42, 0x22, 0xad, 0xf6, 0xaa, 0xcc, 0xcf, 0xf1, 0x59, 0x9d, 0x03, 0x67,
+  0xaf, 0xe7, 0x0e, 0xf6, 0xf7, 0xfa, 0x47, 0x03, 0x32, 0x74, 0xbb, 0xf7, 0xc9, 0xd9, 0x77, 0x04,
+  0xe7, 0x88, 0x33, 0x70, 0xbd, 0x7e, 0x17, 0x3f, 0x0e, 0xfb, 0x0f, 0x1e, 0x1a, 0x25, 0x69, 0xa1,
+  0xa3, 0x50, 0x34, 0x03, 0x83, 0x9a, 0xb3, 0x6c, 0x9f, 0x72, 0x83, 0x84, 0xb0, 0xb0, 0x9c, 0xb9,
+  0x53, 0x4c, 0x14, 0x9b, 0xca, 0x1d, 0xb9, 0xf9, 0x6d, 0x6b, 0x84, 0xc0, 0x6d, 0xc5, 0x9e, 0x40,
+  0xb3, 0x51, 0x5b, 0x87, 0x64, 0x37, 0x1f, 0x9f, 0x00, 0x8b, 0xc6, 0xba, 0xe9, 0x8b, 0x38, 0xb4,
+  0x3a, 0xef, 0x5e, 0xbd, 0xfc, 0x99, 0x38, 0x0f, 0x5c, 0x6f, 0xe8, 0x10, 0xa7, 0x3b, 0xec, 0x3f,
+  0x74, 0x5a, 0x6b, 0xa8, 0x60, 0x4e, 0xd9, 0xf4, 0xa4, 0x81, 0x8a, 0xac, 0x4a, 0x75, 0x42, 0x65,
+  0xc4, 0x78, 0x73, 0x3b, 0x7d, 0x4c, 0x30, 0x36, 0x43, 0x48, 0x52, 0x90, 0x54, 0x67, 0x12, 0x09,
+  0x20, 0xcf, 0x7e, 0xd5, 0x2c, 0xa0, 0xf3, 0x8a, 0xfc, 0x4c, 0x6b, 0xc1, 0x2b, 0x53, 0x7c, 0xcd,
+  0xed, 0x48, 0x02, 0x70, 0x8b, 0x08, 0x1e, 0xc4, 0x2c, 0x38, 0x36, 0x21, 0x13, 0x69, 0xee, 0xce,
+  0x9b, 0xb7, 0x0c, 0xae, 0x1f, 0xbe, 0x26, 0x3d, 0x77, 0xe8, 0xee, 0xb9, 0x5e, 0x89, 0xaf, 0xb5,
+  0x56, 0xe8, 0x28, 0x3d, 0x7c, 0xae, 0x7d, 0xc1, 0x51, 0x01, 0x95, 0xe1, 0xb9, 0x3f, 0xc6, 0xeb,
+  0xa8, 0xed, 0xd9, 0x6b, 0x13, 0xad, 0xa1, 0x3b, 0x38, 0x70, 0x3d, 0x67, 0x78, 0xe4, 0xa1, 0x36,
+  0x9c, 0x9f, 0xb5, 0xb2, 0xdc, 0xab, 0xd1, 0x12, 0xdb, 0x67, 0x11, 0xc9, 0x3f, 0xc4, 0x71, 0xe1,
+  0x68, 0x33, 0xb0, 0x3a, 0xb6, 0x5d, 0xb3, 0xff, 0xfe, 0xad, 0x3b, 0x73, 0xf4, 0x35, 0x51, 0xbc,
+  0x78, 0x4a, 0x5c, 0xa5, 0x69, 0x28, 0x48, 0x08, 0x31, 0x39, 0x64, 0x0a, 0xf5, 0xd2, 0xab, 0x90,
+  0xa0, 0xa0, 0xce, 0x94, 0x2d, 0xc5, 0x89, 0xd5, 0x69, 0xa9, 0x94, 0xf2, 0x0b, 0x0b, 0x31, 0xf5,
+  0x21, 0xb6, 0x3a, 0x87, 0x4c, 0x02, 0x47, 0x25, 0x46, 0xe2, 0x52, 0xb9, 0x09, 0x8d, 0x33, 0x28,
+  0xcc, 0xc0, 0xab, 0x41, 0x4f, 0x0f, 0xf3, 0x69, 0xab, 0xe3, 0xa4, 0x34, 0xa2, 0xe1, 0x74, 0xe7,
+  0x42, 0xd8, 0xaf, 0x09, 0x03, 0xce, 0xde, 0xd0, 0x98, 0xf4, 0x40, 0xe1, 0x6d, 0x89, 0xf0, 0x9c,
+  0x84, 0xe1, 0xe5, 0x16, 0xcb, 0xe1, 0x0a, 0x61, 0x24, 0x85, 0xd2, 0x87, 0x2c, 0xe2, 0x34, 0x36,
+  0x7e, 0x5e, 0x15, 0xa8, 0x2c, 0xa5, 0x3e, 0x55, 0xb0, 0x1c, 0x0a, 0x55, 0x4a, 0x57, 0x0e, 0x5a,
+  0x19, 0x8c, 0xa3, 0x54, 0xb3, 0x64, 0x49, 0x10, 0x59, 0x2e, 0xbb, 0xc2, 0xc3, 0x1f, 0xb1, 0xbb,
+  0x6c, 0xb9, 0xa3, 0x4f, 0xd8, 0x88, 0x79, 0x4a, 0x31, 0x73, 0x38, 0x09, 0xef, 0x24, 0x2b, 0x02,
+  0xd0, 0xc7, 0x34, 0x2f, 0x39, 0xe8, 0xe5, 0x40, 0xb0, 0x52, 0x7a, 0xe5, 0x41, 0xe8, 0x1f, 0x2c,
+  0xcb, 0x45, 0xf3, 0x0e, 0xf5, 0xd3, 0xcb, 0x8f, 0xbe, 0xee, 0x85, 0xff, 0x8a, 0x3c, 0xa4, 0xb1,
+  0x90, 0xa0, 0x48, 0x57, 0xf0, 0x11, 0x8b, 0x30, 0x41, 0x86, 0x42, 0x7d, 0xe0, 0x95, 0x9f, 0xa6,
+  0x33, 0xcc, 0x4a, 0x35, 0xd2, 0x9d, 0xe6, 0xdb, 0x65, 0xcc, 0x0b, 0x46, 0x91, 0xd9, 0xd6, 0x95,
+  0x4c, 0x1b, 0x0b, 0xf3, 0x74, 0xb6, 0x12, 0xff, 0xbe, 0x7d, 0xfe, 0x26, 0xc7, 0xc4, 0x50, 0xbb,
+  0x20, 0xa0, 0xcc, 0x7b, 0xb0, 0x34, 0xa4, 0x3c, 0xef, 0xf7, 0x4c, 0x76, 0xca, 0xc9, 0x97, 0x30,
+  0xbe, 0x22, 0x54, 0xef, 0x5e, 0xfd, 0xf4, 0x94, 0x1c, 0x60, 0x6e, 0xb1, 0xc3, 0x69, 0x66, 0x0a,
+  0xd8, 0xd9, 0x1f, 0x7c, 0x69, 0x68, 0xbd, 0x22, 0x37, 0x75, 0x05, 0xbe, 0x97, 0xe2, 0x84, 0xaf,
+  0x1c, 0xdf, 0xb7, 0xcf, 0x88, 0x07, 0xf1, 0xd9, 0x2f, 0x55, 0xea, 0xac, 0x5d, 0x17, 0x99, 0x57,
+  0xb9, 0xed, 0x03, 0xd9, 0xfa, 0xf6, 0xe5, 0xf7, 0x26, 0x80, 0x53, 0x9e, 0x96, 0x6e, 0xba, 0x9c,
+  0xa9, 0x8c, 0xa7, 0x99, 0x2e, 0xac, 0x2b, 0x57, 0x4d, 0xf9, 0x65, 0x6c, 0x9a, 0x63, 0x67, 0x55,
+  0x13, 0x54, 0x1c, 0x25, 0x37, 0x91, 0x70, 0xb7, 0x5a, 0x6b, 0x85, 0xe4, 0xf9, 0xce, 0x05, 0xcd,
+  0x91, 0x14, 0x19, 0x5e, 0xc1, 0x56, 0x3e, 0x22, 0xfa, 0x34, 0xc5, 0x92, 0x83, 0x67, 0x89, 0x5f,
+  0x55, 0x3e, 0x8c, 0x4f, 0x59, 0x4c, 0x72, 0xaf, 0xb4, 0x2d, 0xbb, 0x51, 0x37, 0xd5, 0x09, 0xa4,
+  0x6d, 0xab, 0x5e, 0xdb, 0x2c, 0xbd, 0xde, 0xb9, 0x8a, 0xe0, 0x57, 0xc5, 0xed, 0x3d, 0x86, 0xcd,
+  0x33, 0x3c, 0x84, 0x92, 0xe4, 0xe4, 0x26, 0xd2, 0x21, 0xd3, 0x42, 0xad, 0xc6, 0xae, 0x99, 0xab,
+  0x50, 0x59, 0xb6, 0x59, 0xd9, 0xd5, 0xb0, 0x0c, 0xf5, 0xcc, 0x6f, 0x69, 0xdd, 0x55, 0x44, 0xfc,
+  0x1f, 0xd6, 0x5d, 0x79, 0x53, 0x56, 0x6c, 0xdf, 0xc5, 0xfb, 0x54, 0x19, 0xb9, 0x31, 0x8d, 0xde,
+  0x66, 0x69, 0xe5, 0xe6, 0xb5, 0xac, 0x5c, 0x2c, 0x30, 0xfd, 0xfc, 0xb2, 0x9c, 0xd7, 0x97, 0x74,
+  0x02, 0x05, 0xb9, 0x8b, 0x02, 0xf3, 0x9b, 0xbf, 0xc8, 0xbd, 0x23, 0xc7, 0xeb, 0x39, 0xde, 0x35,
+  0x2b, 0xcb, 0xd9, 0x92, 0xa5, 0xbb, 0x98, 0xf3, 0xd1, 0x8d, 0x03, 0x81, 0x25, 0xde, 0x62, 0x29,
+  0x74, 0xe1, 0x2a, 0xcd, 0x56, 0x3e, 0xc5, 0x6b, 0x57, 0x15, 0xd7, 0x21, 0x53, 0x29, 0x12, 0xa0,
+  0xc9, 0x05, 0x87, 0x5d, 0x9f, 0x06, 0xc7, 0xc6, 0xad, 0x3c, 0x6c, 0x7e, 0x3c, 0xda, 0xd9, 0xda,
+  0x68, 0x7c, 0xba, 0x9b, 0xd2, 0x30, 0x64, 0x3c, 0x6a, 0x36, 0xea, 0xe9, 0xe3, 0x5d, 0x5f, 0xc8,
+  0x10, 0xa4, 0x8d, 0x0f, 0x0b, 0xcb, 0x94, 0x29, 0xc8, 0x77, 0x8b, 0xda, 0xdc, 0xf6, 0x05, 0x1a,
+  0x95, 0x14, 0x42, 0x1a, 0x1e, 0x6b, 0x9b, 0xc6, 0x58, 0x60, 0x35, 0x03, 0x30, 0x4f, 0xec, 0x0c,
+  0x01, 0x4a, 0x5e, 0x3b, 0x81, 0x66, 0x13, 0xd1, 0x24, 0x2d, 0xa5, 0x25, 0xe2, 0x9e, 0x85, 0x37,
+  0xcc, 0x4b, 0x92, 0x3a, 0x06, 0x21, 0x5f, 0xea, 0x98, 0xf8, 0x2c, 0x19, 0x04, 0x21, 0xb1, 0x53,
+  0x2c, 0x73, 0x16, 0x8e, 0xcb, 0xe8, 0xcf, 0x84, 0x45, 0x8b, 0x28, 0x8a, 0xa1, 0x9c, 0x2f, 0x22,
+  0x83, 0x1e, 0x2c, 0x7a, 0x11, 0x0f, 0x5b, 0x80, 0xc3, 0xee, 0xfe, 0xde, 0x3d, 0xf7, 0x81, 0x33,
+  0xe8, 0xbb, 0x7b, 0xc3, 0xfd, 0x0f, 0x6a, 0x02, 0x5e, 0xbc, 0x41, 0x23, 0x03, 0x86, 0x4e, 0x9d,
+  0x7f, 0x81, 0xff, 0x93, 0x3a, 0x1a, 0xd0, 0x07, 0x10, 0x43, 0x24, 0x69, 0x52, 0x40, 0x7c, 0xf1,
+  0x3b, 0x39, 0x90, 0xc2, 0xa7, 0x92, 0x54, 0xf3, 0xf3, 0xc8, 0x2e, 0xd5, 0x2a, 0x21, 0x9c, 0x51,
+  0x8a, 0x45, 0x01, 0xe8, 0x47, 0x58, 0x73, 0xa1, 0xc6, 0xf9, 0xae, 0xca, 0xc6, 0x4e, 0xc8, 0x04,
+  0x32, 0x3f, 0xe8, 0x35, 0x3e, 0x0f, 0x28, 0x48, 0x8a, 0x3a, 0x6e, 0x59, 0xeb, 0x47, 0x42, 0xe8,
+  0x0b, 0x4d, 0x61, 0xe7, 0xec, 0x65, 0x8c, 0xb5, 0x25, 0x25, 0x34, 0xd0, 0x19, 0x52, 0xe1, 0x49,
+  0x71, 0xbd, 0x4d, 0xc0, 0xcd, 0x4b, 0x63, 0x02, 0x84, 0x7b, 0xf5, 0x51, 0x1a, 0x52, 0xfd, 0xfe,
+  0x02, 0xf4, 0x0a, 0xb0, 0x25, 0x71, 0x16, 0x1a, 0xdd, 0x73, 0xda, 0x60, 0xc7, 0x3b, 0x23, 0xb4,
+  0xd8, 0xf9, 0x96, 0x6b, 0x97, 0xbd, 0x60, 0xd3, 0x0f, 0xf3, 0xad, 0x02, 0xc9, 0x52, 0x4d, 0x94,
+  0x0c, 0xca, 0xbe, 0xfe, 0x0b, 0xd3, 0xd6, 0xef, 0x6c, 0xd5, 0x37, 0xd6, 0xc3, 0x9d, 0x9d, 0xb0,
+  0xbe, 0x4d, 0xb7, 0x82, 0x2d, 0x6c, 0xeb, 0x51, 0x63, 0x2e, 0x69, 0xfa, 0xfb, 0xa2, 0xb1, 0xc7,
+  0xb8, 0xe7, 0xff, 0x62, 0xfc, 0x0b, 0x15, 0x3e, 0x8e, 0xfb, 0xd6, 0x10, 0x00, 0x00,
+};
+
+const UiAsset UI_ASSETS[] = {
+  { "/app.css", "text/css", UI_APP_CSS_GZ, sizeof(UI_APP_CSS_GZ), "\"4e2787ebc8a91d43\"", true },
+  { "/app.js", "application/javascript", UI_APP_JS_GZ, sizeof(UI_APP_JS_GZ), "\"97032d99d08a7c73\"", true },
+  { "/", "text/html; charset=utf-8", UI_INDEX_HTML_GZ, sizeof(UI_INDEX_HTML_GZ), "\"e8b65c24428f62a3\"", false },
+};
+
+#define UI_ASSET_COUNT (sizeof(UI_ASSETS) / sizeof(UI_ASSETS[0]))
+
+#endif
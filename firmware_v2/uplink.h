@@ -0,0 +1,376 @@
+/*
+ * ============================================================================
+ * UPLINK.H - TAREA DE ENLACE DE RED v4.0
+ * Sistema Monitoreo Reefer Industrial
+ * ============================================================================
+ *
+ * Todo el tráfico saliente (Supabase, Telegram, chequeo de internet, sondeo
+ * de comandos) corre en una tarea FreeRTOS fijada al core 0. loop() corre
+ * en el core 1 y solo encola trabajos ya serializados: nunca espera a la red,
+ * así la latencia de puertas, defrost y sirena no depende del enlace.
+ *
+ * Colas y políticas de desborde:
+ * - Lecturas (readings): buzón de 1 lugar, la más nueva reemplaza a la
+ *   anterior (una lectura vieja no sirve si hay una nueva).
+ * - Eventos normales (estado del dispositivo, puertas, defrost):
+ *   cola acotada, si está llena se descarta el trabajo NUEVO.
+ * - Eventos críticos (alertas, Telegram): si la cola está llena se
+ *   descarta el trabajo MÁS VIEJO para hacer lugar.
+ * - Trabajos con más de UPLINK_JOB_MAX_AGE_MS en cola se descartan al
+ *   desencolar (vencidos).
+ *
+ * Lecturas y eventos viajan como registros binarios (telemetry.h, ~30
+ * bytes); el JSON para PostgREST se arma en esta tarea, fuera de loop().
+ *
+ * Las conexiones HTTPS quedan abiertas entre trabajos (http_pool.h).
+ *
+ * Con el diario en flash (journal.h) lecturas y eventos de Supabase no
+ * pasan por estas colas: uplinkPeriodic() los sube desde el diario.
+ * Las alertas tampoco: uplinkPeriodic() las entrega desde la bandeja de
+ * salida (outbox.h), con reintentos por canal.
+ *
+ * Con UPLINK_TASK_ENABLED = false los trabajos se ejecutan en línea
+ * (comportamiento anterior, bloqueante).
+ *
+ * ============================================================================
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include "config.h"
+#include "types.h"
+#include "http_pool.h"
+#include "journal.h"
+
+extern Config config;
+extern SystemState state;
+
+// Ejecutores (supabase.h, telegram.h, wifi_utils.h)
+extern int supabaseExecute(const char* method, const char* path, const char* body);
+extern int supabaseExecuteRecord(const uint8_t* record, size_t len);
+extern int telegramDeliver(const char* message);
+extern void checkInternet();
+extern String supabaseCheckCommands();
+extern void supabaseJournalPump();
+extern bool outboxPump();
+extern void sim800Loop();
+
+// ============================================================================
+// TIPOS
+// ============================================================================
+enum UplinkJobType {
+    UPLINK_SUPABASE_POST = 0,
+    UPLINK_SUPABASE_PATCH,
+    UPLINK_SUPABASE_RECORD,         // Registro binario (telemetry.h)
+    UPLINK_TELEGRAM
+};
+
+enum UplinkPriority {
+    UPLINK_PRIO_NORMAL = 0,         // Cola llena: descartar el nuevo
+    UPLINK_PRIO_CRITICAL            // Cola llena: descartar el más viejo
+};
+
+// POD: FreeRTOS copia los trabajos byte a byte en la cola
+struct UplinkJob {
+    uint8_t type;
+    uint8_t priority;
+    uint16_t len;                   // Bytes en body (sin el '\0' en texto)
+    unsigned long enqueuedAt;
+    char path[UPLINK_PATH_MAX];     // Tabla/filtro PostgREST (vacío en Telegram/registros)
+    char body[UPLINK_BODY_MAX];     // JSON, texto del mensaje o registro binario
+};
+
+struct UplinkStats {
+    uint32_t enqueued;
+    uint32_t sent;                  // Respuesta 2xx
+    uint32_t failed;                // Error HTTP o de red
+    uint32_t coalesced;             // Lecturas reemplazadas por una más nueva
+    uint32_t droppedFull;           // Descartadas por cola llena
+    uint32_t evicted;               // Desalojadas por un evento crítico
+    uint32_t droppedStale;          // Vencidas en cola
+    uint32_t droppedOversize;       // Payload mayor a UPLINK_BODY_MAX
+    uint32_t queueHighWater;
+    int lastCode;
+    unsigned long lastLatencyMs;
+    unsigned long maxLatencyMs;
+    uint64_t totalLatencyMs;        // Para el promedio (sent + failed)
+};
+
+// ============================================================================
+// VARIABLES
+// ============================================================================
+QueueHandle_t uplinkQueue = NULL;
+QueueHandle_t uplinkReadingSlot = NULL;
+TaskHandle_t uplinkTaskHandle = NULL;
+UplinkStats uplinkStats;
+portMUX_TYPE uplinkStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// EJECUCIÓN (tarea de enlace, o en línea si la tarea está deshabilitada)
+// ============================================================================
+// Contabilizar una petición; true si fue 2xx
+bool uplinkCountResult(int code, unsigned long latency) {
+    bool ok = code >= 200 && code < 300;
+
+    portENTER_CRITICAL(&uplinkStatsMux);
+    if (ok) uplinkStats.sent++;
+    else uplinkStats.failed++;
+    uplinkStats.lastCode = code;
+    uplinkStats.lastLatencyMs = latency;
+    if (latency > uplinkStats.maxLatencyMs) uplinkStats.maxLatencyMs = latency;
+    uplinkStats.totalLatencyMs += latency;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+    return ok;
+}
+
+void uplinkExecute(const UplinkJob& job) {
+    unsigned long start = millis();
+    int code;
+
+    switch (job.type) {
+        case UPLINK_SUPABASE_POST:
+            code = supabaseExecute("POST", job.path, job.body);
+            break;
+        case UPLINK_SUPABASE_PATCH:
+            code = supabaseExecute("PATCH", job.path, job.body);
+            break;
+        case UPLINK_SUPABASE_RECORD:
+            code = supabaseExecuteRecord((const uint8_t*)job.body, job.len);
+            break;
+        case UPLINK_TELEGRAM:
+            code = telegramDeliver(job.body);
+            break;
+        default:
+            code = -1;
+    }
+
+    unsigned long latency = millis() - start;
+    bool ok = uplinkCountResult(code, latency);
+
+    if (job.type != UPLINK_TELEGRAM) state.supabaseSyncOk = ok;
+    if (!ok) {
+        Serial.printf("[UPLINK] ✗ %s %s: %d (%lu ms)\n",
+                      job.type == UPLINK_TELEGRAM ? "TELEGRAM" : "SUPABASE",
+                      job.type == UPLINK_SUPABASE_RECORD ? "(registro)" : job.path,
+                      code, latency);
+    }
+}
+
+// Tareas periódicas de red (no pasan por la cola)
+void uplinkPeriodic() {
+    unsigned long now = millis();
+
+    checkInternet();
+    httpPoolMaintain();
+    sim800Loop();
+
+    // Alertas pendientes, antes que la telemetría
+    outboxPump();
+
+    // Diario: subir pendientes y preparar el próximo sector
+    supabaseJournalPump();
+    journalMaintain();
+
+    // Verificar comandos remotos
+    static unsigned long lastCommandCheck = 0;
+    if (now - lastCommandCheck >= INTERVAL_COMMAND_CHECK_MS) {
+        lastCommandCheck = now;
+        if (config.supabaseEnabled && state.internetAvailable) {
+            String cmd = supabaseCheckCommands();
+            if (cmd.length() > 0) {
+                // Procesar comando (integrar con serial_api.h)
+                // processCommand(cmd);
+            }
+        }
+    }
+}
+
+bool uplinkIsStale(const UplinkJob& job) {
+    if (millis() - job.enqueuedAt <= UPLINK_JOB_MAX_AGE_MS) return false;
+    portENTER_CRITICAL(&uplinkStatsMux);
+    uplinkStats.droppedStale++;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+    return true;
+}
+
+void uplinkTask(void* param) {
+    (void)param;
+    // static: UplinkJob es grande para el stack de la tarea
+    static UplinkJob job;
+
+    Serial.printf("[UPLINK] Tarea iniciada en core %d\n", xPortGetCoreID());
+
+    for (;;) {
+        // Eventos primero; la espera acota el período de uplinkPeriodic()
+        if (xQueueReceive(uplinkQueue, &job, pdMS_TO_TICKS(UPLINK_IDLE_WAIT_MS)) == pdTRUE) {
+            if (!uplinkIsStale(job)) uplinkExecute(job);
+        } else if (xQueueReceive(uplinkReadingSlot, &job, 0) == pdTRUE) {
+            if (!uplinkIsStale(job)) uplinkExecute(job);
+        }
+
+        uplinkPeriodic();
+    }
+}
+
+// ============================================================================
+// API PARA EL LOOP DE CONTROL (nunca bloquea)
+// ============================================================================
+void uplinkInit() {
+    memset(&uplinkStats, 0, sizeof(uplinkStats));
+    httpPoolInit();
+
+    #if UPLINK_TASK_ENABLED
+    uplinkQueue = xQueueCreate(UPLINK_QUEUE_LEN, sizeof(UplinkJob));
+    uplinkReadingSlot = xQueueCreate(1, sizeof(UplinkJob));
+    if (uplinkQueue && uplinkReadingSlot) {
+        xTaskCreatePinnedToCore(uplinkTask, "uplink", UPLINK_TASK_STACK, NULL,
+                                UPLINK_TASK_PRIORITY, &uplinkTaskHandle, UPLINK_TASK_CORE);
+    }
+    #endif
+
+    if (!uplinkTaskHandle) {
+        Serial.println("[UPLINK] Modo en línea (sin tarea)");
+    }
+}
+
+// Encolar un trabajo. path/data se copian; devuelve false si se descartó.
+bool uplinkSubmitBytes(UplinkJobType type, UplinkPriority priority,
+                       const char* path, const void* data, size_t len) {
+    if (len >= UPLINK_BODY_MAX || strlen(path) >= UPLINK_PATH_MAX) {
+        portENTER_CRITICAL(&uplinkStatsMux);
+        uplinkStats.droppedOversize++;
+        portEXIT_CRITICAL(&uplinkStatsMux);
+        Serial.printf("[UPLINK] ✗ Payload demasiado grande (%u bytes)\n", (unsigned)len);
+        return false;
+    }
+
+    static UplinkJob job;
+    job.type = type;
+    job.priority = priority;
+    job.len = (uint16_t)len;
+    job.enqueuedAt = millis();
+    snprintf(job.path, sizeof(job.path), "%s", path);
+    memcpy(job.body, data, len);
+    job.body[len] = '\0';
+
+    portENTER_CRITICAL(&uplinkStatsMux);
+    uplinkStats.enqueued++;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+
+    // Sin tarea: ejecutar en línea
+    if (!uplinkTaskHandle) {
+        uplinkExecute(job);
+        return true;
+    }
+
+    bool ok = xQueueSend(uplinkQueue, &job, 0) == pdTRUE;
+    if (!ok && priority == UPLINK_PRIO_CRITICAL) {
+        // Hacer lugar descartando el más viejo
+        static UplinkJob oldest;
+        if (xQueueReceive(uplinkQueue, &oldest, 0) == pdTRUE) {
+            portENTER_CRITICAL(&uplinkStatsMux);
+            uplinkStats.evicted++;
+            portEXIT_CRITICAL(&uplinkStatsMux);
+        }
+        ok = xQueueSend(uplinkQueue, &job, 0) == pdTRUE;
+    }
+
+    portENTER_CRITICAL(&uplinkStatsMux);
+    if (!ok) uplinkStats.droppedFull++;
+    uint32_t used = UPLINK_QUEUE_LEN - uxQueueSpacesAvailable(uplinkQueue);
+    if (used > uplinkStats.queueHighWater) uplinkStats.queueHighWater = used;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+
+    return ok;
+}
+
+bool uplinkSubmit(UplinkJobType type, UplinkPriority priority,
+                  const char* path, const String& body) {
+    return uplinkSubmitBytes(type, priority, path, body.c_str(), body.length());
+}
+
+// Evento como registro binario (telemetry.h)
+bool uplinkSubmitRecord(UplinkPriority priority, const uint8_t* record, size_t len) {
+    return uplinkSubmitBytes(UPLINK_SUPABASE_RECORD, priority, "", record, len);
+}
+
+// Lectura periódica (registro binario): solo se conserva la más nueva
+bool uplinkSubmitReading(const uint8_t* record, size_t len) {
+    // En línea, o rechazo por tamaño (lo contabiliza uplinkSubmitBytes)
+    if (!uplinkTaskHandle || len >= UPLINK_BODY_MAX) {
+        return uplinkSubmitRecord(UPLINK_PRIO_NORMAL, record, len);
+    }
+
+    static UplinkJob job;
+    job.type = UPLINK_SUPABASE_RECORD;
+    job.priority = UPLINK_PRIO_NORMAL;
+    job.len = (uint16_t)len;
+    job.enqueuedAt = millis();
+    job.path[0] = '\0';
+    memcpy(job.body, record, len);
+
+    bool replaced = uxQueueMessagesWaiting(uplinkReadingSlot) > 0;
+    xQueueOverwrite(uplinkReadingSlot, &job);
+
+    portENTER_CRITICAL(&uplinkStatsMux);
+    uplinkStats.enqueued++;
+    if (replaced) uplinkStats.coalesced++;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+    return true;
+}
+
+// Llamar desde loop(): en modo en línea corre las tareas periódicas
+void uplinkLoop() {
+    if (!uplinkTaskHandle) {
+        uplinkPeriodic();
+    }
+}
+
+void getUplinkJSON(JsonObject& obj) {
+    portENTER_CRITICAL(&uplinkStatsMux);
+    UplinkStats s = uplinkStats;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+
+    obj["task"] = uplinkTaskHandle != NULL;
+    obj["queued"] = uplinkQueue ? uxQueueMessagesWaiting(uplinkQueue) : 0;
+    obj["queue_len"] = UPLINK_QUEUE_LEN;
+    obj["queue_high_water"] = s.queueHighWater;
+    obj["enqueued"] = s.enqueued;
+    obj["sent"] = s.sent;
+    obj["failed"] = s.failed;
+    obj["coalesced"] = s.coalesced;
+    obj["dropped_full"] = s.droppedFull;
+    obj["evicted"] = s.evicted;
+    obj["dropped_stale"] = s.droppedStale;
+    obj["dropped_oversize"] = s.droppedOversize;
+    obj["last_code"] = s.lastCode;
+    obj["last_latency_ms"] = s.lastLatencyMs;
+    obj["max_latency_ms"] = s.maxLatencyMs;
+    uint32_t done = s.sent + s.failed;
+    obj["avg_latency_ms"] = done ? (uint32_t)(s.totalLatencyMs / done) : 0;
+
+    JsonObject pool = obj.createNestedObject("http_pool");
+    getHttpPoolJSON(pool);
+
+    JsonObject journalObj = obj.createNestedObject("journal");
+    getJournalJSON(journalObj);
+}
+
+// Cambia cuando se mueve algún contador de "uplink" (web_status.h)
+uint32_t uplinkActivity() {
+    portENTER_CRITICAL(&uplinkStatsMux);
+    UplinkStats s = uplinkStats;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+
+    portENTER_CRITICAL(&httpPoolStatsMux);
+    uint32_t requests = httpPoolStats.requests;
+    portEXIT_CRITICAL(&httpPoolStatsMux);
+
+    return s.enqueued + s.sent + s.failed + s.coalesced + s.droppedFull +
+           s.evicted + s.droppedStale + s.droppedOversize + requests +
+           journal.appended + journal.uploaded + journal.overwritten +
+           (uplinkQueue ? uxQueueMessagesWaiting(uplinkQueue) : 0);
+}
+
+#endif // UPLINK_H
@@ -1,17 +1,42 @@
 /*
  * web_api.h - Servidor web y API REST
- * Sistema Monitoreo Reefer v3.0
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * esp_http_server en su propia tarea (core 0), con keep-alive: el
+ * dashboard reusa la conexión para cada pedido y /api/stream queda abierta
+ * en la misma tarea sin bloquearla (web_stream.h).
+ *
+ * - Lecturas rápidas (/api/status, config, alertas, perf, UI): corren en la
+ *   tarea del servidor. El handler toma webStateMutex solo mientras arma el
+ *   JsonDocument (una foto consistente de sensorData/state) y lo envía sin
+ *   el lock. loop() toma el lock solo para leer sensores y aplicar cambios.
+ * - Handlers que esperan (cambios, /api/command, historial, traza): la
+ *   tarea del servidor los pasa a WEB_WORKERS workers con
+ *   httpd_req_async_handler_begin(), así un historial de 30 días o un
+ *   teléfono lento no frenan al resto de los clientes.
+ * - Cambios (config, alertas, relé, defrost...): el handler no toca los
+ *   globales; encola un WebCommand que loop() aplica al inicio de la
+ *   siguiente iteración y espera el resultado para responder.
+ *
+ * - POST /api/command: texto de serial_api.h; también corre en loop() y
+ *   la respuesta vuelve por webCommandReply.
  */
 
 #ifndef WEB_API_H
 #define WEB_API_H
 
-#include <WebServer.h>
+#include <esp_http_server.h>
 #include <ArduinoJson.h>
 #include "config.h"
 #include "types.h"
+#include "html_ui.h"
+#include "history.h"
+#include "web_response.h"
+#include "web_status.h"
+#include "web_stream.h"
+#include "serial_api.h"
 
-extern WebServer server;
+extern httpd_handle_t server;
 extern Config config;
 extern SensorData sensorData;
 extern SystemState state;
@@ -19,256 +44,792 @@ extern SystemState state;
 extern void saveConfig();
 extern void acknowledgeAlert();
 extern void clearAlert();
-extern void triggerAlert(String message, bool critical);
+extern void triggerAlert(String message, bool critical, uint8_t source, const char* type);
 extern void setRelay(bool on);
 extern bool testTelegram();
 extern void resetWiFi();
-extern String getEmbeddedHTML();
+extern void enterDefrostMode(const char* triggeredBy);
+extern void exitDefrostMode();
+extern void getSensorsJSON(JsonObject& obj);
+extern void getStateJSON(JsonObject& obj);
+extern void getConfigJSON(JsonObject& obj);
+extern void getAlertsJSON(JsonObject& obj);
+extern const char* parseRulesJSON(JsonArray arr, Config& c);
+extern void getPerfJSON(JsonObject& obj);
+extern void getUplinkJSON(JsonObject& obj);
+extern esp_err_t handleApiTrace(httpd_req_t* req);
+extern void perfReset();
+extern uint32_t deviceUnixTime();
+
+// ============================================
+// LOCK DE ESTADO Y COMANDOS
+// ============================================
+enum WebCommandType : uint8_t {
+  WEB_CMD_ACK_ALERT = 0,
+  WEB_CMD_TEST_ALERT,
+  WEB_CMD_RELAY,
+  WEB_CMD_DEFROST_TOGGLE,           // Resultado: defrost activo después
+  WEB_CMD_SET_CONFIG,
+  WEB_CMD_TELEGRAM_TEST,
+  WEB_CMD_PERF_RESET,
+  WEB_CMD_WIFI_RESET,
+  WEB_CMD_TEXT                      // Comando de serial_api.h; respuesta en webCommandReply
+};
+
+struct WebCommand {
+  WebCommandType type;
+  uint32_t ticket;
+  bool arg;                         // WEB_CMD_RELAY: encender
+  Config config;                    // WEB_CMD_SET_CONFIG: config completa
+  char text[WEB_COMMAND_TEXT_LEN];  // WEB_CMD_TEXT
+};
+
+SemaphoreHandle_t webStateMutex = NULL;
+QueueHandle_t webCommandQueue = NULL;
+portMUX_TYPE webCommandMux = portMUX_INITIALIZER_UNLOCKED;
+uint32_t webCommandTicket = 0;      // Último emitido (con webCommandMutex)
+uint32_t webCommandsApplied = 0;    // Último aplicado (loop)
+bool webCommandResults[WEB_COMMAND_QUEUE_LEN];
+char webCommandReply[WEB_COMMAND_REPLY_LEN];  // Último WEB_CMD_TEXT
+
+// Los workers mandan de a un comando: webCommand (con la Config completa)
+// no va en su stack y webCommandReply es del que tiene el mutex
+SemaphoreHandle_t webCommandMutex = NULL;
+WebCommand webCommand;
+
+void webStateLock() {
+  if (webStateMutex) xSemaphoreTake(webStateMutex, portMAX_DELAY);
+}
+
+void webStateUnlock() {
+  if (webStateMutex) xSemaphoreGive(webStateMutex);
+}
+
+// Aplicar un comando (loop, con el lock tomado)
+bool webRunCommand(const WebCommand& cmd) {
+  statusTouch(STATUS_SYSTEM);
+  if (cmd.type == WEB_CMD_SET_CONFIG || cmd.type == WEB_CMD_TEXT) statusTouch(STATUS_SENSOR);
+  
+  switch (cmd.type) {
+    case WEB_CMD_ACK_ALERT:
+      acknowledgeAlert();
+      return true;
+    case WEB_CMD_TEST_ALERT:
+      triggerAlert("🧪 Alerta de prueba", true);
+      return true;
+    case WEB_CMD_RELAY:
+      setRelay(cmd.arg);
+      return true;
+    case WEB_CMD_DEFROST_TOGGLE:
+      // Alterna: la máquina de estados se encarga de alertas, relé y cooldown
+      if (state.currentState == STATE_DEFROST) {
+        exitDefrostMode();
+      } else {
+        enterDefrostMode("manual");
+      }
+      return state.currentState == STATE_DEFROST;
+    case WEB_CMD_SET_CONFIG:
+      config = cmd.config;
+      Serial.printf("[CONFIG] Guardado: tempCrit=%.1f, supabase=%d\n", config.tempCritical, config.supabaseEnabled);
+      saveConfig();
+      return true;
+    case WEB_CMD_TELEGRAM_TEST:
+      return testTelegram();
+    case WEB_CMD_PERF_RESET:
+      perfReset();
+      return true;
+    case WEB_CMD_WIFI_RESET:
+      resetWiFi();
+      return true;
+    case WEB_CMD_TEXT: {
+      String reply = processCommand(String(cmd.text));
+      snprintf(webCommandReply, sizeof(webCommandReply), "%s", reply.c_str());
+      return !reply.startsWith("ERROR");
+    }
+  }
+  return false;
+}
+
+// Llamar desde loop() con el lock tomado
+void webApplyCommands() {
+  if (!webCommandQueue) return;
+  
+  static WebCommand cmd;
+  while (xQueueReceive(webCommandQueue, &cmd, 0) == pdTRUE) {
+    bool result = webRunCommand(cmd);
+    portENTER_CRITICAL(&webCommandMux);
+    webCommandResults[cmd.ticket % WEB_COMMAND_QUEUE_LEN] = result;
+    webCommandsApplied = cmd.ticket;
+    portEXIT_CRITICAL(&webCommandMux);
+  }
+}
+
+// Pedir un cambio a loop() y esperar el resultado. false en 'applied' si
+// loop() no lo aplicó a tiempo (el comando puede aplicarse igual después).
+// Con webCommandMutex tomado (webCommandAcquire).
+bool webPostCommand(WebCommand& cmd, bool& applied) {
+  applied = true;
+  cmd.ticket = ++webCommandTicket;
+  if (xQueueSend(webCommandQueue, &cmd, 0) != pdTRUE) {
+    applied = false;
+    return false;
+  }
+  
+  unsigned long start = millis();
+  while (millis() - start < WEB_COMMAND_TIMEOUT_MS) {
+    portENTER_CRITICAL(&webCommandMux);
+    bool done = (int32_t)(webCommandsApplied - cmd.ticket) >= 0;
+    bool result = webCommandResults[cmd.ticket % WEB_COMMAND_QUEUE_LEN];
+    portEXIT_CRITICAL(&webCommandMux);
+    if (done) return result;
+    vTaskDelay(1);
+  }
+  applied = false;
+  return false;
+}
+
+WebCommand& webCommandAcquire(WebCommandType type) {
+  xSemaphoreTake(webCommandMutex, portMAX_DELAY);
+  webCommand.type = type;
+  webCommand.arg = false;
+  return webCommand;
+}
+
+void webCommandRelease() {
+  xSemaphoreGive(webCommandMutex);
+}
+
+esp_err_t sendBusy(httpd_req_t* req) {
+  return sendJsonText(req, 503, "{\"error\":\"Busy\"}");
+}
+
+// Comando sin argumentos; {"success":true} cuando loop() lo aplicó
+esp_err_t sendCommand(httpd_req_t* req, WebCommandType type) {
+  bool applied;
+  webPostCommand(webCommandAcquire(type), applied);
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
+  return sendJsonText(req, 200, "{\"success\":true}");
+}
 
 // ============================================
 // HANDLER: Página principal
 // ============================================
-void handleRoot() {
-  server.send(200, "text/html", getEmbeddedHTML());
+esp_err_t handleRoot(httpd_req_t* req) {
+  return sendUiAsset(req, *findUiAsset("/"));
+}
+
+// app.css y app.js (user_ctx: el UiAsset)
+esp_err_t handleUiAsset(httpd_req_t* req) {
+  return sendUiAsset(req, *(const UiAsset*)req->user_ctx);
 }
 
 // ============================================
 // HANDLER: API Status
 // ============================================
-void handleApiStatus() {
-  StaticJsonDocument<1024> doc;
-  
-  JsonObject sensor = doc.createNestedObject("sensor");
-  sensor["temp1"] = sensorData.temp1;
-  sensor["temp2"] = sensorData.temp2;
-  sensor["temp_avg"] = sensorData.tempAvg;
-  sensor["temp_dht"] = sensorData.tempDHT;
-  sensor["humidity"] = sensorData.humidity;
-  sensor["door_open"] = sensorData.doorOpen;
-  sensor["door_open_sec"] = sensorData.doorOpen ? (millis() - sensorData.doorOpenSince) / 1000 : 0;
-  sensor["sensor_count"] = sensorData.sensorCount;
-  sensor["valid"] = sensorData.valid;
-  
-  JsonObject sys = doc.createNestedObject("system");
-  sys["alert_active"] = state.alertActive;
-  sys["alert_acknowledged"] = state.alertAcknowledged;
-  sys["critical"] = state.criticalAlert;
-  sys["alert_message"] = state.alertMessage;
-  sys["relay_on"] = state.relayState;
-  sys["internet"] = state.internetAvailable;
-  sys["wifi_connected"] = state.wifiConnected;
-  sys["ap_mode"] = state.apMode;
-  sys["uptime_sec"] = (millis() - state.uptime) / 1000;
-  sys["total_alerts"] = state.totalAlerts;
-  sys["wifi_rssi"] = WiFi.RSSI();
-  sys["simulation_mode"] = config.simulationMode;
-  sys["door_enabled"] = config.doorEnabled;
-  sys["sensor1_enabled"] = config.sensor1Enabled;
-  sys["sensor2_enabled"] = config.sensor2Enabled;
-  sys["defrost_mode"] = state.defrostMode;
-  sys["defrost_minutes"] = state.defrostMode ? (millis() - state.defrostStartTime) / 60000 : 0;
-  sys["supabase_enabled"] = config.supabaseEnabled;
-  
-  JsonObject device = doc.createNestedObject("device");
-  device["id"] = DEVICE_ID;
-  device["name"] = DEVICE_NAME;
-  device["ip"] = state.localIP;
-  device["mdns"] = String(MDNS_NAME) + ".local";
-  
-  JsonObject loc = doc.createNestedObject("location");
-  loc["name"] = LOCATION_NAME;
-  loc["detail"] = LOCATION_DETAIL;
-  
-  String response;
-  serializeJson(doc, response);
-  
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", response);
+// Secciones con cambios después de 'since' (0 = todas), ver web_status.h.
+// Con el lock tomado.
+void buildStatusJSON(JsonDocument& doc, uint32_t since) {
+  bool sensorChanged = statusChangedSince(STATUS_SENSOR, since);
+  bool systemChanged = statusChangedSince(STATUS_SYSTEM, since);
+  
+  // Resumen plano (lo consume el dashboard embebido)
+  if (sensorChanged) {
+    JsonObject sensor = doc.createNestedObject("sensor");
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+      if (sensorData.temp[i].enabled) {
+        sensor["temp" + String(i + 1)] = sensorData.temp[i].value;
+      }
+    }
+    sensor["temp_avg"] = sensorData.tempAvg;
+    sensor["temp_dht"] = sensorData.tempAmbient;
+    sensor["humidity"] = sensorData.humidity;
+    sensor["door_open"] = sensorData.anyDoorOpen;
+    sensor["door_open_sec"] = sensorData.door[0].isOpen ? (millis() - sensorData.door[0].openSince) / 1000 : 0;
+    sensor["sensor_count"] = sensorData.tempSensorCount;
+    sensor["valid"] = sensorData.tempValid;
+  }
+  
+  if (systemChanged) {
+    bool defrostActive = (state.currentState == STATE_DEFROST);
+    
+    JsonObject sys = doc.createNestedObject("system");
+    sys["state"] = state.stateName;
+    sys["alert_active"] = state.alertActive;
+    sys["alert_acknowledged"] = state.alertAcknowledged;
+    sys["critical"] = state.alertCritical;
+    sys["alert_message"] = state.alertMessage;
+    sys["relay_on"] = sensorData.relay[0].state;
+    sys["internet"] = state.internetAvailable;
+    sys["wifi_connected"] = state.wifiConnected;
+    sys["ap_mode"] = state.apMode;
+    sys["uptime_sec"] = (millis() - state.bootTime) / 1000;
+    sys["total_alerts"] = state.totalAlerts;
+    sys["wifi_rssi"] = WiFi.RSSI();
+    sys["simulation_mode"] = config.simulationMode;
+    sys["defrost_mode"] = defrostActive;
+    sys["defrost_minutes"] = defrostActive ? (millis() - state.defrostStartTime) / 60000 : 0;
+    sys["supabase_enabled"] = config.supabaseEnabled;
+    
+    // Detalle v4 (estado de la máquina)
+    JsonObject stateObj = doc.createNestedObject("state");
+    getStateJSON(stateObj);
+  }
+  
+  // Detalle v4 (todas las sondas/puertas)
+  if (sensorChanged) {
+    JsonObject sensorsObj = doc.createNestedObject("sensors");
+    getSensorsJSON(sensorsObj);
+  }
+  
+  if (statusChangedSince(STATUS_UPLINK, since)) {
+    JsonObject uplink = doc.createNestedObject("uplink");
+    getUplinkJSON(uplink);
+  }
+  
+  if (systemChanged) {
+    JsonObject device = doc.createNestedObject("device");
+    device["id"] = DEVICE_ID;
+    device["name"] = DEVICE_NAME;
+    device["ip"] = state.localIP;
+    device["mdns"] = String(MDNS_NAME) + ".local";
+    
+    JsonObject loc = doc.createNestedObject("location");
+    loc["name"] = LOCATION_NAME;
+    loc["detail"] = LOCATION_DETAIL;
+  }
+  
+  doc["version"] = statusVersion;
+}
+
+// GET /api/status            documento completo (ETag, 304 si no cambió)
+// GET /api/status?since=N    solo las secciones que cambiaron después de N
+esp_err_t handleApiStatus(httpd_req_t* req) {
+  char etag[24];
+  char arg[16];
+  uint32_t since = webQueryArg(req, "since", arg, sizeof(arg)) ? strtoul(arg, NULL, 10) : 0;
+  
+  if (since > 0) {
+    StaticJsonDocument<JSON_BUFFER_SIZE> doc;
+    webStateLock();
+    // Versión de otro arranque: todo
+    if (since > statusVersion) since = 0;
+    buildStatusJSON(doc, since);
+    statusETag(etag, sizeof(etag), statusVersion);
+    webStateUnlock();
+    
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    return sendJsonDocument(req, 200, doc);
+  }
+  
+  webStateLock();
+  statusETag(etag, sizeof(etag), statusVersion);
+  webStateUnlock();
+  httpd_resp_set_hdr(req, "ETag", etag);
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  
+  char ifNoneMatch[64];
+  if (webHeader(req, "If-None-Match", ifNoneMatch, sizeof(ifNoneMatch)) && strstr(ifNoneMatch, etag)) {
+    return sendEmpty(req, 304);
+  }
+  
+  // Si cambió entre medio se envía la versión nueva con el ETag anterior:
+  // el próximo pedido no dará 304 y la traerá de nuevo
+  const char* text;
+  size_t len;
+  uint32_t version;
+  if (statusRender(text, len, version)) {
+    return sendJsonText(req, 200, text, len);
+  }
+  
+  StaticJsonDocument<JSON_BUFFER_SIZE> doc;
+  webStateLock();
+  buildStatusJSON(doc, 0);
+  webStateUnlock();
+  return sendJsonDocument(req, 200, doc);
 }
 
 // ============================================
 // HANDLER: GET Config
 // ============================================
-void handleApiGetConfig() {
-  StaticJsonDocument<512> doc;
+esp_err_t handleApiGetConfig(httpd_req_t* req) {
+  DynamicJsonDocument doc(4096);
   
-  doc["temp_max"] = config.tempMax;
-  doc["temp_critical"] = config.tempCritical;
-  doc["alert_delay_sec"] = config.alertDelaySec;
-  doc["door_open_max_sec"] = config.doorOpenMaxSec;
-  doc["defrost_cooldown_sec"] = config.defrostCooldownSec;
-  doc["defrost_relay_nc"] = config.defrostRelayNC;
-  doc["relay_enabled"] = config.relayEnabled;
-  doc["buzzer_enabled"] = config.buzzerEnabled;
-  doc["telegram_enabled"] = config.telegramEnabled;
-  doc["supabase_enabled"] = config.supabaseEnabled;
-  doc["sensor1_enabled"] = config.sensor1Enabled;
-  doc["sensor2_enabled"] = config.sensor2Enabled;
-  doc["dht22_enabled"] = config.dht22Enabled;
-  doc["door_enabled"] = config.doorEnabled;
-  doc["simulation_mode"] = config.simulationMode;
+  JsonObject obj = doc.to<JsonObject>();
+  webStateLock();
+  getConfigJSON(obj);
+  webStateUnlock();
   
-  String response;
-  serializeJson(doc, response);
-  
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", response);
+  return sendJsonDocument(req, 200, doc);
 }
 
 // ============================================
 // HANDLER: POST Config
 // ============================================
-void handleApiSetConfig() {
-  if (!server.hasArg("plain")) {
-    server.send(400, "application/json", "{\"error\":\"No body\"}");
-    return;
+esp_err_t handleApiSetConfig(httpd_req_t* req) {
+  String body;
+  if (req->content_len == 0) {
+    return sendJsonText(req, 400, "{\"error\":\"No body\"}");
+  }
+  if (!webReadBody(req, body)) {
+    return sendJsonText(req, 413, "{\"error\":\"Body too large\"}");
   }
   
-  StaticJsonDocument<512> doc;
-  DeserializationError error = deserializeJson(doc, server.arg("plain"));
+  DynamicJsonDocument doc(4096);
+  DeserializationError error = deserializeJson(doc, body);
   
   if (error) {
-    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-    return;
+    return sendJsonText(req, 400, "{\"error\":\"Invalid JSON\"}");
   }
   
-  if (doc.containsKey("temp_max")) config.tempMax = doc["temp_max"];
-  if (doc.containsKey("temp_critical")) config.tempCritical = doc["temp_critical"];
-  if (doc.containsKey("alert_delay_sec")) config.alertDelaySec = doc["alert_delay_sec"];
-  if (doc.containsKey("door_open_max_sec")) config.doorOpenMaxSec = doc["door_open_max_sec"];
-  if (doc.containsKey("defrost_cooldown_sec")) config.defrostCooldownSec = doc["defrost_cooldown_sec"];
-  if (doc.containsKey("defrost_relay_nc")) config.defrostRelayNC = doc["defrost_relay_nc"];
-  if (doc.containsKey("relay_enabled")) config.relayEnabled = doc["relay_enabled"];
-  if (doc.containsKey("buzzer_enabled")) config.buzzerEnabled = doc["buzzer_enabled"];
-  if (doc.containsKey("telegram_enabled")) config.telegramEnabled = doc["telegram_enabled"];
-  if (doc.containsKey("supabase_enabled")) config.supabaseEnabled = doc["supabase_enabled"];
-  if (doc.containsKey("sensor1_enabled")) config.sensor1Enabled = doc["sensor1_enabled"];
-  if (doc.containsKey("sensor2_enabled")) config.sensor2Enabled = doc["sensor2_enabled"];
-  if (doc.containsKey("dht22_enabled")) config.dht22Enabled = doc["dht22_enabled"];
-  if (doc.containsKey("door_enabled")) config.doorEnabled = doc["door_enabled"];
-  if (doc.containsKey("simulation_mode")) config.simulationMode = doc["simulation_mode"];
+  // Cambios sobre una copia; loop() la aplica y la guarda
+  WebCommand& cmd = webCommandAcquire(WEB_CMD_SET_CONFIG);
+  webStateLock();
+  cmd.config = config;
+  webStateUnlock();
+  Config& c = cmd.config;
   
-  Serial.printf("[CONFIG] Guardado: tempCrit=%.1f, supabase=%d\n", config.tempCritical, config.supabaseEnabled);
+  if (doc.containsKey("temp_max")) c.tempMax = doc["temp_max"];
+  if (doc.containsKey("temp_critical")) c.tempCritical = doc["temp_critical"];
+  if (doc.containsKey("alert_delay_sec")) c.alertDelaySec = doc["alert_delay_sec"];
+  if (doc.containsKey("door_open_max_sec")) c.doorOpenMaxSec = doc["door_open_max_sec"];
+  if (doc.containsKey("defrost_cooldown_sec")) c.defrostCooldownSec = doc["defrost_cooldown_sec"];
+  if (doc.containsKey("defrost_relay_nc")) c.defrostRelayNC = doc["defrost_relay_nc"];
+  if (doc.containsKey("relay_enabled")) c.relayEnabled = doc["relay_enabled"];
+  if (doc.containsKey("buzzer_enabled")) c.buzzerEnabled = doc["buzzer_enabled"];
+  if (doc.containsKey("telegram_enabled")) c.telegramEnabled = doc["telegram_enabled"];
+  if (doc.containsKey("supabase_enabled")) c.supabaseEnabled = doc["supabase_enabled"];
+  if (doc.containsKey("dht22_enabled")) c.dht22Enabled = doc["dht22_enabled"];
+  if (doc.containsKey("temp_sensors_enabled")) {
+    JsonArray arr = doc["temp_sensors_enabled"];
+    for (int i = 0; i < MAX_TEMP_SENSORS && i < (int)arr.size(); i++) c.tempSensorEnabled[i] = arr[i];
+  }
+  if (doc.containsKey("doors_enabled")) {
+    JsonArray arr = doc["doors_enabled"];
+    for (int i = 0; i < MAX_DOOR_SENSORS && i < (int)arr.size(); i++) c.doorEnabled[i] = arr[i];
+  }
+  if (doc.containsKey("relays_enabled")) {
+    JsonArray arr = doc["relays_enabled"];
+    for (int i = 0; i < MAX_RELAYS && i < (int)arr.size(); i++) c.relayOutputEnabled[i] = arr[i];
+  }
+  if (doc.containsKey("simulation_mode")) c.simulationMode = doc["simulation_mode"];
+  if (doc.containsKey("interior_probes")) {
+    JsonArray arr = doc["interior_probes"];
+    c.interiorProbes = 0;
+    for (JsonVariant v : arr) {
+      int i = v.as<int>();
+      if (i >= 0 && i < MAX_TEMP_SENSORS) c.interiorProbes |= 1 << i;
+    }
+  }
+  if (doc.containsKey("trend_horizon_min")) c.trendHorizonMin = doc["trend_horizon_min"];
+  if (doc.containsKey("rules")) {
+    // La lista completa reemplaza a la anterior (rules.h)
+    const char* err = parseRulesJSON(doc["rules"], c);
+    if (err) {
+      webCommandRelease();
+      String reply = String("{\"error\":\"") + err + "\"}";
+      return sendJsonText(req, 400, reply.c_str());
+    }
+  }
   
-  saveConfig();
+  bool applied;
+  webPostCommand(cmd, applied);
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
+  return sendJsonText(req, 200, "{\"success\":true}");
+}
+
+// ============================================
+// HANDLER: GET Alerts (alerta activa y estado de cada regla)
+// ============================================
+esp_err_t handleApiGetAlerts(httpd_req_t* req) {
+  DynamicJsonDocument doc(8192);
   
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true}");
+  JsonObject obj = doc.to<JsonObject>();
+  webStateLock();
+  getAlertsJSON(obj);
+  webStateUnlock();
+  
+  return sendJsonDocument(req, 200, doc);
 }
 
 // ============================================
 // HANDLER: Acknowledge Alert
 // ============================================
-void handleApiAckAlert() {
-  acknowledgeAlert();
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true}");
+esp_err_t handleApiAckAlert(httpd_req_t* req) {
+  return sendCommand(req, WEB_CMD_ACK_ALERT);
 }
 
 // ============================================
 // HANDLER: Test Alert
 // ============================================
-void handleApiTestAlert() {
-  triggerAlert("🧪 Alerta de prueba", true);
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true}");
+esp_err_t handleApiTestAlert(httpd_req_t* req) {
+  return sendCommand(req, WEB_CMD_TEST_ALERT);
 }
 
 // ============================================
 // HANDLER: Relay Control
 // ============================================
-void handleApiRelay() {
-  if (server.hasArg("plain")) {
+esp_err_t handleApiRelay(httpd_req_t* req) {
+  String body;
+  if (req->content_len > 0 && webReadBody(req, body)) {
     StaticJsonDocument<64> doc;
-    deserializeJson(doc, server.arg("plain"));
+    deserializeJson(doc, body);
     if (doc.containsKey("state")) {
-      setRelay(doc["state"]);
+      WebCommand& cmd = webCommandAcquire(WEB_CMD_RELAY);
+      cmd.arg = doc["state"];
+      bool applied;
+      webPostCommand(cmd, applied);
+      webCommandRelease();
+      if (!applied) return sendBusy(req);
     }
   }
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true}");
+  return sendJsonText(req, 200, "{\"success\":true}");
 }
 
 // ============================================
 // HANDLER: Test Telegram
 // ============================================
-void handleApiTelegramTest() {
-  bool success = testTelegram();
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(success ? 200 : 500, "application/json", 
-              success ? "{\"success\":true}" : "{\"error\":\"Failed\"}");
+esp_err_t handleApiTelegramTest(httpd_req_t* req) {
+  bool applied;
+  bool success = webPostCommand(webCommandAcquire(WEB_CMD_TELEGRAM_TEST), applied);
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
+  if (success) return sendJsonText(req, 200, "{\"success\":true}");
+  return sendJsonText(req, 500, "{\"error\":\"Failed\"}");
 }
 
 // ============================================
 // HANDLER: Defrost Mode
 // ============================================
-void handleApiDefrost() {
-  state.defrostMode = !state.defrostMode;
+esp_err_t handleApiDefrost(httpd_req_t* req) {
+  bool applied;
+  bool defrostActive = webPostCommand(webCommandAcquire(WEB_CMD_DEFROST_TOGGLE), applied);
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
   
-  if (state.defrostMode) {
-    state.defrostStartTime = millis();
-    state.alertActive = false;
-    state.criticalAlert = false;
-    state.alertAcknowledged = false;
-    setRelay(false);
-    digitalWrite(PIN_BUZZER, LOW);
-    Serial.println("[DESCONGELAMIENTO] ACTIVADO");
-  } else {
-    unsigned long defrostMin = (millis() - state.defrostStartTime) / 60000;
-    state.defrostStartTime = 0;
-    Serial.printf("[DESCONGELAMIENTO] DESACTIVADO - Duró %lu min\n", defrostMin);
-  }
+  return sendJsonText(req, 200, defrostActive ? "{\"success\":true,\"defrost_mode\":true}"
+                                              : "{\"success\":true,\"defrost_mode\":false}");
+}
+
+// ============================================
+// HANDLER: Perfilador de loop()
+// ============================================
+// Sin el lock de estado: getPerfJSON() copia cada bloque con perfMux
+esp_err_t handleApiPerf(httpd_req_t* req) {
+  DynamicJsonDocument doc(6144);
+  JsonObject obj = doc.to<JsonObject>();
+  getPerfJSON(obj);
   
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true,\"defrost_mode\":" + String(state.defrostMode ? "true" : "false") + "}");
+  return sendJsonDocument(req, 200, doc);
+}
+
+esp_err_t handleApiPerfReset(httpd_req_t* req) {
+  return sendCommand(req, WEB_CMD_PERF_RESET);
 }
 
 // ============================================
 // HANDLER: WiFi Reset
 // ============================================
-void handleApiWifiReset() {
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(200, "application/json", "{\"success\":true}");
+esp_err_t handleApiWifiReset(httpd_req_t* req) {
+  esp_err_t err = sendJsonText(req, 200, "{\"success\":true}");
   delay(500);
-  resetWiFi();
+  bool applied;
+  webPostCommand(webCommandAcquire(WEB_CMD_WIFI_RESET), applied);
+  webCommandRelease();
+  return err;
+}
+
+// ============================================
+// HANDLER: Comandos de texto (serial_api.h)
+// ============================================
+// GET /api/command?cmd=STATUS  o  POST /api/command con el comando en el body
+esp_err_t handleApiCommand(httpd_req_t* req) {
+  String text;
+  char arg[WEB_COMMAND_TEXT_LEN + 1];
+  if (webQueryArg(req, "cmd", arg, sizeof(arg))) {
+    text = arg;
+  } else if (req->content_len > 0 && !webReadBody(req, text)) {
+    return sendJsonText(req, 413, "{\"error\":\"Body too large\"}");
+  }
+  text.trim();
+  
+  if (text.length() == 0) {
+    return sendJsonText(req, 400, "{\"error\":\"No command provided\"}");
+  }
+  if (text.length() >= WEB_COMMAND_TEXT_LEN) {
+    return sendJsonText(req, 400, "{\"error\":\"Command too long\"}");
+  }
+  
+  // La respuesta se copia antes de soltar el mutex: el próximo comando
+  // pisa webCommandReply
+  WebCommand& cmd = webCommandAcquire(WEB_CMD_TEXT);
+  snprintf(cmd.text, sizeof(cmd.text), "%s", text.c_str());
+  bool applied;
+  bool success = webPostCommand(cmd, applied);
+  char reply[WEB_COMMAND_REPLY_LEN];
+  memcpy(reply, webCommandReply, sizeof(reply));
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
+  
+  // Respuesta JSON directo al socket (HELP y STATUS son varias líneas)
+  ChunkedResponse out = beginChunkedJson(req, 200);
+  out.print("{\"command\":");
+  out.jsonString(text.c_str());
+  out.print(",\"response\":");
+  out.jsonString(reply);
+  out.print(success ? ",\"success\":true}" : ",\"success\":false}");
+  return out.end();
+}
+
+// POST /api/restart y /api/factory_reset: atajos de RESTART y RESET_CONFIG
+esp_err_t sendTextCommand(httpd_req_t* req, const char* text, const char* reply) {
+  WebCommand& cmd = webCommandAcquire(WEB_CMD_TEXT);
+  snprintf(cmd.text, sizeof(cmd.text), "%s", text);
+  bool applied;
+  webPostCommand(cmd, applied);
+  webCommandRelease();
+  if (!applied) return sendBusy(req);
+  return sendJsonText(req, 200, reply);
+}
+
+esp_err_t handleApiRestart(httpd_req_t* req) {
+  return sendTextCommand(req, "RESTART", "{\"success\":true,\"message\":\"Reiniciando en 2 segundos...\"}");
+}
+
+esp_err_t handleApiFactoryReset(httpd_req_t* req) {
+  return sendTextCommand(req, "RESET_CONFIG", "{\"success\":true,\"message\":\"Configuración restaurada\"}");
 }
 
 // ============================================
 // HANDLER: CORS Preflight
 // ============================================
-void handleCORS() {
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  server.send(204);
+esp_err_t handleCORS(httpd_req_t* req) {
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+  return sendEmpty(req, 204);
+}
+
+// ============================================
+// HANDLER: Historial por niveles (history.h)
+// ============================================
+// "90", "90s", "15m", "6h", "30d" -> segundos (0 si no es válido)
+uint32_t parseDurationSec(const char* text) {
+  char* end;
+  unsigned long n = strtoul(text, &end, 10);
+  switch (*end) {
+    case '\0':
+    case 's': return n;
+    case 'm': return n * 60;
+    case 'h': return n * 3600;
+    case 'd': return n * 86400;
+  }
+  return 0;
+}
+
+// GET /api/history?range=6h&res=5m
+// Puntos del nivel que mejor se ajusta, del más viejo al actual (un nivel
+// de 30 días son ~60 KB de JSON, se arma directo en el socket). Los buckets
+// se copian de a tandas con el lock y se envían sin él.
+#define HISTORY_COPY_BATCH 16
+
+esp_err_t handleApiHistory(httpd_req_t* req) {
+  char arg[16];
+  uint32_t rangeSec = webQueryArg(req, "range", arg, sizeof(arg)) ? parseDurationSec(arg) : 0;
+  uint32_t resSec = webQueryArg(req, "res", arg, sizeof(arg)) ? parseDurationSec(arg) : 0;
+  if (rangeSec == 0) rangeSec = HISTORY_DEFAULT_RANGE_SEC;
+  
+  webStateLock();
+  const HistoryTier& tier = historySelectTier(rangeSec, resSec);
+  uint16_t count = historyBucketCount(tier, rangeSec);
+  uint32_t firstId = tier.headId - (count - 1);
+  
+  // Buckets en uptime -> hora unix si el reloj es válido
+  uint32_t uptimeSec = (millis() - state.bootTime) / 1000;
+  uint32_t nowUnix = deviceUnixTime();
+  webStateUnlock();
+  
+  ChunkedResponse out = beginChunkedJson(req, 200);
+  char point[160];
+  int n = snprintf(point, sizeof(point),
+                   "{\"res_sec\":%lu,\"range_sec\":%lu,\"time\":\"%s\",\"points\":[",
+                   (unsigned long)tier.periodSec, (unsigned long)count * tier.periodSec,
+                   nowUnix ? "unix" : "uptime");
+  out.write(point, n);
+  
+  HistoryBucket batch[HISTORY_COPY_BATCH];
+  bool valid[HISTORY_COPY_BATCH];
+  bool first = true;
+  for (uint16_t done = 0; done < count; ) {
+    uint16_t batchLen = min((uint16_t)HISTORY_COPY_BATCH, (uint16_t)(count - done));
+    webStateLock();
+    for (uint16_t i = 0; i < batchLen; i++) {
+      valid[i] = historyBucketById(tier, firstId + done + i, batch[i]);
+    }
+    webStateUnlock();
+    
+    for (uint16_t i = 0; i < batchLen; i++) {
+      // Salió del anillo mientras se enviaba: se omite
+      if (!valid[i]) continue;
+      const HistoryBucket& b = batch[i];
+      uint32_t start = (firstId + done + i) * tier.periodSec;
+      uint32_t t = nowUnix ? nowUnix - (uptimeSec - start) : start;
+      const char* sep = first ? "" : ",";
+      first = false;
+      
+      if (b.count > 0) {
+        n = snprintf(point, sizeof(point),
+                     "%s{\"t\":%lu,\"min\":%.2f,\"max\":%.2f,\"avg\":%.2f,"
+                     "\"door_sec\":%u,\"alert_sec\":%u,\"sec\":%u}",
+                     sep, (unsigned long)t,
+                     b.min / 100.0, b.max / 100.0, b.sum / 100.0 / b.count,
+                     b.doorSec, b.alertSec, b.sampleSec);
+      } else {
+        n = snprintf(point, sizeof(point),
+                     "%s{\"t\":%lu,\"min\":null,\"max\":null,\"avg\":null,"
+                     "\"door_sec\":%u,\"alert_sec\":%u,\"sec\":%u}",
+                     sep, (unsigned long)t,
+                     b.doorSec, b.alertSec, b.sampleSec);
+      }
+      out.write(point, n);
+    }
+    done += batchLen;
+  }
+  
+  out.print("]}");
+  return out.end();
 }
 
 // ============================================
 // HANDLER: Not Found
 // ============================================
-void handleNotFound() {
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.send(404, "application/json", "{\"error\":\"Not found\"}");
+esp_err_t handleNotFound(httpd_req_t* req, httpd_err_code_t error) {
+  (void)error;
+  return sendJsonText(req, 404, "{\"error\":\"Not found\"}");
+}
+
+// ============================================
+// WORKERS
+// ============================================
+// Los handlers que esperan a loop() o envían mucho salen de la tarea del
+// servidor: webDefer() pasa el pedido a la cola y un worker lo atiende.
+struct WebRoute {
+  const char* uri;
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t* req);
+  bool worker;
+};
+
+struct WebJob {
+  httpd_req_t* req;
+  esp_err_t (*handler)(httpd_req_t* req);
+};
+
+QueueHandle_t webJobQueue = NULL;
+
+esp_err_t webDefer(httpd_req_t* req) {
+  WebJob job;
+  job.handler = ((const WebRoute*)req->user_ctx)->handler;
+  if (httpd_req_async_handler_begin(req, &job.req) != ESP_OK) return sendBusy(req);
+  
+  if (xQueueSend(webJobQueue, &job, 0) != pdTRUE) {
+    // Workers ocupados: se responde desde acá
+    sendBusy(job.req);
+    httpd_req_async_handler_complete(job.req);
+  }
+  return ESP_OK;
+}
+
+void webWorker(void* param) {
+  (void)param;
+  WebJob job;
+  for (;;) {
+    if (xQueueReceive(webJobQueue, &job, portMAX_DELAY) != pdTRUE) continue;
+    // Igual que un handler que falla en la tarea del servidor
+    if (job.handler(job.req) != ESP_OK) {
+      httpd_sess_trigger_close(server, httpd_req_to_sockfd(job.req));
+    }
+    httpd_req_async_handler_complete(job.req);
+  }
 }
 
 // ============================================
 // CONFIGURAR RUTAS
 // ============================================
+const WebRoute WEB_ROUTES[] = {
+  { "/",                   HTTP_GET,     handleRoot,            false },
+  { "/api/status",         HTTP_GET,     handleApiStatus,       false },
+  { "/api/stream",         HTTP_GET,     handleApiStream,       false },
+  { "/api/config",         HTTP_GET,     handleApiGetConfig,    false },
+  { "/api/config",         HTTP_POST,    handleApiSetConfig,    true  },
+  { "/api/config",         HTTP_OPTIONS, handleCORS,            false },
+  { "/api/alerts",         HTTP_GET,     handleApiGetAlerts,    false },
+  { "/api/alert/ack",      HTTP_POST,    handleApiAckAlert,     true  },
+  { "/api/alert/test",     HTTP_POST,    handleApiTestAlert,    true  },
+  { "/api/relay",          HTTP_POST,    handleApiRelay,        true  },
+  { "/api/telegram/test",  HTTP_POST,    handleApiTelegramTest, true  },
+  { "/api/defrost",        HTTP_POST,    handleApiDefrost,      true  },
+  { "/api/wifi/reset",     HTTP_POST,    handleApiWifiReset,    true  },
+  { "/api/perf",           HTTP_GET,     handleApiPerf,         false },
+  { "/api/history",        HTTP_GET,     handleApiHistory,      true  },
+  { "/api/trace",          HTTP_GET,     handleApiTrace,        true  },
+  { "/api/perf/reset",     HTTP_POST,    handleApiPerfReset,    true  },
+  { "/api/command",        HTTP_GET,     handleApiCommand,      true  },
+  { "/api/command",        HTTP_POST,    handleApiCommand,      true  },
+  { "/api/restart",        HTTP_POST,    handleApiRestart,      true  },
+  { "/api/factory_reset",  HTTP_POST,    handleApiFactoryReset, true  },
+};
+
+// En setup(), antes que los módulos que publican eventos o comandos
 void setupWebServer() {
-  server.on("/", HTTP_GET, handleRoot);
-  server.on("/api/status", HTTP_GET, handleApiStatus);
-  server.on("/api/config", HTTP_GET, handleApiGetConfig);
-  server.on("/api/config", HTTP_POST, handleApiSetConfig);
-  server.on("/api/config", HTTP_OPTIONS, handleCORS);
-  server.on("/api/alert/ack", HTTP_POST, handleApiAckAlert);
-  server.on("/api/alert/test", HTTP_POST, handleApiTestAlert);
-  server.on("/api/relay", HTTP_POST, handleApiRelay);
-  server.on("/api/telegram/test", HTTP_POST, handleApiTelegramTest);
-  server.on("/api/defrost", HTTP_POST, handleApiDefrost);
-  server.on("/api/wifi/reset", HTTP_POST, handleApiWifiReset);
-  server.onNotFound(handleNotFound);
-  
-  server.begin();
+  webStateMutex = xSemaphoreCreateMutex();
+  webCommandMutex = xSemaphoreCreateMutex();
+  webCommandQueue = xQueueCreate(WEB_COMMAND_QUEUE_LEN, sizeof(WebCommand));
+  webJobQueue = xQueueCreate(WEB_JOB_QUEUE_LEN, sizeof(WebJob));
+  statusBootId = esp_random();
+}
+
+// Al final de setup(): desde acá los handlers corren en las tareas
+void webStart() {
+  httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
+  cfg.core_id = WEB_SERVER_CORE;
+  cfg.stack_size = WEB_SERVER_STACK;
+  cfg.task_priority = WEB_SERVER_PRIORITY;
+  cfg.max_open_sockets = WEB_MAX_SOCKETS;
+  cfg.max_uri_handlers = WEB_MAX_URI_HANDLERS;
+  cfg.lru_purge_enable = true;      // Sin sockets libres se cierra la conexión más vieja
+  
+  if (httpd_start(&server, &cfg) != ESP_OK) {
+    Serial.println("[ERROR] No se pudo iniciar el web server");
+    return;
+  }
+  
+  for (const WebRoute& route : WEB_ROUTES) {
+    httpd_uri_t uri;
+    uri.uri = route.uri;
+    uri.method = route.method;
+    uri.handler = route.worker ? webDefer : route.handler;
+    uri.user_ctx = (void*)&route;
+    httpd_register_uri_handler(server, &uri);
+  }
+  for (size_t i = 0; i < UI_ASSET_COUNT; i++) {
+    if (!UI_ASSETS[i].immutable) continue;
+    httpd_uri_t uri;
+    uri.uri = UI_ASSETS[i].path;
+    uri.method = HTTP_GET;
+    uri.handler = handleUiAsset;
+    uri.user_ctx = (void*)&UI_ASSETS[i];
+    httpd_register_uri_handler(server, &uri);
+  }
+  httpd_register_err_handler(server, HTTPD_404_NOT_FOUND, handleNotFound);
+  
+  for (int i = 0; i < WEB_WORKERS; i++) {
+    xTaskCreatePinnedToCore(webWorker, "web_worker", WEB_WORKER_STACK, NULL,
+                            WEB_SERVER_PRIORITY, NULL, WEB_SERVER_CORE);
+  }
+  xTaskCreatePinnedToCore(streamTask, "web_stream", STREAM_TASK_STACK, NULL,
+                          WEB_SERVER_PRIORITY, NULL, WEB_SERVER_CORE);
   Serial.println("[OK] Web server iniciado");
 }
 
@@ -0,0 +1,207 @@
+/*
+ * web_response.h - Respuestas JSON por partes para la API web
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * ChunkedResponse serializa directo al socket con Transfer-Encoding:
+ * chunked, juntando WEB_CHUNK_SIZE bytes en el stack antes de cada envío.
+ * Antes cada handler armaba el JSON completo en un String del heap y recién
+ * ahí lo enviaba: el pico de RAM era el doble del payload y varios
+ * teléfonos consultando a la vez fragmentaban el heap.
+ *
+ * Uso (req es el httpd_req_t* del handler):
+ *   return sendJsonDocument(req, 200, doc);             // documento ArduinoJson
+ *   return sendJsonText(req, 200, "{\"success\":true}");  // texto fijo, sin copias
+ *
+ *   ChunkedResponse out = beginChunkedJson(req, 200);   // armado a mano
+ *   out.print("{\"items\":[");
+ *   ...
+ *   return out.end();
+ *
+ * También están acá las lecturas del pedido (query, encabezados, cuerpo).
+ */
+
+#ifndef WEB_RESPONSE_H
+#define WEB_RESPONSE_H
+
+#include <esp_http_server.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// ============================================
+// ESCRITOR POR PARTES
+// ============================================
+class ChunkedResponse : public Print {
+public:
+  explicit ChunkedResponse(httpd_req_t* req) : req_(req), used_(0), failed_(false) {}
+  
+  size_t write(uint8_t c) override {
+    if (used_ == sizeof(buf_)) flush();
+    buf_[used_++] = (char)c;
+    return 1;
+  }
+  
+  size_t write(const uint8_t* data, size_t size) override {
+    size_t left = size;
+    while (left > 0) {
+      if (used_ == sizeof(buf_)) flush();
+      size_t n = min(left, sizeof(buf_) - used_);
+      memcpy(buf_ + used_, data, n);
+      used_ += n;
+      data += n;
+      left -= n;
+    }
+    return size;
+  }
+  using Print::write;
+  
+  // Texto como string JSON (con comillas y escapes)
+  void jsonString(const char* s) {
+    write('"');
+    for (; *s; s++) {
+      char c = *s;
+      if (c == '"' || c == '\\') {
+        write('\\');
+        write((uint8_t)c);
+      } else if (c == '\n') {
+        write("\\n");
+      } else if (c == '\r') {
+        write("\\r");
+      } else if (c == '\t') {
+        write("\\t");
+      } else if ((uint8_t)c < 0x20) {
+        char esc[8];
+        snprintf(esc, sizeof(esc), "\\u%04x", c);
+        write(esc);
+      } else {
+        write((uint8_t)c);
+      }
+    }
+    write('"');
+  }
+  
+  // Si el cliente se fue, el resto se descarta
+  void flush() {
+    if (used_ == 0) return;
+    if (!failed_ && httpd_resp_send_chunk(req_, buf_, used_) != ESP_OK) failed_ = true;
+    used_ = 0;
+  }
+  
+  // Último bloque y fin de la respuesta
+  esp_err_t end() {
+    flush();
+    if (!failed_ && httpd_resp_send_chunk(req_, NULL, 0) != ESP_OK) failed_ = true;
+    return failed_ ? ESP_FAIL : ESP_OK;
+  }
+  
+private:
+  httpd_req_t* req_;
+  char buf_[WEB_CHUNK_SIZE];
+  size_t used_;
+  bool failed_;
+};
+
+// ============================================
+// AYUDAS PARA LOS HANDLERS
+// ============================================
+// Línea de estado de httpd ("200 OK")
+const char* webStatusText(int code) {
+  switch (code) {
+    case 200: return "200 OK";
+    case 204: return "204 No Content";
+    case 304: return "304 Not Modified";
+    case 400: return "400 Bad Request";
+    case 404: return "404 Not Found";
+    case 405: return "405 Method Not Allowed";
+    case 409: return "409 Conflict";
+    case 413: return "413 Payload Too Large";
+    case 503: return "503 Service Unavailable";
+    case 504: return "504 Gateway Timeout";
+    default:  return "500 Internal Server Error";
+  }
+}
+
+// Encabezados de una respuesta JSON por partes
+ChunkedResponse beginChunkedJson(httpd_req_t* req, int code) {
+  httpd_resp_set_status(req, webStatusText(code));
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return ChunkedResponse(req);
+}
+
+esp_err_t sendJsonDocument(httpd_req_t* req, int code, const JsonDocument& doc) {
+  ChunkedResponse out = beginChunkedJson(req, code);
+  serializeJson(doc, out);
+  return out.end();
+}
+
+// JSON ya serializado (literal en flash o caché): con Content-Length, sin copiarlo
+esp_err_t sendJsonText(httpd_req_t* req, int code, const char* json, size_t len) {
+  httpd_resp_set_status(req, webStatusText(code));
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, json, len);
+}
+
+esp_err_t sendJsonText(httpd_req_t* req, int code, const char* json) {
+  return sendJsonText(req, code, json, strlen(json));
+}
+
+// Sin cuerpo (OPTIONS, 304)
+esp_err_t sendEmpty(httpd_req_t* req, int code) {
+  httpd_resp_set_status(req, webStatusText(code));
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, NULL, 0);
+}
+
+// ============================================
+// LECTURA DEL PEDIDO
+// ============================================
+// Valor de un parámetro de la query, decodificado (%XX y '+').
+// Un valor más largo que out se trunca.
+bool webQueryArg(httpd_req_t* req, const char* key, char* out, size_t size) {
+  char query[HTTPD_MAX_URI_LEN + 1];
+  esp_err_t err = httpd_req_get_url_query_str(req, query, sizeof(query));
+  if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) return false;
+  err = httpd_query_key_value(query, key, out, size);
+  if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) return false;
+  
+  char* w = out;
+  for (const char* r = out; *r; r++) {
+    if (*r == '+') {
+      *w++ = ' ';
+    } else if (*r == '%' && isxdigit((uint8_t)r[1]) && isxdigit((uint8_t)r[2])) {
+      char hex[3] = { r[1], r[2], 0 };
+      *w++ = (char)strtol(hex, NULL, 16);
+      r += 2;
+    } else {
+      *w++ = *r;
+    }
+  }
+  *w = 0;
+  return true;
+}
+
+bool webHeader(httpd_req_t* req, const char* name, char* out, size_t size) {
+  esp_err_t err = httpd_req_get_hdr_value_str(req, name, out, size);
+  return err == ESP_OK || err == ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+// Cuerpo completo de un POST (hasta WEB_BODY_MAX)
+bool webReadBody(httpd_req_t* req, String& body) {
+  if (req->content_len > WEB_BODY_MAX) return false;
+  body = "";
+  body.reserve(req->content_len);
+  char buf[256];
+  size_t left = req->content_len;
+  while (left > 0) {
+    int n = httpd_req_recv(req, buf, min(left, sizeof(buf) - 1));
+    if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+    if (n <= 0) return false;
+    buf[n] = 0;
+    body += buf;
+    left -= n;
+  }
+  return true;
+}
+
+#endif
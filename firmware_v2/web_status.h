@@ -0,0 +1,126 @@
+/*
+ * web_status.h - Versión del estado y caché de /api/status
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * statusVersion sube con cada cambio visible en /api/status: muestra de
+ * temperatura distinta, puerta, estado, alerta, comando de la API y el
+ * tick de STATUS_TICK_MS. Cada sección guarda la versión de su último
+ * cambio y el tick solo toca las que cambiaron con el reloj:
+ *   - "system" siempre (uptime, WiFi, contadores)
+ *   - "sensor" solo con una puerta abierta (door_open_sec)
+ *   - "uplink" solo si se movieron sus contadores
+ * Con la cámara quieta, ?since= devuelve solo "system" y "version".
+ *   STATUS_SENSOR  "sensor", "sensors"
+ *   STATUS_SYSTEM  "system", "state", "device", "location"
+ *   STATUS_UPLINK  "uplink"
+ *
+ * - ETag "<boot>-<versión>": If-None-Match igual responde 304 sin cuerpo.
+ * - ?since=<versión>: solo las secciones que cambiaron después.
+ * - El documento completo se serializa una vez por versión en statusCache
+ *   y todos los clientes (y el snapshot de /api/stream) envían esa copia.
+ *
+ * Los campos derivados del reloj (uptime_sec, door_open_sec...) quedan
+ * como estaban al renderizar, a lo sumo STATUS_TICK_MS atrás.
+ */
+
+#ifndef WEB_STATUS_H
+#define WEB_STATUS_H
+
+#include <ArduinoJson.h>
+#include "config.h"
+#include "types.h"
+
+extern SensorData sensorData;
+
+extern void buildStatusJSON(JsonDocument& doc, uint32_t since);
+extern void webStateLock();
+extern void webStateUnlock();
+extern void streamNotifySystem();
+extern uint32_t uplinkActivity();
+
+// ============================================
+// VERSIONES
+// ============================================
+enum StatusSection : uint8_t {
+  STATUS_SENSOR = 0,
+  STATUS_SYSTEM,
+  STATUS_UPLINK,
+  STATUS_SECTIONS
+};
+
+// Las escribe loop() y las leen los handlers, siempre con el lock
+uint32_t statusVersion = 1;
+uint32_t statusSectionVersion[STATUS_SECTIONS] = { 1, 1, 1 };
+uint32_t statusBootId = 0;          // Distingue ETags de antes de un reinicio
+
+void statusTouch(StatusSection section) {
+  statusSectionVersion[section] = ++statusVersion;
+}
+
+// ¿Incluir la sección en una respuesta ?since=?
+inline bool statusChangedSince(StatusSection section, uint32_t since) {
+  return statusSectionVersion[section] > since;
+}
+
+// Llamar desde loop() con el lock tomado
+void statusTick() {
+  static unsigned long lastTick = 0;
+  if (millis() - lastTick < STATUS_TICK_MS) return;
+  lastTick = millis();
+
+  static uint32_t lastUplink = 0;
+  uint32_t uplink = uplinkActivity();
+  if (uplink != lastUplink) {
+    lastUplink = uplink;
+    statusTouch(STATUS_UPLINK);
+  }
+  if (sensorData.anyDoorOpen) statusTouch(STATUS_SENSOR);
+
+  statusTouch(STATUS_SYSTEM);
+  streamNotifySystem();
+}
+
+// ============================================
+// CACHÉ DEL DOCUMENTO COMPLETO (tarea del servidor)
+// ============================================
+struct StatusCache {
+  uint32_t version;                 // 0 = vacío
+  size_t len;
+  char text[STATUS_CACHE_SIZE];
+};
+
+StatusCache statusCache;
+
+// Documento de la versión actual; false si no entra en la caché
+bool statusRender(const char*& text, size_t& len, uint32_t& version) {
+  static StaticJsonDocument<JSON_BUFFER_SIZE> doc;
+
+  webStateLock();
+  version = statusVersion;
+  bool fresh = statusCache.version == version;
+  if (!fresh) {
+    doc.clear();
+    buildStatusJSON(doc, 0);
+  }
+  webStateUnlock();
+
+  if (!fresh) {
+    if (measureJson(doc) >= sizeof(statusCache.text)) {
+      Serial.println("[WEB] ✗ /api/status no entra en STATUS_CACHE_SIZE");
+      statusCache.version = 0;
+      return false;
+    }
+    statusCache.len = serializeJson(doc, statusCache.text, sizeof(statusCache.text));
+    statusCache.version = version;
+  }
+
+  text = statusCache.text;
+  len = statusCache.len;
+  return true;
+}
+
+void statusETag(char* out, size_t size, uint32_t version) {
+  snprintf(out, size, "\"%08lx-%lu\"", (unsigned long)statusBootId, (unsigned long)version);
+}
+
+#endif
@@ -0,0 +1,350 @@
+/*
+ * web_stream.h - Eventos en vivo (Server-Sent Events) en /api/stream
+ * Sistema Monitoreo Reefer v4.0
+ *
+ * En lugar de pedir /api/status cada 2 s, el dashboard abre un EventSource
+ * y recibe:
+ *   event: snapshot  documento completo de /api/status (al conectar)
+ *   event: state     cambio de la máquina de estados    -> system
+ *   event: alert     alerta activada, reconocida o resuelta -> system
+ *   event: door      apertura o cierre de una puerta    -> sensor
+ *   event: sample    temperaturas distintas a la muestra anterior -> sensor
+ *   event: system    uptime, WiFi, internet (cada STATUS_TICK_MS) -> system
+ * Cada delta usa las mismas claves que la sección indicada de /api/status:
+ * el cliente las copia encima del snapshot.
+ *
+ * loop() arma los eventos (JSON corto) en un anillo de STREAM_RING_LEN.
+ * Cada STREAM_PUMP_MS, streamTask() le pide a la tarea del servidor que
+ * los escriba (httpd_queue_work): los clientes solo se tocan ahí.
+ *
+ * La conexión de /api/stream queda abierta en el servidor (sess_ctx). Los
+ * envíos no bloquean (MSG_DONTWAIT): lo que el socket no acepta queda en
+ * el buffer del cliente y sigue en la próxima vuelta, así un teléfono con
+ * mala señal no frena a los demás. Un cliente que se atrasa más que el
+ * anillo recibe un snapshot nuevo; si el socket falla, se cierra.
+ *
+ * Los mismos puntos suben la versión de /api/status (web_status.h), haya
+ * suscriptores o no.
+ */
+
+#ifndef WEB_STREAM_H
+#define WEB_STREAM_H
+
+#include <WiFi.h>
+#include <esp_http_server.h>
+#include <sys/socket.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "types.h"
+
+extern httpd_handle_t server;
+extern Config config;
+extern SensorData sensorData;
+extern SystemState state;
+
+extern void buildStatusJSON(JsonDocument& doc, uint32_t since);
+extern bool statusRender(const char*& text, size_t& len, uint32_t& version);
+extern void webStateLock();
+extern void webStateUnlock();
+extern esp_err_t sendJsonText(httpd_req_t* req, int code, const char* json);
+
+// ============================================
+// TIPOS Y VARIABLES
+// ============================================
+struct StreamEvent {
+  const char* name;                 // Literal
+  char data[STREAM_EVENT_MAX];
+};
+
+struct StreamClient {
+  int fd;
+  bool active;                      // Recibe eventos
+  bool open;                        // Sesión abierta en el servidor (hasta streamSessionClosed)
+  bool snapshot;                    // Enviar el documento completo antes que los eventos
+  uint32_t next;                    // Próximo evento a enviar
+  uint16_t outLen;                  // Pendiente en out: [outSent, outLen)
+  uint16_t outSent;
+  char out[STREAM_OUT_SIZE];
+};
+
+StreamEvent streamEvents[STREAM_RING_LEN];
+uint32_t streamPublished = 0;       // Eventos publicados (total)
+portMUX_TYPE streamMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Solo la tarea del servidor toca los clientes
+StreamClient streamClients[STREAM_MAX_CLIENTS];
+volatile uint8_t streamClientCount = 0;
+volatile bool streamPumpQueued = false;
+
+// ============================================
+// PUBLICACIÓN (loop)
+// ============================================
+void streamPublish(const char* name, JsonDocument& doc) {
+  // Sin suscriptores no se serializa nada
+  if (streamClientCount == 0) return;
+  
+  char data[STREAM_EVENT_MAX];
+  if (measureJson(doc) >= sizeof(data)) {
+    Serial.printf("[STREAM] ✗ Evento %s demasiado grande\n", name);
+    return;
+  }
+  serializeJson(doc, data, sizeof(data));
+  
+  portENTER_CRITICAL(&streamMux);
+  StreamEvent& ev = streamEvents[streamPublished % STREAM_RING_LEN];
+  ev.name = name;
+  memcpy(ev.data, data, sizeof(data));
+  streamPublished++;
+  portEXIT_CRITICAL(&streamMux);
+}
+
+void streamNotifyState() {
+  statusTouch(STATUS_SYSTEM);
+  if (streamClientCount == 0) return;
+  StaticJsonDocument<192> doc;
+  bool defrostActive = (state.currentState == STATE_DEFROST);
+  doc["state"] = state.stateName;
+  doc["defrost_mode"] = defrostActive;
+  doc["defrost_minutes"] = defrostActive ? (millis() - state.defrostStartTime) / 60000 : 0;
+  streamPublish("state", doc);
+}
+
+void streamNotifyAlert() {
+  statusTouch(STATUS_SYSTEM);
+  if (streamClientCount == 0) return;
+  StaticJsonDocument<STREAM_EVENT_MAX> doc;
+  doc["alert_active"] = state.alertActive;
+  doc["alert_acknowledged"] = state.alertAcknowledged;
+  doc["critical"] = state.alertCritical;
+  doc["alert_message"] = state.alertMessage;
+  doc["relay_on"] = sensorData.relay[0].state;
+  doc["total_alerts"] = state.totalAlerts;
+  streamPublish("alert", doc);
+}
+
+void streamNotifyDoor(int door) {
+  statusTouch(STATUS_SENSOR);
+  if (streamClientCount == 0) return;
+  // Se llama a mitad de readDoorSensors(): anyDoorOpen todavía no está listo
+  bool anyOpen = false;
+  for (int i = 0; i < MAX_DOOR_SENSORS; i++) {
+    if (sensorData.door[i].enabled && sensorData.door[i].isOpen) anyOpen = true;
+  }
+  
+  StaticJsonDocument<128> doc;
+  doc["door"] = door;
+  doc["open"] = sensorData.door[door].isOpen;
+  doc["door_open"] = anyOpen;
+  doc["door_open_sec"] = 0;
+  streamPublish("door", doc);
+}
+
+// Solo si alguna temperatura cambió (la sonda repite el valor casi siempre)
+void streamNotifySample() {
+  static float lastTemp[MAX_TEMP_SENSORS];
+  static bool lastValid = false;
+  
+  bool changed = sensorData.tempValid != lastValid;
+  for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+    if (sensorData.temp[i].value != lastTemp[i]) changed = true;
+    lastTemp[i] = sensorData.temp[i].value;
+  }
+  lastValid = sensorData.tempValid;
+  if (!changed) return;
+  
+  statusTouch(STATUS_SENSOR);
+  if (streamClientCount == 0) return;
+  StaticJsonDocument<256> doc;
+  for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+    if (sensorData.temp[i].enabled) {
+      doc["temp" + String(i + 1)] = sensorData.temp[i].value;
+    }
+  }
+  doc["temp_avg"] = sensorData.tempAvg;
+  doc["valid"] = sensorData.tempValid;
+  streamPublish("sample", doc);
+}
+
+// Desde statusTick()
+void streamNotifySystem() {
+  if (streamClientCount == 0) return;
+  StaticJsonDocument<192> doc;
+  bool defrostActive = (state.currentState == STATE_DEFROST);
+  doc["uptime_sec"] = (millis() - state.bootTime) / 1000;
+  doc["wifi_rssi"] = WiFi.RSSI();
+  doc["internet"] = state.internetAvailable;
+  doc["supabase_enabled"] = config.supabaseEnabled;
+  doc["defrost_minutes"] = defrostActive ? (millis() - state.defrostStartTime) / 60000 : 0;
+  streamPublish("system", doc);
+}
+
+// ============================================
+// ENVÍO (tarea del servidor)
+// ============================================
+void streamDrop(StreamClient& c) {
+  if (!c.active) return;
+  c.active = false;
+  streamClientCount--;
+  Serial.printf("[STREAM] Cliente desconectado (%u activos)\n", streamClientCount);
+}
+
+// free_ctx de la sesión: el cliente se fue o el servidor la cerró
+void streamSessionClosed(void* ctx) {
+  StreamClient& c = *(StreamClient*)ctx;
+  streamDrop(c);
+  c.open = false;
+}
+
+void streamClose(StreamClient& c) {
+  streamDrop(c);
+  httpd_sess_trigger_close(server, c.fd);
+}
+
+bool streamAppend(StreamClient& c, const char* text, size_t len) {
+  if (len > sizeof(c.out) - c.outLen) return false;
+  memcpy(c.out + c.outLen, text, len);
+  c.outLen += len;
+  return true;
+}
+
+bool streamAppendEvent(StreamClient& c, const char* name, const char* data) {
+  size_t room = sizeof(c.out) - c.outLen;
+  int n = snprintf(c.out + c.outLen, room, "event: %s\ndata: %s\n\n", name, data);
+  if (n < 0 || (size_t)n >= room) return false;
+  c.outLen += n;
+  return true;
+}
+
+// El mismo texto que /api/status (caché compartida)
+bool streamAppendSnapshot(StreamClient& c) {
+  static const char HEAD[] = "event: snapshot\ndata: ";
+  const char* text;
+  size_t len;
+  uint32_t version;
+  if (!statusRender(text, len, version)) return false;
+  if (sizeof(HEAD) - 1 + len + 2 > sizeof(c.out) - c.outLen) return false;
+  streamAppend(c, HEAD, sizeof(HEAD) - 1);
+  streamAppend(c, text, len);
+  streamAppend(c, "\n\n", 2);
+  return true;
+}
+
+// Lo que el socket acepte sin esperar; false si la conexión falló
+bool streamFlush(StreamClient& c) {
+  while (c.outSent < c.outLen) {
+    int n = httpd_socket_send(server, c.fd, c.out + c.outSent, c.outLen - c.outSent, MSG_DONTWAIT);
+    if (n == HTTPD_SOCK_ERR_TIMEOUT) return true;
+    if (n <= 0) return false;
+    c.outSent += n;
+  }
+  c.outLen = 0;
+  c.outSent = 0;
+  return true;
+}
+
+void streamPumpClient(StreamClient& c) {
+  if (!streamFlush(c)) {
+    streamClose(c);
+    return;
+  }
+  // El socket sigue lleno: los eventos esperan en el anillo
+  if (c.outLen > 0) return;
+  
+  if (c.snapshot) {
+    if (!streamAppendSnapshot(c)) {
+      streamClose(c);
+      return;
+    }
+    c.snapshot = false;
+  }
+  
+  static StreamEvent ev;
+  for (;;) {
+    portENTER_CRITICAL(&streamMux);
+    uint32_t published = streamPublished;
+    bool lost = published - c.next > STREAM_RING_LEN;
+    if (c.next != published && !lost) ev = streamEvents[c.next % STREAM_RING_LEN];
+    portEXIT_CRITICAL(&streamMux);
+  
+    if (c.next == published) break;
+    if (lost) {
+      // Se atrasó más que el anillo: foto completa en la próxima vuelta
+      c.next = published;
+      c.snapshot = true;
+      break;
+    }
+    // Sin lugar: sigue en la próxima vuelta
+    if (!streamAppendEvent(c, ev.name, ev.data)) break;
+    c.next++;
+  }
+  
+  if (!streamFlush(c)) streamClose(c);
+}
+
+void streamPump() {
+  for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+    if (streamClients[i].active) streamPumpClient(streamClients[i]);
+  }
+}
+
+void streamPumpWork(void* arg) {
+  (void)arg;
+  streamPumpQueued = false;
+  streamPump();
+}
+
+// Pide una vuelta de streamPump() a la tarea del servidor
+void streamTask(void* param) {
+  (void)param;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(STREAM_PUMP_MS));
+    if (streamClientCount == 0 || streamPumpQueued) continue;
+    streamPumpQueued = true;
+    if (httpd_queue_work(server, streamPumpWork, NULL) != ESP_OK) streamPumpQueued = false;
+  }
+}
+
+// ============================================
+// HANDLER: GET /api/stream
+// ============================================
+esp_err_t handleApiStream(httpd_req_t* req) {
+  int slot = -1;
+  for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+    if (!streamClients[i].open) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot < 0) {
+    return sendJsonText(req, 503, "{\"error\":\"Too many streams\"}");
+  }
+  
+  // Encabezados a mano: la respuesta no termina al salir del handler y la
+  // sesión queda abierta mientras tenga sess_ctx
+  StreamClient& c = streamClients[slot];
+  c.fd = httpd_req_to_sockfd(req);
+  c.outLen = 0;
+  c.outSent = 0;
+  static const char HEADERS[] = "HTTP/1.1 200 OK\r\n"
+                                "Content-Type: text/event-stream\r\n"
+                                "Cache-Control: no-cache\r\n"
+                                "Connection: keep-alive\r\n"
+                                "Access-Control-Allow-Origin: *\r\n\r\n"
+                                "retry: 3000\n\n";
+  streamAppend(c, HEADERS, sizeof(HEADERS) - 1);
+  c.snapshot = true;
+  portENTER_CRITICAL(&streamMux);
+  c.next = streamPublished;
+  portEXIT_CRITICAL(&streamMux);
+  c.active = true;
+  c.open = true;
+  req->sess_ctx = &c;
+  req->free_ctx = streamSessionClosed;
+  streamClientCount++;
+  Serial.printf("[STREAM] Cliente conectado (%u activos)\n", streamClientCount);
+  
+  streamPumpClient(c);
+  return ESP_OK;
+}
+
+#endif
@@ -40,6 +40,22 @@ void connectWiFi() {
   }
 }
 
+// ============================================
+// HORA DEL DISPOSITIVO (SNTP)
+// ============================================
+// El SNTP del ESP32 sincroniza en segundo plano y re-sincroniza solo
+void initDeviceClock() {
+  if (!state.wifiConnected) return;
+  configTime(0, 0, NTP_SERVER_1, NTP_SERVER_2);
+  Serial.println("[RELOJ] SNTP iniciado (UTC)");
+}
+
+// Hora unix, o 0 si el reloj todavía no se sincronizó
+uint32_t deviceUnixTime() {
+  time_t now = time(nullptr);
+  return now > (time_t)CLOCK_VALID_AFTER ? (uint32_t)now : 0;
+}
+
 // ============================================
 // CONFIGURAR mDNS
 // ============================================
@@ -55,6 +71,7 @@ void setupMDNS() {
 // ============================================
 // VERIFICAR CONEXIÓN A INTERNET
 // ============================================
+// Bloquea hasta 5 s: corre en la tarea de enlace (uplink.h)
 void checkInternet() {
   if (millis() - state.lastInternetCheck < 30000) return;
   state.lastInternetCheck = millis();
@@ -11,6 +11,7 @@
 #include <HTTPClient.h>
 #include <time.h>
 #include <Preferences.h>
+#include <new>
 
 // CONFIGURACIÓN
 const char* WIFI_SSID = "PARAMETICAN_WIFI";
@@ -43,11 +44,51 @@ struct AlertThresholds {
 AlertThresholds thresholds;
 
 // ESTRUCTURAS
-#define MAX_RIFTS 6
-#define MAX_HISTORY 1440
+// Registro dinámico: los emisores se registran solos en el primer POST
+// (clave device_id) y el registro se guarda en Preferences. El id es el
+// rift_id que manda el emisor (el depósito en Supabase); solo los que no
+// mandan ninguno reciben uno libre.
+#define MAX_RIFTS 64
+#define RIFT_SLAB_SIZE 8            // RiftData se reservan de a bloques
+#define RIFT_HASH_SIZE 128          // Potencia de 2, >= 2 x MAX_RIFTS
+#define DEVICE_ID_LEN 24
+#define RIFT_OFFLINE_MS 120000      // Sin datos por más tiempo: offline
+
+// LOTES (/api/data/batch)
+#define BATCH_MAX_BODY 8192
+#define BATCH_MAX_RECORDS 128
+#define BATCH_RECORD_SIZE 12        // Registro del formato binario
+#define BATCH_SEQ_WINDOW 256        // seq repetidos dentro de la ventana = duplicado
+
+// HISTORIAL: un punto cada HISTORY_SAMPLE_SEC como máximo (24 h por RIFT)
+#define HISTORY_POINTS 480
+#define HISTORY_SAMPLE_SEC 180
+
+// Punto de historial en 4 bytes (antes 12): temperatura en centésimas y
+// el tiempo como diferencia con el punto anterior. Las lecturas que llegan
+// dentro de la misma ventana se juntan: temperatura máxima y banderas OR.
+#define HISTORY_DT_BITS 14
+#define HISTORY_DT_MAX ((1 << HISTORY_DT_BITS) - 1)   // 4,5 h
+#define HISTORY_FLAG_DOOR (1 << 14)
+#define HISTORY_FLAG_ALERT (1 << 15)
+#define HISTORY_NO_TEMP INT16_MIN
+
+struct HistoryPoint {
+  uint16_t dtFlags;   // bits 0-13: segundos desde el punto anterior; 14 puerta; 15 alerta
+  int16_t temp;       // Centésimas de °C
+};
+
+struct RiftHistory {
+  HistoryPoint points[HISTORY_POINTS];
+  uint16_t head;      // Punto más nuevo (ventana abierta)
+  uint16_t count;
+  uint32_t headTime;  // Segundos de uptime del punto más nuevo
+};
 
 struct RiftData {
-  int id;
+  int id;                          // rift_id del emisor, o asignado si no manda
+  bool idAssigned;                 // true = asignado acá (lo cede a un emisor que lo reclame)
+  char deviceId[DEVICE_ID_LEN];
   String name;
   String location;
   float temp1, temp2, tempAvg;
@@ -58,17 +99,32 @@ struct RiftData {
   bool online, alertActive;
   String alertMessage;
   unsigned long alertStartTime;
+  unsigned long highTempStart;
+  uint32_t lastSeq;                // Último seq de /api/data/batch
+  uint32_t lastBoot;               // boot de ese seq (0 = el emisor no manda)
+  RiftHistory history;
 };
 
-struct HistoryPoint {
-  unsigned long timestamp;
-  float temperature;
+// Una lectura de un emisor, venga de /api/data o de un lote
+struct Reading {
+  uint32_t seq;                    // 0 = sin número de secuencia
+  uint32_t boot;                   // Cambia cuando el emisor reinicia seq; 0 = no manda
+  uint32_t age;                    // Segundos desde que se tomó (lotes con buffer)
+  float temp1, temp2, tempAvg;
   bool doorOpen;
+  unsigned long doorOpenSince;
+  int sensorCount, rssi;
 };
 
-RiftData rifts[MAX_RIFTS];
-HistoryPoint history[MAX_RIFTS][MAX_HISTORY];
-int historyIndex[MAX_RIFTS] = {0};
+enum IngestResult { INGEST_OK, INGEST_DUPLICATE, INGEST_NO_KEY, INGEST_FULL };
+
+RiftData* riftSlabs[MAX_RIFTS / RIFT_SLAB_SIZE];
+int riftCount = 0;
+uint8_t riftIndex[RIFT_HASH_SIZE];  // Índice + 1 en el registro (0 = libre)
+
+inline RiftData& rift(int i) {
+  return riftSlabs[i / RIFT_SLAB_SIZE][i % RIFT_SLAB_SIZE];
+}
 
 WebServer server(80);
 Preferences preferences;
@@ -109,7 +165,7 @@ void setup() {
   }
   
   loadConfiguration();
-  initRifts();
+  loadRegistry();
   connectWiFi();
   configTime(GMT_OFFSET, 0, NTP_SERVER);
   setupWebServer();
@@ -140,19 +196,153 @@ void loop() {
   delay(10);
 }
 
-void initRifts() {
-  const char* names[] = {"RIFT-01","RIFT-02","RIFT-03","RIFT-04","RIFT-05","RIFT-06"};
-  const char* locs[] = {"Deposito Principal","Deposito Carnes","Deposito Lacteos",
-                        "Deposito Verduras","Deposito Bebidas","Deposito Reserva"};
+// REGISTRO DE EMISORES (hash con direccionamiento abierto)
+uint32_t hashDeviceId(const char* s) {
+  uint32_t h = 2166136261u;   // FNV-1a
+  while (*s) {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+int findRift(const char* deviceId) {
+  uint32_t slot = hashDeviceId(deviceId) & (RIFT_HASH_SIZE - 1);
+  while (riftIndex[slot]) {
+    int i = riftIndex[slot] - 1;
+    if (strcmp(rift(i).deviceId, deviceId) == 0) return i;
+    slot = (slot + 1) & (RIFT_HASH_SIZE - 1);
+  }
+  return -1;
+}
+
+int findRiftById(int id) {
+  for (int i = 0; i < riftCount; i++) {
+    if (rift(i).id == id) return i;
+  }
+  return -1;
+}
+
+// Menor id sin usar
+int freeRiftId() {
+  int id = 1;
+  while (findRiftById(id) >= 0) id++;
+  return id;
+}
+
+// Alta en memoria; -1 si el registro está lleno o no hay RAM
+int addRift(const char* deviceId, const char* name, const char* location, int id, bool idAssigned) {
+  if (riftCount >= MAX_RIFTS) return -1;
   
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    rifts[i].id = i + 1;
-    rifts[i].name = names[i];
-    rifts[i].location = locs[i];
-    rifts[i].online = false;
-    rifts[i].temp1 = rifts[i].temp2 = rifts[i].tempAvg = -999.0;
-    rifts[i].alertActive = false;
+  int i = riftCount;
+  if (i % RIFT_SLAB_SIZE == 0) {
+    riftSlabs[i / RIFT_SLAB_SIZE] = new (std::nothrow) RiftData[RIFT_SLAB_SIZE];
+    if (!riftSlabs[i / RIFT_SLAB_SIZE]) return -1;
   }
+  
+  RiftData& r = rift(i);
+  r.id = id;
+  r.idAssigned = idAssigned;
+  strlcpy(r.deviceId, deviceId, sizeof(r.deviceId));
+  r.name = name;
+  r.location = location;
+  r.online = false;
+  r.temp1 = r.temp2 = r.tempAvg = -999.0;
+  r.alertActive = false;
+  r.highTempStart = 0;
+  r.lastSeq = 0;
+  r.lastBoot = 0;
+  memset(&r.history, 0, sizeof(r.history));
+  
+  uint32_t slot = hashDeviceId(r.deviceId) & (RIFT_HASH_SIZE - 1);
+  while (riftIndex[slot]) slot = (slot + 1) & (RIFT_HASH_SIZE - 1);
+  riftIndex[slot] = i + 1;
+  riftCount++;
+  return i;
+}
+
+void saveRift(int i) {
+  char key[8];
+  preferences.begin("registry", false);
+  snprintf(key, sizeof(key), "d%d", i);
+  preferences.putString(key, rift(i).deviceId);
+  snprintf(key, sizeof(key), "n%d", i);
+  preferences.putString(key, rift(i).name);
+  snprintf(key, sizeof(key), "l%d", i);
+  preferences.putString(key, rift(i).location);
+  snprintf(key, sizeof(key), "i%d", i);
+  preferences.putInt(key, rift(i).id);
+  snprintf(key, sizeof(key), "a%d", i);
+  preferences.putBool(key, rift(i).idAssigned);
+  preferences.putInt("count", riftCount);
+  preferences.end();
+}
+
+// Registros de antes del rift_id: el id era el orden de registro
+void loadRegistry() {
+  char key[8];
+  preferences.begin("registry", true);
+  int count = preferences.getInt("count", 0);
+  for (int i = 0; i < count; i++) {
+    snprintf(key, sizeof(key), "d%d", i);
+    String deviceId = preferences.getString(key, "");
+    snprintf(key, sizeof(key), "n%d", i);
+    String name = preferences.getString(key, deviceId);
+    snprintf(key, sizeof(key), "l%d", i);
+    String location = preferences.getString(key, "");
+    snprintf(key, sizeof(key), "i%d", i);
+    int id = preferences.getInt(key, i + 1);
+    snprintf(key, sizeof(key), "a%d", i);
+    bool idAssigned = preferences.getBool(key, true);
+    if (deviceId.length() == 0 || addRift(deviceId.c_str(), name.c_str(), location.c_str(), id, idAssigned) < 0) break;
+  }
+  preferences.end();
+  Serial.printf("[REGISTRO] %d emisores\n", riftCount);
+}
+
+// El emisor i manda su rift_id: si otro lo tenía asignado acá, ese pasa a
+// uno libre. Dos emisores con el mismo rift_id es un error de config.
+void claimRiftId(int i, int riftId) {
+  RiftData& r = rift(i);
+  if (r.id == riftId && !r.idAssigned) return;
+  
+  int other = findRiftById(riftId);
+  r.id = riftId;
+  r.idAssigned = false;
+  if (other >= 0 && other != i) {
+    if (rift(other).idAssigned) {
+      rift(other).id = freeRiftId();
+      saveRift(other);
+      Serial.printf("[REGISTRO] %s pasa a #%d\n", rift(other).deviceId, rift(other).id);
+    } else {
+      Serial.printf("[REGISTRO] ✗ %s y %s mandan rift_id %d\n", rift(other).deviceId, r.deviceId, riftId);
+    }
+  }
+  saveRift(i);
+}
+
+// Buscar o registrar (primer POST de un emisor nuevo). riftId 0 = el
+// emisor no manda rift_id.
+int resolveRift(const char* deviceId, const char* name, const char* location, int riftId) {
+  int i = findRift(deviceId);
+  if (i >= 0) {
+    // El emisor cambió su nombre o ubicación
+    if (rift(i).name != name || rift(i).location != location) {
+      rift(i).name = name;
+      rift(i).location = location;
+      saveRift(i);
+    }
+    if (riftId > 0) claimRiftId(i, riftId);
+    return i;
+  }
+  
+  i = addRift(deviceId, name, location, freeRiftId(), true);
+  if (i >= 0) {
+    if (riftId > 0) claimRiftId(i, riftId);
+    else saveRift(i);
+    Serial.printf("[REGISTRO] Nuevo emisor %s (#%d)\n", deviceId, rift(i).id);
+  }
+  return i;
 }
 
 void loadConfiguration() {
@@ -211,6 +401,7 @@ void setupWebServer() {
   server.on("/app", HTTP_GET, handleMobileApp);  // App para celulares
   server.on("/api/status", HTTP_GET, handleGetStatus);
   server.on("/api/data", HTTP_POST, handlePostData);
+  server.on("/api/data/batch", HTTP_POST, handlePostBatch, handleBatchUpload);
   server.on("/api/history", HTTP_GET, handleGetHistory);
   server.on("/api/alerts", HTTP_GET, handleGetAlerts);
   server.on("/api/config", HTTP_GET, handleGetConfig);
@@ -231,24 +422,26 @@ void handleRoot() {
 }
 
 void handleGetStatus() {
-  StaticJsonDocument<2048> doc;
+  // El documento crece con la cantidad de emisores registrados
+  DynamicJsonDocument doc(512 + riftCount * 320);
   JsonArray arr = doc.createNestedArray("rifts");
   
-  for (int i = 0; i < MAX_RIFTS; i++) {
+  for (int i = 0; i < riftCount; i++) {
     JsonObject r = arr.createNestedObject();
-    r["id"] = rifts[i].id;
-    r["name"] = rifts[i].name;
-    r["location"] = rifts[i].location;
-    r["temp1"] = rifts[i].temp1;
-    r["temp2"] = rifts[i].temp2;
-    r["temp_avg"] = rifts[i].tempAvg;
-    r["door_open"] = rifts[i].doorOpen;
-    r["door_open_since"] = rifts[i].doorOpenSince;
-    r["online"] = rifts[i].online;
-    r["last_update"] = rifts[i].lastUpdate;
-    r["alert_active"] = rifts[i].alertActive;
-    r["alert_message"] = rifts[i].alertMessage;
-    r["rssi"] = rifts[i].rssi;
+    r["id"] = rift(i).id;
+    r["device_id"] = (const char*)rift(i).deviceId;
+    r["name"] = rift(i).name.c_str();
+    r["location"] = rift(i).location.c_str();
+    r["temp1"] = rift(i).temp1;
+    r["temp2"] = rift(i).temp2;
+    r["temp_avg"] = rift(i).tempAvg;
+    r["door_open"] = rift(i).doorOpen;
+    r["door_open_since"] = rift(i).doorOpenSince;
+    r["online"] = rift(i).online;
+    r["last_update"] = rift(i).lastUpdate;
+    r["alert_active"] = rift(i).alertActive;
+    r["alert_message"] = rift(i).alertMessage.c_str();
+    r["rssi"] = rift(i).rssi;
   }
   
   doc["internet"] = internetAvailable;
@@ -267,6 +460,91 @@ void handleGetStatus() {
   server.send(200, "application/json", response);
 }
 
+const char* ingestResultName(IngestResult r) {
+  switch (r) {
+    case INGEST_OK:        return "ok";
+    case INGEST_DUPLICATE: return "duplicate";
+    case INGEST_NO_KEY:    return "missing device_id";
+    default:               return "registry full";
+  }
+}
+
+// Campo del registro o, si falta, el valor común del lote
+const char* pickString(JsonObjectConst rec, JsonObjectConst defaults, const char* field) {
+  const char* v = rec[field] | (const char*)nullptr;
+  return v ? v : defaults[field] | (const char*)nullptr;
+}
+
+// Clave del emisor: device_id (MAC, chip id...), si no rift_name; los
+// emisores viejos que solo mandan rift_id quedan como "RIFT-NN"
+bool readingKey(JsonObjectConst rec, JsonObjectConst defaults, char* deviceId) {
+  const char* key = pickString(rec, defaults, "device_id");
+  if (!key) key = pickString(rec, defaults, "rift_name");
+  if (key) {
+    strlcpy(deviceId, key, DEVICE_ID_LEN);
+  } else {
+    int riftId = rec["rift_id"] | (defaults["rift_id"] | 0);
+    if (riftId < 1) return false;
+    snprintf(deviceId, DEVICE_ID_LEN, "RIFT-%02d", riftId);
+  }
+  return deviceId[0] != '\0';
+}
+
+Reading readingFromJson(JsonObjectConst rec) {
+  Reading r;
+  r.seq = rec["seq"] | 0UL;
+  r.boot = rec["boot"] | 0UL;
+  r.age = rec["age"] | 0UL;
+  r.temp1 = rec["temp1"] | -999.0;
+  r.temp2 = rec["temp2"] | -999.0;
+  r.tempAvg = rec["temp_avg"] | -999.0;
+  r.doorOpen = rec["door_open"] | false;
+  r.doorOpenSince = rec["door_open_since"] | 0;
+  r.sensorCount = rec["sensor_count"] | 0;
+  r.rssi = rec["rssi"] | 0;
+  return r;
+}
+
+// Aplica una lectura ya resuelta a su RIFT; sin Serial ni String
+IngestResult applyReading(int idx, const Reading& r) {
+  RiftData& rd = rift(idx);
+  
+  // El emisor reinició la cuenta: con boot se sabe seguro; sin boot,
+  // seq 1 es el primero después de un corte
+  if (r.boot != 0 ? r.boot != rd.lastBoot : r.seq == 1) {
+    rd.lastSeq = 0;
+    rd.lastBoot = r.boot;
+  }
+  
+  // Reintento de un lote cuyo ack se perdió. Un seq muy atrás también es
+  // una cuenta nueva: se acepta.
+  if (r.seq != 0 && rd.lastSeq != 0 && r.seq <= rd.lastSeq && rd.lastSeq - r.seq < BATCH_SEQ_WINDOW) {
+    return INGEST_DUPLICATE;
+  }
+  if (r.seq != 0) rd.lastSeq = r.seq;
+  
+  uint32_t nowSec = millis() / 1000;
+  uint32_t age = r.age < nowSec ? r.age : nowSec;
+  unsigned long when = millis() - age * 1000UL;
+  
+  // El estado en vivo solo avanza con lecturas más nuevas que la actual
+  if (!rd.online || (long)(when - rd.lastUpdate) >= 0) {
+    rd.temp1 = r.temp1;
+    rd.temp2 = r.temp2;
+    rd.tempAvg = r.tempAvg;
+    rd.doorOpen = r.doorOpen;
+    rd.doorOpenSince = r.doorOpenSince;
+    rd.sensorCount = r.sensorCount;
+    rd.rssi = r.rssi;
+    rd.lastUpdate = when;
+    rd.online = millis() - when < RIFT_OFFLINE_MS;
+  }
+  
+  addToHistory(idx, r.tempAvg, r.doorOpen, rd.alertActive, nowSec - age);
+  totalDataReceived++;
+  return INGEST_OK;
+}
+
 void handlePostData() {
   if (!server.hasArg("plain")) {
     server.send(400, "application/json", "{\"error\":\"No data\"}");
@@ -275,48 +553,225 @@ void handlePostData() {
   
   StaticJsonDocument<512> doc;
   deserializeJson(doc, server.arg("plain"));
+  JsonObjectConst rec = doc.as<JsonObjectConst>();
   
-  int riftId = doc["rift_id"] | 0;
-  if (riftId < 1 || riftId > MAX_RIFTS) {
-    server.send(400, "application/json", "{\"error\":\"Invalid rift_id\"}");
+  char deviceId[DEVICE_ID_LEN];
+  if (!readingKey(rec, JsonObjectConst(), deviceId)) {
+    server.send(400, "application/json", "{\"error\":\"Missing device_id\"}");
     return;
   }
   
-  int idx = riftId - 1;
-  rifts[idx].temp1 = doc["temp1"] | -999.0;
-  rifts[idx].temp2 = doc["temp2"] | -999.0;
-  rifts[idx].tempAvg = doc["temp_avg"] | -999.0;
-  rifts[idx].doorOpen = doc["door_open"] | false;
-  rifts[idx].doorOpenSince = doc["door_open_since"] | 0;
-  rifts[idx].sensorCount = doc["sensor_count"] | 0;
-  rifts[idx].rssi = doc["rssi"] | 0;
-  rifts[idx].lastUpdate = millis();
-  rifts[idx].online = true;
+  int idx = resolveRift(deviceId, rec["rift_name"] | (const char*)deviceId, rec["location"] | "", rec["rift_id"] | 0);
+  if (idx < 0) {
+    server.send(503, "application/json", "{\"error\":\"Registry full\"}");
+    return;
+  }
   
-  addToHistory(idx, rifts[idx].tempAvg, rifts[idx].doorOpen);
-  totalDataReceived++;
+  applyReading(idx, readingFromJson(rec));
   
-  Serial.println("[DATA] " + rifts[idx].name + ": " + String(rifts[idx].tempAvg, 1) + "C");
-  server.send(200, "application/json", "{\"status\":\"ok\"}");
+  Serial.printf("[DATA] %s: %.1fC\n", rift(idx).name.c_str(), rift(idx).tempAvg);
+  server.send(200, "application/json", "{\"status\":\"ok\",\"rift_id\":" + String(rift(idx).id) + "}");
+}
+
+// ============================================
+// LOTES: POST /api/data/batch
+// ============================================
+// Muchas lecturas, de uno o varios emisores, en un solo request. Cuerpos:
+//
+// JSON (Content-Type: application/json), un arreglo de registros con los
+// mismos campos que /api/data más "seq", "age" (segundos desde la
+// lectura) y "boot" (opcional, cambia cuando el emisor vuelve a contar
+// seq desde 1), o un objeto con los campos comunes y "readings":
+//   {"device_id":"A4CF12","rift_name":"RIFT-01","location":"...",
+//    "readings":[{"seq":41,"age":90,"temp1":-20.1,...}, ...]}
+//
+// Binario (Content-Type: application/octet-stream), little-endian:
+//   "RB" versión(1)
+//   por emisor: largo_id(1) device_id [rift_id(2), desde versión 2;
+//   0 = sin id] [boot(4), desde versión 3] cantidad(1) y cantidad registros de
+//   BATCH_RECORD_SIZE: seq(4) age(2) temp1(2) temp2(2) flags(1) rssi(1)
+//   Temperaturas en centésimas de °C, INT16_MIN = sonda ausente;
+//   flags bit 0 = puerta abierta.
+//
+// Respuesta: un ack por registro, en orden:
+//   {"status":"ok","accepted":N,"acks":[{"seq":41,"status":"ok"}, ...]}
+// "duplicate" también confirma: ese seq ya estaba guardado.
+
+uint8_t batchBody[BATCH_MAX_BODY];
+size_t batchLen = 0;
+bool batchOverflow = false;
+
+// El cuerpo llega crudo (sin pasar por un String) para aceptar binario
+void handleBatchUpload() {
+  HTTPRaw& raw = server.raw();
+  if (raw.status == RAW_START) {
+    batchLen = 0;
+    batchOverflow = false;
+  } else if (raw.status == RAW_WRITE) {
+    if (batchLen + raw.currentSize > sizeof(batchBody)) {
+      batchOverflow = true;
+    } else {
+      memcpy(batchBody + batchLen, raw.buf, raw.currentSize);
+      batchLen += raw.currentSize;
+    }
+  }
+}
+
+void batchAck(JsonArray acks, uint32_t seq, IngestResult result, int& accepted) {
+  JsonObject a = acks.createNestedObject();
+  a["seq"] = seq;
+  a["status"] = ingestResultName(result);
+  if (result == INGEST_OK || result == INGEST_DUPLICATE) accepted++;
+}
+
+bool ingestJsonBatch(JsonArray acks, int& accepted) {
+  DynamicJsonDocument doc(batchLen * 2 + 512);
+  if (deserializeJson(doc, (const char*)batchBody, batchLen)) return false;
+  
+  JsonObjectConst defaults;
+  JsonArrayConst records;
+  if (doc.is<JsonArray>()) {
+    records = doc.as<JsonArrayConst>();
+  } else {
+    defaults = doc.as<JsonObjectConst>();
+    records = defaults["readings"].as<JsonArrayConst>();
+  }
+  if (records.isNull() || records.size() > BATCH_MAX_RECORDS) return false;
+  
+  char deviceId[DEVICE_ID_LEN];
+  for (JsonObjectConst rec : records) {
+    Reading r = readingFromJson(rec);
+    if (r.boot == 0) r.boot = defaults["boot"] | 0UL;
+    IngestResult result = INGEST_NO_KEY;
+    if (readingKey(rec, defaults, deviceId)) {
+      const char* name = pickString(rec, defaults, "rift_name");
+      const char* location = pickString(rec, defaults, "location");
+      int riftId = rec["rift_id"] | (defaults["rift_id"] | 0);
+      int idx = resolveRift(deviceId, name ? name : deviceId, location ? location : "", riftId);
+      result = idx < 0 ? INGEST_FULL : applyReading(idx, r);
+    }
+    batchAck(acks, r.seq, result, accepted);
+  }
+  return true;
+}
+
+float centiToTemp(int16_t centi) {
+  return centi == INT16_MIN ? -999.0 : centi / 100.0;
+}
+
+bool ingestBinaryBatch(JsonArray acks, int& accepted) {
+  const uint8_t* p = batchBody + 3;
+  const uint8_t* end = batchBody + batchLen;
+  uint8_t version = batchBody[2];
+  if (version < 1 || version > 3) return false;
+  
+  char deviceId[DEVICE_ID_LEN];
+  int total = 0;
+  while (p < end) {
+    uint8_t idLen = *p++;
+    int header = idLen + (version >= 2 ? 2 : 0) + (version >= 3 ? 4 : 0) + 1;
+    if (idLen == 0 || idLen >= DEVICE_ID_LEN || end - p < header) return false;
+    memcpy(deviceId, p, idLen);
+    deviceId[idLen] = '\0';
+    p += idLen;
+    uint16_t riftId = 0;
+    if (version >= 2) {
+      memcpy(&riftId, p, 2);
+      p += 2;
+    }
+    uint32_t boot = 0;
+    if (version >= 3) {
+      memcpy(&boot, p, 4);
+      p += 4;
+    }
+    uint8_t count = *p++;
+    total += count;
+    if (end - p < count * BATCH_RECORD_SIZE || total > BATCH_MAX_RECORDS) return false;
+    
+    // Nombre y ubicación quedan como estaban (o el id si es nuevo)
+    int idx = findRift(deviceId);
+    if (idx < 0) idx = resolveRift(deviceId, deviceId, "", riftId);
+    else if (riftId > 0) claimRiftId(idx, riftId);
+    
+    for (int i = 0; i < count; i++, p += BATCH_RECORD_SIZE) {
+      Reading r;
+      memcpy(&r.seq, p, 4);
+      r.boot = boot;
+      uint16_t age;
+      int16_t t1, t2;
+      memcpy(&age, p + 4, 2);
+      memcpy(&t1, p + 6, 2);
+      memcpy(&t2, p + 8, 2);
+      r.age = age;
+      r.temp1 = centiToTemp(t1);
+      r.temp2 = centiToTemp(t2);
+      r.sensorCount = (t1 != INT16_MIN) + (t2 != INT16_MIN);
+      r.tempAvg = r.sensorCount ? ((t1 != INT16_MIN ? r.temp1 : 0) + (t2 != INT16_MIN ? r.temp2 : 0)) / r.sensorCount : -999.0;
+      r.doorOpen = p[10] & 0x01;
+      r.doorOpenSince = 0;
+      r.rssi = (int8_t)p[11];
+      batchAck(acks, r.seq, idx < 0 ? INGEST_FULL : applyReading(idx, r), accepted);
+    }
+  }
+  return true;
+}
+
+void handlePostBatch() {
+  if (batchOverflow || batchLen == 0) {
+    server.send(batchOverflow ? 413 : 400, "application/json",
+                batchOverflow ? "{\"error\":\"Batch too large\"}" : "{\"error\":\"No data\"}");
+    batchLen = 0;
+    batchOverflow = false;
+    return;
+  }
+  
+  DynamicJsonDocument resp(128 + BATCH_MAX_RECORDS * 48);
+  JsonArray acks = resp.createNestedArray("acks");
+  int accepted = 0;
+  bool binary = batchLen >= 3 && batchBody[0] == 'R' && batchBody[1] == 'B';
+  bool ok = binary ? ingestBinaryBatch(acks, accepted) : ingestJsonBatch(acks, accepted);
+  batchLen = 0;
+  
+  // Registros aplicados antes de un error de formato quedan confirmados
+  resp["status"] = ok ? "ok" : "error";
+  if (!ok) resp["error"] = "Malformed batch";
+  resp["accepted"] = accepted;
+  
+  // Una línea por lote, no por lectura
+  Serial.printf("[BATCH] %s: %d/%u registros\n", binary ? "bin" : "json", accepted, acks.size());
+  
+  String response;
+  serializeJson(resp, response);
+  server.send(ok ? 200 : 400, "application/json", response);
 }
 
 void handleGetHistory() {
-  int riftId = server.arg("rift").toInt();
-  if (riftId < 1 || riftId > MAX_RIFTS) riftId = 1;
-  int idx = riftId - 1;
+  // ?device=<device_id> o ?rift=<id>
+  int idx = server.hasArg("device") ? findRift(server.arg("device").c_str())
+                                    : findRiftById(server.arg("rift").toInt());
+  if (idx < 0 || idx >= riftCount) {
+    server.send(404, "application/json", "{\"error\":\"Unknown rift\"}");
+    return;
+  }
   
   StaticJsonDocument<4096> doc;
-  doc["rift_id"] = riftId;
+  doc["rift_id"] = rift(idx).id;
+  doc["device_id"] = (const char*)rift(idx).deviceId;
   JsonArray data = doc.createNestedArray("data");
   
-  for (int i = 0; i < 100; i++) {
-    int hIdx = (historyIndex[idx] - i + MAX_HISTORY) % MAX_HISTORY;
-    if (history[idx][hIdx].timestamp > 0) {
+  // Del más nuevo al más viejo, reconstruyendo el tiempo hacia atrás
+  RiftHistory& h = rift(idx).history;
+  uint32_t t = h.headTime;
+  for (int i = 0; i < 100 && i < h.count; i++) {
+    const HistoryPoint& hp = h.points[(h.head - i + HISTORY_POINTS) % HISTORY_POINTS];
+    if (hp.temp != HISTORY_NO_TEMP) {
       JsonObject p = data.createNestedObject();
-      p["t"] = history[idx][hIdx].timestamp;
-      p["temp"] = history[idx][hIdx].temperature;
-      p["door"] = history[idx][hIdx].doorOpen;
+      p["t"] = (unsigned long)t * 1000;
+      p["temp"] = hp.temp / 100.0;
+      p["door"] = (hp.dtFlags & HISTORY_FLAG_DOOR) != 0;
+      p["alert"] = (hp.dtFlags & HISTORY_FLAG_ALERT) != 0;
     }
+    t -= hp.dtFlags & HISTORY_DT_MAX;
   }
   
   String response;
@@ -325,15 +780,15 @@ void handleGetHistory() {
 }
 
 void handleGetAlerts() {
-  StaticJsonDocument<1024> doc;
+  DynamicJsonDocument doc(256 + riftCount * 160);
   JsonArray alerts = doc.createNestedArray("alerts");
   
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    if (rifts[i].alertActive) {
+  for (int i = 0; i < riftCount; i++) {
+    if (rift(i).alertActive) {
       JsonObject a = alerts.createNestedObject();
-      a["rift_id"] = rifts[i].id;
-      a["rift_name"] = rifts[i].name;
-      a["message"] = rifts[i].alertMessage;
+      a["rift_id"] = rift(i).id;
+      a["rift_name"] = rift(i).name.c_str();
+      a["message"] = rift(i).alertMessage.c_str();
     }
   }
   
@@ -372,52 +827,78 @@ void handleTestAlert() {
   server.send(200, "application/json", "{\"status\":\"ok\"}");
 }
 
-void addToHistory(int idx, float temp, bool door) {
-  history[idx][historyIndex[idx]].timestamp = millis();
-  history[idx][historyIndex[idx]].temperature = temp;
-  history[idx][historyIndex[idx]].doorOpen = door;
-  historyIndex[idx] = (historyIndex[idx] + 1) % MAX_HISTORY;
+void historyPush(RiftHistory& h, uint32_t dt, int16_t temp, uint16_t flags) {
+  h.head = (h.head + 1) % HISTORY_POINTS;
+  if (h.count < HISTORY_POINTS) h.count++;
+  h.points[h.head].dtFlags = (uint16_t)dt | flags;
+  h.points[h.head].temp = temp;
 }
 
-void checkAlerts() {
-  static unsigned long highTempStart[MAX_RIFTS] = {0};
+// now: segundos de uptime de la lectura. Una lectura de un lote más vieja
+// que el punto abierto se junta con él (el anillo solo crece hacia adelante).
+void addToHistory(int idx, float temp, bool door, bool alert, uint32_t now) {
+  RiftHistory& h = rift(idx).history;
+  if (h.count > 0 && now < h.headTime) now = h.headTime;
   
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    if (!rifts[i].online || rifts[i].tempAvg == -999.0) continue;
+  int16_t centi = HISTORY_NO_TEMP;
+  if (temp > -300.0 && temp < 300.0) centi = (int16_t)lroundf(temp * 100.0);
+  uint16_t flags = (door ? HISTORY_FLAG_DOOR : 0) | (alert ? HISTORY_FLAG_ALERT : 0);
+  
+  // Misma ventana: juntar con el punto abierto
+  if (h.count > 0 && now - h.headTime < HISTORY_SAMPLE_SEC) {
+    HistoryPoint& hp = h.points[h.head];
+    if (centi != HISTORY_NO_TEMP && (hp.temp == HISTORY_NO_TEMP || centi > hp.temp)) hp.temp = centi;
+    hp.dtFlags |= flags;
+    return;
+  }
+  
+  uint32_t dt = h.count > 0 ? now - h.headTime : 0;
+  // Hueco mayor que el delta: puntos sin dato que lo cubren
+  while (dt > HISTORY_DT_MAX) {
+    historyPush(h, HISTORY_DT_MAX, HISTORY_NO_TEMP, 0);
+    dt -= HISTORY_DT_MAX;
+  }
+  historyPush(h, dt, centi, flags);
+  h.headTime = now;
+}
+
+void checkAlerts() {
+  for (int i = 0; i < riftCount; i++) {
+    if (!rift(i).online || rift(i).tempAvg == -999.0) continue;
     
-    if (rifts[i].tempAvg > thresholds.tempCritical) {
-      if (!rifts[i].alertActive) {
-        triggerAlert(i, "CRITICO: Temp " + String(rifts[i].tempAvg, 1) + "C");
+    if (rift(i).tempAvg > thresholds.tempCritical) {
+      if (!rift(i).alertActive) {
+        triggerAlert(i, "CRITICO: Temp " + String(rift(i).tempAvg, 1) + "C");
       }
-    } else if (rifts[i].tempAvg > thresholds.tempMax) {
-      if (!rifts[i].doorOpen) {
-        if (highTempStart[i] == 0) highTempStart[i] = millis();
-        else if ((millis() - highTempStart[i]) / 1000 > thresholds.minDurationSeconds) {
-          if (!rifts[i].alertActive) {
-            triggerAlert(i, "Temp alta: " + String(rifts[i].tempAvg, 1) + "C");
+    } else if (rift(i).tempAvg > thresholds.tempMax) {
+      if (!rift(i).doorOpen) {
+        if (rift(i).highTempStart == 0) rift(i).highTempStart = millis();
+        else if ((millis() - rift(i).highTempStart) / 1000 > thresholds.minDurationSeconds) {
+          if (!rift(i).alertActive) {
+            triggerAlert(i, "Temp alta: " + String(rift(i).tempAvg, 1) + "C");
           }
         }
       }
     } else {
-      highTempStart[i] = 0;
-      if (rifts[i].alertActive) clearAlert(i);
+      rift(i).highTempStart = 0;
+      if (rift(i).alertActive) clearAlert(i);
     }
   }
 }
 
 void triggerAlert(int idx, String msg) {
-  rifts[idx].alertActive = true;
-  rifts[idx].alertMessage = msg;
-  rifts[idx].alertStartTime = millis();
+  rift(idx).alertActive = true;
+  rift(idx).alertMessage = msg;
+  rift(idx).alertStartTime = millis();
   
-  String full = "ALERTA " + rifts[idx].name + "\n" + msg;
+  String full = "ALERTA " + rift(idx).name + "\n" + msg;
   sendTelegramAlert(full);
   totalAlertsSent++;
 }
 
 void clearAlert(int idx) {
-  rifts[idx].alertActive = false;
-  rifts[idx].alertMessage = "";
+  rift(idx).alertActive = false;
+  rift(idx).alertMessage = "";
 }
 
 void sendTelegramAlert(String msg) {
@@ -448,15 +929,15 @@ void syncToSupabase() {
   http.addHeader("apikey", SUPABASE_KEY);
   http.addHeader("Authorization", "Bearer " + String(SUPABASE_KEY));
   
-  StaticJsonDocument<512> doc;
+  DynamicJsonDocument doc(64 + riftCount * 96);
   JsonArray arr = doc.to<JsonArray>();
   
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    if (rifts[i].online && rifts[i].tempAvg != -999.0) {
+  for (int i = 0; i < riftCount; i++) {
+    if (rift(i).online && rift(i).tempAvg != -999.0) {
       JsonObject r = arr.createNestedObject();
-      r["rift_id"] = rifts[i].id;
-      r["temperature"] = rifts[i].tempAvg;
-      r["door_open"] = rifts[i].doorOpen;
+      r["rift_id"] = rift(i).id;
+      r["temperature"] = rift(i).tempAvg;
+      r["door_open"] = rift(i).doorOpen;
     }
   }
   
@@ -467,20 +948,20 @@ void syncToSupabase() {
 }
 
 void checkRiftStatus() {
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    if (rifts[i].online && (millis() - rifts[i].lastUpdate > 120000)) {
-      rifts[i].online = false;
+  for (int i = 0; i < riftCount; i++) {
+    if (rift(i).online && (millis() - rift(i).lastUpdate > RIFT_OFFLINE_MS)) {
+      rift(i).online = false;
     }
   }
   
   // Actualizar estado de alerta local
   localAlertActive = false;
   criticalAlertActive = false;
-  for (int i = 0; i < MAX_RIFTS; i++) {
-    if (rifts[i].alertActive) {
+  for (int i = 0; i < riftCount; i++) {
+    if (rift(i).alertActive) {
       localAlertActive = true;
       // Si la temperatura es crítica (>-10°C), activar sirena
-      if (rifts[i].tempAvg > thresholds.tempCritical) {
+      if (rift(i).tempAvg > thresholds.tempCritical) {
         criticalAlertActive = true;
       }
     }
@@ -0,0 +1,30 @@
+-- Clave de idempotencia del diario en flash del firmware (journal.h)
+-- Ejecutar en Supabase SQL Editor
+--
+-- Cada registro subido desde el diario lleva seq = generación << 32 | secuencia.
+-- El firmware inserta con on_conflict=device_id,seq y
+-- Prefer: resolution=ignore-duplicates: un reenvío (reinicio, timeout) no
+-- duplica filas. Las filas sin seq (firmware anterior) no se ven afectadas.
+
+-- Agregar columna seq (bigint)
+ALTER TABLE readings ADD COLUMN IF NOT EXISTS seq BIGINT;
+ALTER TABLE alerts ADD COLUMN IF NOT EXISTS seq BIGINT;
+ALTER TABLE door_events ADD COLUMN IF NOT EXISTS seq BIGINT;
+ALTER TABLE defrost_sessions ADD COLUMN IF NOT EXISTS seq BIGINT;
+ALTER TABLE power_events ADD COLUMN IF NOT EXISTS seq BIGINT;
+ALTER TABLE maintenance_logs ADD COLUMN IF NOT EXISTS seq BIGINT;
+
+-- Índices únicos (NULL no choca con NULL)
+CREATE UNIQUE INDEX IF NOT EXISTS readings_device_seq_key ON readings (device_id, seq);
+CREATE UNIQUE INDEX IF NOT EXISTS alerts_device_seq_key ON alerts (device_id, seq);
+CREATE UNIQUE INDEX IF NOT EXISTS door_events_device_seq_key ON door_events (device_id, seq);
+CREATE UNIQUE INDEX IF NOT EXISTS defrost_sessions_device_seq_key ON defrost_sessions (device_id, seq);
+CREATE UNIQUE INDEX IF NOT EXISTS power_events_device_seq_key ON power_events (device_id, seq);
+CREATE UNIQUE INDEX IF NOT EXISTS maintenance_logs_device_seq_key ON maintenance_logs (device_id, seq);
+
+-- Verificar que las columnas se agregaron
+SELECT table_name, column_name, data_type
+FROM information_schema.columns
+WHERE column_name = 'seq'
+AND table_name IN ('readings', 'alerts', 'door_events', 'defrost_sessions',
+                   'power_events', 'maintenance_logs');